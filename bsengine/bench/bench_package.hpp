@@ -0,0 +1,25 @@
+﻿// ヘッドレス版のエンジンとリンクするベンチマーク用
+#pragma once
+
+#include <bstorm/config.hpp>
+#include <bstorm/engine.hpp>
+#include <bstorm/package.hpp>
+#include <bstorm/string_util.hpp>
+
+#include <fstream>
+#include <memory>
+
+namespace bstorm
+{
+// 空のパッケージスクリプトを書き出してパッケージを作る
+// スクリプトは開始しないので, オブジェクトはベンチマーク側でPackageのCreate系の関数で作る
+inline std::shared_ptr<Package> CreateBenchPackage(Engine& engine)
+{
+    const char* path = "bench_package.dnh";
+    {
+        std::ofstream file(path);
+        file << "#TouhouDanmakufu[Package]\n@Initialize {}\n@MainLoop {}\n";
+    }
+    return engine.CreatePackage(640, 480, ToUnicode(path));
+}
+}
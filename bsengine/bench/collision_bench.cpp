@@ -0,0 +1,725 @@
+﻿// 当たり判定の空間分割のベンチマーク
+// 同じ場面をQuadTreeBroadphaseとUniformGridBroadphaseで検査し, 衝突検査の回数と時間を比べる
+// 衝突の数が一致することも確認する
+// 円同士の検査はIntersectCircleBatchとShape::IsIntersectedを1万, 5万, 10万個の弾で比べる
+// 並列の検査はスレッド数を変えて時間を比べ, 衝突処理の順番がスレッド数によらないことも確認する
+// 衝突処理の中で判定を追加する場面(弾消しで出るボーナスアイテム)でも確認する
+// 矩形の検査はOrientedRectを使う検査と, 以前の三角関数で頂点を求める検査を比べる
+// 弾の移動はCollisionDetector::Transの時間を測る
+// 複数の円からなる弾は円ごとの判定とShape::Type::CIRCLESの判定を比べ, 衝突の数が一致することも確認する
+#include <bstorm/intersection.hpp>
+#include <bstorm/broadphase.hpp>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <deque>
+#include <random>
+#include <vector>
+
+using namespace bstorm;
+
+namespace
+{
+constexpr int FIELD_WIDTH = 640;
+constexpr int FIELD_HEIGHT = 480;
+
+constexpr CollisionGroup GRP_ENEMY_SHOT = 0;
+constexpr CollisionGroup GRP_PLAYER_SHOT = 1;
+constexpr CollisionGroup GRP_PLAYER = 2;
+constexpr CollisionGroup GRP_PLAYER_GRAZE = 3;
+constexpr CollisionGroup GRP_ENEMY = 4;
+constexpr int GRP_COUNT = 5;
+
+int hitCnt = 0;
+uint64_t hitOrderHash = 0;
+
+void countHit(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2);
+void spawnOnHit(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2);
+
+// DEFAULT_COLLISION_MATRIXと同じ組が衝突する
+const CollisionFunction BENCH_COLLISION_MATRIX[GRP_COUNT * GRP_COUNT] = {
+    // ENEMY_SHOT, PLAYER_SHOT, PLAYER, PLAYER_GRAZE, ENEMY
+    nullptr, countHit, countHit, countHit, nullptr,
+    nullptr, nullptr, nullptr, nullptr, countHit,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
+// 自機の弾が敵弾に当たると, その位置に判定を追加する
+const CollisionFunction BENCH_SPAWN_COLLISION_MATRIX[GRP_COUNT * GRP_COUNT] = {
+    // ENEMY_SHOT, PLAYER_SHOT, PLAYER, PLAYER_GRAZE, ENEMY
+    nullptr, spawnOnHit, countHit, countHit, nullptr,
+    nullptr, nullptr, nullptr, nullptr, countHit,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
+class BenchIntersection : public Intersection
+{
+public:
+    BenchIntersection(float x, float y, float r, CollisionGroup group) : Intersection(Shape(x, y, r), group), id_(nextId_++) {}
+    BenchIntersection(float x1, float y1, float x2, float y2, float width, CollisionGroup group) : Intersection(Shape(x1, y1, x2, y2, width), group), id_(nextId_++) {}
+    BenchIntersection(const Shape& shape, CollisionGroup group) : Intersection(shape, group), id_(nextId_++) {}
+    // 場面の中での作成順
+    int GetId() const { return id_; }
+    static void ResetId() { nextId_ = 0; }
+private:
+    const int id_;
+    static int nextId_;
+};
+int BenchIntersection::nextId_ = 0;
+
+void countHit(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+{
+    hitCnt++;
+    const int id1 = std::static_pointer_cast<BenchIntersection>(isect1)->GetId();
+    const int id2 = std::static_pointer_cast<BenchIntersection>(isect2)->GetId();
+    hitOrderHash = hitOrderHash * 1000003 + id1 * 131071 + id2;
+}
+
+// spawnOnHitで判定を追加する先
+CollisionDetector* spawnDetector = nullptr;
+std::vector<std::shared_ptr<Intersection>> spawnedIsects;
+constexpr size_t MAX_SPAWN_COUNT = 2000;
+
+void spawnOnHit(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+{
+    countHit(isect1, isect2);
+    if (!spawnDetector || spawnedIsects.size() >= MAX_SPAWN_COUNT) return;
+    const auto& box = isect1->GetShape().GetBoundingBox();
+    auto isect = std::make_shared<BenchIntersection>((box.left_ + box.right_) / 2, (box.top_ + box.bottom_) / 2, 8.0f, GRP_ENEMY_SHOT);
+    spawnDetector->Add(isect);
+    spawnedIsects.push_back(isect);
+}
+
+using Scene = std::vector<std::shared_ptr<Intersection>>;
+
+void addPlayer(Scene& scene, float x, float y)
+{
+    scene.push_back(std::make_shared<BenchIntersection>(x, y, 1.5f, GRP_PLAYER));
+    scene.push_back(std::make_shared<BenchIntersection>(x, y, 25.5f, GRP_PLAYER_GRAZE));
+    scene.push_back(std::make_shared<BenchIntersection>(320.0f, 100.0f, 32.0f, GRP_ENEMY));
+    for (int i = 0; i < 100; i++)
+    {
+        scene.push_back(std::make_shared<BenchIntersection>(x - 8.0f + 16.0f * (i & 1), y - 12.0f * (i >> 1), 6.0f, GRP_PLAYER_SHOT));
+    }
+}
+
+// 画面全体にばらまかれた弾
+Scene createScatterScene(int shotCnt)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> xDist(0.0f, (float)FIELD_WIDTH);
+    std::uniform_real_distribution<float> yDist(0.0f, (float)FIELD_HEIGHT);
+    std::uniform_real_distribution<float> rDist(2.0f, 10.0f);
+    Scene scene;
+    for (int i = 0; i < shotCnt; i++)
+    {
+        scene.push_back(std::make_shared<BenchIntersection>(xDist(rng), yDist(rng), rDist(rng), GRP_ENEMY_SHOT));
+    }
+    addPlayer(scene, 320.0f, 400.0f);
+    return scene;
+}
+
+// 敵を中心とした密な全方位弾
+Scene createCurtainScene()
+{
+    Scene scene;
+    for (int ring = 0; ring < 40; ring++)
+    {
+        const float dist = 20.0f + ring * 9.0f;
+        for (int i = 0; i < 200; i++)
+        {
+            const float angle = 6.2831853f * i / 200 + ring * 0.05f;
+            scene.push_back(std::make_shared<BenchIntersection>(320.0f + dist * std::cos(angle), 100.0f + dist * std::sin(angle), 4.0f, GRP_ENEMY_SHOT));
+        }
+    }
+    addPlayer(scene, 320.0f, 400.0f);
+    return scene;
+}
+
+// 4分木のセルの境界に並んだ弾
+Scene createBoundaryScene()
+{
+    Scene scene;
+    const float unitW = (float)FIELD_WIDTH / (1 << QuadTreeBroadphase::MaxLevel);
+    const float unitH = (float)FIELD_HEIGHT / (1 << QuadTreeBroadphase::MaxLevel);
+    for (int i = 0; i < 4000; i++)
+    {
+        const int col = (i % 15) + 1;
+        const int row = (i / 15) % 16;
+        const float y = (row + 0.5f) * unitH + (i / 240) * 0.1f;
+        scene.push_back(std::make_shared<BenchIntersection>(col * unitW, y, 5.0f, GRP_ENEMY_SHOT));
+    }
+    addPlayer(scene, 300.0f, 400.0f);
+    return scene;
+}
+
+// 弾とレーザー
+Scene createLaserScene()
+{
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> xDist(0.0f, (float)FIELD_WIDTH);
+    std::uniform_real_distribution<float> yDist(0.0f, (float)FIELD_HEIGHT);
+    Scene scene;
+    for (int i = 0; i < 2000; i++)
+    {
+        scene.push_back(std::make_shared<BenchIntersection>(xDist(rng), yDist(rng), 4.0f, GRP_ENEMY_SHOT));
+    }
+    for (int i = 0; i < 50; i++)
+    {
+        const float x = 320.0f + 300.0f * std::cos(i * 0.4f);
+        scene.push_back(std::make_shared<BenchIntersection>(320.0f, 100.0f, x, 470.0f, 10.0f, GRP_ENEMY_SHOT));
+    }
+    addPlayer(scene, 320.0f, 400.0f);
+    return scene;
+}
+
+void run(const char* name, const std::function<Scene()>& createScene)
+{
+    constexpr int FRAME_CNT = 100;
+    auto colMatrix = std::make_shared<CollisionMatrix>(GRP_COUNT, BENCH_COLLISION_MATRIX);
+    std::shared_ptr<Broadphase> broadphases[] = {
+        std::make_shared<QuadTreeBroadphase>(FIELD_WIDTH, FIELD_HEIGHT),
+        std::make_shared<UniformGridBroadphase>(FIELD_WIDTH, FIELD_HEIGHT, UniformGridBroadphase::CalcCellSize(DEFAULT_TYPICAL_SHOT_RADIUS))
+    };
+    const char* broadphaseNames[] = { "quadtree", "grid" };
+    for (int i = 0; i < 2; i++)
+    {
+        Scene scene = createScene();
+        CollisionDetector colDetector(broadphases[i], colMatrix);
+        for (const auto& isect : scene)
+        {
+            colDetector.Add(isect);
+        }
+        hitCnt = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < FRAME_CNT; f++)
+        {
+            colDetector.TestAllCollision();
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count() / FRAME_CNT;
+        size_t queryHitCnt = colDetector.GetIntersectionsCollideWithShape(Shape(320.0f, 240.0f, 64.0f), GRP_ENEMY_SHOT).size();
+        std::printf("%-11s %-9s isects=%6zu pairTests=%9zu hits=%6d queryHits=%5zu %8.3f ms/frame\n",
+                    name, broadphaseNames[i], scene.size(), broadphases[i]->GetPairTestCount(), hitCnt / FRAME_CNT, queryHitCnt, ms);
+    }
+}
+
+// 以前の矩形の検査 (比較用)
+namespace legacy
+{
+struct Point
+{
+    float x;
+    float y;
+};
+using Rect = std::array<Point, 4>;
+
+Rect LineToRect(float x1, float y1, float x2, float y2, float width)
+{
+    const float halfWidth = width / 2.0f;
+    const float normalDir = atan2(y2 - y1, x2 - x1) + 3.141592654f / 2.0f;
+    const float dx = halfWidth * cos(normalDir);
+    const float dy = halfWidth * sin(normalDir);
+    return Rect{ Point{ x1 + dx, y1 + dy }, Point{ x1 - dx, y1 - dy }, Point{ x2 - dx, y2 - dy }, Point{ x2 + dx, y2 + dy } };
+}
+
+float cross2(float x1, float y1, float x2, float y2)
+{
+    return x1 * y2 - x2 * y1;
+}
+
+float dot2(float x1, float y1, float x2, float y2)
+{
+    return x1 * x2 + y1 * y2;
+}
+
+bool IsIntersectedSegmentSegment(const Point& a, const Point& b, const Point& c, const Point& d)
+{
+    float cp1 = cross2(c.x - a.x, c.y - a.y, c.x - d.x, c.y - d.y);
+    float cp2 = cross2(c.x - b.x, c.y - b.y, c.x - d.x, c.y - d.y);
+    float cp3 = cross2(c.x - a.x, c.y - a.y, b.x - a.x, b.y - a.y);
+    float cp4 = cross2(d.x - a.x, d.y - a.y, b.x - a.x, b.y - a.y);
+    return cp1 * cp2 <= 0.0f && cp3 * cp4 <= 0.0f;
+}
+
+bool IsPointInRect(const Point& p, const Rect& rect)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        const Point& a = rect[i];
+        const Point& b = rect[(i + 1) & 3];
+        if (cross2(p.x - a.x, p.y - a.y, b.x - a.x, b.y - a.y) > 0.0f) return false;
+    }
+    return true;
+}
+
+bool IsIntersectedCircleSegment(float cx, float cy, float r, const Point& a, const Point& b)
+{
+    float abX = b.x - a.x;
+    float abY = b.y - a.y;
+    float acX = cx - a.x;
+    float acY = cy - a.y;
+    float bcX = cx - b.x;
+    float bcY = cy - b.y;
+    float d = std::abs(cross2(abX, abY, acX, acY)) / std::hypotf(abX, abY);
+    if (d > r) return false;
+    if (dot2(abX, abY, acX, acY) * dot2(abX, abY, bcX, bcY) <= 0.0f) return true;
+    return std::hypotf(acX, acY) <= r || std::hypotf(bcX, bcY) <= r;
+}
+
+bool IsIntersectedLineCircle(float x1, float y1, float x2, float y2, float width, float cx, float cy, float r)
+{
+    const auto rect = LineToRect(x1, y1, x2, y2, width);
+    for (int i = 0; i < 4; i++)
+    {
+        if (IsIntersectedCircleSegment(cx, cy, r, rect[i], rect[(i + 1) & 3])) return true;
+    }
+    return IsPointInRect(Point{ cx, cy }, rect);
+}
+
+bool IsIntersectedLineLine(const float* line1, const float* line2)
+{
+    const auto rect1 = LineToRect(line1[0], line1[1], line1[2], line1[3], line1[4]);
+    const auto rect2 = LineToRect(line2[0], line2[1], line2[2], line2[3], line2[4]);
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            if (IsIntersectedSegmentSegment(rect1[i], rect1[(i + 1) & 3], rect2[j], rect2[(j + 1) & 3])) return true;
+        }
+    }
+    return IsPointInRect(rect1[0], rect2) || IsPointInRect(rect2[0], rect1);
+}
+}
+
+// 線と円, 線と線の検査 (バウンディングボックスの判定を除く)
+// 境界上の誤差以外で結果が変わらないことを確認する
+void runLineKernel()
+{
+    constexpr int LINE_CNT = 2000;
+    constexpr int CIRCLE_CNT = 2000;
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> posDist(0.0f, 200.0f);
+    std::uniform_real_distribution<float> lenDist(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> widthDist(1.0f, 30.0f);
+    std::uniform_real_distribution<float> rDist(1.0f, 20.0f);
+    std::vector<std::array<float, 5>> lines;
+    std::vector<OrientedRect> rects;
+    for (int i = 0; i < LINE_CNT; i++)
+    {
+        const float x1 = posDist(rng);
+        const float y1 = posDist(rng);
+        lines.push_back({ x1, y1, x1 + lenDist(rng), y1 + lenDist(rng), widthDist(rng) });
+        rects.push_back(LineToOrientedRect(lines.back()[0], lines.back()[1], lines.back()[2], lines.back()[3], lines.back()[4]));
+    }
+    std::vector<std::array<float, 3>> circles;
+    for (int i = 0; i < CIRCLE_CNT; i++)
+    {
+        circles.push_back({ posDist(rng), posDist(rng), rDist(rng) });
+    }
+
+    // 線と円
+    int legacyHitCnt = 0;
+    int hitCnt = 0;
+    int diffCnt = 0;
+    double legacyMs = 0;
+    double ms = 0;
+    {
+        std::vector<uint8_t> legacyHits;
+        legacyHits.reserve(LINE_CNT * CIRCLE_CNT);
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& line : lines)
+        {
+            for (const auto& circle : circles)
+            {
+                legacyHits.push_back(legacy::IsIntersectedLineCircle(line[0], line[1], line[2], line[3], line[4], circle[0], circle[1], circle[2]));
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        legacyMs = std::chrono::duration<double, std::milli>(end - start).count();
+        size_t k = 0;
+        start = std::chrono::steady_clock::now();
+        for (const auto& rect : rects)
+        {
+            for (const auto& circle : circles)
+            {
+                const bool hit = IsIntersectedOrientedRectCircle(rect, circle[0], circle[1], circle[2]);
+                hitCnt += hit;
+                legacyHitCnt += legacyHits[k];
+                diffCnt += hit != (legacyHits[k] != 0);
+                k++;
+            }
+        }
+        end = std::chrono::steady_clock::now();
+        ms = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    std::printf("line-circle %8d pairs  legacy %8.3f ms (hits=%7d)  OrientedRect %8.3f ms (hits=%7d)  x%.2f  diff=%d\n",
+                LINE_CNT * CIRCLE_CNT, legacyMs, legacyHitCnt, ms, hitCnt, legacyMs / ms, diffCnt);
+
+    // 線と線
+    legacyHitCnt = hitCnt = diffCnt = 0;
+    {
+        std::vector<uint8_t> legacyHits;
+        legacyHits.reserve(LINE_CNT * LINE_CNT);
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& line1 : lines)
+        {
+            for (const auto& line2 : lines)
+            {
+                legacyHits.push_back(legacy::IsIntersectedLineLine(line1.data(), line2.data()));
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        legacyMs = std::chrono::duration<double, std::milli>(end - start).count();
+        size_t k = 0;
+        start = std::chrono::steady_clock::now();
+        for (const auto& rect1 : rects)
+        {
+            for (const auto& rect2 : rects)
+            {
+                const bool hit = IsIntersectedOrientedRects(rect1, rect2);
+                hitCnt += hit;
+                legacyHitCnt += legacyHits[k];
+                diffCnt += hit != (legacyHits[k] != 0);
+                k++;
+            }
+        }
+        end = std::chrono::steady_clock::now();
+        ms = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    std::printf("line-line   %8d pairs  legacy %8.3f ms (hits=%7d)  OrientedRect %8.3f ms (hits=%7d)  x%.2f  diff=%d\n",
+                LINE_CNT * LINE_CNT, legacyMs, legacyHitCnt, ms, hitCnt, legacyMs / ms, diffCnt);
+}
+
+// 曲がるレーザー
+// ObjCrLaserと同じく, 毎フレーム各レーザーの先頭に線分の判定を1つ足して末尾の判定を1つ消してから検査する
+void runCurvyLasers(int laserCnt, int nodeCnt)
+{
+    constexpr int FRAME_CNT = 100;
+    auto colMatrix = std::make_shared<CollisionMatrix>(GRP_COUNT, BENCH_COLLISION_MATRIX);
+    for (int i = 0; i < 2; i++)
+    {
+        std::shared_ptr<Broadphase> broadphase;
+        if (i == 0)
+        {
+            broadphase = std::make_shared<QuadTreeBroadphase>(FIELD_WIDTH, FIELD_HEIGHT);
+        } else
+        {
+            broadphase = std::make_shared<UniformGridBroadphase>(FIELD_WIDTH, FIELD_HEIGHT, UniformGridBroadphase::CalcCellSize(DEFAULT_TYPICAL_SHOT_RADIUS));
+        }
+        CollisionDetector colDetector(broadphase, colMatrix);
+        Scene player;
+        addPlayer(player, 320.0f, 400.0f);
+        for (const auto& isect : player)
+        {
+            colDetector.Add(isect);
+        }
+        // レーザーの先端の位置と向き
+        std::vector<float> headX(laserCnt, 320.0f);
+        std::vector<float> headY(laserCnt, 100.0f);
+        std::vector<float> angle(laserCnt);
+        std::vector<std::deque<std::shared_ptr<Intersection>>> nodes(laserCnt);
+        auto extend = [&](int k, int frame)
+        {
+            angle[k] += 0.05f * std::sin(frame * 0.02f + k);
+            const float x = headX[k] + 4.0f * std::cos(angle[k]);
+            const float y = headY[k] + 4.0f * std::sin(angle[k]);
+            auto isect = std::make_shared<BenchIntersection>(headX[k], headY[k], x, y, 6.0f, GRP_ENEMY_SHOT);
+            colDetector.Add(isect);
+            nodes[k].push_back(isect);
+            if ((int)nodes[k].size() > nodeCnt)
+            {
+                colDetector.Remove(nodes[k].front());
+                nodes[k].pop_front();
+            }
+            headX[k] = x;
+            headY[k] = y;
+        };
+        for (int k = 0; k < laserCnt; k++)
+        {
+            angle[k] = 6.2831853f * k / laserCnt;
+            for (int n = 0; n < nodeCnt; n++)
+            {
+                extend(k, n);
+            }
+        }
+        hitCnt = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < FRAME_CNT; f++)
+        {
+            for (int k = 0; k < laserCnt; k++)
+            {
+                extend(k, nodeCnt + f);
+            }
+            colDetector.TestAllCollision();
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count() / FRAME_CNT;
+        std::printf("crlaser x%d %-9s isects=%6d pairTests=%9zu hits=%6d %8.3f ms/frame\n",
+                    laserCnt, i == 0 ? "quadtree" : "grid", laserCnt * nodeCnt, broadphase->GetPairTestCount(), hitCnt / FRAME_CNT, ms);
+    }
+}
+
+// 1つの円と弾の円の検査
+void runCircleBatch(int shotCnt)
+{
+    constexpr int LOOP_CNT = 200;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> xDist(0.0f, (float)FIELD_WIDTH);
+    std::uniform_real_distribution<float> yDist(0.0f, (float)FIELD_HEIGHT);
+    std::uniform_real_distribution<float> rDist(2.0f, 10.0f);
+    std::vector<Shape> shapes;
+    CircleBatch batch;
+    for (int i = 0; i < shotCnt; i++)
+    {
+        shapes.emplace_back(xDist(rng), yDist(rng), rDist(rng));
+        float x, y, r;
+        shapes.back().GetCircle(x, y, r);
+        batch.Push(shapes.back().GetBoundingBox(), x, y, r, i);
+    }
+    // 喰らいボム程度の大きさの円
+    const Shape probe(320.0f, 240.0f, 120.0f);
+    float px, py, pr;
+    probe.GetCircle(px, py, pr);
+
+    std::vector<uint32_t> scalarHits;
+    auto start = std::chrono::steady_clock::now();
+    for (int l = 0; l < LOOP_CNT; l++)
+    {
+        scalarHits.clear();
+        for (int i = 0; i < shotCnt; i++)
+        {
+            if (probe.IsIntersected(shapes[i])) scalarHits.push_back(i);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double scalarMs = std::chrono::duration<double, std::milli>(end - start).count() / LOOP_CNT;
+
+    std::vector<uint32_t> batchHits(shotCnt);
+    size_t hitCnt = 0;
+    start = std::chrono::steady_clock::now();
+    for (int l = 0; l < LOOP_CNT; l++)
+    {
+        hitCnt = IntersectCircleBatch(probe.GetBoundingBox(), px, py, pr, batch, 0, batch.Size(), batchHits.data());
+    }
+    end = std::chrono::steady_clock::now();
+    double batchMs = std::chrono::duration<double, std::milli>(end - start).count() / LOOP_CNT;
+    batchHits.resize(hitCnt);
+
+    std::printf("circles=%6d hits=%6zu  Shape::IsIntersected %8.3f ms  IntersectCircleBatch %8.3f ms  x%.2f  %s\n",
+                shotCnt, hitCnt, scalarMs, batchMs, scalarMs / batchMs, batchHits == scalarHits ? "same" : "DIFFERENT");
+}
+
+// 毎フレーム全ての弾を動かしてから検査する
+void runMovingShots(int shotCnt)
+{
+    constexpr int FRAME_CNT = 50;
+    auto colMatrix = std::make_shared<CollisionMatrix>(GRP_COUNT, BENCH_COLLISION_MATRIX);
+    for (int i = 0; i < 2; i++)
+    {
+        std::shared_ptr<Broadphase> broadphase;
+        if (i == 0)
+        {
+            broadphase = std::make_shared<QuadTreeBroadphase>(FIELD_WIDTH, FIELD_HEIGHT);
+        } else
+        {
+            broadphase = std::make_shared<UniformGridBroadphase>(FIELD_WIDTH, FIELD_HEIGHT, UniformGridBroadphase::CalcCellSize(DEFAULT_TYPICAL_SHOT_RADIUS));
+        }
+        const Scene scene = createScatterScene(shotCnt);
+        CollisionDetector colDetector(broadphase, colMatrix);
+        for (const auto& isect : scene)
+        {
+            colDetector.Add(isect);
+        }
+        // 弾ごとの速度
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> speedDist(-3.0f, 3.0f);
+        std::vector<std::pair<float, float>> speeds(shotCnt);
+        for (auto& speed : speeds)
+        {
+            speed = std::make_pair(speedDist(rng), speedDist(rng));
+        }
+        hitCnt = 0;
+        double transMs = 0;
+        double testMs = 0;
+        for (int f = 0; f < FRAME_CNT; f++)
+        {
+            // 往復させて画面内に留める
+            const float dir = (f / 10) % 2 == 0 ? 1.0f : -1.0f;
+            auto start = std::chrono::steady_clock::now();
+            for (int k = 0; k < shotCnt; k++)
+            {
+                colDetector.Trans(scene[k], dir * speeds[k].first, dir * speeds[k].second);
+            }
+            auto mid = std::chrono::steady_clock::now();
+            colDetector.TestAllCollision();
+            auto end = std::chrono::steady_clock::now();
+            transMs += std::chrono::duration<double, std::milli>(mid - start).count();
+            testMs += std::chrono::duration<double, std::milli>(end - mid).count();
+        }
+        std::printf("moving%dk %-9s hits=%6d Trans %8.3f ms/frame  TestAllCollision %8.3f ms/frame\n",
+                    shotCnt / 1000, i == 0 ? "quadtree" : "grid", hitCnt / FRAME_CNT, transMs / FRAME_CNT, testMs / FRAME_CNT);
+    }
+}
+
+// 3つの円からなる細長い弾 (米弾やナイフ弾)
+// isCompoundなら1つの判定にまとめる
+Scene createCompoundShotScene(int shotCnt, bool isCompound)
+{
+    constexpr int CIRCLE_CNT = 3;
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> xDist(0.0f, (float)FIELD_WIDTH);
+    std::uniform_real_distribution<float> yDist(0.0f, (float)FIELD_HEIGHT);
+    std::uniform_real_distribution<float> angleDist(0.0f, 6.2831853f);
+    Scene scene;
+    for (int i = 0; i < shotCnt; i++)
+    {
+        const float x = xDist(rng);
+        const float y = yDist(rng);
+        const float angle = angleDist(rng);
+        float xs[CIRCLE_CNT], ys[CIRCLE_CNT], rs[CIRCLE_CNT];
+        for (int k = 0; k < CIRCLE_CNT; k++)
+        {
+            xs[k] = x + (k - 1) * 6.0f * std::cos(angle);
+            ys[k] = y + (k - 1) * 6.0f * std::sin(angle);
+            rs[k] = 3.0f;
+        }
+        if (isCompound)
+        {
+            scene.push_back(std::make_shared<BenchIntersection>(Shape(CIRCLE_CNT, xs, ys, rs), GRP_ENEMY_SHOT));
+        } else
+        {
+            for (int k = 0; k < CIRCLE_CNT; k++)
+            {
+                scene.push_back(std::make_shared<BenchIntersection>(xs[k], ys[k], rs[k], GRP_ENEMY_SHOT));
+            }
+        }
+    }
+    addPlayer(scene, 320.0f, 400.0f);
+    return scene;
+}
+
+void runCompoundShots(int shotCnt)
+{
+    constexpr int FRAME_CNT = 50;
+    auto colMatrix = std::make_shared<CollisionMatrix>(GRP_COUNT, BENCH_COLLISION_MATRIX);
+    for (int i = 0; i < 2; i++)
+    {
+        int separateHitCnt = 0;
+        for (bool isCompound : { false, true })
+        {
+            std::shared_ptr<Broadphase> broadphase;
+            if (i == 0)
+            {
+                broadphase = std::make_shared<QuadTreeBroadphase>(FIELD_WIDTH, FIELD_HEIGHT);
+            } else
+            {
+                broadphase = std::make_shared<UniformGridBroadphase>(FIELD_WIDTH, FIELD_HEIGHT, UniformGridBroadphase::CalcCellSize(DEFAULT_TYPICAL_SHOT_RADIUS));
+            }
+            const Scene scene = createCompoundShotScene(shotCnt, isCompound);
+            CollisionDetector colDetector(broadphase, colMatrix);
+            for (const auto& isect : scene)
+            {
+                colDetector.Add(isect);
+            }
+            hitCnt = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int f = 0; f < FRAME_CNT; f++)
+            {
+                colDetector.TestAllCollision();
+            }
+            auto end = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(end - start).count() / FRAME_CNT;
+            if (!isCompound) separateHitCnt = hitCnt;
+            std::printf("compound%dk %-9s %-8s isects=%6zu pairTests=%9zu hits=%6d %8.3f ms/frame  %s\n",
+                        shotCnt / 1000, i == 0 ? "quadtree" : "grid", isCompound ? "compound" : "separate", scene.size(),
+                        broadphase->GetPairTestCount(), hitCnt / FRAME_CNT, ms, separateHitCnt == hitCnt ? "same" : "DIFFERENT");
+        }
+    }
+}
+
+// スレッド数ごとの検査
+void runParallel(const char* name, const std::function<Scene()>& createScene, const CollisionFunction* matrix = BENCH_COLLISION_MATRIX)
+{
+    constexpr int FRAME_CNT = 20;
+    auto colMatrix = std::make_shared<CollisionMatrix>(GRP_COUNT, matrix);
+    for (int i = 0; i < 2; i++)
+    {
+        double baseMs = 0;
+        uint64_t baseHash = 0;
+        for (int threadCnt : { 1, 2, 4, 8 })
+        {
+            std::shared_ptr<Broadphase> broadphase;
+            if (i == 0)
+            {
+                broadphase = std::make_shared<QuadTreeBroadphase>(FIELD_WIDTH, FIELD_HEIGHT);
+            } else
+            {
+                broadphase = std::make_shared<UniformGridBroadphase>(FIELD_WIDTH, FIELD_HEIGHT, UniformGridBroadphase::CalcCellSize(DEFAULT_TYPICAL_SHOT_RADIUS));
+            }
+            broadphase->SetThreadCount(threadCnt);
+            // 判定は1つのCollisionDetectorにしか登録できない
+            BenchIntersection::ResetId();
+            const Scene scene = createScene();
+            CollisionDetector colDetector(broadphase, colMatrix);
+            for (const auto& isect : scene)
+            {
+                colDetector.Add(isect);
+            }
+            hitCnt = 0;
+            hitOrderHash = 0;
+            spawnDetector = &colDetector;
+            spawnedIsects.clear();
+            auto start = std::chrono::steady_clock::now();
+            for (int f = 0; f < FRAME_CNT; f++)
+            {
+                colDetector.TestAllCollision();
+            }
+            auto end = std::chrono::steady_clock::now();
+            spawnDetector = nullptr;
+            double ms = std::chrono::duration<double, std::milli>(end - start).count() / FRAME_CNT;
+            // 衝突処理の順番は逐次に検査する1スレッドの時と比べる
+            if (threadCnt == 1)
+            {
+                baseMs = ms;
+                baseHash = hitOrderHash;
+            }
+            std::printf("%-11s %-9s threads=%d hits=%6d %8.3f ms/frame  x%.2f  %s\n",
+                        name, i == 0 ? "quadtree" : "grid", threadCnt, hitCnt / FRAME_CNT, ms, baseMs / ms, baseHash == hitOrderHash ? "same order" : "DIFFERENT ORDER");
+        }
+    }
+}
+}
+
+int main()
+{
+    runCircleBatch(10000);
+    runCircleBatch(50000);
+    runCircleBatch(100000);
+    run("scatter", [] { return createScatterScene(4000); });
+    run("scatter10k", [] { return createScatterScene(10000); });
+    run("scatter50k", [] { return createScatterScene(50000); });
+    run("scatter100k", [] { return createScatterScene(100000); });
+    run("curtain", createCurtainScene);
+    run("boundary", createBoundaryScene);
+    run("laser", createLaserScene);
+    runParallel("scatter100k", [] { return createScatterScene(100000); });
+    runParallel("curtain", createCurtainScene);
+    runParallel("spawn", [] { return createScatterScene(4000); }, BENCH_SPAWN_COLLISION_MATRIX);
+    runParallel("spawn100k", [] { return createScatterScene(100000); }, BENCH_SPAWN_COLLISION_MATRIX);
+    runLineKernel();
+    runCurvyLasers(200, 32);
+    runCompoundShots(4000);
+    runCompoundShots(20000);
+    runMovingShots(10000);
+    runMovingShots(50000);
+    return 0;
+}
@@ -0,0 +1,234 @@
+﻿// 当たり判定のフレーム単位のベンチマーク
+// 敵弾, 自機と擦り判定, 自機の弾, 敵, スペル, レーザー, アイテムを置いた場面で
+// 毎フレーム敵弾を動かしてからTestAllCollisionを行い, 1フレームあたりの時間, 衝突検査の回数, 衝突の数を出す
+// 引数: [敵弾の数] [スレッド数]
+// 敵弾の数を省略すると1000, 5000, 20000, 50000発で測る
+#include <bstorm/intersection.hpp>
+#include <bstorm/broadphase.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace bstorm;
+
+namespace
+{
+constexpr int FIELD_WIDTH = 384;
+constexpr int FIELD_HEIGHT = 448;
+constexpr int FRAME_CNT = 120;
+
+// 衝突の種類
+enum HitKind
+{
+    HIT_ERASE_SHOT,
+    HIT_PLAYER,
+    HIT_GRAZE,
+    HIT_SPELL_ERASE_SHOT,
+    HIT_ENEMY_DAMAGE,
+    HIT_PLAYER_ENEMY,
+    HIT_SPELL_DAMAGE,
+    HIT_ITEM,
+    HIT_TEMP_ENEMY_SHOT,
+    HIT_KIND_COUNT
+};
+
+const char* HIT_KIND_NAMES[HIT_KIND_COUNT] = {
+    "erase", "player", "graze", "spellErase", "enemyDamage", "playerEnemy", "spellDamage", "item", "tempShot"
+};
+
+std::array<long long, HIT_KIND_COUNT> hitCnts;
+
+template <HitKind kind>
+void countHit(const std::shared_ptr<Intersection>&, const std::shared_ptr<Intersection>&)
+{
+    hitCnts[kind]++;
+}
+
+// DEFAULT_COLLISION_MATRIXの関数はObjShot等のオブジェクトを必要とするので,
+// 同じ組に衝突の種類を数えるだけの関数を置いた行列を使う
+const CollisionFunction BENCH_COLLISION_MATRIX[DEFAULT_COLLISION_MATRIX_DIMENSION * DEFAULT_COLLISION_MATRIX_DIMENSION] = {
+    /* COL_GRP_ENEMY_SHOT           */  nullptr, countHit<HIT_ERASE_SHOT>, nullptr, countHit<HIT_PLAYER>, countHit<HIT_GRAZE>, nullptr, nullptr, countHit<HIT_SPELL_ERASE_SHOT>, nullptr, nullptr, nullptr,
+    /* COL_GRP_PLAYER_ERASE_SHOT    */  nullptr, nullptr, nullptr, nullptr, nullptr, countHit<HIT_ENEMY_DAMAGE>, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_PLAYER_NON_ERASESHOT */  nullptr, nullptr, nullptr, nullptr, nullptr, countHit<HIT_ENEMY_DAMAGE>, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_PLAYER               */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, countHit<HIT_PLAYER_ENEMY>, nullptr, nullptr, nullptr, countHit<HIT_TEMP_ENEMY_SHOT>,
+    /* COL_GRP_PLAYER_GRAZE         */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_ENEMY_TO_SHOT        */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, countHit<HIT_SPELL_DAMAGE>, nullptr, nullptr, nullptr,
+    /* COL_GRP_ENEMY_TO_PLAYER      */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_SPELL                */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_PLAYER_TO_ITEM       */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, countHit<HIT_ITEM>, nullptr,
+    /* COL_GRP_ITEM                 */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_TEMP_ENEMY_SHOT      */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
+};
+
+struct MovingIntersection
+{
+    std::shared_ptr<Intersection> isect;
+    float speedX;
+    float speedY;
+};
+
+struct Scene
+{
+    std::vector<MovingIntersection> enemyShots; // 毎フレーム動かす
+    std::vector<std::shared_ptr<Intersection>> others;
+    size_t GetIntersectionCount() const { return enemyShots.size() + others.size(); }
+};
+
+Scene createScene(int enemyShotCnt, CollisionDetector& colDetector)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> xDist(0.0f, (float)FIELD_WIDTH);
+    std::uniform_real_distribution<float> yDist(0.0f, (float)FIELD_HEIGHT);
+    std::uniform_real_distribution<float> angleDist(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> speedDist(0.5f, 3.0f);
+    std::uniform_real_distribution<float> rDist(2.0f, 8.0f);
+    Scene scene;
+    auto add = [&](const std::shared_ptr<Intersection>& isect)
+    {
+        colDetector.Add(isect);
+        scene.others.push_back(isect);
+    };
+
+    // 敵弾, 1割は3つの円からなる細長い弾
+    for (int i = 0; i < enemyShotCnt; i++)
+    {
+        const float x = xDist(rng);
+        const float y = yDist(rng);
+        const float angle = angleDist(rng);
+        const float speed = speedDist(rng);
+        std::shared_ptr<Intersection> isect;
+        if (i % 10 == 0)
+        {
+            float xs[3], ys[3], rs[3];
+            for (int k = 0; k < 3; k++)
+            {
+                xs[k] = x + (k - 1) * 5.0f * std::cos(angle);
+                ys[k] = y + (k - 1) * 5.0f * std::sin(angle);
+                rs[k] = 2.5f;
+            }
+            isect = std::make_shared<Intersection>(Shape(3, xs, ys, rs), COL_GRP_ENEMY_SHOT);
+        } else
+        {
+            isect = std::make_shared<Intersection>(Shape(x, y, rDist(rng)), COL_GRP_ENEMY_SHOT);
+        }
+        colDetector.Add(isect);
+        scene.enemyShots.push_back(MovingIntersection{ isect, speed * std::cos(angle), speed * std::sin(angle) });
+    }
+
+    // 敵弾のレーザー
+    for (int i = 0; i < 16; i++)
+    {
+        const float x = FIELD_WIDTH * (i + 0.5f) / 16;
+        add(std::make_shared<Intersection>(Shape(FIELD_WIDTH / 2.0f, 100.0f, x, (float)FIELD_HEIGHT, 12.0f), COL_GRP_ENEMY_SHOT));
+    }
+
+    // 自機と擦り判定, アイテム回収判定
+    const float playerX = FIELD_WIDTH / 2.0f;
+    const float playerY = FIELD_HEIGHT - 48.0f;
+    add(std::make_shared<Intersection>(Shape(playerX, playerY, 1.5f), COL_GRP_PLAYER));
+    add(std::make_shared<Intersection>(Shape(playerX, playerY, 25.5f), COL_GRP_PLAYER_GRAZE));
+    add(std::make_shared<Intersection>(Shape(playerX, playerY, 0.0f), COL_GRP_PLAYER_TO_ITEM));
+
+    // 自機の弾, 4分の1は敵弾を消す弾
+    for (int i = 0; i < 200; i++)
+    {
+        const float x = playerX - 16.0f + 32.0f * (i & 1);
+        const float y = playerY - 10.0f * (i >> 1);
+        add(std::make_shared<Intersection>(Shape(x, y, 6.0f), i % 4 == 0 ? COL_GRP_PLAYER_ERASE_SHOT : COL_GRP_PLAYER_NON_ERASE_SHOT));
+    }
+
+    // 敵
+    for (int i = 0; i < 4; i++)
+    {
+        const float x = FIELD_WIDTH * (i + 0.5f) / 4;
+        add(std::make_shared<Intersection>(Shape(x, 100.0f, 32.0f), COL_GRP_ENEMY_TO_SHOT));
+        add(std::make_shared<Intersection>(Shape(x, 100.0f, 16.0f), COL_GRP_ENEMY_TO_PLAYER));
+    }
+
+    // スペルの円
+    for (int i = 0; i < 8; i++)
+    {
+        const float angle = 6.2831853f * i / 8;
+        add(std::make_shared<Intersection>(Shape(playerX + 80.0f * std::cos(angle), playerY - 120.0f + 80.0f * std::sin(angle), 48.0f), COL_GRP_SPELL));
+    }
+
+    // アイテム
+    for (int i = 0; i < 500; i++)
+    {
+        add(std::make_shared<Intersection>(Shape(xDist(rng), yDist(rng), 8.0f), COL_GRP_ITEM));
+    }
+    return scene;
+}
+
+void run(int enemyShotCnt, int threadCnt)
+{
+    auto colMatrix = std::make_shared<CollisionMatrix>(DEFAULT_COLLISION_MATRIX_DIMENSION, BENCH_COLLISION_MATRIX);
+    for (int i = 0; i < 2; i++)
+    {
+        std::shared_ptr<Broadphase> broadphase;
+        if (i == 0)
+        {
+            broadphase = std::make_shared<QuadTreeBroadphase>(FIELD_WIDTH, FIELD_HEIGHT);
+        } else
+        {
+            broadphase = std::make_shared<UniformGridBroadphase>(FIELD_WIDTH, FIELD_HEIGHT, UniformGridBroadphase::CalcCellSize(DEFAULT_TYPICAL_SHOT_RADIUS));
+        }
+        broadphase->SetThreadCount(threadCnt);
+        CollisionDetector colDetector(broadphase, colMatrix);
+        Scene scene = createScene(enemyShotCnt, colDetector);
+        hitCnts.fill(0);
+        size_t pairTestCnt = 0;
+        double transMs = 0;
+        double testMs = 0;
+        for (int f = 0; f < FRAME_CNT; f++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (auto& shot : scene.enemyShots)
+            {
+                // 画面端で跳ね返らせて弾の密度を保つ
+                const auto& boundingBox = shot.isect->GetShape().GetBoundingBox();
+                if (boundingBox.left_ < 0.0f || boundingBox.right_ > FIELD_WIDTH) shot.speedX = -shot.speedX;
+                if (boundingBox.top_ < 0.0f || boundingBox.bottom_ > FIELD_HEIGHT) shot.speedY = -shot.speedY;
+                colDetector.Trans(shot.isect, shot.speedX, shot.speedY);
+            }
+            auto mid = std::chrono::steady_clock::now();
+            colDetector.TestAllCollision();
+            auto end = std::chrono::steady_clock::now();
+            transMs += std::chrono::duration<double, std::milli>(mid - start).count();
+            testMs += std::chrono::duration<double, std::milli>(end - mid).count();
+            pairTestCnt += broadphase->GetPairTestCount();
+        }
+        std::printf("shots=%6d %-9s threads=%d isects=%6zu Trans %8.3f ms/frame  TestAllCollision %8.3f ms/frame  pairTests=%9zu/frame\n",
+                    enemyShotCnt, i == 0 ? "quadtree" : "grid", threadCnt, scene.GetIntersectionCount(),
+                    transMs / FRAME_CNT, testMs / FRAME_CNT, pairTestCnt / FRAME_CNT);
+        std::printf("    hits/frame:");
+        for (int kind = 0; kind < HIT_KIND_COUNT; kind++)
+        {
+            std::printf(" %s=%lld", HIT_KIND_NAMES[kind], hitCnts[kind] / FRAME_CNT);
+        }
+        std::printf("\n");
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    const int threadCnt = argc >= 3 ? std::max(1, std::atoi(argv[2])) : 1;
+    if (argc >= 2)
+    {
+        run(std::atoi(argv[1]), threadCnt);
+    } else
+    {
+        for (int enemyShotCnt : { 1000, 5000, 20000, 50000 })
+        {
+            run(enemyShotCnt, threadCnt);
+        }
+    }
+    return 0;
+}
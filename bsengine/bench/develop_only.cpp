@@ -0,0 +1,6 @@
+#include <bstorm/intersection.hpp>
+
+namespace bstorm
+{
+void Shape::Render(const std::shared_ptr<Renderer>& renderer, bool permitCamera) const {}
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+﻿// オブジェクトのキャストのマイクロベンチマーク
+// ヘッドレス版のエンジンで本物のObjShot, ObjItem, ObjSprite2Dを作り,
+// api.cppの関数と同じくIDからオブジェクトを引いて型を判定するのを繰り返す
+// 以前のdynamic_pointer_cast と クラスビットによるキャスト(ObjCast) を比較する
+#include "bench_package.hpp"
+
+#include <bstorm/dnh_const.hpp>
+#include <bstorm/logger.hpp>
+#include <bstorm/obj_item.hpp>
+#include <bstorm/obj_prim.hpp>
+#include <bstorm/obj_shot.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace bstorm;
+
+namespace
+{
+constexpr int OBJ_CNT = 4096;
+constexpr int REPEAT = 2000;
+
+template <class F>
+double Measure(const char* name, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    long long sum = f();
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    std::printf("%-40s %10.3f ms (%lld)\n", name, ms, sum);
+    return ms;
+}
+
+// 同じ型へのキャストをdynamic_pointer_castとObjCastで測る
+// 結果の数(キャストに成功した回数)は同じになる
+template <class T, class F>
+void Compare(const char* name, const Package& package, const std::vector<int>& ids, F use)
+{
+    std::printf("%s\n", name);
+    Measure("  dynamic_pointer_cast", [&]()
+    {
+        long long cnt = 0;
+        for (int r = 0; r < REPEAT; r++)
+            for (int id : ids)
+                if (auto obj = std::dynamic_pointer_cast<T>(package.GetObject<Obj>(id))) { use(*obj); cnt++; }
+        return cnt;
+    });
+    Measure("  ObjCast", [&]()
+    {
+        long long cnt = 0;
+        for (int r = 0; r < REPEAT; r++)
+            for (int id : ids)
+                if (auto obj = package.GetObject<T>(id)) { use(*obj); cnt++; }
+        return cnt;
+    });
+}
+}
+
+int main()
+{
+    int exitCode = 0;
+    try
+    {
+        conf::KeyConfig keyConfig;
+        Engine engine(NULL, &keyConfig);
+        auto package = CreateBenchPackage(engine);
+
+        // 弾, アイテム, スプライトを2:1:1で混ぜる
+        std::vector<int> ids;
+        for (int i = 0; i < OBJ_CNT; i++)
+        {
+            if (i % 4 == 0)
+            {
+                ids.push_back(package->CreateObjSprite2D()->GetID());
+            } else if (i % 4 == 1)
+            {
+                ids.push_back(package->CreateObjItem(ITEM_POWER)->GetID());
+            } else
+            {
+                ids.push_back(package->CreateObjShot(false)->GetID());
+            }
+        }
+
+        // ObjRender_SetX相当 (下位クラスへのキャスト)
+        Compare<ObjRender>("ObjRender", *package, ids, [](ObjRender& obj) { obj.SetZ(obj.GetZ() + 1); });
+        // ObjShot_SetDamage相当 (型の判定に失敗することもある)
+        Compare<ObjShot>("ObjShot", *package, ids, [](ObjShot& obj) { obj.SetDamage(obj.GetDamage() + 1); });
+        // ObjMove_SetSpeed相当 (多重継承の横方向のキャスト)
+        Compare<ObjMove>("ObjMove", *package, ids, [](ObjMove& obj) { obj.SetSpeed(obj.GetSpeed() + 1); });
+        // ObjCol_IsIntersected相当
+        Compare<ObjCol>("ObjCol", *package, ids, [](ObjCol& obj) { (void)obj.GetIntersections().size(); });
+
+        package->Finalize();
+    } catch (Log& log)
+    {
+        std::fprintf(stderr, "%s\n", log.ToString().c_str());
+        exitCode = 1;
+    }
+    return exitCode;
+}
@@ -0,0 +1,131 @@
+﻿// 弾の更新のベンチマーク
+// ヘッドレス版のエンジンでパッケージを動かし, MoveModeA, MoveModeBの弾を置いてTickFrameで進める
+// ObjectTable::UpdateAllの中のShotMoveBatch(並列の移動と, 逐次のUpdateAfterMoveShared)を含めた1フレームあたりの時間を,
+// 逐次更新と, ShotMoveBatchの1, 2, 4, 8スレッドで比べる
+// 弾の位置と数が逐次更新と同じになることも確認する
+// 引数: [弾の数]
+#include "bench_package.hpp"
+
+#include <bstorm/engine_develop_options.hpp>
+#include <bstorm/logger.hpp>
+#include <bstorm/obj_move.hpp>
+#include <bstorm/obj_shot.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace bstorm;
+
+namespace
+{
+constexpr int FRAME_CNT = 300;
+
+struct Result
+{
+    double msPerFrame;
+    size_t shotCnt;
+    uint64_t hash;
+};
+
+uint64_t HashFloat(uint64_t hash, float v)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return (hash ^ bits) * 1099511628211ull;
+}
+
+void CreateShots(Package& package, int shotCnt)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (int i = 0; i < shotCnt; i++)
+    {
+        auto shot = package.CreateObjShot(false);
+        shot->SetMovePosition(dist(rng) * 192.0f + 192.0f, dist(rng) * 224.0f + 224.0f);
+        // 半分をMoveModeA, 残りをMoveModeBにする
+        if (i % 2 == 0)
+        {
+            // ObjShot::SetAngularVelocityは画像の回転なのでObjMoveの方を呼ぶ
+            ObjMove& move = *shot;
+            move.SetSpeed(dist(rng) * 3.0f);
+            move.SetAngle(dist(rng) * 180.0f);
+            move.SetAcceleration(dist(rng) * 0.05f);
+            move.SetMaxSpeed(dist(rng) * 5.0f);
+            move.SetAngularVelocity(dist(rng));
+        } else
+        {
+            shot->SetMoveMode(std::make_shared<MoveModeB>(dist(rng) * 3.0f, dist(rng) * 3.0f, dist(rng) * 0.05f, dist(rng) * 0.05f, dist(rng) * 5.0f, dist(rng) * 5.0f));
+        }
+        shot->Regist();
+    }
+}
+
+// threadCntが0なら逐次更新
+Result Run(Engine& engine, int shotCnt, int threadCnt)
+{
+    engine.GetDevelopOptions()->shotMoveBatchEnable = threadCnt > 0;
+    engine.GetDevelopOptions()->shotUpdateThreadCount = std::max(1, threadCnt);
+
+    auto package = CreateBenchPackage(engine);
+    package->Start();
+    CreateShots(*package, shotCnt);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAME_CNT; f++)
+    {
+        package->TickFrame();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    Result result;
+    result.msPerFrame = std::chrono::duration<double, std::milli>(end - start).count() / FRAME_CNT;
+    result.hash = 14695981039346656037ull;
+    const auto shots = package->GetObjectAll<ObjShot>();
+    for (const auto& shot : shots)
+    {
+        const ObjMove& move = *shot;
+        result.hash = HashFloat(result.hash, move.GetMoveX());
+        result.hash = HashFloat(result.hash, move.GetMoveY());
+        result.hash = HashFloat(result.hash, move.GetSpeed());
+        result.hash = HashFloat(result.hash, move.GetAngle());
+    }
+    result.shotCnt = shots.size();
+    package->Finalize();
+    return result;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    const int shotCnt = argc > 1 ? std::atoi(argv[1]) : 50000;
+    int exitCode = 0;
+    try
+    {
+        conf::KeyConfig keyConfig;
+        Engine engine(NULL, &keyConfig);
+
+        std::printf("shots=%d frames=%d\n", shotCnt, FRAME_CNT);
+        // 結果は逐次更新と, 時間はShotMoveBatchの1スレッドと比べる
+        const Result serial = Run(engine, shotCnt, 0);
+        std::printf("serial    %8.4f ms/frame  shots=%zu\n", serial.msPerFrame, serial.shotCnt);
+        double baseMs = 0;
+        for (int threadCnt : { 1, 2, 4, 8 })
+        {
+            const Result r = Run(engine, shotCnt, threadCnt);
+            if (threadCnt == 1) baseMs = r.msPerFrame;
+            const bool same = r.hash == serial.hash && r.shotCnt == serial.shotCnt;
+            std::printf("threads=%d %8.4f ms/frame  shots=%zu  x%.2f  %s\n", threadCnt, r.msPerFrame, r.shotCnt, baseMs / r.msPerFrame, same ? "same" : "DIFFERENT");
+            if (!same) exitCode = 1;
+        }
+    } catch (Log& log)
+    {
+        std::fprintf(stderr, "%s\n", log.ToString().c_str());
+        exitCode = 1;
+    }
+    return exitCode;
+}
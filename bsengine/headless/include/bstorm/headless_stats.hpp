@@ -0,0 +1,19 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace bstorm
+{
+// ヘッドレスのバックエンドが記録する, 実際には行わなかった描画や再生の回数
+struct HeadlessStats
+{
+    std::atomic<uint64_t> drawCallCount{ 0 };
+    std::atomic<uint64_t> vertexCount{ 0 };
+    std::atomic<uint64_t> textureLoadCount{ 0 };
+    std::atomic<uint64_t> fontCreateCount{ 0 };
+    std::atomic<uint64_t> soundPlayCount{ 0 };
+};
+
+HeadlessStats& GetHeadlessStats();
+}
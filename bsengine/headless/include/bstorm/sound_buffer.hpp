@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include <memory>
+
+namespace bstorm
+{
+// ヘッドレス用のSoundBuffer
+// src/bstorm/sound_buffer.hppと同じインターフェースで, 音声は扱わずに再生状態だけを持つ
+// インクルードパスでsrc/bstormより先に見つかるので, ヘッドレスのビルドでは全てこちらを使う
+class WaveSampleStream;
+class SoundDevice;
+class SoundBuffer
+{
+public:
+    SoundBuffer(std::unique_ptr<WaveSampleStream>&& stream, const std::shared_ptr<SoundDevice>& soundDevice);
+    ~SoundBuffer();
+    void Play();
+    void Stop();
+    void Rewind();
+    void SetVolume(float volume); // 0 ~ 1
+    void SetPan(float pan); // -1 ~ 1
+    void SetLoopEnable(bool enable);
+    void SetLoopTime(size_t beginSec, size_t endSec);
+    void SetLoopSampleCount(size_t begin, size_t end);
+    void SetLoopRange(size_t begin, size_t end);
+    bool IsPlaying() const;
+    float GetVolume() const;
+    size_t GetCurrentPlayCursor() const;
+private:
+    bool isPlaying_;
+    bool isLoopEnabled_;
+    float volume_;
+    float pan_;
+};
+}
@@ -0,0 +1,105 @@
+// ヘッドレス環境用のDirect3D 9の代替
+// ヘッドレスのバックエンドはデバイスを作らないので, インターフェースは型としてだけ宣言する
+#pragma once
+
+#include <windows.h>
+#include <unknwn.h>
+
+typedef DWORD D3DCOLOR;
+#define D3DCOLOR_ARGB(a, r, g, b) ((D3DCOLOR)((((a) & 0xff) << 24) | (((r) & 0xff) << 16) | (((g) & 0xff) << 8) | ((b) & 0xff)))
+#define D3DCOLOR_RGBA(r, g, b, a) D3DCOLOR_ARGB(a, r, g, b)
+#define D3DCOLOR_XRGB(r, g, b) D3DCOLOR_ARGB(0xff, r, g, b)
+
+#define D3DFVF_XYZ 0x002
+#define D3DFVF_XYZRHW 0x004
+#define D3DFVF_NORMAL 0x010
+#define D3DFVF_DIFFUSE 0x040
+#define D3DFVF_TEX1 0x100
+
+#define D3DCLEAR_TARGET 0x00000001
+#define D3DCLEAR_ZBUFFER 0x00000002
+
+#define D3DPS_VERSION(major, minor) (0xFFFF0000 | ((major) << 8) | (minor))
+#define D3DVS_VERSION(major, minor) (0xFFFE0000 | ((major) << 8) | (minor))
+
+typedef enum _D3DPRIMITIVETYPE
+{
+    D3DPT_POINTLIST = 1,
+    D3DPT_LINELIST = 2,
+    D3DPT_LINESTRIP = 3,
+    D3DPT_TRIANGLELIST = 4,
+    D3DPT_TRIANGLESTRIP = 5,
+    D3DPT_TRIANGLEFAN = 6
+} D3DPRIMITIVETYPE;
+
+typedef enum _D3DFORMAT
+{
+    D3DFMT_UNKNOWN = 0,
+    D3DFMT_A8R8G8B8 = 21,
+    D3DFMT_X8R8G8B8 = 22,
+    D3DFMT_D16 = 80
+} D3DFORMAT;
+
+typedef struct _D3DCOLORVALUE
+{
+    float r;
+    float g;
+    float b;
+    float a;
+} D3DCOLORVALUE;
+
+typedef struct _D3DVECTOR
+{
+    float x;
+    float y;
+    float z;
+} D3DVECTOR;
+
+typedef struct _D3DMATRIX
+{
+    union
+    {
+        struct
+        {
+            float _11, _12, _13, _14;
+            float _21, _22, _23, _24;
+            float _31, _32, _33, _34;
+            float _41, _42, _43, _44;
+        };
+        float m[4][4];
+    };
+} D3DMATRIX;
+
+typedef struct _D3DVIEWPORT9
+{
+    DWORD X;
+    DWORD Y;
+    DWORD Width;
+    DWORD Height;
+    float MinZ;
+    float MaxZ;
+} D3DVIEWPORT9;
+
+typedef struct _D3DPRESENT_PARAMETERS_
+{
+    UINT BackBufferWidth;
+    UINT BackBufferHeight;
+    D3DFORMAT BackBufferFormat;
+    UINT BackBufferCount;
+    HWND hDeviceWindow;
+    BOOL Windowed;
+} D3DPRESENT_PARAMETERS;
+
+struct IDirect3D9 : public IUnknown {};
+struct IDirect3DDevice9 : public IUnknown {};
+struct IDirect3DResource9 : public IUnknown {};
+struct IDirect3DBaseTexture9 : public IDirect3DResource9 {};
+struct IDirect3DTexture9 : public IDirect3DBaseTexture9 {};
+struct IDirect3DSurface9 : public IDirect3DResource9 {};
+struct IDirect3DVertexShader9 : public IUnknown {};
+struct IDirect3DPixelShader9 : public IUnknown {};
+
+typedef IDirect3D9* LPDIRECT3D9;
+typedef IDirect3DDevice9* LPDIRECT3DDEVICE9;
+typedef IDirect3DTexture9* LPDIRECT3DTEXTURE9;
+typedef IDirect3DSurface9* LPDIRECT3DSURFACE9;
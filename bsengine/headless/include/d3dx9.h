@@ -0,0 +1,102 @@
+// ヘッドレス環境用のD3DXの代替
+// ベクトルと行列の計算はD3DXと同じ規約(行ベクトル, 左手系)で実装する. 関数の実装はheadless/src/d3dx9_math.cpp
+#pragma once
+
+#include <d3d9.h>
+#include <math.h>
+
+#define D3DX_PI ((FLOAT)3.141592654f)
+#define D3DXToRadian(degree) ((degree) * (D3DX_PI / 180.0f))
+#define D3DXToDegree(radian) ((radian) * (180.0f / D3DX_PI))
+
+struct D3DXVECTOR2
+{
+    D3DXVECTOR2() {}
+    D3DXVECTOR2(FLOAT x, FLOAT y) : x(x), y(y) {}
+    FLOAT x;
+    FLOAT y;
+};
+
+struct D3DXVECTOR3 : public D3DVECTOR
+{
+    D3DXVECTOR3() {}
+    D3DXVECTOR3(FLOAT x, FLOAT y, FLOAT z) { this->x = x; this->y = y; this->z = z; }
+    D3DXVECTOR3& operator+=(const D3DXVECTOR3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+    D3DXVECTOR3& operator-=(const D3DXVECTOR3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+    D3DXVECTOR3& operator*=(FLOAT f) { x *= f; y *= f; z *= f; return *this; }
+    D3DXVECTOR3& operator/=(FLOAT f) { x /= f; y /= f; z /= f; return *this; }
+    D3DXVECTOR3 operator+() const { return *this; }
+    D3DXVECTOR3 operator-() const { return D3DXVECTOR3(-x, -y, -z); }
+    D3DXVECTOR3 operator+(const D3DXVECTOR3& v) const { return D3DXVECTOR3(x + v.x, y + v.y, z + v.z); }
+    D3DXVECTOR3 operator-(const D3DXVECTOR3& v) const { return D3DXVECTOR3(x - v.x, y - v.y, z - v.z); }
+    D3DXVECTOR3 operator*(FLOAT f) const { return D3DXVECTOR3(x * f, y * f, z * f); }
+    D3DXVECTOR3 operator/(FLOAT f) const { return D3DXVECTOR3(x / f, y / f, z / f); }
+    bool operator==(const D3DXVECTOR3& v) const { return x == v.x && y == v.y && z == v.z; }
+    bool operator!=(const D3DXVECTOR3& v) const { return !(*this == v); }
+};
+
+inline D3DXVECTOR3 operator*(FLOAT f, const D3DXVECTOR3& v) { return v * f; }
+
+struct D3DXVECTOR4
+{
+    D3DXVECTOR4() {}
+    D3DXVECTOR4(FLOAT x, FLOAT y, FLOAT z, FLOAT w) : x(x), y(y), z(z), w(w) {}
+    operator FLOAT*() { return &x; }
+    operator const FLOAT*() const { return &x; }
+    FLOAT x;
+    FLOAT y;
+    FLOAT z;
+    FLOAT w;
+};
+
+struct D3DXMATRIX : public D3DMATRIX
+{
+    D3DXMATRIX() {}
+    D3DXMATRIX(const D3DMATRIX& mat) : D3DMATRIX(mat) {}
+    D3DXMATRIX(FLOAT _11, FLOAT _12, FLOAT _13, FLOAT _14,
+               FLOAT _21, FLOAT _22, FLOAT _23, FLOAT _24,
+               FLOAT _31, FLOAT _32, FLOAT _33, FLOAT _34,
+               FLOAT _41, FLOAT _42, FLOAT _43, FLOAT _44);
+    FLOAT& operator()(UINT row, UINT col) { return m[row][col]; }
+    FLOAT operator()(UINT row, UINT col) const { return m[row][col]; }
+    operator FLOAT*() { return &_11; }
+    operator const FLOAT*() const { return &_11; }
+    D3DXMATRIX& operator*=(const D3DXMATRIX& mat);
+    D3DXMATRIX operator*(const D3DXMATRIX& mat) const;
+    bool operator==(const D3DXMATRIX& mat) const;
+    bool operator!=(const D3DXMATRIX& mat) const { return !(*this == mat); }
+};
+
+typedef D3DXMATRIX D3DXMATRIXA16;
+
+D3DXMATRIX* D3DXMatrixIdentity(D3DXMATRIX* out);
+D3DXMATRIX* D3DXMatrixMultiply(D3DXMATRIX* out, const D3DXMATRIX* m1, const D3DXMATRIX* m2);
+D3DXMATRIX* D3DXMatrixTranspose(D3DXMATRIX* out, const D3DXMATRIX* m);
+D3DXMATRIX* D3DXMatrixInverse(D3DXMATRIX* out, FLOAT* determinant, const D3DXMATRIX* m);
+D3DXMATRIX* D3DXMatrixScaling(D3DXMATRIX* out, FLOAT sx, FLOAT sy, FLOAT sz);
+D3DXMATRIX* D3DXMatrixTranslation(D3DXMATRIX* out, FLOAT x, FLOAT y, FLOAT z);
+D3DXMATRIX* D3DXMatrixRotationX(D3DXMATRIX* out, FLOAT angle);
+D3DXMATRIX* D3DXMatrixRotationY(D3DXMATRIX* out, FLOAT angle);
+D3DXMATRIX* D3DXMatrixRotationZ(D3DXMATRIX* out, FLOAT angle);
+D3DXMATRIX* D3DXMatrixRotationYawPitchRoll(D3DXMATRIX* out, FLOAT yaw, FLOAT pitch, FLOAT roll);
+D3DXMATRIX* D3DXMatrixLookAtLH(D3DXMATRIX* out, const D3DXVECTOR3* eye, const D3DXVECTOR3* at, const D3DXVECTOR3* up);
+D3DXMATRIX* D3DXMatrixPerspectiveFovLH(D3DXMATRIX* out, FLOAT fovy, FLOAT aspect, FLOAT zn, FLOAT zf);
+D3DXMATRIX* D3DXMatrixOrthoOffCenterLH(D3DXMATRIX* out, FLOAT l, FLOAT r, FLOAT b, FLOAT t, FLOAT zn, FLOAT zf);
+
+FLOAT D3DXVec3Length(const D3DXVECTOR3* v);
+FLOAT D3DXVec3Dot(const D3DXVECTOR3* v1, const D3DXVECTOR3* v2);
+D3DXVECTOR3* D3DXVec3Cross(D3DXVECTOR3* out, const D3DXVECTOR3* v1, const D3DXVECTOR3* v2);
+D3DXVECTOR3* D3DXVec3Normalize(D3DXVECTOR3* out, const D3DXVECTOR3* v);
+D3DXVECTOR3* D3DXVec3TransformCoord(D3DXVECTOR3* out, const D3DXVECTOR3* v, const D3DXMATRIX* m);
+D3DXVECTOR4* D3DXVec4Normalize(D3DXVECTOR4* out, const D3DXVECTOR4* v);
+
+// ヘッドレスのシェーダはエフェクトの設定を記録せずに捨てる
+struct ID3DXEffect : public IUnknown
+{
+    virtual HRESULT SetTechnique(LPCSTR technique) = 0;
+    virtual HRESULT SetVector(LPCSTR name, const D3DXVECTOR4* vector) = 0;
+    virtual HRESULT SetFloat(LPCSTR name, FLOAT f) = 0;
+    virtual HRESULT SetFloatArray(LPCSTR name, const FLOAT* f, UINT count) = 0;
+    virtual HRESULT SetMatrix(LPCSTR name, const D3DXMATRIX* matrix) = 0;
+    virtual HRESULT SetTexture(LPCSTR name, IDirect3DBaseTexture9* texture) = 0;
+};
@@ -0,0 +1,25 @@
+// ヘッドレス環境用のDirectInputの代替
+// ヘッドレスの入力デバイスはDirectInputを使わないので, インターフェースは型としてだけ宣言する
+#pragma once
+
+#include <windows.h>
+#include <unknwn.h>
+
+typedef struct DIJOYSTATE
+{
+    LONG lX;
+    LONG lY;
+    LONG lZ;
+    LONG lRx;
+    LONG lRy;
+    LONG lRz;
+    LONG rglSlider[2];
+    DWORD rgdwPOV[4];
+    BYTE rgbButtons[32];
+} DIJOYSTATE;
+
+struct IDirectInput8 : public IUnknown {};
+struct IDirectInputDevice8 : public IUnknown {};
+
+typedef IDirectInput8* LPDIRECTINPUT8;
+typedef IDirectInputDevice8* LPDIRECTINPUTDEVICE8;
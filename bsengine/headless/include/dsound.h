@@ -0,0 +1,13 @@
+// ヘッドレス環境用のDirectSoundの代替
+// ヘッドレスのサウンドデバイスはDirectSoundを使わないので, インターフェースは型としてだけ宣言する
+#pragma once
+
+#include <windows.h>
+#include <unknwn.h>
+
+struct IDirectSound8 : public IUnknown {};
+struct IDirectSoundBuffer : public IUnknown {};
+struct IDirectSoundBuffer8 : public IDirectSoundBuffer {};
+
+typedef IDirectSound8* LPDIRECTSOUND8;
+typedef IDirectSoundBuffer8* LPDIRECTSOUNDBUFFER8;
@@ -0,0 +1,13 @@
+// ヘッドレス環境用のCOMの基底インターフェース
+#pragma once
+
+#include <windows.h>
+
+struct IUnknown
+{
+    virtual HRESULT QueryInterface(REFIID riid, void** object) = 0;
+    virtual ULONG AddRef() = 0;
+    virtual ULONG Release() = 0;
+protected:
+    ~IUnknown() {}
+};
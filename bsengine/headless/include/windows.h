@@ -0,0 +1,193 @@
+// ヘッドレス環境用のWin32 APIの代替
+// エンジンが使う型, 定数, 関数だけを宣言する. 関数の実装はheadless/src/win32.cpp
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cwchar>
+#include <climits>
+
+#define WINAPI
+#define __declspec(x) __attribute__((x))
+#define CALLBACK
+#define CONST const
+#define TRUE 1
+#define FALSE 0
+#ifndef NULL
+#define NULL 0
+#endif
+
+typedef uint32_t DWORD;
+typedef int32_t BOOL;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef int32_t INT;
+typedef uint32_t UINT;
+typedef int32_t LONG;
+typedef uint32_t ULONG;
+typedef int64_t INT64;
+typedef uint64_t UINT64;
+typedef int64_t LONGLONG;
+typedef float FLOAT;
+typedef char CHAR;
+typedef wchar_t WCHAR;
+typedef int32_t HRESULT;
+typedef void* HANDLE;
+typedef void* LPVOID;
+typedef const void* LPCVOID;
+typedef char* LPSTR;
+typedef const char* LPCSTR;
+typedef wchar_t* LPWSTR;
+typedef const wchar_t* LPCWSTR;
+typedef LPWSTR LPTSTR;
+typedef LPCWSTR LPCTSTR;
+typedef uintptr_t WPARAM;
+typedef intptr_t LPARAM;
+typedef intptr_t LRESULT;
+typedef DWORD COLORREF;
+
+typedef struct HWND__* HWND;
+typedef struct HINSTANCE__* HINSTANCE;
+typedef HINSTANCE HMODULE;
+typedef struct HDC__* HDC;
+typedef struct HFONT__* HFONT;
+typedef struct HGDIOBJ__* HGDIOBJ;
+
+typedef union _LARGE_INTEGER
+{
+    LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef struct tagRECT
+{
+    LONG left;
+    LONG top;
+    LONG right;
+    LONG bottom;
+} RECT;
+
+typedef struct tagPOINT
+{
+    LONG x;
+    LONG y;
+} POINT;
+
+typedef struct tagSIZE
+{
+    LONG cx;
+    LONG cy;
+} SIZE;
+
+typedef struct _GUID
+{
+    uint32_t Data1;
+    uint16_t Data2;
+    uint16_t Data3;
+    uint8_t Data4[8];
+} GUID;
+typedef GUID IID;
+#define REFIID const IID&
+#define REFGUID const GUID&
+
+#define S_OK ((HRESULT)0)
+#define S_FALSE ((HRESULT)1)
+#define E_FAIL ((HRESULT)0x80004005)
+#define E_NOTIMPL ((HRESULT)0x80004001)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+
+#define MAX_PATH 260
+#define CP_ACP 0
+#define CP_UTF8 65001
+
+#define LOWORD(l) ((WORD)(((uintptr_t)(l)) & 0xffff))
+#define HIWORD(l) ((WORD)((((uintptr_t)(l)) >> 16) & 0xffff))
+#define RGB(r, g, b) ((COLORREF)(((BYTE)(r) | ((WORD)((BYTE)(g)) << 8)) | (((DWORD)(BYTE)(b)) << 16)))
+
+/* 文字コード変換 */
+int MultiByteToWideChar(UINT codePage, DWORD flags, LPCSTR src, int srcLen, LPWSTR dst, int dstLen);
+int WideCharToMultiByte(UINT codePage, DWORD flags, LPCWSTR src, int srcLen, LPSTR dst, int dstLen, LPCSTR defaultChar, BOOL* usedDefaultChar);
+
+/* ファイル */
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define INVALID_FILE_ATTRIBUTES ((DWORD)-1)
+#define FILE_ATTRIBUTE_DIRECTORY 0x00000010
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+#define GENERIC_READ 0x80000000
+#define GENERIC_WRITE 0x40000000
+#define FILE_SHARE_READ 0x00000001
+#define FILE_SHARE_WRITE 0x00000002
+#define FILE_SHARE_DELETE 0x00000004
+#define CREATE_NEW 1
+#define CREATE_ALWAYS 2
+#define OPEN_EXISTING 3
+#define OPEN_ALWAYS 4
+
+typedef struct _FILETIME
+{
+    DWORD dwLowDateTime;
+    DWORD dwHighDateTime;
+} FILETIME;
+
+typedef struct _WIN32_FIND_DATAW
+{
+    DWORD dwFileAttributes;
+    FILETIME ftCreationTime;
+    FILETIME ftLastAccessTime;
+    FILETIME ftLastWriteTime;
+    DWORD nFileSizeHigh;
+    DWORD nFileSizeLow;
+    WCHAR cFileName[MAX_PATH];
+} WIN32_FIND_DATAW, WIN32_FIND_DATA;
+
+DWORD GetFileAttributesW(LPCWSTR path);
+HANDLE FindFirstFileW(LPCWSTR pattern, WIN32_FIND_DATAW* data);
+BOOL FindNextFileW(HANDLE findHandle, WIN32_FIND_DATAW* data);
+BOOL FindClose(HANDLE findHandle);
+HANDLE CreateFileW(LPCWSTR path, DWORD access, DWORD shareMode, void* securityAttributes, DWORD creationDisposition, DWORD flags, HANDLE templateFile);
+BOOL GetFileTime(HANDLE file, FILETIME* creationTime, FILETIME* lastAccessTime, FILETIME* lastWriteTime);
+BOOL CloseHandle(HANDLE handle);
+#define GetFileAttributes GetFileAttributesW
+#define FindFirstFile FindFirstFileW
+#define FindNextFile FindNextFileW
+#define CreateFile CreateFileW
+
+FILE* _wfopen(const wchar_t* path, const wchar_t* mode);
+int _wmkdir(const wchar_t* path);
+
+/* 時間 */
+typedef struct _SYSTEMTIME
+{
+    WORD wYear;
+    WORD wMonth;
+    WORD wDayOfWeek;
+    WORD wDay;
+    WORD wHour;
+    WORD wMinute;
+    WORD wSecond;
+    WORD wMilliseconds;
+} SYSTEMTIME;
+
+void GetLocalTime(SYSTEMTIME* systemTime);
+void Sleep(DWORD milliSec);
+DWORD timeGetTime();
+UINT timeBeginPeriod(UINT period);
+UINT timeEndPeriod(UINT period);
+BOOL QueryPerformanceCounter(LARGE_INTEGER* count);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* freq);
+
+/* デバッグ出力 */
+void OutputDebugStringA(LPCSTR str);
+void OutputDebugStringW(LPCWSTR str);
+
+/* CRT */
+inline double _wtof(const wchar_t* str) { return std::wcstod(str, nullptr); }
+inline int _wtoi(const wchar_t* str) { return (int)std::wcstol(str, nullptr, 10); }
+inline int64_t _wtoi64(const wchar_t* str) { return std::wcstoll(str, nullptr, 10); }
+// MSVCと同じく, 書式の%sはワイド文字列として扱う
+int swprintf_s(wchar_t* buf, size_t size, const wchar_t* format, ...);
+
+/* フォント */
+#define FW_DONTCARE 0
+#define FW_NORMAL 400
+#define FW_BOLD 700
@@ -0,0 +1,260 @@
+﻿#include <d3dx9.h>
+
+#include <cmath>
+
+D3DXMATRIX::D3DXMATRIX(FLOAT _11, FLOAT _12, FLOAT _13, FLOAT _14,
+                       FLOAT _21, FLOAT _22, FLOAT _23, FLOAT _24,
+                       FLOAT _31, FLOAT _32, FLOAT _33, FLOAT _34,
+                       FLOAT _41, FLOAT _42, FLOAT _43, FLOAT _44)
+{
+    this->_11 = _11; this->_12 = _12; this->_13 = _13; this->_14 = _14;
+    this->_21 = _21; this->_22 = _22; this->_23 = _23; this->_24 = _24;
+    this->_31 = _31; this->_32 = _32; this->_33 = _33; this->_34 = _34;
+    this->_41 = _41; this->_42 = _42; this->_43 = _43; this->_44 = _44;
+}
+
+D3DXMATRIX& D3DXMATRIX::operator*=(const D3DXMATRIX& mat)
+{
+    D3DXMatrixMultiply(this, this, &mat);
+    return *this;
+}
+
+D3DXMATRIX D3DXMATRIX::operator*(const D3DXMATRIX& mat) const
+{
+    D3DXMATRIX ret;
+    D3DXMatrixMultiply(&ret, this, &mat);
+    return ret;
+}
+
+bool D3DXMATRIX::operator==(const D3DXMATRIX& mat) const
+{
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            if (m[i][j] != mat.m[i][j]) return false;
+        }
+    }
+    return true;
+}
+
+D3DXMATRIX* D3DXMatrixIdentity(D3DXMATRIX* out)
+{
+    *out = D3DXMATRIX(1, 0, 0, 0,
+                      0, 1, 0, 0,
+                      0, 0, 1, 0,
+                      0, 0, 0, 1);
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixMultiply(D3DXMATRIX* out, const D3DXMATRIX* m1, const D3DXMATRIX* m2)
+{
+    // outとm1, m2が同じ場合があるので一旦別の行列に計算する
+    D3DXMATRIX ret;
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            ret.m[i][j] = m1->m[i][0] * m2->m[0][j] + m1->m[i][1] * m2->m[1][j] + m1->m[i][2] * m2->m[2][j] + m1->m[i][3] * m2->m[3][j];
+        }
+    }
+    *out = ret;
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixTranspose(D3DXMATRIX* out, const D3DXMATRIX* m)
+{
+    D3DXMATRIX ret;
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            ret.m[i][j] = m->m[j][i];
+        }
+    }
+    *out = ret;
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixInverse(D3DXMATRIX* out, FLOAT* determinant, const D3DXMATRIX* m)
+{
+    // 余因子展開
+    const float* a = &m->m[0][0];
+    float inv[16];
+    inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+    inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+    inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+    inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+    inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+    inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+    inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+    inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+    inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+    inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+    inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+    inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+    inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+    inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+    inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] - a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+    inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] + a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+    float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+    if (determinant) *determinant = det;
+    if (det == 0.0f) return NULL;
+    for (int i = 0; i < 16; i++)
+    {
+        (&out->m[0][0])[i] = inv[i] / det;
+    }
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixScaling(D3DXMATRIX* out, FLOAT sx, FLOAT sy, FLOAT sz)
+{
+    *out = D3DXMATRIX(sx, 0, 0, 0,
+                      0, sy, 0, 0,
+                      0, 0, sz, 0,
+                      0, 0, 0, 1);
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixTranslation(D3DXMATRIX* out, FLOAT x, FLOAT y, FLOAT z)
+{
+    *out = D3DXMATRIX(1, 0, 0, 0,
+                      0, 1, 0, 0,
+                      0, 0, 1, 0,
+                      x, y, z, 1);
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixRotationX(D3DXMATRIX* out, FLOAT angle)
+{
+    float c = cosf(angle);
+    float s = sinf(angle);
+    *out = D3DXMATRIX(1, 0, 0, 0,
+                      0, c, s, 0,
+                      0, -s, c, 0,
+                      0, 0, 0, 1);
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixRotationY(D3DXMATRIX* out, FLOAT angle)
+{
+    float c = cosf(angle);
+    float s = sinf(angle);
+    *out = D3DXMATRIX(c, 0, -s, 0,
+                      0, 1, 0, 0,
+                      s, 0, c, 0,
+                      0, 0, 0, 1);
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixRotationZ(D3DXMATRIX* out, FLOAT angle)
+{
+    float c = cosf(angle);
+    float s = sinf(angle);
+    *out = D3DXMATRIX(c, s, 0, 0,
+                      -s, c, 0, 0,
+                      0, 0, 1, 0,
+                      0, 0, 0, 1);
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixRotationYawPitchRoll(D3DXMATRIX* out, FLOAT yaw, FLOAT pitch, FLOAT roll)
+{
+    // Z軸(roll), X軸(pitch), Y軸(yaw)の順に回転
+    D3DXMATRIX rotX, rotY, rotZ;
+    D3DXMatrixRotationX(&rotX, pitch);
+    D3DXMatrixRotationY(&rotY, yaw);
+    D3DXMatrixRotationZ(&rotZ, roll);
+    *out = rotZ * rotX * rotY;
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixLookAtLH(D3DXMATRIX* out, const D3DXVECTOR3* eye, const D3DXVECTOR3* at, const D3DXVECTOR3* up)
+{
+    D3DXVECTOR3 xAxis, yAxis, zAxis;
+    D3DXVECTOR3 dir = *at - *eye;
+    D3DXVec3Normalize(&zAxis, &dir);
+    D3DXVec3Cross(&xAxis, up, &zAxis);
+    D3DXVec3Normalize(&xAxis, &xAxis);
+    D3DXVec3Cross(&yAxis, &zAxis, &xAxis);
+    *out = D3DXMATRIX(xAxis.x, yAxis.x, zAxis.x, 0,
+                      xAxis.y, yAxis.y, zAxis.y, 0,
+                      xAxis.z, yAxis.z, zAxis.z, 0,
+                      -D3DXVec3Dot(&xAxis, eye), -D3DXVec3Dot(&yAxis, eye), -D3DXVec3Dot(&zAxis, eye), 1);
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixPerspectiveFovLH(D3DXMATRIX* out, FLOAT fovy, FLOAT aspect, FLOAT zn, FLOAT zf)
+{
+    float yScale = 1.0f / tanf(fovy / 2);
+    float xScale = yScale / aspect;
+    *out = D3DXMATRIX(xScale, 0, 0, 0,
+                      0, yScale, 0, 0,
+                      0, 0, zf / (zf - zn), 1,
+                      0, 0, -zn * zf / (zf - zn), 0);
+    return out;
+}
+
+D3DXMATRIX* D3DXMatrixOrthoOffCenterLH(D3DXMATRIX* out, FLOAT l, FLOAT r, FLOAT b, FLOAT t, FLOAT zn, FLOAT zf)
+{
+    *out = D3DXMATRIX(2 / (r - l), 0, 0, 0,
+                      0, 2 / (t - b), 0, 0,
+                      0, 0, 1 / (zf - zn), 0,
+                      (l + r) / (l - r), (t + b) / (b - t), zn / (zn - zf), 1);
+    return out;
+}
+
+FLOAT D3DXVec3Length(const D3DXVECTOR3* v)
+{
+    return sqrtf(v->x * v->x + v->y * v->y + v->z * v->z);
+}
+
+FLOAT D3DXVec3Dot(const D3DXVECTOR3* v1, const D3DXVECTOR3* v2)
+{
+    return v1->x * v2->x + v1->y * v2->y + v1->z * v2->z;
+}
+
+D3DXVECTOR3* D3DXVec3Cross(D3DXVECTOR3* out, const D3DXVECTOR3* v1, const D3DXVECTOR3* v2)
+{
+    *out = D3DXVECTOR3(v1->y * v2->z - v1->z * v2->y,
+                       v1->z * v2->x - v1->x * v2->z,
+                       v1->x * v2->y - v1->y * v2->x);
+    return out;
+}
+
+D3DXVECTOR3* D3DXVec3Normalize(D3DXVECTOR3* out, const D3DXVECTOR3* v)
+{
+    // D3DXと同じく, 長さ0のベクトルは0ベクトルにする
+    float len = D3DXVec3Length(v);
+    if (len == 0.0f)
+    {
+        *out = D3DXVECTOR3(0, 0, 0);
+    } else
+    {
+        *out = *v / len;
+    }
+    return out;
+}
+
+D3DXVECTOR3* D3DXVec3TransformCoord(D3DXVECTOR3* out, const D3DXVECTOR3* v, const D3DXMATRIX* m)
+{
+    float x = v->x * m->_11 + v->y * m->_21 + v->z * m->_31 + m->_41;
+    float y = v->x * m->_12 + v->y * m->_22 + v->z * m->_32 + m->_42;
+    float z = v->x * m->_13 + v->y * m->_23 + v->z * m->_33 + m->_43;
+    float w = v->x * m->_14 + v->y * m->_24 + v->z * m->_34 + m->_44;
+    *out = D3DXVECTOR3(x / w, y / w, z / w);
+    return out;
+}
+
+D3DXVECTOR4* D3DXVec4Normalize(D3DXVECTOR4* out, const D3DXVECTOR4* v)
+{
+    float len = sqrtf(v->x * v->x + v->y * v->y + v->z * v->z + v->w * v->w);
+    if (len == 0.0f)
+    {
+        *out = D3DXVECTOR4(0, 0, 0, 0);
+    } else
+    {
+        *out = D3DXVECTOR4(v->x / len, v->y / len, v->z / len, v->w / len);
+    }
+    return out;
+}
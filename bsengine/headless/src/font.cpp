@@ -0,0 +1,69 @@
+﻿#include <bstorm/font.hpp>
+
+#include <bstorm/dnh_const.hpp>
+#include <bstorm/math_util.hpp>
+#include <bstorm/ptr_util.hpp>
+#include <bstorm/headless_stats.hpp>
+
+#include "null_texture.hpp"
+
+namespace bstorm
+{
+// GDIが無いので, 半角は高さの半分, 全角は高さと同じ幅の等幅フォントとして大きさを決める
+Font::Font(const FontParams& params, HWND hWnd, const std::shared_ptr<GraphicDevice>& graphicDevice) :
+    params_(params),
+    texture_(NULL)
+{
+    const wchar_t c = params_.c;
+    const bool isHalfWidth = c < 0x80 || (c >= 0xff61 && c <= 0xff9f);
+    const int cellIncX = isHalfWidth ? params_.size / 2 : params_.size;
+    const int borderWidth = params_.borderType == BORDER_NONE ? 0 : params_.borderWidth;
+    const int fontWidth = cellIncX + 2 * borderWidth;
+    const int fontHeight = params_.size + 2 * borderWidth;
+    const int texWidth = NextPow2(fontWidth);
+    const int texHeight = NextPow2(fontHeight);
+    texture_ = new NullTexture(texWidth, texHeight);
+
+    this->width_ = fontWidth;
+    this->height_ = fontHeight;
+    this->printOffsetX_ = -borderWidth;
+    this->printOffsetY_ = -borderWidth;
+    this->rightCharOffsetX_ = cellIncX + borderWidth;
+    this->nextLineOffsetY_ = params_.size;
+    this->textureWidth_ = texWidth;
+    this->textureHeight_ = texHeight;
+    GetHeadlessStats().fontCreateCount++;
+}
+
+Font::~Font()
+{
+    safe_release(texture_);
+}
+
+FontStore::FontStore(HWND hWnd, const std::shared_ptr<GraphicDevice>& graphicDevice) :
+    hWnd_(hWnd),
+    graphicDevice_(graphicDevice)
+{
+}
+
+const std::shared_ptr<Font>& FontStore::Create(const FontParams& params)
+{
+    return cacheStore_.Load(params, params, hWnd_, graphicDevice_);
+}
+
+bool FontStore::Contains(const FontParams & params) const
+{
+    return cacheStore_.Contains(params);
+}
+
+void FontStore::RemoveUnusedFont()
+{
+    cacheStore_.RemoveUnused();
+}
+
+bool InstallFont(const std::wstring& path)
+{
+    // フォントは使わないので, ファイルがあれば成功とする
+    return GetFileAttributes(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+}
+}
@@ -0,0 +1,53 @@
+﻿#include <bstorm/graphic_device.hpp>
+
+namespace bstorm
+{
+// ヘッドレスではDirect3Dのデバイスを作らない
+// GetDeviceはnullptrを返すので, デバイスを受け取る側もヘッドレスの実装を使うこと
+GraphicDevice::GraphicDevice(HWND hWnd) :
+    d3D_(nullptr),
+    d3DDevice_(nullptr),
+    backBufferSurface_(nullptr),
+    backBufferDepthStencilSurface_(nullptr)
+{
+    // ウィンドウが無いので, バックバッファは既定のウィンドウサイズとする
+    presentParams_ = { 640, 480, D3DFMT_UNKNOWN, 1, hWnd, TRUE };
+}
+
+GraphicDevice::~GraphicDevice()
+{
+}
+
+void GraphicDevice::Reset()
+{
+}
+
+IDirect3DDevice9 * GraphicDevice::GetDevice() const
+{
+    return d3DDevice_;
+}
+
+void GraphicDevice::SwitchRenderTargetToBackBuffer()
+{
+}
+
+void GraphicDevice::ClearRenderTarget(D3DCOLOR color)
+{
+}
+
+bool GraphicDevice::IsPixelShaderSupported(int major, int minor) const
+{
+    // スクリプトの分岐がWindowsと変わらないように, シェーダモデル3.0までは対応していることにする
+    return D3DPS_VERSION(major, minor) <= D3DPS_VERSION(3, 0);
+}
+
+DWORD GraphicDevice::GetBackBufferWidth() const
+{
+    return presentParams_.BackBufferWidth;
+}
+
+DWORD GraphicDevice::GetBackBufferHeight() const
+{
+    return presentParams_.BackBufferHeight;
+}
+}
@@ -0,0 +1,10 @@
+﻿#include <bstorm/headless_stats.hpp>
+
+namespace bstorm
+{
+HeadlessStats& GetHeadlessStats()
+{
+    static HeadlessStats stats;
+    return stats;
+}
+}
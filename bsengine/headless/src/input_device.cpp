@@ -0,0 +1,98 @@
+﻿#include <bstorm/input_device.hpp>
+
+#include <bstorm/dnh_const.hpp>
+
+namespace bstorm
+{
+// 入力デバイスが無いので, 全てのキーとボタンは常に離されている
+// リプレイ再生時はリプレイの入力が使われる
+InputDevice::InputDevice(HWND hWnd) :
+    hWnd_(hWnd),
+    dInput_(NULL),
+    keyboardDevice_(NULL),
+    mouseDevice_(NULL),
+    padDevice_(NULL),
+    padInputState_(NULL),
+    prevPadInputState_(NULL),
+    mouseMoveZ_(0),
+    mousePosProvider_(nullptr),
+    inputEnable_(true)
+{
+    ResetInputState();
+}
+
+InputDevice::~InputDevice()
+{
+}
+
+void InputDevice::UpdateInputState()
+{
+}
+
+void InputDevice::ResetInputState()
+{
+    keyInputStates_.fill(0);
+    prevKeyInputStates_.fill(0);
+    mouseButtonInputStates_.fill(0);
+    prevMouseButtonInputStates_.fill(0);
+    mouseMoveZ_ = 0;
+}
+
+KeyState InputDevice::GetKeyState(Key k) const
+{
+    return KEY_FREE;
+}
+
+KeyState InputDevice::GetMouseState(MouseButton btn) const
+{
+    return KEY_FREE;
+}
+
+KeyState InputDevice::GetPadButtonState(PadButton btn) const
+{
+    return KEY_FREE;
+}
+
+int InputDevice::GetMouseX(int screenWidth, int screenHeight) const
+{
+    if (!inputEnable_) return 0;
+    int x = 0;
+    int y;
+    if (mousePosProvider_)
+    {
+        mousePosProvider_->GetMousePos(screenWidth, screenHeight, x, y);
+    }
+    return x;
+}
+
+int InputDevice::GetMouseY(int screenWidth, int screenHeight) const
+{
+    if (!inputEnable_) return 0;
+    int x;
+    int y = 0;
+    if (mousePosProvider_)
+    {
+        mousePosProvider_->GetMousePos(screenWidth, screenHeight, x, y);
+    }
+    return y;
+}
+
+int InputDevice::GetMouseMoveZ() const
+{
+    return 0;
+}
+
+void InputDevice::SetMousePositionProvider(const std::shared_ptr<MousePositionProvider>& provider)
+{
+    mousePosProvider_ = provider;
+}
+
+void InputDevice::SetInputEnable(bool enable)
+{
+    inputEnable_ = enable;
+}
+
+void InputDevice::InitPadDevice()
+{
+}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <d3d9.h>
+
+#include <atomic>
+
+namespace bstorm
+{
+// 大きさだけを持つヘッドレス用のテクスチャ
+// ヘッドレスのバックエンドが作るテクスチャは全てこれ
+class NullTexture final : public IDirect3DTexture9
+{
+public:
+    NullTexture(int width, int height) : width_(width), height_(height), refCount_(1) {}
+    HRESULT QueryInterface(REFIID riid, void** object) override { return E_NOTIMPL; }
+    ULONG AddRef() override { return ++refCount_; }
+    ULONG Release() override
+    {
+        ULONG cnt = --refCount_;
+        if (cnt == 0) delete this;
+        return cnt;
+    }
+    int GetWidth() const { return width_; }
+    int GetHeight() const { return height_; }
+private:
+    ~NullTexture() {}
+    const int width_;
+    const int height_;
+    std::atomic<ULONG> refCount_;
+};
+}
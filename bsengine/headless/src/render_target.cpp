@@ -0,0 +1,83 @@
+﻿#include <bstorm/render_target.hpp>
+
+#include <bstorm/ptr_util.hpp>
+
+#include "null_texture.hpp"
+
+namespace bstorm
+{
+RenderTarget::RenderTarget(const std::wstring& name, int width, int height, IDirect3DDevice9* d3DDevice_) :
+    LostableGraphicResource(),
+    name_(name),
+    width_(width),
+    height_(height),
+    d3DDevice_(d3DDevice_),
+    texture_(nullptr),
+    textureSurface_(nullptr),
+    textureDepthStencilSurface_(nullptr),
+    viewport_({ 0, 0, (DWORD)width, (DWORD)height, 0.0f, 1.0f })
+{
+    OnResetDevice();
+}
+
+RenderTarget::~RenderTarget()
+{
+    OnLostDevice();
+}
+
+void RenderTarget::SetRenderTarget()
+{
+}
+
+IDirect3DTexture9* RenderTarget::GetTexture() const
+{
+    return texture_;
+}
+
+IDirect3DSurface9 * RenderTarget::GetSurface() const
+{
+    return textureSurface_;
+}
+
+const std::wstring& RenderTarget::GetName() const
+{
+    return name_;
+}
+
+int RenderTarget::GetWidth() const
+{
+    return width_;
+}
+
+int RenderTarget::GetHeight() const
+{
+    return height_;
+}
+
+const D3DVIEWPORT9 & RenderTarget::GetViewport() const
+{
+    return viewport_;
+}
+
+void RenderTarget::SetViewport(int left, int top, int width, int height)
+{
+    viewport_ = { (DWORD)left, (DWORD)top, (DWORD)width, (DWORD)height, 0.0f, 1.0f };
+}
+
+bool RenderTarget::SaveToFile(const std::wstring& path, int left, int top, int right, int bottom) const
+{
+    // 描画結果が無いので保存できない
+    return false;
+}
+
+void RenderTarget::OnResetDevice()
+{
+    if (texture_ != nullptr) return;
+    texture_ = new NullTexture(width_, height_);
+}
+
+void RenderTarget::OnLostDevice()
+{
+    safe_release(texture_);
+}
+}
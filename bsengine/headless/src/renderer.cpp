@@ -0,0 +1,103 @@
+﻿#include <bstorm/renderer.hpp>
+
+#include <bstorm/color_rgb.hpp>
+#include <bstorm/dnh_const.hpp>
+#include <bstorm/mesh.hpp>
+#include <bstorm/headless_stats.hpp>
+
+namespace bstorm
+{
+// 描画はせず, 描画要求の回数と頂点数だけを記録する
+Renderer::Renderer(IDirect3DDevice9* dev) :
+    d3DDevice_(dev),
+    prim2DVertexShader_(nullptr),
+    prim3DVertexShader_(nullptr),
+    meshVertexShader_(nullptr),
+    currentBlendType_(BLEND_NONE),
+    fogEnable_(false),
+    fogStart_(0),
+    fogEnd_(0)
+{
+}
+
+Renderer::~Renderer()
+{
+}
+
+void Renderer::InitRenderState()
+{
+    currentBlendType_ = BLEND_NONE;
+}
+
+void Renderer::RenderPrim2D(D3DPRIMITIVETYPE primType, int vertexCount, const Vertex* vertices, IDirect3DTexture9* texture, int blendType, const D3DXMATRIX& worldMatrix, const std::shared_ptr<Shader>& pixelShader, bool permitCamera, bool insertHalfPixelOffset)
+{
+    SetBlendType(blendType);
+    auto& stats = GetHeadlessStats();
+    stats.drawCallCount++;
+    stats.vertexCount += vertexCount;
+}
+
+void Renderer::RenderPrim3D(D3DPRIMITIVETYPE primType, int vertexCount, const Vertex* vertices, IDirect3DTexture9* texture, int blendType, const D3DXMATRIX& worldMatrix, const std::shared_ptr<Shader>& pixelShader, bool zWriteEnable, bool zTestEnable, bool useFog, bool billboardEnable)
+{
+    SetBlendType(blendType);
+    auto& stats = GetHeadlessStats();
+    stats.drawCallCount++;
+    stats.vertexCount += vertexCount;
+}
+
+void Renderer::RenderMesh(const std::shared_ptr<Mesh>& mesh, const D3DCOLORVALUE& col, int blendType, const D3DXMATRIX& worldMatrix, const std::shared_ptr<Shader>& pixelShader, bool zWriteEnable, bool zTestEnable, bool useFog)
+{
+    SetBlendType(blendType);
+    auto& stats = GetHeadlessStats();
+    for (const auto& mat : mesh->materials)
+    {
+        stats.drawCallCount++;
+        stats.vertexCount += mat.vertices.size();
+    }
+}
+
+void Renderer::SetViewProjMatrix2D(const D3DXMATRIX& view, const D3DXMATRIX& proj)
+{
+}
+
+void Renderer::SetForbidCameraViewProjMatrix2D(int screenWidth, int screenHeight)
+{
+    screenWidth_ = screenWidth;
+    screenHeight_ = screenHeight;
+}
+
+void Renderer::SetViewProjMatrix3D(const D3DXMATRIX& view, const D3DXMATRIX& proj)
+{
+}
+
+void Renderer::SetViewProjMatrix3D(const D3DXMATRIX& view, const D3DXMATRIX& proj, const D3DXMATRIX& billboardMatrix)
+{
+}
+
+void Renderer::SetBlendType(int type)
+{
+    currentBlendType_ = type;
+}
+
+void Renderer::EnableScissorTest(const RECT& rect)
+{
+}
+
+void Renderer::DisableScissorTest()
+{
+}
+
+void Renderer::SetFogEnable(bool enable)
+{
+    fogEnable_ = enable;
+    if (enable) { SetFogParam(0, 0, 0, 0, 0); }
+}
+
+void Renderer::SetFogParam(float start, float end, int r, int g, int b)
+{
+    fogEnable_ = true;
+    fogStart_ = start;
+    fogEnd_ = end;
+    fogColor_ = ColorRGB(r, g, b).ToD3DCOLOR(0xff);
+}
+}
@@ -0,0 +1,59 @@
+﻿#include <bstorm/shader.hpp>
+
+#include <bstorm/logger.hpp>
+
+#include <windows.h>
+
+namespace bstorm
+{
+// 設定された値を全て捨てるエフェクト
+class NullEffect : public ID3DXEffect
+{
+public:
+    HRESULT QueryInterface(REFIID riid, void** object) override { return E_NOTIMPL; }
+    ULONG AddRef() override { return 1; }
+    ULONG Release() override { return 1; }
+    HRESULT SetTechnique(LPCSTR technique) override { return S_OK; }
+    HRESULT SetVector(LPCSTR name, const D3DXVECTOR4* vector) override { return S_OK; }
+    HRESULT SetFloat(LPCSTR name, FLOAT f) override { return S_OK; }
+    HRESULT SetFloatArray(LPCSTR name, const FLOAT* f, UINT count) override { return S_OK; }
+    HRESULT SetMatrix(LPCSTR name, const D3DXMATRIX* matrix) override { return S_OK; }
+    HRESULT SetTexture(LPCSTR name, IDirect3DBaseTexture9* texture) override { return S_OK; }
+};
+
+static NullEffect nullEffect;
+
+Shader::Shader(const std::wstring& path, bool precompiled, IDirect3DDevice9* d3DDevice_) :
+    effect_(&nullEffect)
+{
+    // シェーダはコンパイルしないが, ファイルが無い時はWindowsと同じくエラーにする
+    if (GetFileAttributes(path.c_str()) == INVALID_FILE_ATTRIBUTES)
+    {
+        throw Log(LogLevel::LV_ERROR)
+            .Msg("failed to load shader.")
+            .Param(LogParam(LogParam::Tag::SHADER, path));
+    }
+}
+
+Shader::~Shader()
+{
+}
+
+void Shader::OnLostDevice()
+{
+}
+
+void Shader::OnResetDevice()
+{
+}
+
+void Shader::SetTexture(const std::string & name, IDirect3DTexture9* texture)
+{
+    effect_->SetTexture(name.c_str(), texture);
+}
+
+ID3DXEffect* Shader::getEffect() const
+{
+    return effect_;
+}
+}
@@ -0,0 +1,79 @@
+﻿#include <bstorm/sound_buffer.hpp>
+
+#include <bstorm/math_util.hpp>
+#include <bstorm/wave_sample_stream.hpp>
+#include <bstorm/headless_stats.hpp>
+
+namespace bstorm
+{
+// 再生時間が分からないので, Stopされるまで再生中として扱う
+SoundBuffer::SoundBuffer(std::unique_ptr<WaveSampleStream>&& stream, const std::shared_ptr<SoundDevice>& soundDevice) :
+    isPlaying_(false),
+    isLoopEnabled_(false),
+    volume_(1.0f),
+    pan_(0.0f)
+{
+}
+
+SoundBuffer::~SoundBuffer()
+{
+}
+
+void SoundBuffer::Play()
+{
+    isPlaying_ = true;
+    GetHeadlessStats().soundPlayCount++;
+}
+
+void SoundBuffer::Stop()
+{
+    isPlaying_ = false;
+}
+
+void SoundBuffer::Rewind()
+{
+    isPlaying_ = false;
+}
+
+void SoundBuffer::SetVolume(float volume)
+{
+    volume_ = constrain(volume, 0.0f, 1.0f);
+}
+
+void SoundBuffer::SetPan(float pan)
+{
+    pan_ = constrain(pan, -1.0f, 1.0f);
+}
+
+void SoundBuffer::SetLoopEnable(bool enable)
+{
+    isLoopEnabled_ = enable;
+}
+
+void SoundBuffer::SetLoopTime(size_t beginSec, size_t endSec)
+{
+}
+
+void SoundBuffer::SetLoopSampleCount(size_t begin, size_t end)
+{
+}
+
+void SoundBuffer::SetLoopRange(size_t begin, size_t end)
+{
+}
+
+bool SoundBuffer::IsPlaying() const
+{
+    return isPlaying_;
+}
+
+float SoundBuffer::GetVolume() const
+{
+    return volume_;
+}
+
+size_t SoundBuffer::GetCurrentPlayCursor() const
+{
+    return 0;
+}
+}
@@ -0,0 +1,39 @@
+﻿#include <bstorm/sound_device.hpp>
+
+#include <bstorm/file_util.hpp>
+#include <bstorm/logger.hpp>
+#include <bstorm/sound_buffer.hpp>
+#include <bstorm/wave_sample_stream.hpp>
+
+namespace bstorm
+{
+// 音声はデコードしないので, ファイルの存在と拡張子だけを確認する
+SoundDevice::SoundDevice(HWND hWnd) :
+    hWnd_(hWnd),
+    dSound_(nullptr)
+{
+}
+
+SoundDevice::~SoundDevice()
+{
+}
+
+std::shared_ptr<SoundBuffer> SoundDevice::LoadSound(const std::wstring & path)
+{
+    auto uniqPath = GetCanonicalPath(path);
+    auto ext = GetLowerExt(uniqPath);
+    if (ext == L".wav" || ext == L".wave" || ext == L".ogg")
+    {
+        if (GetFileAttributes(uniqPath.c_str()) == INVALID_FILE_ATTRIBUTES)
+        {
+            throw Log(LogLevel::LV_ERROR)
+                .Msg("can't open file")
+                .Param(LogParam(LogParam::Tag::TEXT, uniqPath));
+        }
+        return std::make_shared<SoundBuffer>(nullptr, shared_from_this());
+    }
+    throw Log(LogLevel::LV_ERROR)
+        .Msg("unsupported sound file format.")
+        .Param(LogParam(LogParam::Tag::TEXT, path));
+}
+}
@@ -0,0 +1,169 @@
+﻿#include <bstorm/texture.hpp>
+
+#include <bstorm/file_util.hpp>
+#include <bstorm/ptr_util.hpp>
+#include <bstorm/logger.hpp>
+#include <bstorm/graphic_device.hpp>
+#include <bstorm/headless_stats.hpp>
+
+#include "null_texture.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace bstorm
+{
+static uint32_t ReadBE16(const uint8_t* p) { return (p[0] << 8) | p[1]; }
+static uint32_t ReadBE32(const uint8_t* p) { return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+static uint32_t ReadLE16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static uint32_t ReadLE32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24); }
+
+static bool ReadJpegSize(const std::vector<uint8_t>& buf, int* width, int* height)
+{
+    size_t pos = 2;
+    while (pos + 4 <= buf.size())
+    {
+        if (buf[pos] != 0xff) return false;
+        const uint8_t marker = buf[pos + 1];
+        if (marker == 0xff)
+        {
+            pos++;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd9))
+        {
+            pos += 2;
+            continue;
+        }
+        // SOFn (DHT, JPG, DACは除く)
+        if (marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc)
+        {
+            if (pos + 9 > buf.size()) return false;
+            *height = ReadBE16(&buf[pos + 5]);
+            *width = ReadBE16(&buf[pos + 7]);
+            return true;
+        }
+        pos += 2 + ReadBE16(&buf[pos + 2]);
+    }
+    return false;
+}
+
+// 画像を展開せずに, ヘッダから大きさだけを読む
+static bool ReadImageSize(const std::wstring& path, int* width, int* height)
+{
+    FILE* fp = _wfopen(path.c_str(), L"rb");
+    if (fp == nullptr) return false;
+    std::vector<uint8_t> buf;
+    uint8_t chunk[4096];
+    size_t readSize;
+    while ((readSize = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    {
+        buf.insert(buf.end(), chunk, chunk + readSize);
+    }
+    fclose(fp);
+
+    if (buf.size() >= 24 && buf[0] == 0x89 && buf[1] == 'P' && buf[2] == 'N' && buf[3] == 'G')
+    {
+        *width = ReadBE32(&buf[16]);
+        *height = ReadBE32(&buf[20]);
+        return true;
+    }
+    if (buf.size() >= 26 && buf[0] == 'B' && buf[1] == 'M')
+    {
+        *width = (int32_t)ReadLE32(&buf[18]);
+        *height = std::abs((int32_t)ReadLE32(&buf[22]));
+        return true;
+    }
+    if (buf.size() >= 4 && buf[0] == 0xff && buf[1] == 0xd8)
+    {
+        return ReadJpegSize(buf, width, height);
+    }
+    if (buf.size() >= 20 && buf[0] == 'D' && buf[1] == 'D' && buf[2] == 'S' && buf[3] == ' ')
+    {
+        *height = ReadLE32(&buf[12]);
+        *width = ReadLE32(&buf[16]);
+        return true;
+    }
+    if (buf.size() >= 18 && GetLowerExt(path) == L".tga")
+    {
+        *width = ReadLE16(&buf[12]);
+        *height = ReadLE16(&buf[14]);
+        return true;
+    }
+    return false;
+}
+
+Texture::Texture(const std::wstring & path, const std::shared_ptr<GraphicDevice> & graphicDevice) :
+    path_(path),
+    d3DTexture_(nullptr),
+    graphicDevice_(graphicDevice)
+{
+    Reload();
+}
+
+Texture::~Texture()
+{
+    safe_release(d3DTexture_);
+    Logger::Write(std::move(
+        Log(LogLevel::LV_INFO)
+        .Msg("release texture.")
+        .Param(LogParam(LogParam::Tag::TEXTURE, path_))));
+}
+
+const std::wstring& Texture::GetPath() const
+{
+    return path_;
+}
+
+int Texture::GetWidth() const
+{
+    return width_;
+}
+
+int Texture::GetHeight() const
+{
+    return height_;
+}
+
+IDirect3DTexture9* Texture::GetTexture() const
+{
+    return d3DTexture_;
+}
+
+void Texture::Reload()
+{
+    int width, height;
+    if (!ReadImageSize(path_, &width, &height))
+    {
+        throw Log(LogLevel::LV_ERROR)
+            .Msg("failed to load texture.")
+            .Param(LogParam(LogParam::Tag::TEXTURE, path_));
+    }
+    safe_release(d3DTexture_);
+    d3DTexture_ = new NullTexture(width, height);
+    GetD3DTextureSize(d3DTexture_, &width_, &height_);
+    GetHeadlessStats().textureLoadCount++;
+}
+
+void GetD3DTextureSize(IDirect3DTexture9 * texture, int * width, int * height)
+{
+    auto nullTexture = static_cast<NullTexture*>(texture);
+    *width = nullTexture->GetWidth();
+    *height = nullTexture->GetHeight();
+}
+
+int GetD3DTextureWidth(IDirect3DTexture9 * texture)
+{
+    int w, h;
+    GetD3DTextureSize(texture, &w, &h);
+    return w;
+}
+
+int GetD3DTextureHeight(IDirect3DTexture9 * texture)
+{
+    int w, h;
+    GetD3DTextureSize(texture, &w, &h);
+    return h;
+}
+}
@@ -0,0 +1,307 @@
+﻿#include <windows.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <iconv.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+const char* GetCodePageName(UINT codePage)
+{
+    switch (codePage)
+    {
+        case CP_UTF8:
+            return "UTF-8";
+        case CP_ACP: // 弾幕風のスクリプトに合わせてShift_JISとして扱う
+        case 932:
+            return "CP932";
+        default:
+            return nullptr;
+    }
+}
+
+// 変換できないバイトは置き換え文字にして読み進める
+template <class Dst>
+bool ConvertByIconv(const char* toCode, const char* fromCode, const char* src, size_t srcBytes, size_t srcUnitBytes, Dst replacement, std::vector<Dst>& dst)
+{
+    iconv_t cd = iconv_open(toCode, fromCode);
+    if (cd == (iconv_t)-1) return false;
+    char* in = const_cast<char*>(src);
+    size_t inLeft = srcBytes;
+    std::vector<Dst> buf(srcBytes + 4);
+    while (inLeft > 0)
+    {
+        char* out = (char*)buf.data();
+        size_t outLeft = buf.size() * sizeof(Dst);
+        size_t ret = iconv(cd, &in, &inLeft, &out, &outLeft);
+        dst.insert(dst.end(), buf.data(), (Dst*)out);
+        if (ret == (size_t)-1 && errno != E2BIG)
+        {
+            dst.push_back(replacement);
+            size_t skip = std::min(inLeft, srcUnitBytes);
+            in += skip;
+            inLeft -= skip;
+        }
+    }
+    iconv_close(cd);
+    return true;
+}
+
+std::string ToNativePath(const wchar_t* path)
+{
+    std::string ret;
+    int size = WideCharToMultiByte(CP_UTF8, 0, path, -1, NULL, 0, NULL, NULL);
+    if (size <= 0) return ret;
+    ret.resize(size);
+    WideCharToMultiByte(CP_UTF8, 0, path, -1, &ret[0], size, NULL, NULL);
+    ret.pop_back(); // 終端文字
+    return ret;
+}
+
+FILETIME ToFileTime(const struct timespec& t)
+{
+    // FILETIMEは1601年1月1日からの100ナノ秒単位
+    constexpr uint64_t epochDiffSec = 11644473600ull;
+    uint64_t time = ((uint64_t)t.tv_sec + epochDiffSec) * 10000000ull + (uint64_t)t.tv_nsec / 100;
+    FILETIME ret;
+    ret.dwLowDateTime = (DWORD)(time & 0xffffffff);
+    ret.dwHighDateTime = (DWORD)(time >> 32);
+    return ret;
+}
+
+struct FindHandle
+{
+    DIR* dir;
+    std::string dirPath;
+};
+
+bool ReadNextEntry(FindHandle* handle, WIN32_FIND_DATAW* data)
+{
+    while (struct dirent* entry = readdir(handle->dir))
+    {
+        struct stat st;
+        if (stat((handle->dirPath + "/" + entry->d_name).c_str(), &st) != 0) continue;
+        std::memset(data, 0, sizeof(WIN32_FIND_DATAW));
+        data->dwFileAttributes = S_ISDIR(st.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+        data->ftLastWriteTime = ToFileTime(st.st_mtim);
+        data->nFileSizeHigh = (DWORD)((uint64_t)st.st_size >> 32);
+        data->nFileSizeLow = (DWORD)((uint64_t)st.st_size & 0xffffffff);
+        int len = MultiByteToWideChar(CP_UTF8, 0, entry->d_name, -1, data->cFileName, MAX_PATH);
+        if (len <= 0) continue;
+        return true;
+    }
+    return false;
+}
+
+struct FileHandle
+{
+    struct stat st;
+};
+
+int64_t GetMonotonicNanoSec()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t)t.tv_sec * 1000000000ll + t.tv_nsec;
+}
+}
+
+int MultiByteToWideChar(UINT codePage, DWORD flags, LPCSTR src, int srcLen, LPWSTR dst, int dstLen)
+{
+    const char* fromCode = GetCodePageName(codePage);
+    if (fromCode == nullptr || src == nullptr) return 0;
+    size_t srcBytes = srcLen < 0 ? std::strlen(src) + 1 : (size_t)srcLen;
+    std::vector<wchar_t> ws;
+    if (!ConvertByIconv<wchar_t>("WCHAR_T", fromCode, src, srcBytes, 1, L'\xfffd', ws)) return 0;
+    if (dstLen == 0) return (int)ws.size();
+    if ((int)ws.size() > dstLen) return 0;
+    std::copy(ws.begin(), ws.end(), dst);
+    return (int)ws.size();
+}
+
+int WideCharToMultiByte(UINT codePage, DWORD flags, LPCWSTR src, int srcLen, LPSTR dst, int dstLen, LPCSTR defaultChar, BOOL* usedDefaultChar)
+{
+    const char* toCode = GetCodePageName(codePage);
+    if (toCode == nullptr || src == nullptr) return 0;
+    size_t srcChars = srcLen < 0 ? std::wcslen(src) + 1 : (size_t)srcLen;
+    std::vector<char> s;
+    if (!ConvertByIconv<char>(toCode, "WCHAR_T", (const char*)src, srcChars * sizeof(wchar_t), sizeof(wchar_t), '?', s)) return 0;
+    if (dstLen == 0) return (int)s.size();
+    if ((int)s.size() > dstLen) return 0;
+    std::copy(s.begin(), s.end(), dst);
+    return (int)s.size();
+}
+
+DWORD GetFileAttributesW(LPCWSTR path)
+{
+    struct stat st;
+    if (stat(ToNativePath(path).c_str(), &st) != 0) return INVALID_FILE_ATTRIBUTES;
+    return S_ISDIR(st.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+}
+
+HANDLE FindFirstFileW(LPCWSTR pattern, WIN32_FIND_DATAW* data)
+{
+    // エンジンが使うのは"dir/*"の形だけ
+    std::string dirPath = ToNativePath(pattern);
+    if (dirPath.size() >= 2 && dirPath.back() == '*' && (dirPath[dirPath.size() - 2] == '/' || dirPath[dirPath.size() - 2] == '\\'))
+    {
+        dirPath.resize(dirPath.size() - 2);
+    }
+    DIR* dir = opendir(dirPath.empty() ? "/" : dirPath.c_str());
+    if (dir == nullptr) return INVALID_HANDLE_VALUE;
+    auto handle = new FindHandle{ dir, dirPath };
+    if (!ReadNextEntry(handle, data))
+    {
+        FindClose(handle);
+        return INVALID_HANDLE_VALUE;
+    }
+    return handle;
+}
+
+BOOL FindNextFileW(HANDLE findHandle, WIN32_FIND_DATAW* data)
+{
+    return ReadNextEntry((FindHandle*)findHandle, data) ? TRUE : FALSE;
+}
+
+BOOL FindClose(HANDLE findHandle)
+{
+    auto handle = (FindHandle*)findHandle;
+    closedir(handle->dir);
+    delete handle;
+    return TRUE;
+}
+
+HANDLE CreateFileW(LPCWSTR path, DWORD access, DWORD shareMode, void* securityAttributes, DWORD creationDisposition, DWORD flags, HANDLE templateFile)
+{
+    // 読み込みで開いて属性を取るためだけに使われるので, statの結果を持つ
+    if (creationDisposition != OPEN_EXISTING || (access & GENERIC_WRITE)) return INVALID_HANDLE_VALUE;
+    auto handle = new FileHandle();
+    if (stat(ToNativePath(path).c_str(), &handle->st) != 0)
+    {
+        delete handle;
+        return INVALID_HANDLE_VALUE;
+    }
+    return handle;
+}
+
+BOOL GetFileTime(HANDLE file, FILETIME* creationTime, FILETIME* lastAccessTime, FILETIME* lastWriteTime)
+{
+    auto handle = (FileHandle*)file;
+    if (creationTime) *creationTime = ToFileTime(handle->st.st_ctim);
+    if (lastAccessTime) *lastAccessTime = ToFileTime(handle->st.st_atim);
+    if (lastWriteTime) *lastWriteTime = ToFileTime(handle->st.st_mtim);
+    return TRUE;
+}
+
+BOOL CloseHandle(HANDLE handle)
+{
+    delete (FileHandle*)handle;
+    return TRUE;
+}
+
+FILE* _wfopen(const wchar_t* path, const wchar_t* mode)
+{
+    return fopen(ToNativePath(path).c_str(), ToNativePath(mode).c_str());
+}
+
+int _wmkdir(const wchar_t* path)
+{
+    return mkdir(ToNativePath(path).c_str(), 0777);
+}
+
+void GetLocalTime(SYSTEMTIME* systemTime)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    struct tm local;
+    localtime_r(&t.tv_sec, &local);
+    systemTime->wYear = (WORD)(local.tm_year + 1900);
+    systemTime->wMonth = (WORD)(local.tm_mon + 1);
+    systemTime->wDayOfWeek = (WORD)local.tm_wday;
+    systemTime->wDay = (WORD)local.tm_mday;
+    systemTime->wHour = (WORD)local.tm_hour;
+    systemTime->wMinute = (WORD)local.tm_min;
+    systemTime->wSecond = (WORD)local.tm_sec;
+    systemTime->wMilliseconds = (WORD)(t.tv_nsec / 1000000);
+}
+
+void Sleep(DWORD milliSec)
+{
+    usleep((useconds_t)milliSec * 1000);
+}
+
+DWORD timeGetTime()
+{
+    return (DWORD)(GetMonotonicNanoSec() / 1000000);
+}
+
+UINT timeBeginPeriod(UINT period)
+{
+    return 0;
+}
+
+UINT timeEndPeriod(UINT period)
+{
+    return 0;
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* count)
+{
+    count->QuadPart = GetMonotonicNanoSec();
+    return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* freq)
+{
+    freq->QuadPart = 1000000000ll;
+    return TRUE;
+}
+
+void OutputDebugStringA(LPCSTR str)
+{
+    std::fputs(str, stderr);
+}
+
+void OutputDebugStringW(LPCWSTR str)
+{
+    std::fputs(ToNativePath(str).c_str(), stderr);
+}
+
+int swprintf_s(wchar_t* buf, size_t size, const wchar_t* format, ...)
+{
+    // MSVCの%s, %cは引数がワイド文字なので, 長さ修飾子lを付けてから渡す
+    std::wstring fmt;
+    for (const wchar_t* p = format; *p != L'\0'; ++p)
+    {
+        fmt.push_back(*p);
+        if (*p != L'%') continue;
+        ++p;
+        while (*p != L'\0' && std::wcschr(L"-+ #0123456789.*", *p))
+        {
+            fmt.push_back(*p++);
+        }
+        if (*p == L'\0') break;
+        if (*p == L's' || *p == L'c')
+        {
+            fmt.push_back(L'l');
+        }
+        fmt.push_back(*p);
+    }
+    va_list args;
+    va_start(args, format);
+    int ret = std::vswprintf(buf, size, fmt.c_str(), args);
+    va_end(args);
+    if (ret < 0 && size > 0)
+    {
+        buf[0] = L'\0';
+    }
+    return ret;
+}
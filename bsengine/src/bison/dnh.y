@@ -52,7 +52,7 @@ using namespace bstorm;
 static int yylex(DnhParser::semantic_type *yylval, DnhParser::location_type* yylloc, DnhParseContext* ctx)
 {
     auto lexer = ctx->lexer;
-    auto tk = lexer->dnhlex();
+    auto tk = lexer->NextToken();
     switch(tk)
     {
         case DnhParser::token_type::TK_NUM:
@@ -77,28 +77,28 @@ static std::shared_ptr<SourcePos> GetSourcePos(lua_State * L)
 
 static int GetModuleDirectory(lua_State* L)
 {
-    DnhArray(L"./").Push(L);
+    DnhString(L"./").Push(L);
     return 1;
 }
 
 static int GetMainStgScriptPath(lua_State* L)
 {
     Package* package = Package::Current;
-    DnhArray(package->GetMainStgScriptPath()).Push(L);
+    DnhString(package->GetMainStgScriptPath()).Push(L);
     return 1;
 }
 
 static int GetMainStgScriptDirectory(lua_State* L)
 {
     Package* package = Package::Current;
-    DnhArray(package->GetMainStgScriptDirectory()).Push(L);
+    DnhString(package->GetMainStgScriptDirectory()).Push(L);
     return 1;
 }
 
 static int GetMainPackageScriptPath(lua_State* L)
 {
     Package* package = Package::Current;
-    DnhArray(package->GetMainPackageScriptPath()).Push(L);
+    DnhString(package->GetMainPackageScriptPath()).Push(L);
     return 1;
 }
 
@@ -111,7 +111,7 @@ static int GetScriptPathList(lua_State* L)
     DnhArray pathList(scriptList.size());
     for (const auto& info : scriptList)
     {
-        pathList.PushBack(std::make_unique<DnhArray>(info.path));
+        pathList.PushBack(std::make_unique<DnhString>(info.path));
     }
     pathList.Push(L);
     return 1;
@@ -120,7 +120,7 @@ static int GetScriptPathList(lua_State* L)
 static int GetCurrentDateTimeS(lua_State* L)
 {
     Package* package = Package::Current;
-    DnhArray(package->GetCurrentDateTimeS()).Push(L);
+    DnhString(package->GetCurrentDateTimeS()).Push(L);
     return 1;
 }
 
@@ -157,7 +157,7 @@ static int InstallFont(lua_State* L)
 static int ToString(lua_State* L)
 {
     auto str = DnhValue::ToString(L, 1);
-    DnhArray(str).Push(L);
+    DnhString(str).Push(L);
     return 1;
 }
 
@@ -300,7 +300,7 @@ static int GetCommonDataAreaKeyList(lua_State* L)
     DnhArray ret(keyList.size());
     for (const auto& key : keyList)
     {
-        ret.PushBack(std::make_unique<DnhArray>(key));
+        ret.PushBack(std::make_unique<DnhString>(key));
     }
     ret.Push(L);
     return 1;
@@ -313,7 +313,7 @@ static int GetCommonDataValueKeyList(lua_State* L)
     DnhArray ret;
     for (const auto& key : package->GetCommonDataValueKeyList(area))
     {
-        ret.PushBack(std::make_unique<DnhArray>(key));
+        ret.PushBack(std::make_unique<DnhString>(key));
     }
     ret.Push(L);
     return 1;
@@ -729,7 +729,7 @@ static int GetReservedRenderTargetName(lua_State* L)
 {
     Package* package = Package::Current;
     int n = DnhValue::ToInt(L, 1);
-    DnhArray(package->GetReservedRenderTargetName(n)).Push(L);
+    DnhString(package->GetReservedRenderTargetName(n)).Push(L);
     return 1;
 }
 
@@ -1421,14 +1421,14 @@ static int GetAngleToPlayer(lua_State* L)
 static int GetPlayerID(lua_State* L)
 {
     Package* package = Package::Current;
-    DnhArray(package->GetPlayerID()).Push(L);
+    DnhString(package->GetPlayerID()).Push(L);
     return 1;
 }
 
 static int GetPlayerReplayName(lua_State* L)
 {
     Package* package = Package::Current;
-    DnhArray(package->GetPlayerReplayName()).Push(L);
+    DnhString(package->GetPlayerReplayName()).Push(L);
     return 1;
 }
 
@@ -1494,6 +1494,27 @@ static int GetEnemyBossObjectID(lua_State* L)
     return 1;
 }
 
+// IDの配列を要素数分の領域を確保したテーブルとして積む
+static void pushIdArray(lua_State* L, const std::vector<int>& ids)
+{
+    lua_createtable(L, ids.size(), 0);
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        lua_pushnumber(L, ids[i]);
+        lua_rawseti(L, -2, i + 1);
+    }
+}
+
+static int GetEnemyIdNearest(lua_State* L)
+{
+    Package* package = Package::Current;
+    float x = DnhValue::ToNum(L, 1);
+    float y = DnhValue::ToNum(L, 2);
+    int k = DnhValue::ToInt(L, 3);
+    pushIdArray(L, package->GetEnemyIdNearest(x, y, k));
+    return 1;
+}
+
 static int GetAllEnemyID(lua_State* L)
 {
     Package* package = Package::Current;
@@ -1598,7 +1619,7 @@ static int TrimString(lua_State* L)
 {
     auto str = DnhValue::ToString(L, 1);
     TrimSpace(&str);
-    DnhArray(str).Push(L);
+    DnhString(str).Push(L);
     return 1;
 }
 
@@ -1624,7 +1645,7 @@ static int rtos(lua_State* L)
     std::wstring buf(zeroCnt1 + zeroCnt2 + 32, L'\0'); // それなりに大きく
     swprintf_s(&buf[0], buf.size(), &printfFormat[0], num);
     // c_strして別のwstringを作ることで無駄なヌル文字を消去
-    DnhArray(std::wstring(buf.c_str())).Push(L);
+    DnhString(std::wstring(buf.c_str())).Push(L);
     return 1;
 }
 
@@ -1659,7 +1680,7 @@ static int vtos(lua_State* L)
     {
         buf = L"error format";
     }
-    DnhArray(std::wstring(buf.c_str())).Push(L);
+    DnhString(std::wstring(buf.c_str())).Push(L);
     return 1;
 }
 
@@ -1670,7 +1691,7 @@ static int SplitString(lua_State* L)
     DnhArray arr;
     for (auto& s : Split(str, delim))
     {
-        arr.PushBack(std::make_unique<DnhArray>(s));
+        arr.PushBack(std::make_unique<DnhString>(s));
     }
     arr.Push(L);
     return 1;
@@ -1679,7 +1700,7 @@ static int SplitString(lua_State* L)
 static int GetFileDirectory(lua_State* L)
 {
     auto path = DnhValue::ToString(L, 1);
-    DnhArray(GetParentPath(path) + L"/").Push(L);
+    DnhString(GetParentPath(path) + L"/").Push(L);
     return 1;
 }
 
@@ -1688,7 +1709,7 @@ static int GetFilePathList(lua_State* L)
     auto dirPath = DnhValue::ToString(L, 1);
     if (dirPath.empty())
     {
-        DnhArray(L"").Push(L);
+        DnhString(L"").Push(L);
         return 1;
     }
 
@@ -1703,7 +1724,7 @@ static int GetFilePathList(lua_State* L)
     DnhArray ret;
     for (const auto& path : pathList)
     {
-        ret.PushBack(std::make_unique<DnhArray>(path));
+        ret.PushBack(std::make_unique<DnhString>(path));
     }
     ret.Push(L);
     return 1;
@@ -1714,7 +1735,7 @@ static int GetDirectoryList(lua_State* L)
     auto dirPath = DnhValue::ToString(L, 1);
     if (dirPath.empty())
     {
-        DnhArray(L"").Push(L);
+        DnhString(L"").Push(L);
         return 1;
     }
 
@@ -1729,7 +1750,7 @@ static int GetDirectoryList(lua_State* L)
     DnhArray ret;
     for (const auto& dir : dirList)
     {
-        ret.PushBack(std::make_unique<DnhArray>(ConcatPath(dir, L"")));
+        ret.PushBack(std::make_unique<DnhString>(ConcatPath(dir, L"")));
     }
     ret.Push(L);
     return 1;
@@ -1977,41 +1998,94 @@ static int SetShotIntersectionLine(lua_State* L)
     return 0;
 }
 
+// 自機スクリプトなら敵の弾, それ以外なら自機の弾
+static int getDefaultShotTarget(lua_State* L)
+{
+    return GetScript(L)->GetType() == ScriptType::Value::PLAYER ? TARGET_ENEMY : TARGET_PLAYER;
+}
+
+// 軸に平行な矩形を太さのある線分で表す
+static Shape rectToShape(float left, float top, float right, float bottom)
+{
+    const float centerY = (top + bottom) / 2.0f;
+    return Shape(left, centerY, right, centerY, bottom - top);
+}
+
 static int GetShotIdInCircleA1(lua_State* L)
 {
     Package* package = Package::Current;
-    Script* script = GetScript(L);
-    double x = DnhValue::ToNum(L, 1);
-    double y = DnhValue::ToNum(L, 2);
-    double r = DnhValue::ToNum(L, 3);
-    DnhArray ids;
-    for (auto& shot : package->GetShotInCircle(x, y, r, script->GetType() == ScriptType::Value::PLAYER ? TARGET_ENEMY : TARGET_PLAYER))
-    {
-        if (shot)
-        {
-            ids.PushBack(std::make_unique<DnhReal>((double)shot->GetID()));
-        }
-    }
-    ids.Push(L);
+    float x = DnhValue::ToNum(L, 1);
+    float y = DnhValue::ToNum(L, 2);
+    float r = DnhValue::ToNum(L, 3);
+    pushIdArray(L, package->GetShotIdInShape(Shape(x, y, r), getDefaultShotTarget(L)));
     return 1;
 }
 
 static int GetShotIdInCircleA2(lua_State* L)
 {
     Package* package = Package::Current;
-    double x = DnhValue::ToNum(L, 1);
-    double y = DnhValue::ToNum(L, 2);
-    double r = DnhValue::ToNum(L, 3);
+    float x = DnhValue::ToNum(L, 1);
+    float y = DnhValue::ToNum(L, 2);
+    float r = DnhValue::ToNum(L, 3);
     int target = DnhValue::ToInt(L, 4);
-    DnhArray ids;
-    for (auto& shot : package->GetShotInCircle(x, y, r, target))
-    {
-        if (shot)
-        {
-            ids.PushBack(std::make_unique<DnhReal>((double)shot->GetID()));
-        }
-    }
-    ids.Push(L);
+    pushIdArray(L, package->GetShotIdInShape(Shape(x, y, r), target));
+    return 1;
+}
+
+static int GetShotIdInRectA1(lua_State* L)
+{
+    Package* package = Package::Current;
+    float left = DnhValue::ToNum(L, 1);
+    float top = DnhValue::ToNum(L, 2);
+    float right = DnhValue::ToNum(L, 3);
+    float bottom = DnhValue::ToNum(L, 4);
+    pushIdArray(L, package->GetShotIdInShape(rectToShape(left, top, right, bottom), getDefaultShotTarget(L)));
+    return 1;
+}
+
+static int GetShotIdInRectA2(lua_State* L)
+{
+    Package* package = Package::Current;
+    float left = DnhValue::ToNum(L, 1);
+    float top = DnhValue::ToNum(L, 2);
+    float right = DnhValue::ToNum(L, 3);
+    float bottom = DnhValue::ToNum(L, 4);
+    int target = DnhValue::ToInt(L, 5);
+    pushIdArray(L, package->GetShotIdInShape(rectToShape(left, top, right, bottom), target));
+    return 1;
+}
+
+static int GetShotCountInCircle(lua_State* L)
+{
+    Package* package = Package::Current;
+    float x = DnhValue::ToNum(L, 1);
+    float y = DnhValue::ToNum(L, 2);
+    float r = DnhValue::ToNum(L, 3);
+    int target = DnhValue::ToInt(L, 4);
+    lua_pushnumber(L, package->GetShotCountInShape(Shape(x, y, r), target));
+    return 1;
+}
+
+static int GetShotCountInRect(lua_State* L)
+{
+    Package* package = Package::Current;
+    float left = DnhValue::ToNum(L, 1);
+    float top = DnhValue::ToNum(L, 2);
+    float right = DnhValue::ToNum(L, 3);
+    float bottom = DnhValue::ToNum(L, 4);
+    int target = DnhValue::ToInt(L, 5);
+    lua_pushnumber(L, package->GetShotCountInShape(rectToShape(left, top, right, bottom), target));
+    return 1;
+}
+
+static int GetShotIdNearest(lua_State* L)
+{
+    Package* package = Package::Current;
+    float x = DnhValue::ToNum(L, 1);
+    float y = DnhValue::ToNum(L, 2);
+    int k = DnhValue::ToInt(L, 3);
+    int target = DnhValue::ToInt(L, 4);
+    pushIdArray(L, package->GetShotIdNearest(x, y, k, target));
     return 1;
 }
 
@@ -2402,22 +2476,22 @@ static int GetScriptInfoA1(lua_State* L)
             lua_pushnumber(L, info.type.GetScriptConst());
             break;
         case INFO_SCRIPT_PATH:
-            DnhArray(info.path).Push(L);
+            DnhString(info.path).Push(L);
             break;
         case INFO_SCRIPT_ID:
-            DnhArray(info.id).Push(L);
+            DnhString(info.id).Push(L);
             break;
         case INFO_SCRIPT_TITLE:
-            DnhArray(info.title).Push(L);
+            DnhString(info.title).Push(L);
             break;
         case INFO_SCRIPT_TEXT:
-            DnhArray(info.text).Push(L);
+            DnhString(info.text).Push(L);
             break;
         case INFO_SCRIPT_IMAGE:
-            DnhArray(info.imagePath).Push(L);
+            DnhString(info.imagePath).Push(L);
             break;
         case INFO_SCRIPT_REPLAY_NAME:
-            DnhArray(info.replayName).Push(L);
+            DnhString(info.replayName).Push(L);
             break;
         default:
             lua_pushnumber(L, -1);
@@ -2652,9 +2726,9 @@ static int ObjRender_SetColor(lua_State* L)
     {
         obj->SetColor(r, g, b);
         // ObjPrimでObjSpriteList2Dでなければ全ての頂点に設定
-        if (auto prim = std::dynamic_pointer_cast<ObjPrim>(obj))
+        if (auto prim = ObjCast<ObjPrim>(obj.get()))
         {
-            if (!std::dynamic_pointer_cast<ObjSpriteList2D>(prim))
+            if (!ObjCast<ObjSpriteList2D>(prim))
             {
                 int vertexCnt = prim->GetVertexCount();
                 for (int i = 0; i < vertexCnt; i++)
@@ -2678,9 +2752,9 @@ static int ObjRender_SetColorHSV(lua_State* L)
     {
         obj->SetColorHSV(h, s, v);
         // ObjPrimでObjSpriteList2Dでなければ全ての頂点に設定
-        if (auto prim = std::dynamic_pointer_cast<ObjPrim>(obj))
+        if (auto prim = ObjCast<ObjPrim>(obj.get()))
         {
-            if (!std::dynamic_pointer_cast<ObjSpriteList2D>(prim))
+            if (!ObjCast<ObjSpriteList2D>(prim))
             {
                 int vertexCnt = prim->GetVertexCount();
                 const auto& color = prim->GetColor();
@@ -3895,10 +3969,10 @@ static int ObjFileT_GetLineText(lua_State* L)
     int lineNum = DnhValue::ToInt(L, 2);
     if (auto obj = package->GetObject<ObjFileT>(objId))
     {
-        DnhArray(obj->GetLineText(lineNum)).Push(L);
+        DnhString(obj->GetLineText(lineNum)).Push(L);
     } else
     {
-        DnhArray(L"").Push(L);
+        DnhString(L"").Push(L);
     }
     return 1;
 }
@@ -3914,7 +3988,7 @@ static int ObjFileT_SplitLineText(lua_State* L)
         DnhArray ret;
         for (const auto& s : obj->SplitLineText(lineNum, delim))
         {
-            ret.PushBack(std::make_unique<DnhArray>(s));
+            ret.PushBack(std::make_unique<DnhString>(s));
         }
         ret.Push(L);
     } else
@@ -4116,10 +4190,10 @@ static int ObjFileB_ReadString(lua_State*L)
     int size = DnhValue::ToInt(L, 2);
     if (auto obj = package->GetObject<ObjFileB>(objId))
     {
-        DnhArray(obj->ReadString(size)).Push(L);
+        DnhString(obj->ReadString(size)).Push(L);
     } else
     {
-        DnhArray(L"").Push(L);
+        DnhString(L"").Push(L);
     }
     return 1;
 }
@@ -5351,7 +5425,7 @@ static int CreatePlayerShotA1(lua_State* L)
 static int GetTransitionRenderTargetName(lua_State* L)
 {
     Package* package = Package::Current;
-    DnhArray(package->GetTransitionRenderTargetName()).Push(L);
+    DnhString(package->GetTransitionRenderTargetName()).Push(L);
     return 1;
 }
 
@@ -5489,25 +5563,25 @@ static int GetFreePlayerScriptInfo(lua_State* L)
         switch (infoType)
         {
             case INFO_SCRIPT_PATH:
-                DnhArray(info.path).Push(L);
+                DnhString(info.path).Push(L);
                 break;
             case INFO_SCRIPT_ID:
-                DnhArray(info.id).Push(L);
+                DnhString(info.id).Push(L);
                 break;
             case INFO_SCRIPT_TITLE:
-                DnhArray(info.title).Push(L);
+                DnhString(info.title).Push(L);
                 break;
             case INFO_SCRIPT_TEXT:
-                DnhArray(info.text).Push(L);
+                DnhString(info.text).Push(L);
                 break;
             case INFO_SCRIPT_IMAGE:
-                DnhArray(info.imagePath).Push(L);
+                DnhString(info.imagePath).Push(L);
                 break;
             case INFO_SCRIPT_REPLAY_NAME:
-                DnhArray(info.replayName).Push(L);
+                DnhString(info.replayName).Push(L);
                 break;
             default:
-                DnhArray(L"").Push(L);
+                DnhString(L"").Push(L);
                 break;
         }
         return 1;
@@ -5524,7 +5598,7 @@ static int LoadReplayList(lua_State* L)
 static int GetValidReplayIndices(lua_State* L)
 {
     // FUTURE : impl
-    DnhArray(L"").Push(L);
+    DnhString(L"").Push(L);
     return 1;
 }
 
@@ -5538,7 +5612,7 @@ static int IsValidReplayIndex(lua_State* L)
 static int GetReplayInfo(lua_State* L)
 {
     // FUTURE : impl
-    DnhArray(L"").Push(L);
+    DnhString(L"").Push(L);
     return 1;
 }
 
@@ -6441,6 +6515,7 @@ std::shared_ptr<Env> CreateInitRootEnv(ScriptType scriptType, const std::wstring
         builtin(GetAllEnemyIntersectionPosition, 0);
         builtin(GetEnemyIntersectionPositionByIdA1, 1);
         builtin(GetEnemyIntersectionPositionByIdA2, 3);
+        builtin(GetEnemyIdNearest, 3);
         builtin(LoadEnemyShotData, 1);
         builtin(ReloadEnemyShotData, 1);
 
@@ -6459,6 +6534,11 @@ std::shared_ptr<Env> CreateInitRootEnv(ScriptType scriptType, const std::wstring
         builtin(SetShotIntersectionLine, 5);
         builtin(GetShotIdInCircleA1, 3);
         builtin(GetShotIdInCircleA2, 4);
+        builtin(GetShotIdInRectA1, 4);
+        builtin(GetShotIdInRectA2, 5);
+        builtin_real(GetShotCountInCircle, 4);
+        builtin_real(GetShotCountInRect, 5);
+        builtin(GetShotIdNearest, 4);
         builtin_real(GetShotCount, 1);
         builtin(SetShotAutoDeleteClip, 4);
         builtin(GetShotDataInfoA1, 3);
@@ -0,0 +1,883 @@
+﻿#include <bstorm/broadphase.hpp>
+
+#include <bstorm/math_util.hpp>
+#include <bstorm/thread_util.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+
+namespace bstorm
+{
+Broadphase::Broadphase(int cellCount) :
+    cells_(cellCount),
+    cellGroupMasks_(cellCount, 0),
+    cellCollidableGroupMasks_(cellCount, 0),
+    pairTestCnt_(0),
+    recordCnt_(0),
+    isTesting_(false),
+    threadCnt_(1),
+    contexts_(1)
+{
+}
+
+Broadphase::~Broadphase()
+{
+}
+
+void Broadphase::Add(const std::shared_ptr<Intersection>& isect)
+{
+    if (isect->slotIdx_ >= 0)
+    {
+        Remove(isect);
+    }
+    uint32_t slotIdx;
+    if (freeSlotIndices_.empty())
+    {
+        slotIdx = slots_.size();
+        slots_.emplace_back();
+    } else
+    {
+        slotIdx = freeSlotIndices_.back();
+        freeSlotIndices_.pop_back();
+    }
+    const int cellIdx = CalcCellIndexFromBoundingBox(isect->GetShape().GetBoundingBox());
+    auto& cell = cells_[cellIdx];
+    auto& slot = slots_[slotIdx];
+    slot.isect = isect;
+    slot.cellIdx = cellIdx;
+    slot.posInCell = cell.size();
+    cell.push_back(MakeRecord(*isect, slotIdx));
+    isect->slotIdx_ = slotIdx;
+}
+
+void Broadphase::Update(const std::shared_ptr<Intersection>& isect)
+{
+    if (isect->slotIdx_ < 0 || isTesting_)
+    {
+        // 検査中はセルを書き換えない, 登録し直す
+        Add(isect);
+        return;
+    }
+    // スロットはそのまま使い, 所属するセルが変わった時だけセルを移る
+    const uint32_t slotIdx = isect->slotIdx_;
+    auto& slot = slots_[slotIdx];
+    const int cellIdx = CalcCellIndexFromBoundingBox(isect->GetShape().GetBoundingBox());
+    if (cellIdx != slot.cellIdx)
+    {
+        UnlinkRecord(slotIdx);
+        slot.cellIdx = cellIdx;
+        slot.posInCell = cells_[cellIdx].size();
+        cells_[cellIdx].emplace_back();
+    }
+    cells_[slot.cellIdx][slot.posInCell] = MakeRecord(*isect, slotIdx);
+}
+
+void Broadphase::Remove(const std::shared_ptr<Intersection>& isect)
+{
+    if (isect->slotIdx_ < 0) return;
+    const uint32_t slotIdx = isect->slotIdx_;
+    isect->slotIdx_ = -1;
+    if (isTesting_)
+    {
+        // 検査中はセルを書き換えない, 次のCompactで取り除く
+        slots_[slotIdx].isect.reset();
+        return;
+    }
+    UnlinkRecord(slotIdx);
+    FreeSlot(slotIdx);
+}
+
+Broadphase::Record Broadphase::MakeRecord(const Intersection& isect, uint32_t slotIdx)
+{
+    const auto& shape = isect.GetShape();
+    Record record{ shape.GetBoundingBox(), 0.0f, 0.0f, 0.0f, isect.GetCollisionGroup(), false, slotIdx };
+    if (shape.GetType() == Shape::Type::CIRCLE)
+    {
+        shape.GetCircle(record.x, record.y, record.r);
+        record.isCircle = true;
+    }
+    return record;
+}
+
+void Broadphase::UnlinkRecord(uint32_t slotIdx)
+{
+    // 末尾の判定と入れ替えて削除
+    auto& cell = cells_[slots_[slotIdx].cellIdx];
+    const uint32_t pos = slots_[slotIdx].posInCell;
+    cell[pos] = cell.back();
+    slots_[cell[pos].slotIdx].posInCell = pos;
+    cell.pop_back();
+}
+
+void Broadphase::TestAllCollision(const CollisionMatrix& colMatrix)
+{
+    pairTestCnt_ = 0;
+    // 前回衝突した当たり判定を空にする
+    for (const auto& p : collidedIsects_)
+    {
+        if (auto isect = p.lock())
+        {
+            isect->collideIsects_.clear();
+        }
+    }
+    collidedIsects_.clear();
+    Compact(colMatrix);
+    // NOTE: CollisionFunction内でIntersectionが移動すると、移動先でさらに判定が取られることがある
+    //       弾幕風の場合、衝突時に移動することはないのでこれを仕様とし特に対策は行わない
+    //       検査中に削除された判定はセルに残るが、lockできないので衝突しない
+    contexts_.resize(threadCnt_);
+    for (auto& ctx : contexts_)
+    {
+        ctx.pairTestCnt = 0;
+    }
+    isTesting_ = true;
+    TestAllCells(colMatrix);
+    isTesting_ = false;
+    for (const auto& ctx : contexts_)
+    {
+        pairTestCnt_ += ctx.pairTestCnt;
+    }
+}
+
+void Broadphase::SetThreadCount(int threadCnt)
+{
+    threadCnt_ = std::max(1, threadCnt);
+}
+
+int Broadphase::CalcTestThreadCount() const
+{
+    return std::max(1, std::min(threadCnt_, (int)(recordCnt_ / MIN_RECORD_COUNT_PER_THREAD)));
+}
+
+void Broadphase::RunParallelTasks(int taskCnt, int threadCnt, const CollisionMatrix& colMatrix, const std::function<void(int, int, TestContext&)>& func)
+{
+    assert(threadCnt <= contexts_.size());
+    if (taskCollisions_.size() < taskCnt) taskCollisions_.resize(taskCnt);
+    for (int taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    {
+        taskCollisions_[taskIdx].clear();
+    }
+
+    // 並列: 衝突した組をタスクごとに貯める
+    // タスクの重さは判定の分布によって偏るので、空いたスレッドから順に次のタスクを取る
+    std::atomic<int> nextTaskIdx(0);
+    ParallelRange(threadCnt, threadCnt, [&](int begin, int end)
+    {
+        for (int threadIdx = begin; threadIdx < end; threadIdx++)
+        {
+            auto& ctx = contexts_[threadIdx];
+            int taskIdx;
+            while ((taskIdx = nextTaskIdx++) < taskCnt)
+            {
+                ctx.deferredCollisions = &taskCollisions_[taskIdx];
+                func(taskIdx, threadIdx, ctx);
+            }
+            ctx.deferredCollisions = nullptr;
+        }
+    });
+
+    // 逐次: タスクの順番で衝突処理を行う (スレッド数によらず同じ順番になる)
+    for (int taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    {
+        for (const auto& collision : taskCollisions_[taskIdx])
+        {
+            Collide(collision.first, collision.second, colMatrix);
+        }
+    }
+}
+
+void Broadphase::TestPair(const Record& record1, const Record& record2, const CollisionMatrix& colMatrix, TestContext& ctx)
+{
+    ctx.pairTestCnt++;
+    if (!record1.boundingBox.IsIntersected(record2.boundingBox)) return;
+    // 衝突処理中にslots_が伸びることがあるので参照は保持しない
+    auto isect1 = slots_[record1.slotIdx].isect.lock();
+    if (!isect1) return;
+    auto isect2 = slots_[record2.slotIdx].isect.lock();
+    if (!isect2) return;
+    // 複数の円からなる判定(Shape::Type::CIRCLES)は当たった円の数だけ衝突処理を行う
+    const int hitCnt = isect1->GetShape().CountIntersections(isect2->GetShape());
+    if (hitCnt == 0) return;
+    if (ctx.deferredCollisions)
+    {
+        for (int i = 0; i < hitCnt; i++)
+        {
+            ctx.deferredCollisions->emplace_back(record1.slotIdx, record2.slotIdx);
+        }
+    } else
+    {
+        Collide(isect1, isect2, colMatrix);
+        for (int i = 1; i < hitCnt; i++)
+        {
+            Collide(record1.slotIdx, record2.slotIdx, colMatrix);
+        }
+    }
+}
+
+void Broadphase::Collide(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2, const CollisionMatrix& colMatrix)
+{
+    // 衝突した相手を保存
+    if (isect1->collideIsects_.empty()) collidedIsects_.push_back(isect1);
+    if (isect2->collideIsects_.empty()) collidedIsects_.push_back(isect2);
+    isect1->collideIsects_.push_back(isect2);
+    isect2->collideIsects_.push_back(isect1);
+    colMatrix.Collide(isect1, isect2);
+}
+
+void Broadphase::Collide(uint32_t slotIdx1, uint32_t slotIdx2, const CollisionMatrix& colMatrix)
+{
+    // 先に衝突処理した組で削除された判定は衝突しない
+    auto isect1 = slots_[slotIdx1].isect.lock();
+    if (!isect1) return;
+    auto isect2 = slots_[slotIdx2].isect.lock();
+    if (!isect2) return;
+    Collide(isect1, isect2, colMatrix);
+}
+
+void Broadphase::CollideOrDefer(uint32_t slotIdx1, uint32_t slotIdx2, const CollisionMatrix& colMatrix, TestContext& ctx)
+{
+    if (ctx.deferredCollisions)
+    {
+        ctx.deferredCollisions->emplace_back(slotIdx1, slotIdx2);
+    } else
+    {
+        Collide(slotIdx1, slotIdx2, colMatrix);
+    }
+}
+
+void Broadphase::TestCircles(const CircleBatch& circles1, size_t begin1, size_t end1, const CircleBatch& circles2, size_t begin2, size_t end2, const CollisionMatrix& colMatrix, TestContext& ctx)
+{
+    // 要素数の多い方をまとめて検査する
+    if (end1 - begin1 > end2 - begin2)
+    {
+        TestCircles(circles2, begin2, end2, circles1, begin1, end1, colMatrix, ctx);
+        return;
+    }
+    const size_t batchSize = end2 - begin2;
+    if (batchSize == 0) return;
+    auto& hitIndices = ctx.hitIndices;
+    if (hitIndices.size() < batchSize) hitIndices.resize(batchSize);
+    for (size_t i = begin1; i < end1; i++)
+    {
+        ctx.pairTestCnt += batchSize;
+        const BoundingBox boundingBox(circles1.left[i], circles1.top[i], circles1.right[i], circles1.bottom[i]);
+        const size_t hitCnt = IntersectCircleBatch(boundingBox, circles1.x[i], circles1.y[i], circles1.r[i], circles2, begin2, end2, hitIndices.data());
+        for (size_t k = 0; k < hitCnt; k++)
+        {
+            CollideOrDefer(circles1.ids[i], circles2.ids[hitIndices[k]], colMatrix, ctx);
+        }
+    }
+}
+
+void Broadphase::TestRecordLists(const RecordList& list1, const RecordList& list2, const CollisionMatrix& colMatrix, TestContext& ctx)
+{
+    TestCircles(*list1.circles, list1.circleBegin, list1.circleEnd, *list2.circles, list2.circleBegin, list2.circleEnd, colMatrix, ctx);
+    // 円以外が含まれる組は1組ずつ検査する
+    for (size_t i = list1.circleBegin; i < list1.circleEnd; i++)
+    {
+        for (size_t j = 0; j < list2.shapeCnt; j++)
+        {
+            TestPair(GetCircleRecord(*list1.circles, i, list1.group), list2.shapes[j], colMatrix, ctx);
+        }
+    }
+    for (size_t i = 0; i < list1.shapeCnt; i++)
+    {
+        for (size_t j = list2.circleBegin; j < list2.circleEnd; j++)
+        {
+            TestPair(list1.shapes[i], GetCircleRecord(*list2.circles, j, list2.group), colMatrix, ctx);
+        }
+        for (size_t j = 0; j < list2.shapeCnt; j++)
+        {
+            TestPair(list1.shapes[i], list2.shapes[j], colMatrix, ctx);
+        }
+    }
+}
+
+void Broadphase::TestRecordList(const RecordList& list, const CollisionMatrix& colMatrix, TestContext& ctx)
+{
+    for (size_t i = list.circleBegin; i < list.circleEnd; i++)
+    {
+        TestCircles(*list.circles, i, i + 1, *list.circles, i + 1, list.circleEnd, colMatrix, ctx);
+        for (size_t j = 0; j < list.shapeCnt; j++)
+        {
+            TestPair(GetCircleRecord(*list.circles, i, list.group), list.shapes[j], colMatrix, ctx);
+        }
+    }
+    for (size_t i = 0; i < list.shapeCnt; i++)
+    {
+        for (size_t j = i + 1; j < list.shapeCnt; j++)
+        {
+            TestPair(list.shapes[i], list.shapes[j], colMatrix, ctx);
+        }
+    }
+}
+
+Broadphase::Record Broadphase::GetCircleRecord(const CircleBatch& circles, size_t idx, CollisionGroup group)
+{
+    const BoundingBox boundingBox(circles.left[idx], circles.top[idx], circles.right[idx], circles.bottom[idx]);
+    return Record{ boundingBox, circles.x[idx], circles.y[idx], circles.r[idx], group, true, circles.ids[idx] };
+}
+
+void Broadphase::PushRecord(const Record& record, CircleBatch& circles, std::vector<Record>& shapes)
+{
+    if (record.isCircle)
+    {
+        circles.Push(record.boundingBox, record.x, record.y, record.r, record.slotIdx);
+    } else
+    {
+        shapes.push_back(record);
+    }
+}
+
+void Broadphase::ForEachCandidateInCell(int cellIdx, const BoundingBox& boundingBox, const std::function<void(const std::shared_ptr<Intersection>&)>& func) const
+{
+    for (const auto& record : cells_[cellIdx])
+    {
+        if (!record.boundingBox.IsIntersected(boundingBox)) continue;
+        if (auto isect = slots_[record.slotIdx].isect.lock())
+        {
+            func(isect);
+        }
+    }
+}
+
+void Broadphase::Compact(const CollisionMatrix& colMatrix)
+{
+    const int dim = colMatrix.GetDimension();
+    assert(dim <= 32);
+    collidableGroupMasks_.assign(dim, 0);
+    for (int group1 = 0; group1 < dim; group1++)
+    {
+        for (int group2 = 0; group2 < dim; group2++)
+        {
+            if (colMatrix.IsCollidable(group1, group2))
+            {
+                collidableGroupMasks_[group1] |= 1u << group2;
+            }
+        }
+    }
+
+    recordCnt_ = 0;
+    for (int cellIdx = 0; cellIdx < cells_.size(); cellIdx++)
+    {
+        auto& cell = cells_[cellIdx];
+        uint32_t groupMask = 0;
+        uint32_t collidableGroupMask = 0;
+        size_t cnt = 0;
+        for (size_t i = 0; i < cell.size(); i++)
+        {
+            const Record record = cell[i];
+            if (slots_[record.slotIdx].isect.expired())
+            {
+                // 弱参照が切れてたら削除
+                FreeSlot(record.slotIdx);
+                continue;
+            }
+            if (cnt != i)
+            {
+                cell[cnt] = record;
+                slots_[record.slotIdx].posInCell = cnt;
+            }
+            cnt++;
+            groupMask |= 1u << record.group;
+            collidableGroupMask |= collidableGroupMasks_[record.group];
+        }
+        cell.resize(cnt);
+        recordCnt_ += cnt;
+        cellGroupMasks_[cellIdx] = groupMask;
+        cellCollidableGroupMasks_[cellIdx] = collidableGroupMask;
+    }
+}
+
+void Broadphase::FreeSlot(uint32_t slotIdx)
+{
+    slots_[slotIdx].isect.reset();
+    freeSlotIndices_.push_back(slotIdx);
+}
+
+// maskの最下位の立っているビットを下ろしてその位置を返す
+static inline int popLowestBit(uint32_t& mask)
+{
+    int i = 0;
+    while (((mask >> i) & 1) == 0) i++;
+    mask &= ~(1u << i);
+    return i;
+}
+
+static inline int CalcTreeIndex(int level, int morton)
+{
+    return ((1 << (level << 1)) - 1) / 3 + morton;
+}
+
+QuadTreeBroadphase::QuadTreeBroadphase(int fieldWidth, int fieldHeight) :
+    Broadphase(CellCount),
+    fieldWidth_((float)fieldWidth),
+    fieldHeight_((float)fieldHeight),
+    unitCellWidth_(1.0f * fieldWidth / (1 << MaxLevel)),
+    unitCellHeight_(1.0f * fieldHeight / (1 << MaxLevel))
+{
+    assert(fieldWidth_ >= 0.0f);
+    assert(fieldHeight_ >= 0.0f);
+    assert(MaxLevel >= 0);
+    static_assert(ParallelSplitLevel <= MaxLevel, "ParallelSplitLevel must not exceed MaxLevel");
+}
+
+void QuadTreeBroadphase::ForEachCandidate(const BoundingBox& boundingBox, const std::function<void(const std::shared_ptr<Intersection>&)>& func) const
+{
+    // 幅優先探索
+    // 部分木の同じレベルのセルは連続しているので, キューを使わずにレベルごとの範囲で辿る
+    // 部分木を1レベル下る度に祖先を1つ上る (キューで辿った時と同じ順番)
+    const int startTreeIndex = CalcCellIndexFromBoundingBox(boundingBox);
+    ForEachCandidateInCell(startTreeIndex, boundingBox, func);
+    int lowLevelBegin = (startTreeIndex << 2) + 1;
+    int lowLevelEnd = lowLevelBegin + 4;
+    int highLevelIdx = startTreeIndex;
+    while (lowLevelBegin < CellCount || highLevelIdx != 0)
+    {
+        // 下位レベル
+        if (lowLevelBegin < CellCount)
+        {
+            for (int treeIdx = lowLevelBegin; treeIdx < lowLevelEnd; treeIdx++)
+            {
+                ForEachCandidateInCell(treeIdx, boundingBox, func);
+            }
+            lowLevelBegin = (lowLevelBegin << 2) + 1;
+            lowLevelEnd = (lowLevelEnd << 2) + 1;
+        }
+        // 上位レベル
+        if (highLevelIdx != 0)
+        {
+            highLevelIdx = (highLevelIdx - 1) >> 2;
+            ForEachCandidateInCell(highLevelIdx, boundingBox, func);
+        }
+    }
+}
+
+void QuadTreeBroadphase::TestAllCells(const CollisionMatrix& colMatrix)
+{
+    // 部分木ごとのグループの集合を下位レベルから求める
+    for (int treeIdx = CellCount - 1; treeIdx >= 0; treeIdx--)
+    {
+        uint32_t groupMask = cellGroupMasks_[treeIdx];
+        uint32_t collidableGroupMask = cellCollidableGroupMasks_[treeIdx];
+        const int lowLevelNode1 = (treeIdx << 2) + 1;
+        if (lowLevelNode1 < CellCount)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                groupMask |= subtreeGroupMasks_[lowLevelNode1 + i];
+                collidableGroupMask |= subtreeCollidableGroupMasks_[lowLevelNode1 + i];
+            }
+        }
+        subtreeGroupMasks_[treeIdx] = groupMask;
+        subtreeCollidableGroupMasks_[treeIdx] = collidableGroupMask;
+    }
+    const int threadCnt = CalcTestThreadCount();
+    walkers_.resize(std::max(walkers_.size(), (size_t)threadCnt));
+    SplitTasks();
+    // 逐次に検査する時も同じタスクに分け, 衝突処理は全てのタスクの検査が終わってから行う
+    // セルは探索中に読むので, すぐに衝突処理すると衝突処理で追加された判定まで同じフレームで検査してしまう
+    // 衝突処理の呼ばれる順番と結果はスレッド数によらない
+    RunParallelTasks(1 + splitTreeIndices_.size(), threadCnt, colMatrix, [&](int taskIdx, int threadIdx, TestContext& ctx)
+    {
+        TestTask(taskIdx, colMatrix, walkers_[threadIdx], ctx);
+    });
+}
+
+void QuadTreeBroadphase::SplitTasks()
+{
+    // 衝突しうる組を含む部分木だけをタスクにする
+    const int splitBeginIdx = CalcTreeIndex(ParallelSplitLevel, 0);
+    const int splitEndIdx = CalcTreeIndex(ParallelSplitLevel + 1, 0);
+    splitTreeIndices_.clear();
+    for (int treeIdx = splitBeginIdx; treeIdx < splitEndIdx; treeIdx++)
+    {
+        uint32_t visitedGroupMask = 0;
+        for (int node = treeIdx; node != 0;)
+        {
+            node = (node - 1) >> 2;
+            visitedGroupMask |= cellGroupMasks_[node];
+        }
+        if ((subtreeCollidableGroupMasks_[treeIdx] & (subtreeGroupMasks_[treeIdx] | visitedGroupMask)) == 0) continue;
+        splitTreeIndices_.push_back(treeIdx);
+    }
+
+    // 上位のノードの判定はタスク間で共有するので先に集めておく
+    const int groupCnt = GetGroupCount();
+    upperNodeRecords_.resize(splitBeginIdx);
+    for (int treeIdx = 0; treeIdx < splitBeginIdx; treeIdx++)
+    {
+        auto& records = upperNodeRecords_[treeIdx];
+        records.Resize(groupCnt);
+        for (int group = 0; group < groupCnt; group++)
+        {
+            records.Clear(group);
+        }
+        for (const auto& record : cells_[treeIdx])
+        {
+            records.Push(record);
+        }
+    }
+}
+
+void QuadTreeBroadphase::TestTask(int taskIdx, const CollisionMatrix& colMatrix, Walker& walker, TestContext& ctx)
+{
+    walker.Reset(GetGroupCount());
+    if (taskIdx == 0)
+    {
+        // ParallelSplitLevelより上位のノード同士の組
+        walker.endTreeIdx = CalcTreeIndex(ParallelSplitLevel, 0);
+        TestNodeCollision(0, 0, colMatrix, walker, ctx);
+        return;
+    }
+    const int treeIdx = splitTreeIndices_[taskIdx - 1];
+    uint32_t visitedGroupMask = 0;
+    for (int node = treeIdx; node != 0;)
+    {
+        node = (node - 1) >> 2;
+        visitedGroupMask |= cellGroupMasks_[node];
+        walker.ancestors[walker.ancestorCnt++] = &upperNodeRecords_[node];
+    }
+    walker.endTreeIdx = CellCount;
+    TestNodeCollision(treeIdx, visitedGroupMask, colMatrix, walker, ctx);
+}
+
+// 指定したノードの上位と下位にある全当たり判定のペアに対して衝突検査を行う
+// treeIdx: ノード番号
+// visitedGroupMask: 上位レベルのノードの判定のグループの集合
+// walker.visited, walker.ancestors: 上位レベルのノードの判定
+//                                  Recordをコピーして保持するので、衝突処理中にセルが伸びても問題ない
+void QuadTreeBroadphase::TestNodeCollision(int treeIdx, uint32_t visitedGroupMask, const CollisionMatrix& colMatrix, Walker& walker, TestContext& ctx)
+{
+    // 部分木の中にも、部分木と上位レベルの間にも衝突しうる組が無ければ探索しない
+    if ((subtreeCollidableGroupMasks_[treeIdx] & (subtreeGroupMasks_[treeIdx] | visitedGroupMask)) == 0) return;
+
+    // このノードの判定をグループごとに集める
+    const uint32_t nodeGroupMask = cellGroupMasks_[treeIdx];
+    uint32_t mask = nodeGroupMask;
+    while (mask != 0)
+    {
+        const int group = popLowestBit(mask);
+        walker.node.Clear(group);
+    }
+    for (const auto& record : cells_[treeIdx])
+    {
+        // 衝突処理中に追加された判定は次の検査まで無視
+        if (((nodeGroupMask >> record.group) & 1) == 0) continue;
+        walker.node.Push(record);
+    }
+
+    mask = nodeGroupMask;
+    while (mask != 0)
+    {
+        const CollisionGroup group1 = popLowestBit(mask);
+        const RecordList list1 = walker.node.GetList(group1);
+        // 上位レベルの判定との組
+        uint32_t targetGroupMask = GetCollidableGroupMask(group1) & visitedGroupMask;
+        while (targetGroupMask != 0)
+        {
+            const CollisionGroup group2 = popLowestBit(targetGroupMask);
+            for (int i = 0; i < walker.ancestorCnt; i++)
+            {
+                TestRecordLists(list1, walker.ancestors[i]->GetList(group2), colMatrix, ctx);
+            }
+            TestRecordLists(list1, walker.visited.GetList(group2), colMatrix, ctx);
+        }
+        // このノード内の組
+        targetGroupMask = GetCollidableGroupMask(group1) & nodeGroupMask;
+        while (targetGroupMask != 0)
+        {
+            const CollisionGroup group2 = popLowestBit(targetGroupMask);
+            if (group2 < group1) continue;
+            if (group2 == group1)
+            {
+                TestRecordList(list1, colMatrix, ctx);
+            } else
+            {
+                TestRecordLists(list1, walker.node.GetList(group2), colMatrix, ctx);
+            }
+        }
+    }
+
+    // 上位のレベルの判定の数をグループごとに覚えておき、このノードの判定を追加
+    std::array<size_t, 32> prevVisitedCircleCounts;
+    std::array<size_t, 32> prevVisitedShapeCounts;
+    mask = nodeGroupMask;
+    while (mask != 0)
+    {
+        const int group = popLowestBit(mask);
+        auto& visitedCircles = walker.visited.circles[group];
+        auto& visitedShapes = walker.visited.shapes[group];
+        prevVisitedCircleCounts[group] = visitedCircles.Size();
+        prevVisitedShapeCounts[group] = visitedShapes.size();
+        visitedCircles.Append(walker.node.circles[group]);
+        visitedShapes.insert(visitedShapes.end(), walker.node.shapes[group].begin(), walker.node.shapes[group].end());
+    }
+
+    const int lowLevelNode1 = (treeIdx << 2) + 1;
+    if (lowLevelNode1 < walker.endTreeIdx)
+    {
+        visitedGroupMask |= nodeGroupMask;
+        TestNodeCollision(lowLevelNode1, visitedGroupMask, colMatrix, walker, ctx);
+        TestNodeCollision(lowLevelNode1 + 1, visitedGroupMask, colMatrix, walker, ctx);
+        TestNodeCollision(lowLevelNode1 + 2, visitedGroupMask, colMatrix, walker, ctx);
+        TestNodeCollision(lowLevelNode1 + 3, visitedGroupMask, colMatrix, walker, ctx);
+    }
+
+    // このノードで追加した判定を除外
+    mask = nodeGroupMask;
+    while (mask != 0)
+    {
+        const int group = popLowestBit(mask);
+        walker.visited.circles[group].Resize(prevVisitedCircleCounts[group]);
+        walker.visited.shapes[group].resize(prevVisitedShapeCounts[group]);
+    }
+}
+
+void QuadTreeBroadphase::GroupedRecords::Resize(int groupCnt)
+{
+    circles.resize(groupCnt);
+    shapes.resize(groupCnt);
+}
+
+void QuadTreeBroadphase::GroupedRecords::Clear(CollisionGroup group)
+{
+    circles[group].Clear();
+    shapes[group].clear();
+}
+
+Broadphase::RecordList QuadTreeBroadphase::GroupedRecords::GetList(CollisionGroup group) const
+{
+    return RecordList{ group, &circles[group], 0, circles[group].Size(), shapes[group].data(), shapes[group].size() };
+}
+
+void QuadTreeBroadphase::Walker::Reset(int groupCnt)
+{
+    visited.Resize(groupCnt);
+    node.Resize(groupCnt);
+    for (int group = 0; group < groupCnt; group++)
+    {
+        visited.Clear(group);
+    }
+    ancestorCnt = 0;
+}
+
+static inline uint32_t separateBit(uint32_t n)
+{
+    n = (n | (n << 8)) & 0x00ff00ff;
+    n = (n | (n << 4)) & 0x0f0f0f0f;
+    n = (n | (n << 2)) & 0x33333333;
+    return (n | (n << 1)) & 0x55555555;
+}
+
+static inline uint32_t pointToMorton(float x, float y, float unitWidth, float unitHeight)
+{
+    return separateBit((uint32_t)(x / unitWidth)) | (separateBit((uint32_t)(y / unitHeight)) << 1);
+}
+
+int QuadTreeBroadphase::CalcCellIndexFromBoundingBox(const BoundingBox & boundingBox) const
+{
+    float left = constrain(boundingBox.left_, 0.0f, fieldWidth_ - 1);
+    float right = constrain(boundingBox.right_, 0.0f, fieldWidth_ - 1);
+    float top = constrain(boundingBox.top_, 0.0f, fieldHeight_ - 1);
+    float bottom = constrain(boundingBox.bottom_, 0.0f, fieldHeight_ - 1);
+
+    uint32_t m1 = pointToMorton(left, top, unitCellWidth_, unitCellHeight_);
+    uint32_t m2 = pointToMorton(right, bottom, unitCellWidth_, unitCellHeight_);
+    uint32_t m = m1 ^ m2;
+    int k = 0;
+    for (int i = 0; i < MaxLevel; m >>= 2, i++)
+    {
+        if ((m & 0x3) != 0) { k = i + 1; }
+    }
+    int level = MaxLevel - k;
+    uint32_t morton = m2 >> (k << 1);
+    return CalcTreeIndex(level, morton);
+}
+
+static int calcGridCellCount(float fieldSize, float cellSize)
+{
+    return std::max(1, (int)std::ceil(fieldSize / cellSize));
+}
+
+UniformGridBroadphase::UniformGridBroadphase(int fieldWidth, int fieldHeight, float cellSize) :
+    Broadphase(calcGridCellCount(fieldWidth, cellSize) * calcGridCellCount(fieldHeight, cellSize) + 1),
+    fieldWidth_((float)fieldWidth),
+    fieldHeight_((float)fieldHeight),
+    cellSize_(cellSize),
+    cellCountX_(calcGridCellCount(fieldWidth, cellSize)),
+    cellCountY_(calcGridCellCount(fieldHeight, cellSize)),
+    largeCellIdx_(cellCountX_ * cellCountY_)
+{
+    assert(fieldWidth_ >= 0.0f);
+    assert(fieldHeight_ >= 0.0f);
+    assert(cellSize_ > 0.0f);
+}
+
+float UniformGridBroadphase::CalcCellSize(float typicalShotRadius)
+{
+    // セルが小さすぎるとセルの走査の方が重くなる
+    return std::max(4.0f * typicalShotRadius, 16.0f);
+}
+
+void UniformGridBroadphase::ForEachCandidate(const BoundingBox& boundingBox, const std::function<void(const std::shared_ptr<Intersection>&)>& func) const
+{
+    // グリッド内の判定の大きさはセル以下なので、中心はboundingBoxを半セル分広げた範囲にある
+    const float margin = cellSize_ / 2.0f;
+    const int x1 = CalcCellX(boundingBox.left_ - margin);
+    const int x2 = CalcCellX(boundingBox.right_ + margin);
+    const int y1 = CalcCellY(boundingBox.top_ - margin);
+    const int y2 = CalcCellY(boundingBox.bottom_ + margin);
+    for (int y = y1; y <= y2; y++)
+    {
+        for (int x = x1; x <= x2; x++)
+        {
+            ForEachCandidateInCell(y * cellCountX_ + x, boundingBox, func);
+        }
+    }
+    ForEachCandidateInCell(largeCellIdx_, boundingBox, func);
+}
+
+// NOTE: 検査の順番は4分木とは異なるので、衝突処理の呼ばれる順番も異なる
+void UniformGridBroadphase::TestAllCells(const CollisionMatrix& colMatrix)
+{
+    // 判定をセルとグループごとに並べる
+    const int groupCnt = GetGroupCount();
+    circles_.Clear();
+    shapes_.clear();
+    circleBegins_.resize(cells_.size() * groupCnt + 1);
+    shapeBegins_.resize(cells_.size() * groupCnt + 1);
+    for (int cellIdx = 0; cellIdx < cells_.size(); cellIdx++)
+    {
+        for (int group = 0; group < groupCnt; group++)
+        {
+            circleBegins_[cellIdx * groupCnt + group] = circles_.Size();
+            shapeBegins_[cellIdx * groupCnt + group] = shapes_.size();
+            if (((cellGroupMasks_[cellIdx] >> group) & 1) == 0) continue;
+            for (const auto& record : cells_[cellIdx])
+            {
+                if (record.group == group)
+                {
+                    PushRecord(record, circles_, shapes_);
+                }
+            }
+        }
+    }
+    circleBegins_.back() = circles_.Size();
+    shapeBegins_.back() = shapes_.size();
+
+    // 行ごとに検査する
+    const int rowCnt = cellCountY_ + 1;
+    const int threadCnt = CalcTestThreadCount();
+    if (threadCnt > 1)
+    {
+        RunParallelTasks(rowCnt, threadCnt, colMatrix, [&](int y, int threadIdx, TestContext& ctx)
+        {
+            TestRow(y, colMatrix, ctx);
+        });
+        return;
+    }
+    for (int y = 0; y < rowCnt; y++)
+    {
+        TestRow(y, colMatrix, GetSequentialContext());
+    }
+}
+
+void UniformGridBroadphase::TestRow(int y, const CollisionMatrix& colMatrix, TestContext& ctx)
+{
+    if (y == cellCountY_)
+    {
+        TestCellCollision(largeCellIdx_, largeCellIdx_, colMatrix, ctx);
+        return;
+    }
+    // 同じセルと、右, 左下, 下, 右下のセルとの組を検査すれば隣接する全てのセルの組を1回ずつ検査できる
+    for (int x = 0; x < cellCountX_; x++)
+    {
+        const int cellIdx = y * cellCountX_ + x;
+        if (cellCollidableGroupMasks_[cellIdx] == 0) continue;
+        TestCellCollision(cellIdx, cellIdx, colMatrix, ctx);
+        if (x + 1 < cellCountX_)
+        {
+            TestCellCollision(cellIdx, cellIdx + 1, colMatrix, ctx);
+        }
+        if (y + 1 < cellCountY_)
+        {
+            if (x > 0)
+            {
+                TestCellCollision(cellIdx, cellIdx + cellCountX_ - 1, colMatrix, ctx);
+            }
+            TestCellCollision(cellIdx, cellIdx + cellCountX_, colMatrix, ctx);
+            if (x + 1 < cellCountX_)
+            {
+                TestCellCollision(cellIdx, cellIdx + cellCountX_ + 1, colMatrix, ctx);
+            }
+        }
+    }
+
+    // 大きな判定は全ての判定と検査する
+    if (cellCollidableGroupMasks_[largeCellIdx_] == 0) return;
+    for (int x = 0; x < cellCountX_; x++)
+    {
+        TestCellCollision(largeCellIdx_, y * cellCountX_ + x, colMatrix, ctx);
+    }
+}
+
+// cellIdx1とcellIdx2が同じ場合はセル内の全ての組を検査する
+void UniformGridBroadphase::TestCellCollision(int cellIdx1, int cellIdx2, const CollisionMatrix& colMatrix, TestContext& ctx)
+{
+    // 衝突しうる組が無ければ飛ばす
+    const uint32_t groupMask2 = cellGroupMasks_[cellIdx2];
+    if ((cellCollidableGroupMasks_[cellIdx1] & groupMask2) == 0) return;
+    uint32_t groupMask1 = cellGroupMasks_[cellIdx1];
+    while (groupMask1 != 0)
+    {
+        const CollisionGroup group1 = popLowestBit(groupMask1);
+        const RecordList list1 = GetCellList(cellIdx1, group1);
+        uint32_t targetGroupMask = GetCollidableGroupMask(group1) & groupMask2;
+        while (targetGroupMask != 0)
+        {
+            const CollisionGroup group2 = popLowestBit(targetGroupMask);
+            if (cellIdx1 != cellIdx2)
+            {
+                TestRecordLists(list1, GetCellList(cellIdx2, group2), colMatrix, ctx);
+            } else if (group1 == group2)
+            {
+                TestRecordList(list1, colMatrix, ctx);
+            } else if (group1 < group2)
+            {
+                TestRecordLists(list1, GetCellList(cellIdx2, group2), colMatrix, ctx);
+            }
+        }
+    }
+}
+
+Broadphase::RecordList UniformGridBroadphase::GetCellList(int cellIdx, CollisionGroup group) const
+{
+    const int listIdx = cellIdx * GetGroupCount() + group;
+    const size_t shapeBegin = shapeBegins_[listIdx];
+    return RecordList{ group, &circles_, circleBegins_[listIdx], circleBegins_[listIdx + 1], shapes_.data() + shapeBegin, shapeBegins_[listIdx + 1] - shapeBegin };
+}
+
+int UniformGridBroadphase::CalcCellX(float x) const
+{
+    return (int)(constrain(x, 0.0f, fieldWidth_ - 1) / cellSize_);
+}
+
+int UniformGridBroadphase::CalcCellY(float y) const
+{
+    return (int)(constrain(y, 0.0f, fieldHeight_ - 1) / cellSize_);
+}
+
+int UniformGridBroadphase::CalcCellIndexFromBoundingBox(const BoundingBox& boundingBox) const
+{
+    if (boundingBox.right_ - boundingBox.left_ > cellSize_ || boundingBox.bottom_ - boundingBox.top_ > cellSize_)
+    {
+        return largeCellIdx_;
+    }
+    const int x = CalcCellX((boundingBox.left_ + boundingBox.right_) / 2.0f);
+    const int y = CalcCellY((boundingBox.top_ + boundingBox.bottom_) / 2.0f);
+    return y * cellCountX_ + x;
+}
+}
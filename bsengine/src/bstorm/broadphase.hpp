@@ -0,0 +1,238 @@
+﻿#pragma once
+
+#include <bstorm/intersection.hpp>
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <cstdint>
+
+namespace bstorm
+{
+// ===================================================
+// ◆ Broadphase
+// ===================================================
+// 当たり判定の空間分割
+// 衝突する可能性のある判定の組を絞り込む。実際の衝突検査と衝突処理はTestPairで行う。
+// 判定はセルごとの連続した配列にRecord(バウンディングボックス, グループ, スロット番号)として格納する。
+// 判定本体へはスロットのweak_ptrを通してアクセスし、バウンディングボックスが重なった時だけlockする。
+// 円同士の組は円をCircleBatchに集めてIntersectCircleBatchでまとめて検査し、衝突した組だけlockする。
+// スレッド数が2以上なら互いに独立なタスクに分けて並列に検査し、衝突した組をタスクの順番で衝突処理する。
+class Broadphase : private NonCopyable
+{
+public:
+    virtual ~Broadphase();
+    // 登録済みなら登録し直す
+    void Add(const std::shared_ptr<Intersection>& isect);
+    void Remove(const std::shared_ptr<Intersection>& isect);
+    // 登録済みの判定の形状やグループが変わった時に呼ぶ, 未登録なら登録する
+    // 所属するセルが変わらなければセル内のRecordを書き換えるだけで済ませる
+    void Update(const std::shared_ptr<Intersection>& isect);
+    // boundingBoxとバウンディングボックスが重なる判定を全て列挙する
+    virtual void ForEachCandidate(const BoundingBox& boundingBox, const std::function<void(const std::shared_ptr<Intersection>&)>& func) const = 0;
+    // 衝突する可能性のある全ての判定の組に対して衝突検査を行う
+    void TestAllCollision(const CollisionMatrix& colMatrix);
+    // 直前のTestAllCollisionで行った衝突検査の回数
+    size_t GetPairTestCount() const { return pairTestCnt_; }
+    // 衝突検査に使うスレッド数
+    int GetThreadCount() const { return threadCnt_; }
+    void SetThreadCount(int threadCnt);
+    // これより少ない判定の数では並列化しない
+    static constexpr int MIN_RECORD_COUNT_PER_THREAD = 1024;
+protected:
+    struct Record
+    {
+        BoundingBox boundingBox;
+        float x; // x, y, rは円の場合のみ
+        float y;
+        float r;
+        CollisionGroup group;
+        bool isCircle;
+        uint32_t slotIdx;
+    };
+    using Cell = std::vector<Record>;
+    // 同じグループの判定の集合
+    // 円はcircles[circleBegin, circleEnd)に、それ以外はshapes[0, shapeCnt)にある
+    struct RecordList
+    {
+        CollisionGroup group;
+        const CircleBatch* circles;
+        size_t circleBegin;
+        size_t circleEnd;
+        const Record* shapes;
+        size_t shapeCnt;
+    };
+    using CollisionPair = std::pair<uint32_t, uint32_t>; // 衝突した判定のスロット番号の組
+    // 検査を行うスレッドごとの状態
+    // 他のスレッドの状態と同じキャッシュラインに乗らないように揃える
+    struct alignas(64) TestContext
+    {
+        std::vector<CollisionPair>* deferredCollisions = nullptr; // nullptrなら衝突したらすぐに衝突処理を行う
+        std::vector<uint32_t> hitIndices;
+        size_t pairTestCnt = 0;
+    };
+    Broadphase(int cellCount);
+    virtual int CalcCellIndexFromBoundingBox(const BoundingBox& boundingBox) const = 0;
+    // 全てのセルの組に対して衝突検査を行う
+    virtual void TestAllCells(const CollisionMatrix& colMatrix) = 0;
+    // 判定の数から検査に使うスレッド数を決める, 1なら逐次に検査する
+    int CalcTestThreadCount() const;
+    // 逐次に検査する時に使う
+    TestContext& GetSequentialContext() { return contexts_[0]; }
+    // taskCnt個のタスクをthreadCnt個のスレッドで分担してfunc(taskIdx, threadIdx, ctx)を呼び、
+    // 全て終わった後に衝突した組をタスクの順番で衝突処理する
+    // funcは他のタスクと同時に呼ばれるので、セルや判定を書き換えてはならない
+    // threadCntが1なら呼び出し元のスレッドでタスクを順に呼ぶ
+    void RunParallelTasks(int taskCnt, int threadCnt, const CollisionMatrix& colMatrix, const std::function<void(int, int, TestContext&)>& func);
+    // バウンディングボックスが重なっていれば衝突検査を行い、衝突していれば衝突した相手を保存して衝突処理を行う
+    void TestPair(const Record& record1, const Record& record2, const CollisionMatrix& colMatrix, TestContext& ctx);
+    // list1とlist2の間の全ての組を検査する
+    void TestRecordLists(const RecordList& list1, const RecordList& list2, const CollisionMatrix& colMatrix, TestContext& ctx);
+    // list内の全ての組を検査する
+    void TestRecordList(const RecordList& list, const CollisionMatrix& colMatrix, TestContext& ctx);
+    // セル内のバウンディングボックスが重なる判定を列挙する
+    void ForEachCandidateInCell(int cellIdx, const BoundingBox& boundingBox, const std::function<void(const std::shared_ptr<Intersection>&)>& func) const;
+    // groupと衝突しうるグループの集合
+    uint32_t GetCollidableGroupMask(CollisionGroup group) const { return collidableGroupMasks_[group]; }
+    int GetGroupCount() const { return collidableGroupMasks_.size(); }
+    static void PushRecord(const Record& record, CircleBatch& circles, std::vector<Record>& shapes);
+    std::vector<Cell> cells_;
+    // TestAllCells中に使う
+    std::vector<uint32_t> cellGroupMasks_; // セル内の判定のグループの集合
+    std::vector<uint32_t> cellCollidableGroupMasks_; // セル内の判定と衝突しうるグループの集合
+    size_t pairTestCnt_;
+private:
+    struct Slot
+    {
+        std::weak_ptr<Intersection> isect;
+        int cellIdx;
+        uint32_t posInCell;
+    };
+    // 消えた判定を取り除き、セルごとのグループの集合を求める
+    void Compact(const CollisionMatrix& colMatrix);
+    // 衝突検査済みの組の衝突処理を行う
+    void Collide(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2, const CollisionMatrix& colMatrix);
+    void Collide(uint32_t slotIdx1, uint32_t slotIdx2, const CollisionMatrix& colMatrix);
+    // 衝突処理を行うか、ctxに後で衝突処理する組として貯める
+    void CollideOrDefer(uint32_t slotIdx1, uint32_t slotIdx2, const CollisionMatrix& colMatrix, TestContext& ctx);
+    void TestCircles(const CircleBatch& circles1, size_t begin1, size_t end1, const CircleBatch& circles2, size_t begin2, size_t end2, const CollisionMatrix& colMatrix, TestContext& ctx);
+    static Record GetCircleRecord(const CircleBatch& circles, size_t idx, CollisionGroup group);
+    static Record MakeRecord(const Intersection& isect, uint32_t slotIdx);
+    // スロットの判定をセルから取り除く, スロットは解放しない
+    void UnlinkRecord(uint32_t slotIdx);
+    void FreeSlot(uint32_t slotIdx);
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> freeSlotIndices_;
+    std::vector<uint32_t> collidableGroupMasks_;
+    std::vector<std::weak_ptr<Intersection>> collidedIsects_; // 前回衝突した相手を保存した判定
+    size_t recordCnt_;
+    bool isTesting_;
+    int threadCnt_;
+    std::vector<TestContext> contexts_; // スレッドごと
+    std::vector<std::vector<CollisionPair>> taskCollisions_; // タスクごと
+};
+
+// ===================================================
+// ◆ QuadTreeBroadphase
+// ===================================================
+// 線形4分木
+// 判定はバウンディングボックスを含む最小のノードに所属する
+// 衝突しうるグループの組を含まない部分木は探索しない
+// ParallelSplitLevelのノードを根とする部分木と、それより上位のノードをそれぞれタスクにして、タスクの順に衝突処理する
+// 並列に検査する時はタスクをスレッドで分担する
+class QuadTreeBroadphase : public Broadphase
+{
+public:
+    // 4分木の分割度, 合計(4^(MaxLevel+1) - 1) / 3個のセルが生成される
+    static constexpr int MaxLevel = 4;
+    // タスクにする部分木のレベル, 4^ParallelSplitLevel個の部分木に分かれる
+    static constexpr int ParallelSplitLevel = 3;
+    QuadTreeBroadphase(int fieldWidth, int fieldHeight);
+    void ForEachCandidate(const BoundingBox& boundingBox, const std::function<void(const std::shared_ptr<Intersection>&)>& func) const override;
+protected:
+    int CalcCellIndexFromBoundingBox(const BoundingBox& boundingBox) const override;
+    void TestAllCells(const CollisionMatrix& colMatrix) override;
+private:
+    // グループごとに分けた判定
+    struct GroupedRecords
+    {
+        void Resize(int groupCnt);
+        void Clear(CollisionGroup group);
+        void Push(const Record& record) { PushRecord(record, circles[record.group], shapes[record.group]); }
+        RecordList GetList(CollisionGroup group) const;
+        std::vector<CircleBatch> circles;
+        std::vector<std::vector<Record>> shapes;
+    };
+    // 探索中の状態, スレッドごとに持つ
+    struct Walker
+    {
+        void Reset(int groupCnt);
+        GroupedRecords visited; // 上位レベルのノードの判定
+        GroupedRecords node; // 現在のノードの判定
+        // visitedより上位のノードの判定, 部分木の根の祖先をタスク間で共有する
+        std::array<const GroupedRecords*, ParallelSplitLevel> ancestors;
+        int ancestorCnt;
+        int endTreeIdx; // これ以降のノードには降りない
+    };
+    void TestNodeCollision(int treeIdx, uint32_t visitedGroupMask, const CollisionMatrix& colMatrix, Walker& walker, TestContext& ctx);
+    // 衝突しうる組を含む部分木を集めて, 上位のノードの判定を用意する
+    void SplitTasks();
+    void TestTask(int taskIdx, const CollisionMatrix& colMatrix, Walker& walker, TestContext& ctx);
+    const float fieldWidth_;
+    const float fieldHeight_;
+    const float unitCellWidth_;
+    const float unitCellHeight_;
+    static constexpr int CellCount = ((1 << (2 * (MaxLevel + 1))) - 1) / 3;
+    std::array<uint32_t, CellCount> subtreeGroupMasks_; // 部分木内の判定のグループの集合
+    std::array<uint32_t, CellCount> subtreeCollidableGroupMasks_; // 部分木内の判定と衝突しうるグループの集合
+    std::vector<Walker> walkers_; // スレッドごと
+    std::vector<int> splitTreeIndices_; // タスクにする部分木の根
+    std::vector<GroupedRecords> upperNodeRecords_; // ParallelSplitLevelより上位のノードの判定
+};
+
+// ===================================================
+// ◆ UniformGridBroadphase
+// ===================================================
+// 一様グリッド
+// 判定はバウンディングボックスの中心を含むセルに所属し、隣接するセルの判定とだけ検査する
+// バウンディングボックスがセルより大きい判定(レーザー、スペル等)は専用のセルに入れ、全ての判定と検査する
+// セルの行ごとにタスクにするので、逐次でも並列でも同じ順番で衝突処理が呼ばれる
+class UniformGridBroadphase : public Broadphase
+{
+public:
+    UniformGridBroadphase(int fieldWidth, int fieldHeight, float cellSize);
+    // 標準的な弾の半径からセルの大きさを決める
+    // 半径がその2倍までの弾はグリッドに入る
+    static float CalcCellSize(float typicalShotRadius);
+    void ForEachCandidate(const BoundingBox& boundingBox, const std::function<void(const std::shared_ptr<Intersection>&)>& func) const override;
+    float GetCellSize() const { return cellSize_; }
+protected:
+    int CalcCellIndexFromBoundingBox(const BoundingBox& boundingBox) const override;
+    void TestAllCells(const CollisionMatrix& colMatrix) override;
+private:
+    int CalcCellX(float x) const;
+    int CalcCellY(float y) const;
+    // y行目のセルと隣接するセルの組, 大きな判定とy行目のセルの組を検査する
+    // y == cellCountY_なら大きな判定同士の組を検査する
+    void TestRow(int y, const CollisionMatrix& colMatrix, TestContext& ctx);
+    void TestCellCollision(int cellIdx1, int cellIdx2, const CollisionMatrix& colMatrix, TestContext& ctx);
+    RecordList GetCellList(int cellIdx, CollisionGroup group) const;
+    const float fieldWidth_;
+    const float fieldHeight_;
+    const float cellSize_;
+    const int cellCountX_;
+    const int cellCountY_;
+    const int largeCellIdx_; // 大きな判定用のセル
+    // TestAllCells中に使う
+    // セルとグループごとに並べた判定, (セル, グループ)の範囲はcircleBegins_, shapeBegins_に入れる
+    CircleBatch circles_;
+    std::vector<Record> shapes_;
+    std::vector<uint32_t> circleBegins_;
+    std::vector<uint32_t> shapeBegins_;
+};
+
+// 弾の標準的な判定の半径
+constexpr float DEFAULT_TYPICAL_SHOT_RADIUS = 6.0f;
+}
@@ -16,10 +16,9 @@ template <class K, class V>
 class CacheStore
 {
 private:
-    template <class V>
     struct CacheEntry
     {
-        CacheEntry(bool reserve, std::shared_future<std::shared_ptr<V>>& future) :
+        CacheEntry(bool reserve, const std::shared_future<std::shared_ptr<V>>& future) :
             isReserved(reserve),
             future(future)
         {
@@ -27,18 +26,32 @@ private:
         bool isReserved;
         std::shared_future<std::shared_ptr<V>> future;
     };
-    std::unordered_map<K, CacheEntry<V>> cacheMap_;
+    std::unordered_map<K, CacheEntry> cacheMap_;
     mutable std::mutex mutex;
 public:
     // blocking
     const std::shared_ptr<V>& Get(const K& key) const noexcept(false)
     {
+        // [h҂ĂԂ͑̃XbhubNȂ
+        std::shared_future<std::shared_ptr<V>> future;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = cacheMap_.find(key);
+            if (it == cacheMap_.end())
+            {
+                throw std::runtime_error("cache not exist.");
+            }
+            future = it->second.future;
+        }
+        future.wait();
         std::lock_guard<std::mutex> lock(mutex);
         auto it = cacheMap_.find(key);
         if (it != cacheMap_.end())
         {
             return it->second.future.get();
         }
+        // ҂ĂԂɏꂽꍇ, [h̗O΂𓊂
+        future.get();
         throw std::runtime_error("cache not exist.");
     }
 
@@ -59,20 +72,36 @@ public:
         return false;
     }
 
+    // ͑̃L[̃[hubNȂ
+    // L[̃[h͐̊҂
     template <class... Args>
     const std::shared_ptr<V>& Load(const K& key, Args&&... args) noexcept(false)
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        auto it = cacheMap_.find(key);
-        if (it != cacheMap_.end())
+        std::promise<std::shared_ptr<V>> promise;
+        bool isCreator = false;
         {
-            return it->second.future.get();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cacheMap_.count(key) == 0)
+            {
+                cacheMap_.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(false, promise.get_future().share()));
+                isCreator = true;
+            }
         }
 
-        std::promise<std::shared_ptr<V>> promise;
-        promise.set_value(std::make_shared<V>(std::forward<Args>(args)...));
-        cacheMap_.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(false, promise.get_future().share()));
-        return cacheMap_.at(key).future.get();
+        if (isCreator)
+        {
+            try
+            {
+                promise.set_value(std::make_shared<V>(std::forward<Args>(args)...));
+            } catch (...)
+            {
+                // ҂ĂXbhɗO`ĂLbV
+                promise.set_exception(std::current_exception());
+                Remove(key);
+                throw;
+            }
+        }
+        return Get(key);
     }
 
     template <class... Args>
@@ -102,7 +131,7 @@ public:
     {
         std::lock_guard<std::mutex> lock(mutex);
         // gɂă
-        std::unordered_map<K, CacheEntry<V>>().swap(cacheMap_);
+        std::unordered_map<K, CacheEntry>().swap(cacheMap_);
     }
 
     // non blocking
@@ -163,7 +192,7 @@ public:
         for (auto& pair : cacheMap_)
         {
             const K& key = pair.first;
-            CacheEntry<V>& entry = pair.second;
+            CacheEntry& entry = pair.second;
             bool& reserved = entry.isReserved;
             auto& future = entry.future;
             if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
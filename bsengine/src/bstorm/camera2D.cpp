@@ -24,7 +24,10 @@ void Camera2D::GenerateViewMatrix(D3DXMATRIX* view) const
 {
     // カメラ中心に変換してから拡大して回転
     D3DXMATRIXA16 rot;
-    D3DXMatrixLookAtLH(view, &D3DXVECTOR3(focusX_, focusY_, 1.0f), &D3DXVECTOR3(focusX_, focusY_, 0.0f), &D3DXVECTOR3(0.0f, -1.0f, 0.0f));
+    const D3DXVECTOR3 eye(focusX_, focusY_, 1.0f);
+    const D3DXVECTOR3 at(focusX_, focusY_, 0.0f);
+    const D3DXVECTOR3 up(0.0f, -1.0f, 0.0f);
+    D3DXMatrixLookAtLH(view, &eye, &at, &up);
     D3DXMatrixRotationZ(&rot, D3DXToRadian(-angleZ_));
     rot._11 *= ratioX_; rot._12 *= ratioX_;
     rot._21 *= ratioY_; rot._22 *= ratioY_;
@@ -57,7 +57,8 @@ void Camera3D::GenerateViewMatrix(D3DXMATRIX* view, D3DXMATRIX* billboard) const
     D3DXMatrixLookAtLH(view, &eye, &at, &up);
 
     // ビルボード行列行列
-    D3DXMatrixLookAtLH(billboard, &D3DXVECTOR3(0.0f, 0.0f, 0.0f), &gaze, &up);
+    const D3DXVECTOR3 origin(0.0f, 0.0f, 0.0f);
+    D3DXMatrixLookAtLH(billboard, &origin, &gaze, &up);
     D3DXMatrixInverse(billboard, NULL, billboard);
 }
 
@@ -2,18 +2,141 @@
 
 #include <bstorm/env.hpp>
 #include <bstorm/script_entry_routine_names.hpp>
+#include <bstorm/file_util.hpp>
+#include <bstorm/source_map.hpp>
 
 #include <algorithm>
+#include <unordered_map>
 
 namespace bstorm
 {
 // NOTE: B\ȕ
 
+// XNvgǂݍޑgݍ݊֐, pX󂯎̈ʒu
+static const std::unordered_map<std::string, size_t> scriptLoadingFuncs =
+{
+    { "LoadScript", 0 },
+    { "LoadScriptInThread", 0 },
+    { "SetStageMainScript", 0 },
+    { "SetStagePlayerScript", 0 },
+    { "StartShotScript", 0 },
+    { "StartItemScript", 0 },
+    { "ObjEnemyBossScene_Add", 2 }
+};
+
+// ^_ł؂܂ł̍ĉ͉
+static constexpr int MAX_TYPE_INFERENCE_ITERATION = 8;
+
+static bool IsScalarType(ExpType type)
+{
+    return type == ExpType::REAL || type == ExpType::BOOL;
+}
+
 void CodeAnalyzer::Analyze(Node & n)
+{
+    reachedDefs_.clear();
+    Run(n);
+
+    // ϐ̌^_
+    // Ă, lSREAL(܂BOOL)̕ϐ͂̌^Ɖ肵ĉ͂
+    // Ɩϐ͉肩O, ȂȂ܂ŌJԂ
+    std::unordered_map<NodeDef*, ExpType> guesses;
+    std::unordered_set<NodeDef*> rejected;
+    for (const auto& assign : varAssigns_)
+    {
+        auto var = assign.var.get();
+        if (rejected.count(var) != 0) continue;
+        if (initializedVars_.count(var) == 0 || assign.kind == VarAssign::Kind::OTHER)
+        {
+            rejected.insert(var);
+            guesses.erase(var);
+            continue;
+        }
+        auto type = GetAssignedType(assign);
+        if (type == ExpType::ANY) continue; // ̕ϐ̌^
+        auto it = guesses.find(var);
+        if (IsScalarType(type) && (it == guesses.end() || it->second == type))
+        {
+            guesses[var] = type;
+        } else
+        {
+            rejected.insert(var);
+            guesses.erase(var);
+        }
+    }
+
+    std::vector<std::shared_ptr<NodeDef>> typedVars;
+    for (const auto& assign : varAssigns_)
+    {
+        if (guesses.count(assign.var.get()) != 0)
+        {
+            typedVars.push_back(assign.var);
+        }
+    }
+
+    for (int i = 0; !guesses.empty(); i++)
+    {
+        for (auto& var : typedVars)
+        {
+            auto it = guesses.find(var.get());
+            var->retType = it == guesses.end() ? ExpType::ANY : it->second;
+        }
+        ResetAnalysis();
+        Run(n);
+
+        bool consistent = true;
+        for (const auto& assign : varAssigns_)
+        {
+            auto it = guesses.find(assign.var.get());
+            if (it == guesses.end()) continue;
+            if (GetAssignedType(assign) != it->second)
+            {
+                guesses.erase(it);
+                consistent = false;
+            }
+        }
+        if (consistent) break;
+
+        if (i + 1 >= MAX_TYPE_INFERENCE_ITERATION)
+        {
+            guesses.clear();
+        }
+        if (guesses.empty())
+        {
+            for (auto& var : typedVars)
+            {
+                var->retType = ExpType::ANY;
+            }
+            ResetAnalysis();
+            Run(n);
+        }
+    }
+
+    ElideCopy();
+}
+void CodeAnalyzer::Run(Node & n)
 {
     env_ = nullptr;
+    scriptRefs_.clear();
+    varAssigns_.clear();
+    initializedVars_.clear();
+    copySites_.clear();
+    mutatedVars_.clear();
     n.Traverse(*this);
 }
+void CodeAnalyzer::ResetAnalysis()
+{
+    for (auto& def : reachedDefs_)
+    {
+        def->unreachable = true;
+        if (auto varDecl = std::dynamic_pointer_cast<NodeVarDecl>(def))
+        {
+            varDecl->assignCnt = 0;
+            varDecl->refCnt = 0;
+        }
+    }
+    reachedDefs_.clear();
+}
 void CodeAnalyzer::Traverse(NodeNum & lit)
 {
     lit.noSubEffect = true;
@@ -90,11 +213,6 @@ void CodeAnalyzer::Traverse(NodeCat& exp)
 void CodeAnalyzer::Traverse(NodeNoParenCallExp & call)
 {
     auto def = env_->FindDef(call.name);
-    if (std::dynamic_pointer_cast<NodeBuiltInFunc>(def) ||
-        std::dynamic_pointer_cast<NodeConst>(def))
-    {
-        call.copyRequired = false;
-    }
     AnalyzeDef(call.name);
     call.noSubEffect = def->noSubEffect;
     if (auto varDecl = std::dynamic_pointer_cast<NodeVarDecl>(def))
@@ -102,6 +220,10 @@ void CodeAnalyzer::Traverse(NodeNoParenCallExp & call)
         varDecl->refCnt++;
     }
     call.expType = def->retType;
+    // ϐ̌^͍ĉ͂ŉ肪Oƕς̂, Rs[̗vۂ͖񌈂ߒ
+    call.copyRequired = !(std::dynamic_pointer_cast<NodeBuiltInFunc>(def) ||
+                          std::dynamic_pointer_cast<NodeConst>(def) ||
+                          IsScalarType(call.expType));
 }
 void CodeAnalyzer::Traverse(NodeCallExp & call)
 {
@@ -122,13 +244,17 @@ void CodeAnalyzer::Traverse(NodeCallExp & call)
         }
     }
     call.expType = def->retType;
+    AnalyzeScriptReference(call.name, call.args);
+    AddArgCopySites(call.name, call.args);
 }
 void CodeAnalyzer::Traverse(NodeArrayRef& exp)
 {
-    exp.copyRequired = false;
     exp.array->Traverse(*this);
     exp.idx->Traverse(*this);
     exp.noSubEffect = exp.array->noSubEffect && exp.idx->noSubEffect;
+    exp.expType = exp.array->expType.IsArray() ? ExpType::ARRAY_ELEM(exp.array->expType) : ExpType::ANY;
+    // vf̓Rs[ɎQƂ̂, zȂۑ鎞ɃRs[Kv
+    exp.copyRequired = !(IsScalarType(exp.expType) || exp.expType == ExpType::CHAR);
 }
 void CodeAnalyzer::Traverse(NodeRange& range)
 {
@@ -222,11 +348,13 @@ void CodeAnalyzer::Traverse(NodeWhile & stmt)
 void CodeAnalyzer::Traverse(NodeAscent & stmt)
 {
     stmt.range->Traverse(*this);
+    AddLoopParamAssign(stmt.param, stmt.range->start, *stmt.block);
     stmt.block->Traverse(*this);
 }
 void CodeAnalyzer::Traverse(NodeDescent & stmt)
 {
     stmt.range->Traverse(*this);
+    AddLoopParamAssign(stmt.param, stmt.range->end, *stmt.block);
     stmt.block->Traverse(*this);
 }
 
@@ -263,6 +391,8 @@ void CodeAnalyzer::Traverse(NodeCallStmt & call)
     {
         arg->Traverse(*this);
     }
+    AnalyzeScriptReference(call.name, call.args);
+    AddArgCopySites(call.name, call.args);
 }
 void CodeAnalyzer::Traverse(NodeReturn & stmt)
 {
@@ -274,10 +404,14 @@ void CodeAnalyzer::Traverse(NodeBreak &) {}
 void CodeAnalyzer::Traverse(NodeSucc& stmt)
 {
     stmt.lhs->Traverse(*this);
+    if (!stmt.lhs->indices.empty()) mutatedVars_.insert(env_->FindDef(stmt.lhs->name).get());
+    AddVarAssign(stmt.lhs->name, nullptr, stmt.lhs->indices.empty() ? VarAssign::Kind::SUCC_PRED : VarAssign::Kind::OTHER);
 }
 void CodeAnalyzer::Traverse(NodePred& stmt)
 {
     stmt.lhs->Traverse(*this);
+    if (!stmt.lhs->indices.empty()) mutatedVars_.insert(env_->FindDef(stmt.lhs->name).get());
+    AddVarAssign(stmt.lhs->name, nullptr, stmt.lhs->indices.empty() ? VarAssign::Kind::SUCC_PRED : VarAssign::Kind::OTHER);
 }
 void CodeAnalyzer::Traverse(NodeVarDecl& def)
 {
@@ -292,7 +426,10 @@ void CodeAnalyzer::Traverse(NodeVarInit& stmt)
     if (auto varDecl = std::dynamic_pointer_cast<NodeVarDecl>(env_->FindDef(stmt.name)))
     {
         varDecl->assignCnt++;
+        initializedVars_.insert(varDecl.get());
     }
+    AddVarAssign(stmt.name, stmt.rhs, VarAssign::Kind::ASSIGN);
+    AddCopySite(stmt.rhs, env_->FindDef(stmt.name).get());
 }
 void CodeAnalyzer::Traverse(NodeProcParam & def)
 {
@@ -327,11 +464,53 @@ void CodeAnalyzer::AnalyzeDef(const std::string& name)
             auto prevEnv = env_;
             env_ = defEnv;
             def->unreachable = false;
+            reachedDefs_.push_back(def);
             def->Traverse(*this);
             env_ = prevEnv;
         }
     }
 }
+void CodeAnalyzer::AnalyzeScriptReference(const std::string & name, const std::vector<std::shared_ptr<NodeExp>>& args)
+{
+    auto it = scriptLoadingFuncs.find(name);
+    if (it == scriptLoadingFuncs.end()) return;
+    if (!std::dynamic_pointer_cast<NodeBuiltInFunc>(env_->FindDef(name))) return;
+    const size_t pathArgIdx = it->second;
+    if (pathArgIdx >= args.size()) return;
+    std::wstring path;
+    if (EvalConstPath(*args[pathArgIdx], path))
+    {
+        scriptRefs_.push_back(ScriptReference{ name, path });
+    }
+}
+bool CodeAnalyzer::EvalConstPath(NodeExp & exp, std::wstring & path) const
+{
+    // 񃊃e, GetCurrentScriptDirectory, ̘A]
+    if (auto str = dynamic_cast<NodeStr*>(&exp))
+    {
+        path += str->str;
+        return true;
+    }
+    if (auto cat = dynamic_cast<NodeCat*>(&exp))
+    {
+        return EvalConstPath(*cat->lhs, path) && EvalConstPath(*cat->rhs, path);
+    }
+    std::string callName;
+    if (auto call = dynamic_cast<NodeCallExp*>(&exp))
+    {
+        if (!call->args.empty()) return false;
+        callName = call->name;
+    } else if (auto call = dynamic_cast<NodeNoParenCallExp*>(&exp))
+    {
+        callName = call->name;
+    }
+    if (callName == "GetCurrentScriptDirectory" && exp.srcPos && std::dynamic_pointer_cast<NodeBuiltInFunc>(env_->FindDef(callName)))
+    {
+        path += GetParentPath(*exp.srcPos->filename) + L"/";
+        return true;
+    }
+    return false;
+}
 void CodeAnalyzer::AnalyzeMonoOp(NodeMonoOp & exp)
 {
     exp.copyRequired = false;
@@ -348,10 +527,7 @@ void CodeAnalyzer::AnalyzeArithAndArrayBinOp(NodeBinOp & exp)
 {
     exp.copyRequired = false;
     AnalyzeBinOp(exp);
-    if (exp.lhs->expType == ExpType::REAL && exp.rhs->expType == ExpType::REAL)
-    {
-        exp.expType = ExpType::REAL;
-    }
+    exp.expType = (exp.lhs->expType == ExpType::REAL && exp.rhs->expType == ExpType::REAL) ? ExpType::REAL : ExpType::ANY;
 }
 void CodeAnalyzer::AnalyzeArithBinOp(NodeBinOp & exp)
 {
@@ -368,10 +544,7 @@ void CodeAnalyzer::AnalyzeCmpBinOp(NodeBinOp & exp)
 void CodeAnalyzer::AnalyzeLogBinOp(NodeBinOp & exp)
 {
     AnalyzeBinOp(exp);
-    if (exp.lhs->expType == exp.rhs->expType)
-    {
-        exp.expType = exp.lhs->expType;
-    }
+    exp.expType = exp.lhs->expType == exp.rhs->expType ? exp.lhs->expType : ExpType::ANY;
     exp.copyRequired = exp.lhs->copyRequired || exp.rhs->copyRequired;
 }
 void CodeAnalyzer::AnalyzeAssign(NodeAssign & stmt)
@@ -379,5 +552,136 @@ void CodeAnalyzer::AnalyzeAssign(NodeAssign & stmt)
     stmt.lhs->Traverse(*this);
     stmt.rhs->Traverse(*this);
     stmt.noSubEffect = false;
+
+    auto kind = VarAssign::Kind::ASSIGN;
+    if (!stmt.lhs->indices.empty() || dynamic_cast<NodeCatAssign*>(&stmt))
+    {
+        kind = VarAssign::Kind::OTHER;
+    } else if (dynamic_cast<NodeAddAssign*>(&stmt) || dynamic_cast<NodeSubAssign*>(&stmt))
+    {
+        kind = VarAssign::Kind::ADD_SUB;
+    } else if (dynamic_cast<NodeMulAssign*>(&stmt) || dynamic_cast<NodeDivAssign*>(&stmt) ||
+               dynamic_cast<NodeRemAssign*>(&stmt) || dynamic_cast<NodePowAssign*>(&stmt))
+    {
+        kind = VarAssign::Kind::ARITH;
+    }
+    AddVarAssign(stmt.lhs->name, stmt.rhs, kind);
+
+    auto def = env_->FindDef(stmt.lhs->name);
+    if (kind == VarAssign::Kind::ASSIGN)
+    {
+        // a = a ~ e;  a ɒژAR[hɂȂ
+        bool isMutatingCat = false;
+        if (auto cat = std::dynamic_pointer_cast<NodeCat>(stmt.rhs))
+        {
+            if (auto var = std::dynamic_pointer_cast<NodeNoParenCallExp>(cat->lhs))
+            {
+                isMutatingCat = var->name == stmt.lhs->name;
+            }
+        }
+        if (isMutatingCat)
+        {
+            mutatedVars_.insert(def.get());
+        } else
+        {
+            AddCopySite(stmt.rhs, def.get());
+        }
+    } else if (!stmt.lhs->indices.empty() || dynamic_cast<NodeCatAssign*>(&stmt))
+    {
+        mutatedVars_.insert(def.get());
+    }
+}
+void CodeAnalyzer::AddVarAssign(const std::string & name, const std::shared_ptr<NodeExp>& rhs, VarAssign::Kind kind)
+{
+    auto def = env_->FindDef(name);
+    if (std::dynamic_pointer_cast<NodeVarDecl>(def) || std::dynamic_pointer_cast<NodeLoopParam>(def))
+    {
+        varAssigns_.push_back(VarAssign{ def, rhs, kind });
+    }
+}
+void CodeAnalyzer::AddLoopParamAssign(const std::string & param, const std::shared_ptr<NodeExp>& init, NodeBlock & blk)
+{
+    // [vϐɂ̓[vJn̒l1l
+    auto it = blk.nameTable->find(param);
+    if (it == blk.nameTable->end()) return;
+    if (auto loopParam = std::dynamic_pointer_cast<NodeLoopParam>(it->second))
+    {
+        initializedVars_.insert(loopParam.get());
+        varAssigns_.push_back(VarAssign{ loopParam, init, VarAssign::Kind::ASSIGN });
+    }
+}
+ExpType CodeAnalyzer::GetAssignedType(const VarAssign & assign) const
+{
+    ExpType varType = assign.var->retType;
+    switch (assign.kind)
+    {
+        case VarAssign::Kind::ASSIGN:
+            return assign.rhs->expType;
+        case VarAssign::Kind::ADD_SUB:
+            return (varType == ExpType::REAL && assign.rhs->expType == ExpType::REAL) ? ExpType::REAL : ExpType::ANY;
+        case VarAssign::Kind::ARITH:
+            return ExpType::REAL;
+        case VarAssign::Kind::SUCC_PRED:
+            return IsScalarType(varType) ? varType : ExpType::ANY;
+    }
+    return ExpType::ANY;
+}
+NodeDef* CodeAnalyzer::GetAliasedVar(NodeExp & exp) const
+{
+    // ϐ̂, ܂͕ϐ̗vfQƂ鎮Ȃ, ̕ϐ
+    if (auto var = dynamic_cast<NodeNoParenCallExp*>(&exp))
+    {
+        auto def = env_->FindDef(var->name);
+        return def && def->IsVariable() ? def.get() : nullptr;
+    }
+    if (auto ref = dynamic_cast<NodeArrayRef*>(&exp))
+    {
+        return GetAliasedVar(*ref->array);
+    }
+    return nullptr;
+}
+void CodeAnalyzer::AddCopySite(const std::shared_ptr<NodeExp>& exp, NodeDef* dst)
+{
+    if (!dst) return;
+    if (auto src = GetAliasedVar(*exp))
+    {
+        copySites_.push_back(CopySite{ exp, src, dst });
+    }
+}
+void CodeAnalyzer::AddArgCopySites(const std::string & name, const std::vector<std::shared_ptr<NodeExp>>& args)
+{
+    // [U`̊֐, ^XN͉̈ւ̑Ƃ݂Ȃ
+    auto def = env_->FindDef(name);
+    std::shared_ptr<NodeBlock> blk;
+    const std::vector<std::string>* params = nullptr;
+    if (auto func = std::dynamic_pointer_cast<NodeFuncDef>(def))
+    {
+        blk = func->block;
+        params = &func->params;
+    } else if (auto task = std::dynamic_pointer_cast<NodeTaskDef>(def))
+    {
+        blk = task->block;
+        params = &task->params;
+    }
+    if (!params || params->size() != args.size()) return;
+    for (int i = 0; i < args.size(); i++)
+    {
+        auto it = blk->nameTable->find((*params)[i]);
+        if (it != blk->nameTable->end())
+        {
+            AddCopySite(args[i], it->second.get());
+        }
+    }
+}
+void CodeAnalyzer::ElideCopy()
+{
+    // QƌۑgȂȂ, lLĂDNH̒l̈Ӗ_͕ςȂ
+    for (auto& site : copySites_)
+    {
+        if (mutatedVars_.count(site.src) == 0 && mutatedVars_.count(site.dst) == 0)
+        {
+            site.exp->copyRequired = false;
+        }
+    }
 }
 }
\ No newline at end of file
@@ -1,5 +1,9 @@
 #pragma once
 #include <bstorm/node.hpp>
+#include <bstorm/script_info.hpp>
+
+#include <vector>
+#include <unordered_set>
 
 namespace bstorm
 {
@@ -8,6 +12,8 @@ class CodeAnalyzer : public NodeTraverser
 {
 public:
     void Analyze(Node& n);
+    // paths of scripts loaded by built-in functions with constant arguments
+    const std::vector<ScriptReference>& GetScriptReferences() const { return scriptRefs_; }
     void Traverse(NodeNum&) override;
     void Traverse(NodeChar&) override;
     void Traverse(NodeStr&) override;
@@ -76,7 +82,47 @@ public:
     void Traverse(NodeAlternative&) override;
     void Traverse(NodeHeader&) override;
 private:
+    // ϐւ̑ (^_p)
+    struct VarAssign
+    {
+        enum class Kind
+        {
+            ASSIGN, // a = e;
+            ADD_SUB, // a += e; a -= e;
+            ARITH, // a *= e; a /= e; a %= e; a ^= e;
+            SUCC_PRED, // a++; a--;
+            OTHER // a ~= e; a[i] = e; ...
+        };
+        std::shared_ptr<NodeDef> var;
+        std::shared_ptr<NodeExp> rhs;
+        Kind kind;
+    };
     std::shared_ptr<Env> env_;
+    std::vector<ScriptReference> scriptRefs_;
+    std::vector<std::shared_ptr<NodeDef>> reachedDefs_;
+    std::vector<VarAssign> varAssigns_;
+    std::unordered_set<NodeDef*> initializedVars_;
+    // lۑӏ (Rs[ȗ̉͗p)
+    struct CopySite
+    {
+        std::shared_ptr<NodeExp> exp;
+        NodeDef* src; // l̎Qƌ̕ϐ
+        NodeDef* dst; // ۑ̕ϐ
+    };
+    std::vector<CopySite> copySites_;
+    // vf̏AŒgڏϐ
+    std::unordered_set<NodeDef*> mutatedVars_;
+    void Run(Node& n);
+    void ResetAnalysis();
+    void AddVarAssign(const std::string& name, const std::shared_ptr<NodeExp>& rhs, VarAssign::Kind kind);
+    void AddLoopParamAssign(const std::string& param, const std::shared_ptr<NodeExp>& init, NodeBlock& blk);
+    ExpType GetAssignedType(const VarAssign& assign) const;
+    NodeDef* GetAliasedVar(NodeExp& exp) const;
+    void AddCopySite(const std::shared_ptr<NodeExp>& exp, NodeDef* dst);
+    void AddArgCopySites(const std::string& name, const std::vector<std::shared_ptr<NodeExp>>& args);
+    void ElideCopy();
+    void AnalyzeScriptReference(const std::string& name, const std::vector<std::shared_ptr<NodeExp>>& args);
+    bool EvalConstPath(NodeExp& exp, std::wstring& path) const;
     void AnalyzeDef(const std::string& name);
     void AnalyzeMonoOp(NodeMonoOp& exp);
     void AnalyzeBinOp(NodeBinOp& exp);
@@ -1,10 +1,12 @@
 ﻿#include <bstorm/code_generator.hpp>
 
+#include <bstorm/constant_folder.hpp>
 #include <bstorm/script_name_prefix.hpp>
 #include <bstorm/string_util.hpp>
 #include <bstorm/file_util.hpp>
 
 #include <cassert>
+#include <cstdio>
 #include <regex>
 
 namespace bstorm
@@ -45,6 +47,7 @@ CodeGenerator::CodeGenerator(const Option& option) :
     indentLevel_(0),
     outputLine_(1),
     isLineHead_(true),
+    foldedNodeCnt_(0),
     option_(option)
 {
 }
@@ -53,6 +56,12 @@ void CodeGenerator::Generate(Node & n)
 {
     env_ = nullptr;
     code_.clear();
+    foldedNodeCnt_ = 0;
+    if (option_.foldConstant)
+    {
+        ConstantFolder folder;
+        foldedNodeCnt_ = folder.Fold(n);
+    }
     n.Traverse(*this);
 }
 
@@ -69,13 +78,27 @@ void CodeGenerator::Traverse(NodeChar& exp)
 
 void CodeGenerator::Traverse(NodeStr& exp)
 {
-    AddCode("{");
-    for (int i = 0; i < exp.str.size(); i++)
+    // in  : "abc"
+    // out : r_str("abc")
+    std::string lit;
+    for (unsigned char c : ToUTF8(exp.str))
     {
-        if (i != 0) AddCode(",");
-        NodeChar(exp.str[i]).Traverse(*this);
+        if (c == '\\' || c == '"')
+        {
+            lit += '\\';
+            lit += c;
+        } else if (c < 0x20 || c == 0x7f)
+        {
+            // 改行も含めてエスケープするので出力行はずれない
+            char buf[5];
+            snprintf(buf, sizeof(buf), "\\%03d", c);
+            lit += buf;
+        } else
+        {
+            lit += c;
+        }
     }
-    AddCode("}");
+    AddCode(runtime("str") + "(\"" + lit + "\")");
 }
 void CodeGenerator::Traverse(NodeArray& exp)
 {
@@ -87,7 +110,7 @@ void CodeGenerator::Traverse(NodeArray& exp)
     for (int i = 0; i < exp.elems.size(); i++)
     {
         if (i != 0) AddCode(",");
-        exp.elems[i]->Traverse(*this);
+        GenCopy(*exp.elems[i]);
     }
     AddCode("})");
 }
@@ -106,6 +129,9 @@ void CodeGenerator::Traverse(NodeNot& exp)
     if (exp.rhs->expType == ExpType::BOOL)
     {
         AddCode("(not("); exp.rhs->Traverse(*this); AddCode("))");
+    } else if (exp.rhs->expType == ExpType::REAL)
+    {
+        AddCode("("); exp.rhs->Traverse(*this); AddCode(" == 0)");
     } else
     {
         GenMonoOp("not", exp);
@@ -124,11 +150,11 @@ void CodeGenerator::Traverse(NodeLt& exp) { GenArithBinOp("lt", "<", exp); }
 void CodeGenerator::Traverse(NodeGt& exp) { GenArithBinOp("gt", ">", exp); }
 void CodeGenerator::Traverse(NodeLe& exp) { GenArithBinOp("le", "<=", exp); }
 void CodeGenerator::Traverse(NodeGe& exp) { GenArithBinOp("ge", ">=", exp); }
-void CodeGenerator::Traverse(NodeEq& exp) { GenArithBinOp("eq", "==", exp); }
-void CodeGenerator::Traverse(NodeNe& exp) { GenArithBinOp("ne", "~=", exp); }
+void CodeGenerator::Traverse(NodeEq& exp) { GenEqBinOp("eq", "==", exp); }
+void CodeGenerator::Traverse(NodeNe& exp) { GenEqBinOp("ne", "~=", exp); }
 
-void CodeGenerator::Traverse(NodeAnd& exp) { GenLogBinOp("and", exp); }
-void CodeGenerator::Traverse(NodeOr& exp) { GenLogBinOp("or", exp); }
+void CodeGenerator::Traverse(NodeAnd& exp) { GenLogBinOp("and", "and", exp); }
+void CodeGenerator::Traverse(NodeOr& exp) { GenLogBinOp("or", "or", exp); }
 void CodeGenerator::Traverse(NodeCat& exp)
 {
     {
@@ -281,8 +307,33 @@ void CodeGenerator::GenArithBinOp(const std::string & fname, const std::string&
         GenBinOp(fname, exp);
     }
 }
-void CodeGenerator::GenLogBinOp(const std::string & fname, NodeBinOp & exp)
+void CodeGenerator::GenEqBinOp(const std::string & fname, const std::string & op, NodeBinOp & exp)
+{
+    // 真偽値同士の比較はそのまま比較できる
+    if (exp.lhs->expType == ExpType::BOOL && exp.rhs->expType == ExpType::BOOL)
+    {
+        AddCode("(");
+        exp.lhs->Traverse(*this);
+        AddCode(op);
+        exp.rhs->Traverse(*this);
+        AddCode(")");
+    } else
+    {
+        GenArithBinOp(fname, op, exp);
+    }
+}
+void CodeGenerator::GenLogBinOp(const std::string & fname, const std::string & op, NodeBinOp & exp)
 {
+    if (exp.lhs->expType == ExpType::BOOL && exp.rhs->expType == ExpType::BOOL)
+    {
+        // 両辺が真偽値ならLuaの論理演算子がそのまま使える
+        AddCode("(");
+        exp.lhs->Traverse(*this);
+        AddCode(" " + op + " ");
+        exp.rhs->Traverse(*this);
+        AddCode(")");
+        return;
+    }
     AddCode(runtime(fname) + "(");
     exp.lhs->Traverse(*this);
     AddCode(", function() return ");
@@ -446,11 +497,28 @@ void CodeGenerator::GenCallStmt(NodeCallStmt & call, bool doTCO)
     }
     AddCode(");"); NewLine(call.srcPos);
 }
-void CodeGenerator::GenOpAssign(const std::string & fname, const std::shared_ptr<NodeLeftVal>& left, const NullableSharedPtr<NodeExp>& right)
+void CodeGenerator::GenOpAssign(const std::string & fname, const std::string & op, const std::shared_ptr<NodeLeftVal>& left, const NullableSharedPtr<NodeExp>& right)
 {
     switch (left->indices.size())
     {
         case 0:
+            if (!op.empty() && env_->FindDef(left->name)->retType == ExpType::REAL && (!right || right->expType == ExpType::REAL))
+            {
+                // in  : a += e; a++;
+                // out : a = (r_nc(a) + e); a = (r_nc(a) + 1);
+                AddCode(varname(left->name, env_) + " = (");
+                GenNilCheckExp(left->name);
+                AddCode(op);
+                if (right)
+                {
+                    right->Traverse(*this);
+                } else
+                {
+                    AddCode("1");
+                }
+                AddCode(");"); NewLine(left->srcPos);
+                break;
+            }
             // in  : a += e;
             // out : a = add(r_nc(a), e);
             AddCode(varname(left->name, env_) + " = ");
@@ -467,12 +535,12 @@ void CodeGenerator::GenOpAssign(const std::string & fname, const std::shared_ptr
             // in  : a[_i] += e;
             // out :  r_nc(a);
             //        local i = _i;
-            //        r_write1(a, i, r_add(r_read(a, i), e));
+            //        a = r_write1(a, i, r_add(r_read(a, i), e));
             AddCode("do"); NewLine();
             GenNilCheckStmt(left->name);
             NewLine(left->srcPos);
             AddCode("local i = "); left->indices[0]->Traverse(*this); AddCode(";"); NewLine(left->srcPos);
-            AddCode(runtime("write1") + "(" + varname(left->name, env_) + ", i, ");
+            AddCode(varname(left->name, env_) + " = " + runtime("write1") + "(" + varname(left->name, env_) + ", i, ");
             AddCode(runtime(fname) + "(");
             AddCode(runtime("read") + "(" + varname(left->name, env_) + ", i)");
             if (right)
@@ -487,7 +555,7 @@ void CodeGenerator::GenOpAssign(const std::string & fname, const std::shared_ptr
             // in  : a[i][j]..[z] += e;
             // out : r_nc(a);
             //       local is = {i, j, .. , z};
-            //       r_write(a, is, r_add(r_read(..r_read(a, is[1]), is[2]), .. is[n]), e);
+            //       a = r_write(a, is, r_add(r_read(..r_read(a, is[1]), is[2]), .. is[n]), e);
             AddCode("do"); NewLine();
             GenNilCheckStmt(left->name); NewLine(left->srcPos);
             AddCode("local is = {");
@@ -497,7 +565,7 @@ void CodeGenerator::GenOpAssign(const std::string & fname, const std::shared_ptr
                 left->indices[i]->Traverse(*this);
             }
             AddCode("};"); NewLine(left->srcPos);
-            AddCode(runtime("write") + "(" + varname(left->name, env_) + ", is");
+            AddCode(varname(left->name, env_) + " = " + runtime("write") + "(" + varname(left->name, env_) + ", is");
             AddCode("," + runtime(fname) + "(");
             for (int i = 0; i < left->indices.size(); i++)
             {
@@ -535,6 +603,9 @@ void CodeGenerator::GenCondition(std::shared_ptr<NodeExp>& exp)
     if (exp->expType == ExpType::BOOL)
     {
         exp->Traverse(*this);
+    } else if (exp->expType == ExpType::REAL)
+    {
+        AddCode("("); exp->Traverse(*this); AddCode(" ~= 0)");
     } else
     {
         AddCode(runtime("tobool")); AddCode("("); exp->Traverse(*this); AddCode(")");
@@ -569,7 +640,7 @@ void CodeGenerator::GenCase(NodeCase & cs, ExpType condType)
 
 void CodeGenerator::Traverse(NodeArrayRef& exp)
 {
-    AddCode(runtime("read"));
+    AddCode(runtime("ref"));
     AddCode("(");
     exp.array->Traverse(*this);
     AddCode(",");
@@ -597,13 +668,14 @@ void CodeGenerator::Traverse(NodeAssign& stmt)
     {
         case 0:
             // in : a = a ~ e;
-            // out: r_mcat(a, e);
+            // out: a = r_mcat(a, e);
             if (auto binOp = std::dynamic_pointer_cast<NodeCat>(stmt.rhs))
             {
                 if (auto var = std::dynamic_pointer_cast<NodeNoParenCallExp>(binOp->lhs))
                 {
                     if (stmt.lhs->name == var->name)
                     {
+                        AddCode(varname(def) + " = ");
                         AddCode(runtime("mcat"));
                         AddCode("(");
                         AddCode(varname(def));
@@ -620,7 +692,8 @@ void CodeGenerator::Traverse(NodeAssign& stmt)
             break;
         case 1:
             // in  : a[i] = e;
-            // out : r_write1(r_nc(a), i, e);
+            // out : a = r_write1(r_nc(a), i, e);
+            AddCode(varname(def) + " = ");
             AddCode(runtime("write1"));
             AddCode("(");
             GenNilCheckExp(def->name);
@@ -632,7 +705,8 @@ void CodeGenerator::Traverse(NodeAssign& stmt)
             break;
         default:
             // in  : a[i1][i2] .. [in] = e;
-            // out : r_write(r_nc(a), {i1, i2, .. in}, e);
+            // out : a = r_write(r_nc(a), {i1, i2, .. in}, e);
+            AddCode(varname(def) + " = ");
             AddCode(runtime("write"));
             AddCode("(");
             GenNilCheckExp(def->name);
@@ -649,13 +723,13 @@ void CodeGenerator::Traverse(NodeAssign& stmt)
     }
     NewLine(stmt.srcPos);
 }
-void CodeGenerator::Traverse(NodeAddAssign& stmt) { GenOpAssign("add", stmt.lhs, stmt.rhs); }
-void CodeGenerator::Traverse(NodeSubAssign& stmt) { GenOpAssign("sub", stmt.lhs, stmt.rhs); }
-void CodeGenerator::Traverse(NodeMulAssign& stmt) { GenOpAssign("mul", stmt.lhs, stmt.rhs); }
-void CodeGenerator::Traverse(NodeDivAssign& stmt) { GenOpAssign("div", stmt.lhs, stmt.rhs); }
-void CodeGenerator::Traverse(NodeRemAssign& stmt) { GenOpAssign("rem", stmt.lhs, stmt.rhs); }
-void CodeGenerator::Traverse(NodePowAssign& stmt) { GenOpAssign("pow", stmt.lhs, stmt.rhs); }
-void CodeGenerator::Traverse(NodeCatAssign& stmt) { GenOpAssign("mcat", stmt.lhs, stmt.rhs); }
+void CodeGenerator::Traverse(NodeAddAssign& stmt) { GenOpAssign("add", "+", stmt.lhs, stmt.rhs); }
+void CodeGenerator::Traverse(NodeSubAssign& stmt) { GenOpAssign("sub", "-", stmt.lhs, stmt.rhs); }
+void CodeGenerator::Traverse(NodeMulAssign& stmt) { GenOpAssign("mul", "*", stmt.lhs, stmt.rhs); }
+void CodeGenerator::Traverse(NodeDivAssign& stmt) { GenOpAssign("div", "/", stmt.lhs, stmt.rhs); }
+void CodeGenerator::Traverse(NodeRemAssign& stmt) { GenOpAssign("rem", "%", stmt.lhs, stmt.rhs); }
+void CodeGenerator::Traverse(NodePowAssign& stmt) { GenOpAssign("pow", "^", stmt.lhs, stmt.rhs); }
+void CodeGenerator::Traverse(NodeCatAssign& stmt) { GenOpAssign("mcat", "", stmt.lhs, stmt.rhs); }
 
 void CodeGenerator::Traverse(NodeCallStmt& call)
 {
@@ -720,8 +794,8 @@ void CodeGenerator::Traverse(NodeBreak& stmt)
     NewLine(stmt.srcPos);
 }
 
-void CodeGenerator::Traverse(NodeSucc& stmt) { GenOpAssign("succ", stmt.lhs, nullptr); }
-void CodeGenerator::Traverse(NodePred& stmt) { GenOpAssign("pred", stmt.lhs, nullptr); }
+void CodeGenerator::Traverse(NodeSucc& stmt) { GenOpAssign("succ", "+", stmt.lhs, nullptr); }
+void CodeGenerator::Traverse(NodePred& stmt) { GenOpAssign("pred", "-", stmt.lhs, nullptr); }
 
 void CodeGenerator::Traverse(NodeVarDecl &) {}
 void CodeGenerator::Traverse(NodeVarInit& stmt)
@@ -744,7 +818,13 @@ void CodeGenerator::Traverse(NodeVarInit& stmt)
 void CodeGenerator::Traverse(NodeProcParam &) {}
 void CodeGenerator::Traverse(NodeLoopParam& param)
 {
-    AddCode("local " + varname(param.name, env_) + " = " + runtime("cp") + "(i);");
+    if (param.retType == ExpType::REAL)
+    {
+        AddCode("local " + varname(param.name, env_) + " = i;");
+    } else
+    {
+        AddCode("local " + varname(param.name, env_) + " = " + runtime("cp") + "(i);");
+    }
     NewLine(param.srcPos);
 }
 void CodeGenerator::Traverse(NodeResult &) {}
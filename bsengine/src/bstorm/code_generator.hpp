@@ -19,11 +19,13 @@ public:
         bool enableNilCheck = true;
         bool deleteUnreachableDefinition = false;
         bool deleteUnneededAssign = false;
+        bool foldConstant = false;
     };
     CodeGenerator(const Option& option);
     void Generate(Node& program);
     const SourceMap& GetSourceMap() const { return srcMap_; }
     const std::string& GetCode() const { return code_; }
+    size_t GetFoldedNodeCount() const { return foldedNodeCnt_; }
     void Traverse(NodeNum&) override;
     void Traverse(NodeChar&) override;
     void Traverse(NodeStr&) override;
@@ -101,13 +103,14 @@ private:
     void GenMonoOp(const std::string& fname, NodeMonoOp& exp);
     void GenBinOp(const std::string& fname, NodeBinOp& exp);
     void GenArithBinOp(const std::string& fname, const std::string& op, NodeBinOp& exp);
-    void GenLogBinOp(const std::string& fname, NodeBinOp& exp);
+    void GenEqBinOp(const std::string& fname, const std::string& op, NodeBinOp& exp);
+    void GenLogBinOp(const std::string& fname, const std::string& op, NodeBinOp& exp);
     void GenNilCheckExp(const std::string& name);
     void GenNilCheckStmt(const std::string& name);
     void GenProc(const std::shared_ptr<NodeDef>& def, const std::vector<std::string>& params_, NodeBlock& blk);
     void GenBlock(NodeBlock& blk, bool doTCO);
     void GenCallStmt(NodeCallStmt& call, bool doTCO);
-    void GenOpAssign(const std::string& fname, const std::shared_ptr<NodeLeftVal>& left, const NullableSharedPtr<NodeExp>& right);
+    void GenOpAssign(const std::string& fname, const std::string& op, const std::shared_ptr<NodeLeftVal>& left, const NullableSharedPtr<NodeExp>& right);
     void GenCopy(NodeExp& exp);
     void GenCondition(std::shared_ptr<NodeExp>& exp);
     void GenCase(NodeCase& cs, ExpType condType);
@@ -118,6 +121,7 @@ private:
     int indentLevel_;
     int outputLine_;
     bool isLineHead_;
+    size_t foldedNodeCnt_;
     const Option option_;
 };
 }
\ No newline at end of file
@@ -212,7 +212,7 @@ void CommonDataDB::SaveCommonDataArea(const DataAreaName& areaName, const std::w
     }
     std::ofstream fstream;
     MakeDirectoryP(GetParentPath(path));
-    fstream.open(path, std::ios::out | std::ios::binary);
+    OpenFileStream(fstream, path, std::ios::out | std::ios::binary);
     if (!fstream.good())
     {
         throw failed_to_save_common_data_area()
@@ -286,7 +286,7 @@ void CommonDataDB::LoadCommonDataArea(const DataAreaName& areaName, std::istream
 void CommonDataDB::LoadCommonDataArea(const DataAreaName& areaName, const std::wstring& path) noexcept(false)
 {
     std::ifstream stream;
-    stream.open(path, std::ios::in | std::ios::binary);
+    OpenFileStream(stream, path, std::ios::in | std::ios::binary);
     if (!stream.is_open())
     {
         throw cant_open_common_data_file(path);
@@ -0,0 +1,402 @@
+﻿#include <bstorm/constant_folder.hpp>
+
+#include <bstorm/env.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace bstorm
+{
+// NOTE: 実行時と同じ結果になる演算だけ畳み込む
+
+// LuaJITのmath.rad, math.degと同じ定数
+static constexpr double RADIANS_PER_DEGREE = 1.74532925199432957692e-2;
+static constexpr double DEGREES_PER_RADIAN = 57.29577951308232087680;
+
+static bool ParseNum(const std::string& str, double& x)
+{
+    if (str.empty()) return false;
+    char* end = nullptr;
+    x = std::strtod(str.c_str(), &end);
+    return *end == '\0';
+}
+
+static double Neg(double x) { return -x; }
+static double Abs(double x) { return std::fabs(x); }
+static double Add(double x, double y) { return x + y; }
+static double Sub(double x, double y) { return x - y; }
+static double Mul(double x, double y) { return x * y; }
+static double Div(double x, double y) { return x / y; }
+static double Rem(double x, double y) { return x - std::floor(x / y) * y; } // Luaの%と同じ
+static double Pow(double x, double y) { return std::pow(x, y); }
+
+// 引数が定数なら畳み込んでよい組み込み関数
+static bool EvalPureBuiltInFunc(const std::string& name, const std::vector<double>& args, double& result)
+{
+    if (name == "sin" && args.size() == 1)
+    {
+        result = std::sin(args[0] * RADIANS_PER_DEGREE);
+    } else if (name == "cos" && args.size() == 1)
+    {
+        result = std::cos(args[0] * RADIANS_PER_DEGREE);
+    } else if (name == "atan2" && args.size() == 2)
+    {
+        result = std::atan2(args[0], args[1]) * DEGREES_PER_RADIAN;
+    } else if (name == "absolute" && args.size() == 1)
+    {
+        result = std::fabs(args[0]);
+    } else if (name == "truncate" && args.size() == 1)
+    {
+        result = std::trunc(args[0]);
+    } else
+    {
+        return false;
+    }
+    return true;
+}
+
+size_t ConstantFolder::Fold(Node & n)
+{
+    env_ = nullptr;
+    constVars_.clear();
+    folded_ = nullptr;
+    foldedNodeCnt_ = 0;
+    n.Traverse(*this);
+    return foldedNodeCnt_;
+}
+void ConstantFolder::Traverse(NodeNum &) {}
+void ConstantFolder::Traverse(NodeChar &) {}
+void ConstantFolder::Traverse(NodeStr &) {}
+void ConstantFolder::Traverse(NodeArray & arr)
+{
+    for (auto& elem : arr.elems) { FoldExp(elem); }
+}
+void ConstantFolder::Traverse(NodeNeg & exp)
+{
+    // -(数値リテラル)は負の定数の表現なので畳み込まない
+    if (std::dynamic_pointer_cast<NodeNum>(exp.rhs)) return;
+    FoldMonoOp(exp, Neg);
+}
+void ConstantFolder::Traverse(NodeNot & exp) { FoldExp(exp.rhs); }
+void ConstantFolder::Traverse(NodeAbs & exp) { FoldMonoOp(exp, Abs); }
+void ConstantFolder::Traverse(NodeAdd & exp)
+{
+    FoldBinOp(exp, Add);
+    if (!folded_) FoldIdentity(exp, 0, 0);
+}
+void ConstantFolder::Traverse(NodeSub & exp)
+{
+    FoldBinOp(exp, Sub);
+    if (!folded_) FoldIdentity(exp, NAN, 0);
+}
+void ConstantFolder::Traverse(NodeMul & exp)
+{
+    FoldBinOp(exp, Mul);
+    if (!folded_) FoldIdentity(exp, 1, 1);
+}
+void ConstantFolder::Traverse(NodeDiv & exp)
+{
+    FoldBinOp(exp, Div);
+    if (!folded_) FoldIdentity(exp, NAN, 1);
+}
+void ConstantFolder::Traverse(NodeRem & exp) { FoldBinOp(exp, Rem); }
+void ConstantFolder::Traverse(NodePow & exp) { FoldBinOp(exp, Pow); }
+void ConstantFolder::Traverse(NodeLt & exp) { FoldExp(exp.lhs); FoldExp(exp.rhs); }
+void ConstantFolder::Traverse(NodeGt & exp) { FoldExp(exp.lhs); FoldExp(exp.rhs); }
+void ConstantFolder::Traverse(NodeLe & exp) { FoldExp(exp.lhs); FoldExp(exp.rhs); }
+void ConstantFolder::Traverse(NodeGe & exp) { FoldExp(exp.lhs); FoldExp(exp.rhs); }
+void ConstantFolder::Traverse(NodeEq & exp) { FoldExp(exp.lhs); FoldExp(exp.rhs); }
+void ConstantFolder::Traverse(NodeNe & exp) { FoldExp(exp.lhs); FoldExp(exp.rhs); }
+void ConstantFolder::Traverse(NodeAnd & exp)
+{
+    FoldExp(exp.lhs);
+    FoldExp(exp.rhs);
+    if (exp.lhs->expType == exp.rhs->expType) exp.expType = exp.lhs->expType;
+}
+void ConstantFolder::Traverse(NodeOr & exp)
+{
+    FoldExp(exp.lhs);
+    FoldExp(exp.rhs);
+    if (exp.lhs->expType == exp.rhs->expType) exp.expType = exp.lhs->expType;
+}
+void ConstantFolder::Traverse(NodeCat & exp) { FoldExp(exp.lhs); FoldExp(exp.rhs); }
+void ConstantFolder::Traverse(NodeNoParenCallExp & call)
+{
+    double x;
+    if (GetConstNum(call.name, x))
+    {
+        SetFolded(call, x);
+    }
+}
+void ConstantFolder::Traverse(NodeCallExp & call)
+{
+    for (auto& arg : call.args) { FoldExp(arg); }
+    double x;
+    if (call.args.empty() && GetConstNum(call.name, x))
+    {
+        SetFolded(call, x);
+        return;
+    }
+    FoldCall(call);
+}
+void ConstantFolder::Traverse(NodeArrayRef & exp)
+{
+    FoldExp(exp.array);
+    FoldExp(exp.idx);
+}
+void ConstantFolder::Traverse(NodeRange & range)
+{
+    FoldExp(range.start);
+    FoldExp(range.end);
+}
+void ConstantFolder::Traverse(NodeArraySlice & exp)
+{
+    FoldExp(exp.array);
+    exp.range->Traverse(*this);
+}
+void ConstantFolder::Traverse(NodeNop &) {}
+void ConstantFolder::Traverse(NodeLeftVal & left)
+{
+    for (auto& idx : left.indices) { FoldExp(idx); }
+}
+void ConstantFolder::Traverse(NodeAssign & stmt) { FoldAssign(stmt); }
+void ConstantFolder::Traverse(NodeAddAssign & stmt) { FoldAssign(stmt); }
+void ConstantFolder::Traverse(NodeSubAssign & stmt) { FoldAssign(stmt); }
+void ConstantFolder::Traverse(NodeMulAssign & stmt) { FoldAssign(stmt); }
+void ConstantFolder::Traverse(NodeDivAssign & stmt) { FoldAssign(stmt); }
+void ConstantFolder::Traverse(NodeRemAssign & stmt) { FoldAssign(stmt); }
+void ConstantFolder::Traverse(NodePowAssign & stmt) { FoldAssign(stmt); }
+void ConstantFolder::Traverse(NodeCatAssign & stmt) { FoldAssign(stmt); }
+void ConstantFolder::Traverse(NodeCallStmt & call)
+{
+    for (auto& arg : call.args) { FoldExp(arg); }
+}
+void ConstantFolder::Traverse(NodeReturn & stmt) { FoldExp(stmt.ret); }
+void ConstantFolder::Traverse(NodeReturnVoid &) {}
+void ConstantFolder::Traverse(NodeYield &) {}
+void ConstantFolder::Traverse(NodeBreak &) {}
+void ConstantFolder::Traverse(NodeSucc & stmt) { stmt.lhs->Traverse(*this); }
+void ConstantFolder::Traverse(NodePred & stmt) { stmt.lhs->Traverse(*this); }
+void ConstantFolder::Traverse(NodeVarDecl &) {}
+void ConstantFolder::Traverse(NodeVarInit & stmt)
+{
+    FoldExp(stmt.rhs);
+    // 初期化以外で代入されない変数は定数として伝播する
+    if (auto varDecl = std::dynamic_pointer_cast<NodeVarDecl>(env_->FindDef(stmt.name)))
+    {
+        double x;
+        if (varDecl->assignCnt == 1 && GetConstNum(stmt.rhs, x))
+        {
+            constVars_[varDecl.get()] = x;
+        }
+    }
+}
+void ConstantFolder::Traverse(NodeProcParam &) {}
+void ConstantFolder::Traverse(NodeLoopParam &) {}
+void ConstantFolder::Traverse(NodeResult &) {}
+void ConstantFolder::Traverse(NodeBlock & blk) { FoldBlock(blk); }
+void ConstantFolder::Traverse(NodeSubDef & def) { def.block->Traverse(*this); }
+void ConstantFolder::Traverse(NodeBuiltInSubDef & def) { def.block->Traverse(*this); }
+void ConstantFolder::Traverse(NodeFuncDef & def) { def.block->Traverse(*this); }
+void ConstantFolder::Traverse(NodeTaskDef & def) { def.block->Traverse(*this); }
+void ConstantFolder::Traverse(NodeBuiltInFunc &) {}
+void ConstantFolder::Traverse(NodeConst &) {}
+void ConstantFolder::Traverse(NodeLocal & stmt) { stmt.block->Traverse(*this); }
+void ConstantFolder::Traverse(NodeLoop & stmt) { stmt.block->Traverse(*this); }
+void ConstantFolder::Traverse(NodeTimes & stmt)
+{
+    FoldExp(stmt.cnt);
+    stmt.block->Traverse(*this);
+}
+void ConstantFolder::Traverse(NodeWhile & stmt)
+{
+    FoldExp(stmt.cond);
+    stmt.block->Traverse(*this);
+}
+void ConstantFolder::Traverse(NodeAscent & stmt)
+{
+    stmt.range->Traverse(*this);
+    stmt.block->Traverse(*this);
+}
+void ConstantFolder::Traverse(NodeDescent & stmt)
+{
+    stmt.range->Traverse(*this);
+    stmt.block->Traverse(*this);
+}
+void ConstantFolder::Traverse(NodeElseIf & elsif)
+{
+    FoldExp(elsif.cond);
+    elsif.block->Traverse(*this);
+}
+void ConstantFolder::Traverse(NodeIf & stmt)
+{
+    FoldExp(stmt.cond);
+    stmt.thenBlock->Traverse(*this);
+    for (auto& elsif : stmt.elsifs) elsif->Traverse(*this);
+    if (stmt.elseBlock) stmt.elseBlock->Traverse(*this);
+}
+void ConstantFolder::Traverse(NodeCase & c)
+{
+    for (auto& exp : c.exps) { FoldExp(exp); }
+    c.block->Traverse(*this);
+}
+void ConstantFolder::Traverse(NodeAlternative & stmt)
+{
+    FoldExp(stmt.cond);
+    for (auto& c : stmt.cases) c->Traverse(*this);
+    if (stmt.others) stmt.others->Traverse(*this);
+}
+void ConstantFolder::Traverse(NodeHeader &) {}
+
+void ConstantFolder::FoldExp(std::shared_ptr<NodeExp>& exp)
+{
+    folded_ = nullptr;
+    exp->Traverse(*this);
+    if (folded_)
+    {
+        exp = folded_;
+        folded_ = nullptr;
+        foldedNodeCnt_++;
+    }
+}
+bool ConstantFolder::GetConstNum(const std::shared_ptr<NodeExp>& exp, double & x) const
+{
+    if (auto num = std::dynamic_pointer_cast<NodeNum>(exp))
+    {
+        return ParseNum(num->number, x);
+    }
+    if (auto neg = std::dynamic_pointer_cast<NodeNeg>(exp))
+    {
+        if (auto num = std::dynamic_pointer_cast<NodeNum>(neg->rhs))
+        {
+            if (ParseNum(num->number, x))
+            {
+                x = -x;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+bool ConstantFolder::GetConstNum(const std::string & name, double & x) const
+{
+    auto def = env_->FindDef(name);
+    if (auto c = std::dynamic_pointer_cast<NodeConst>(def))
+    {
+        return c->retType == ExpType::REAL && ParseNum(c->value, x);
+    }
+    auto it = constVars_.find(def.get());
+    if (it != constVars_.end())
+    {
+        x = it->second;
+        return true;
+    }
+    return false;
+}
+void ConstantFolder::SetFolded(const NodeExp& src, double x)
+{
+    folded_ = nullptr;
+    if (!std::isfinite(x)) return;
+
+    // 最短で元の値に戻る表記にする
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.15g", std::fabs(x));
+    double y;
+    if (!ParseNum(buf, y) || y != std::fabs(x))
+    {
+        std::snprintf(buf, sizeof(buf), "%.17g", std::fabs(x));
+    }
+
+    // 負の数は単項マイナスで表す (a--1 がLuaのコメントになるのを防ぐ)
+    auto num = std::make_shared<NodeNum>(std::string(buf));
+    num->srcPos = src.srcPos;
+    if (std::signbit(x))
+    {
+        auto neg = std::make_shared<NodeNeg>(num);
+        neg->srcPos = src.srcPos;
+        neg->noSubEffect = true;
+        // 畳み込む前の式と同じく実数として特殊化されるようにする
+        neg->expType = ExpType::REAL;
+        neg->copyRequired = false;
+        folded_ = neg;
+    } else
+    {
+        folded_ = num;
+    }
+}
+void ConstantFolder::FoldMonoOp(NodeMonoOp & exp, double(*f)(double))
+{
+    FoldExp(exp.rhs);
+    double x;
+    if (GetConstNum(exp.rhs, x))
+    {
+        SetFolded(exp, f(x));
+    }
+}
+void ConstantFolder::FoldBinOp(NodeBinOp & exp, double(*f)(double, double))
+{
+    FoldExp(exp.lhs);
+    FoldExp(exp.rhs);
+    double x, y;
+    if (GetConstNum(exp.lhs, x) && GetConstNum(exp.rhs, y))
+    {
+        SetFolded(exp, f(x, y));
+    }
+    if (exp.lhs->expType == ExpType::REAL && exp.rhs->expType == ExpType::REAL)
+    {
+        exp.expType = ExpType::REAL;
+    }
+}
+void ConstantFolder::FoldIdentity(NodeBinOp & exp, double lhsIdentity, double rhsIdentity)
+{
+    // e + 0, e * 1 などを e にする
+    // 実数以外は演算で型変換が起こるので対象外
+    double x;
+    if (exp.rhs->expType == ExpType::REAL && GetConstNum(exp.lhs, x) && x == lhsIdentity)
+    {
+        folded_ = exp.rhs;
+    } else if (exp.lhs->expType == ExpType::REAL && GetConstNum(exp.rhs, x) && x == rhsIdentity)
+    {
+        folded_ = exp.lhs;
+    }
+}
+void ConstantFolder::FoldCall(NodeCallExp & call)
+{
+    if (!std::dynamic_pointer_cast<NodeBuiltInFunc>(env_->FindDef(call.name))) return;
+    std::vector<double> args;
+    for (const auto& arg : call.args)
+    {
+        double x;
+        if (!GetConstNum(arg, x)) return;
+        args.push_back(x);
+    }
+    double result;
+    if (EvalPureBuiltInFunc(call.name, args, result))
+    {
+        SetFolded(call, result);
+    }
+}
+void ConstantFolder::FoldAssign(NodeAssign & stmt)
+{
+    stmt.lhs->Traverse(*this);
+    FoldExp(stmt.rhs);
+}
+void ConstantFolder::FoldBlock(NodeBlock & blk)
+{
+    env_ = std::make_shared<Env>(blk.nameTable, env_);
+    // 先に文を処理して, 定数で初期化される変数を関数本体に伝播させる
+    for (auto& stmt : blk.stmts)
+    {
+        stmt->Traverse(*this);
+    }
+    for (auto& bind : *(blk.nameTable))
+    {
+        if (!bind.second->unreachable)
+        {
+            bind.second->Traverse(*this);
+        }
+    }
+    env_ = env_->GetParent();
+}
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+﻿#pragma once
+
+#include <bstorm/node.hpp>
+
+#include <memory>
+#include <unordered_map>
+
+namespace bstorm
+{
+class Env;
+// 定数式の畳み込みと定数伝播
+// NOTE: CodeAnalyzerの解析結果(到達可能性, 代入回数)を使うので, 解析後に実行すること
+class ConstantFolder : public NodeTraverser
+{
+public:
+    // 畳み込んだノードの数を返す
+    size_t Fold(Node& n);
+    void Traverse(NodeNum&) override;
+    void Traverse(NodeChar&) override;
+    void Traverse(NodeStr&) override;
+    void Traverse(NodeArray&) override;
+    void Traverse(NodeNeg&) override;
+    void Traverse(NodeNot&) override;
+    void Traverse(NodeAbs&) override;
+    void Traverse(NodeAdd&) override;
+    void Traverse(NodeSub&) override;
+    void Traverse(NodeMul&) override;
+    void Traverse(NodeDiv&) override;
+    void Traverse(NodeRem&) override;
+    void Traverse(NodePow&) override;
+    void Traverse(NodeLt&) override;
+    void Traverse(NodeGt&) override;
+    void Traverse(NodeLe&) override;
+    void Traverse(NodeGe&) override;
+    void Traverse(NodeEq&) override;
+    void Traverse(NodeNe&) override;
+    void Traverse(NodeAnd&) override;
+    void Traverse(NodeOr&) override;
+    void Traverse(NodeCat&) override;
+    void Traverse(NodeNoParenCallExp&) override;
+    void Traverse(NodeCallExp&) override;
+    void Traverse(NodeArrayRef&) override;
+    void Traverse(NodeRange&) override;
+    void Traverse(NodeArraySlice&) override;
+    void Traverse(NodeNop&) override;
+    void Traverse(NodeLeftVal&) override;
+    void Traverse(NodeAssign&) override;
+    void Traverse(NodeAddAssign&) override;
+    void Traverse(NodeSubAssign&) override;
+    void Traverse(NodeMulAssign&) override;
+    void Traverse(NodeDivAssign&) override;
+    void Traverse(NodeRemAssign&) override;
+    void Traverse(NodePowAssign&) override;
+    void Traverse(NodeCatAssign&) override;
+    void Traverse(NodeCallStmt&) override;
+    void Traverse(NodeReturn&) override;
+    void Traverse(NodeReturnVoid&) override;
+    void Traverse(NodeYield&) override;
+    void Traverse(NodeBreak&) override;
+    void Traverse(NodeSucc&) override;
+    void Traverse(NodePred&) override;
+    void Traverse(NodeVarDecl&) override;
+    void Traverse(NodeVarInit&) override;
+    void Traverse(NodeProcParam&) override;
+    void Traverse(NodeLoopParam&) override;
+    void Traverse(NodeResult&) override;
+    void Traverse(NodeBlock&) override;
+    void Traverse(NodeSubDef&) override;
+    void Traverse(NodeBuiltInSubDef&) override;
+    void Traverse(NodeFuncDef&) override;
+    void Traverse(NodeTaskDef&) override;
+    void Traverse(NodeBuiltInFunc&) override;
+    void Traverse(NodeConst&) override;
+    void Traverse(NodeLocal&) override;
+    void Traverse(NodeLoop&) override;
+    void Traverse(NodeTimes&) override;
+    void Traverse(NodeWhile&) override;
+    void Traverse(NodeAscent&) override;
+    void Traverse(NodeDescent&) override;
+    void Traverse(NodeElseIf&) override;
+    void Traverse(NodeIf&) override;
+    void Traverse(NodeCase&) override;
+    void Traverse(NodeAlternative&) override;
+    void Traverse(NodeHeader&) override;
+private:
+    std::shared_ptr<Env> env_;
+    // 一度しか代入されない定数初期化された変数
+    std::unordered_map<const NodeDef*, double> constVars_;
+    std::shared_ptr<NodeExp> folded_;
+    size_t foldedNodeCnt_ = 0;
+    void FoldExp(std::shared_ptr<NodeExp>& exp);
+    bool GetConstNum(const std::shared_ptr<NodeExp>& exp, double& x) const;
+    bool GetConstNum(const std::string& name, double& x) const;
+    void SetFolded(const NodeExp& src, double x);
+    void FoldMonoOp(NodeMonoOp& exp, double(*f)(double));
+    void FoldBinOp(NodeBinOp& exp, double(*f)(double, double));
+    void FoldIdentity(NodeBinOp& exp, double lhsIdentity, double rhsIdentity);
+    void FoldCall(NodeCallExp& call);
+    void FoldAssign(NodeAssign& stmt);
+    void FoldBlock(NodeBlock& blk);
+};
+}
\ No newline at end of file
@@ -0,0 +1,273 @@
+﻿#include <bstorm/intersection.hpp>
+
+#include <bstorm/dnh_const.hpp>
+#include <bstorm/obj_enemy.hpp>
+#include <bstorm/obj_shot.hpp>
+#include <bstorm/obj_item.hpp>
+#include <bstorm/obj_player.hpp>
+#include <bstorm/obj_spell.hpp>
+
+// 弾幕風の当たり判定の種類(ShotIntersection等)と衝突時の処理
+// オブジェクトに依存するので, 形状と衝突検出(intersection.cpp)とは分けている
+namespace bstorm
+{
+ShotIntersection::ShotIntersection(float x, float y, float r, const std::shared_ptr<ObjShot>& shot, bool isTmpIntersection) :
+    ShotIntersection(Shape(x, y, r), shot, isTmpIntersection)
+{
+}
+
+ShotIntersection::ShotIntersection(float x1, float y1, float x2, float y2, float width, const std::shared_ptr<ObjShot>& shot, bool isTmpIntersection) :
+    ShotIntersection(Shape(x1, y1, x2, y2, width), shot, isTmpIntersection)
+{
+}
+
+ShotIntersection::ShotIntersection(const Shape& shape, const std::shared_ptr<ObjShot>& shot, bool isTmpIntersection) :
+    Intersection(shape,
+                 shot->IsPlayerShot() ?
+                 (shot->IsEraseShotEnabled() ? COL_GRP_PLAYER_ERASE_SHOT : COL_GRP_PLAYER_NON_ERASE_SHOT) :
+                 COL_GRP_ENEMY_SHOT),
+    shot_(shot),
+    isPlayerShot_(shot->IsPlayerShot()),
+    isTmpIntersection_(isTmpIntersection)
+{
+}
+
+void ShotIntersection::SetEraseShotEnable(bool enable)
+{
+    ChangeCollisionGroup(enable ? COL_GRP_PLAYER_ERASE_SHOT : COL_GRP_PLAYER_NON_ERASE_SHOT);
+}
+
+EnemyIntersectionToShot::EnemyIntersectionToShot(float x, float y, float r, const std::shared_ptr<ObjEnemy>& enemy) :
+    Intersection(Shape(x, y, r), COL_GRP_ENEMY_TO_SHOT),
+    enemy_(enemy),
+    x_(x),
+    y_(y)
+{
+}
+
+EnemyIntersectionToPlayer::EnemyIntersectionToPlayer(float x, float y, float r, const std::shared_ptr<ObjEnemy>& enemy) :
+    Intersection(Shape(x, y, r), COL_GRP_ENEMY_TO_PLAYER),
+    enemy_(enemy)
+{
+}
+
+PlayerIntersection::PlayerIntersection(float x, float y, float r, const std::shared_ptr<ObjPlayer>& player) :
+    Intersection(Shape(x, y, r), COL_GRP_PLAYER),
+    player_(player)
+{
+}
+
+PlayerGrazeIntersection::PlayerGrazeIntersection(float x, float y, float r, const std::shared_ptr<ObjPlayer>& player) :
+    Intersection(Shape(x, y, r), COL_GRP_PLAYER_GRAZE),
+    player_(player)
+{
+}
+
+SpellIntersection::SpellIntersection(float x, float y, float r, const std::shared_ptr<ObjSpell>& spell) :
+    Intersection(Shape(x, y, r), COL_GRP_SPELL),
+    spell_(spell)
+{
+}
+
+SpellIntersection::SpellIntersection(float x1, float y1, float x2, float y2, float width, const std::shared_ptr<ObjSpell>& spell) :
+    Intersection(Shape(x1, y1, x2, y2, width), COL_GRP_SPELL),
+    spell_(spell)
+{
+}
+
+PlayerIntersectionToItem::PlayerIntersectionToItem(float x, float y, const std::shared_ptr<ObjPlayer>& player) :
+    Intersection(Shape(x, y, 0), COL_GRP_PLAYER_TO_ITEM),
+    player_(player)
+{
+}
+
+ItemIntersection::ItemIntersection(float x, float y, float r, const std::shared_ptr<ObjItem>& item) :
+    Intersection(Shape(x, y, r), COL_GRP_ITEM),
+    item_(item)
+{
+}
+
+TempEnemyShotIntersection::TempEnemyShotIntersection(float x, float y, float r) :
+    Intersection(Shape(x, y, r), COL_GRP_TEMP_ENEMY_SHOT)
+{
+}
+
+TempEnemyShotIntersection::TempEnemyShotIntersection(float x1, float y1, float x2, float y2, float width) :
+    Intersection(Shape(x1, y1, x2, y2, width), COL_GRP_TEMP_ENEMY_SHOT)
+{
+}
+
+static inline bool isShotIntersectionEnabled(const std::shared_ptr<ShotIntersection>& isect)
+{
+    if (auto shot = isect->GetShot().lock())
+    {
+        // Regist前でShotDataで元から設定されている当たり判定の時は衝突無効
+        if (!shot->IsRegistered() && !isect->IsTempIntersection()) return false;
+        // 判定が無効になっているとき、または遅延時は衝突無効
+        if (!shot->IsIntersectionEnabled() || shot->IsDelay()) return false;
+        return true;
+    }
+    return false;
+}
+
+static void collideEnemyShotWithPlayerEraseShot(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+{
+    auto playerShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect2);
+    if (auto playerShot = playerShotIsect->GetShot().lock())
+    {
+        if (playerShot->IsEraseShotEnabled())
+        {
+            auto enemyShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect1);
+            if (auto enemyShot = enemyShotIsect->GetShot().lock())
+            {
+                if (isShotIntersectionEnabled(enemyShotIsect) && isShotIntersectionEnabled(playerShotIsect))
+                {
+                    if (playerShot->GetType() == OBJ_SHOT)
+                    {
+                        playerShot->SetPenetration(playerShot->GetPenetration() - 1);
+                    }
+                    enemyShot->EraseWithSpell();
+                }
+            }
+        }
+    }
+}
+
+static void collideEnemyShotWithPlayer(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+{
+    auto enemyShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect1);
+    if (isShotIntersectionEnabled(enemyShotIsect))
+    {
+        if (auto enemyShot = enemyShotIsect->GetShot().lock())
+        {
+            if (auto player = std::dynamic_pointer_cast<PlayerIntersection>(isect2)->GetPlayer().lock())
+            {
+                player->Hit(enemyShot->GetID());
+            }
+        }
+    }
+}
+
+static void collideEnemyShotWithPlayerGraze(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+{
+    auto enemyShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect1);
+    if (isShotIntersectionEnabled(enemyShotIsect))
+    {
+        if (auto enemyShot = enemyShotIsect->GetShot().lock())
+        {
+            if (auto player = std::dynamic_pointer_cast<PlayerGrazeIntersection>(isect2)->GetPlayer().lock())
+            {
+                if (enemyShot->IsGrazeEnabled() && player->IsGrazeEnabled())
+                {
+                    player->GrazeToShot(enemyShot->GetID(), 1);
+                    enemyShot->Graze();
+                }
+            }
+        }
+    }
+}
+
+static void collideEnemyShotWithSpell(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+{
+    auto enemyShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect1);
+    if (auto spell = std::dynamic_pointer_cast<SpellIntersection>(isect2)->GetSpell().lock())
+    {
+        if (spell->IsEraseShotEnabled())
+        {
+            if (isShotIntersectionEnabled(enemyShotIsect))
+            {
+                if (auto enemyShot = enemyShotIsect->GetShot().lock())
+                {
+                    enemyShot->EraseWithSpell();
+                }
+            }
+        }
+    }
+}
+
+static void collidePlayerShotWithEnemyIntersectionToShot(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+{
+    auto playerShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect1);
+    auto enemyIsectToShot = std::dynamic_pointer_cast<EnemyIntersectionToShot>(isect2);
+    if (isShotIntersectionEnabled(playerShotIsect))
+    {
+        if (auto playerShot = playerShotIsect->GetShot().lock())
+        {
+            if (auto enemy = enemyIsectToShot->GetEnemy().lock())
+            {
+                if (playerShot->GetType() == OBJ_SHOT)
+                {
+                    playerShot->SetPenetration(playerShot->GetPenetration() - 1);
+                }
+                if (playerShot->IsSpellFactorEnabled())
+                {
+                    enemy->AddSpellDamage(playerShot->GetDamage());
+                } else
+                {
+                    enemy->AddShotDamage(playerShot->GetDamage());
+                }
+            }
+        }
+    }
+}
+
+static void collidePlayerWithEnemyIntersectionToPlayer(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+{
+    if (auto player = std::dynamic_pointer_cast<PlayerIntersection>(isect1)->GetPlayer().lock())
+    {
+        if (auto enemy = std::dynamic_pointer_cast<EnemyIntersectionToPlayer>(isect2)->GetEnemy().lock())
+        {
+            player->Hit(enemy->GetID());
+        }
+    }
+}
+
+static void collideEnemyIntersectionToShotWithSpell(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+{
+    if (auto enemy = std::dynamic_pointer_cast<EnemyIntersectionToShot>(isect1)->GetEnemy().lock())
+    {
+        if (auto spell = std::dynamic_pointer_cast<SpellIntersection>(isect2)->GetSpell().lock())
+        {
+            enemy->AddSpellDamage(spell->GetDamage());
+        }
+    }
+}
+
+static void collideWithPlayerToItemWithItem(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+{
+    if (auto player = std::dynamic_pointer_cast<PlayerIntersectionToItem>(isect1)->GetPlayer().lock())
+    {
+        if (auto item = std::dynamic_pointer_cast<ItemIntersection>(isect2)->GetItem().lock())
+        {
+            if (player->GetState() == STATE_NORMAL)
+            {
+                player->ObtainItem(item->GetID());
+                item->Obtained();
+            }
+        }
+    }
+}
+
+static void collidePlayerWithTempEnemyShot(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+{
+    if (auto player = std::dynamic_pointer_cast<PlayerIntersection>(isect1)->GetPlayer().lock())
+    {
+        player->Hit(ID_INVALID);
+    }
+}
+
+// col matrix
+const CollisionFunction DEFAULT_COLLISION_MATRIX[DEFAULT_COLLISION_MATRIX_DIMENSION * DEFAULT_COLLISION_MATRIX_DIMENSION] = {
+    /* COL_GRP_ENEMY_SHOT           */  nullptr, collideEnemyShotWithPlayerEraseShot, nullptr, collideEnemyShotWithPlayer, collideEnemyShotWithPlayerGraze, nullptr, nullptr, collideEnemyShotWithSpell, nullptr, nullptr, nullptr,
+    /* COL_GRP_PLAYER_ERASE_SHOT    */  nullptr, nullptr, nullptr, nullptr, nullptr, collidePlayerShotWithEnemyIntersectionToShot, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_PLAYER_NON_ERASESHOT */  nullptr, nullptr, nullptr, nullptr, nullptr, collidePlayerShotWithEnemyIntersectionToShot, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_PLAYER               */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, collidePlayerWithEnemyIntersectionToPlayer, nullptr, nullptr, nullptr, collidePlayerWithTempEnemyShot,
+    /* COL_GRP_PLAYER_GRAZE         */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_ENEMY_TO_SHOT        */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, collideEnemyIntersectionToShotWithSpell, nullptr, nullptr, nullptr,
+    /* COL_GRP_ENEMY_TO_PLAYER      */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_SPELL                */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_PLAYER_TO_ITEM       */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, collideWithPlayerToItemWithItem, nullptr,
+    /* COL_GRP_ITEM                 */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    /* COL_GRP_TEMP_ENEMY_SHOT      */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
+};
+}
\ No newline at end of file
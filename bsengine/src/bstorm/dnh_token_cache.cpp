@@ -0,0 +1,39 @@
+#include <bstorm/dnh_token_cache.hpp>
+
+namespace bstorm
+{
+std::shared_ptr<const DnhTokenFragment> DnhTokenCache::Get(const std::wstring & path, TimeStamp lastUpdateTime) const
+{
+    if (lastUpdateTime == TIME_STAMP_NONE) return nullptr;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = fragments_.find(path);
+    if (it == fragments_.end()) return nullptr;
+    if (it->second->lastUpdateTime != lastUpdateTime) return nullptr;
+    return it->second;
+}
+
+void DnhTokenCache::Put(const std::wstring & path, const std::shared_ptr<const DnhTokenFragment>& fragment)
+{
+    if (fragment->lastUpdateTime == TIME_STAMP_NONE) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    fragments_[path] = fragment;
+}
+
+void DnhTokenCache::Remove(const std::wstring & path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    fragments_.erase(path);
+}
+
+void DnhTokenCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    fragments_.clear();
+}
+
+size_t DnhTokenCache::GetFragmentCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fragments_.size();
+}
+}
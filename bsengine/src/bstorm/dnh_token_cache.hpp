@@ -0,0 +1,45 @@
+#pragma once
+
+#include <bstorm/time_stamp.hpp>
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+namespace bstorm
+{
+struct DnhToken
+{
+    int type;
+    std::string str;
+    std::wstring wstr;
+    wchar_t wchar;
+    int line;
+    int column;
+};
+
+// token sequence of one include file
+struct DnhTokenFragment
+{
+    TimeStamp lastUpdateTime;
+    std::vector<DnhToken> tokens;
+};
+
+// cache of lexed include files, shared between scripts.
+// thread-safe
+class DnhTokenCache
+{
+public:
+    // returns nullptr if not cached or file was updated
+    std::shared_ptr<const DnhTokenFragment> Get(const std::wstring& path, TimeStamp lastUpdateTime) const;
+    void Put(const std::wstring& path, const std::shared_ptr<const DnhTokenFragment>& fragment);
+    void Remove(const std::wstring& path);
+    void Clear();
+    size_t GetFragmentCount() const;
+private:
+    std::unordered_map<std::wstring, std::shared_ptr<const DnhTokenFragment>> fragments_;
+    mutable std::mutex mutex_;
+};
+}
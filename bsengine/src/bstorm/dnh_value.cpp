@@ -4,6 +4,16 @@
 
 namespace bstorm
 {
+// パックした文字列 {str = utf8文字列, len = 文字数} ならutf8文字列を返す
+// 形式はscript_runtime.luaのrl_strと合わせること
+static const char* GetPackedString(lua_State* L, int idx, size_t* size)
+{
+    lua_getfield(L, idx, "str");
+    const char* str = lua_type(L, -1) == LUA_TSTRING ? lua_tolstring(L, -1, size) : nullptr;
+    lua_pop(L, 1); // 文字列はテーブルから参照されているので解放されない
+    return str;
+}
+
 std::unique_ptr<DnhValue> DnhValue::Get(lua_State* L, int idx)
 {
     switch (lua_type(L, idx))
@@ -19,7 +29,30 @@ std::unique_ptr<DnhValue> DnhValue::Get(lua_State* L, int idx)
             return std::make_unique<DnhBool>((bool)lua_toboolean(L, idx));
         case LUA_TTABLE:
         {
+            size_t strSize;
+            if (const char* str = GetPackedString(L, idx, &strSize))
+            {
+                return std::make_unique<DnhString>(ToUnicode(std::string(str, strSize)));
+            }
             size_t size = lua_objlen(L, idx);
+            if (size != 0)
+            {
+                // 文字の配列ならutf8のまま繋げてから変換する
+                lua_rawgeti(L, idx, 1);
+                const bool isStr = lua_type(L, -1) == LUA_TSTRING;
+                lua_pop(L, 1);
+                if (isStr)
+                {
+                    std::string str;
+                    for (int i = 1; i <= size; i++)
+                    {
+                        lua_rawgeti(L, idx, i);
+                        if (const char* c = lua_tostring(L, -1)) str += c;
+                        lua_pop(L, 1);
+                    }
+                    return std::make_unique<DnhString>(ToUnicode(str));
+                }
+            }
             std::unique_ptr<DnhArray> arr = std::make_unique<DnhArray>(size);
             for (int i = 1; i <= size; i++)
             {
@@ -62,8 +95,33 @@ std::unique_ptr<DnhValue> DnhValue::Deserialize(std::istream& in)
         {
             uint32_t length;
             in.read((char*)&length, sizeof(length));
+            // 先頭から続くcharはDnhStringに読み込む
+            std::wstring str;
+            int i = 0;
+            for (; i < length; i++)
+            {
+                const auto pos = in.tellg();
+                uint32_t elemHeader;
+                in.read((char*)&elemHeader, sizeof(elemHeader));
+                if ((Type)elemHeader != Type::CHAR)
+                {
+                    in.seekg(pos);
+                    break;
+                }
+                wchar_t c;
+                in.read((char*)&c, sizeof(c));
+                str += c;
+            }
+            if (length != 0 && i == length)
+            {
+                return std::make_unique<DnhString>(std::move(str));
+            }
             auto arr = std::make_unique<DnhArray>((size_t)(length));
-            for (int i = 0; i < length; i++)
+            for (wchar_t c : str)
+            {
+                arr->PushBack(std::make_unique<DnhChar>(c));
+            }
+            for (; i < length; i++)
             {
                 arr->PushBack(DnhValue::Deserialize(in));
             }
@@ -147,7 +205,11 @@ bool DnhValue::ToBool(lua_State* L, int idx)
         case LUA_TBOOLEAN:
             return (bool)lua_toboolean(L, idx);
         case LUA_TTABLE:
+        {
+            size_t strSize;
+            if (GetPackedString(L, idx, &strSize)) return strSize != 0;
             return lua_objlen(L, idx) != 0;
+        }
         default:
             return false;
     }
@@ -155,6 +217,14 @@ bool DnhValue::ToBool(lua_State* L, int idx)
 
 std::wstring DnhValue::ToString(lua_State*L, int idx)
 {
+    if (lua_type(L, idx) == LUA_TTABLE)
+    {
+        size_t strSize;
+        if (const char* str = GetPackedString(L, idx, &strSize))
+        {
+            return ToUnicode(std::string(str, strSize));
+        }
+    }
     return DnhValue::Get(L, idx)->ToString();
 }
 
@@ -170,6 +240,11 @@ std::string DnhValue::ToStringU8(lua_State * L, int idx)
             return lua_toboolean(L, idx) ? "true" : "false";
         case LUA_TTABLE:
         {
+            size_t strSize;
+            if (const char* str = GetPackedString(L, idx, &strSize))
+            {
+                return std::string(str, strSize);
+            }
             const size_t size = lua_objlen(L, idx);
             if (size == 0) return "";
             lua_rawgeti(L, idx, 1);
@@ -197,6 +272,22 @@ std::string DnhValue::ToStringU8(lua_State * L, int idx)
     }
 }
 
+void DnhValue::PushString(lua_State* L, const std::wstring& s)
+{
+    std::string str = ToUTF8(s);
+    // rl_strと同じくutf8の継続バイト以外を数える
+    size_t len = 0;
+    for (unsigned char c : str)
+    {
+        if ((c & 0xc0) != 0x80) len++;
+    }
+    lua_createtable(L, 0, 2);
+    lua_pushlstring(L, str.c_str(), str.size());
+    lua_setfield(L, -2, "str");
+    lua_pushnumber(L, (lua_Number)len);
+    lua_setfield(L, -2, "len");
+}
+
 const std::unique_ptr<DnhValue>& DnhValue::Nil()
 {
     static std::unique_ptr<DnhValue> nil = std::make_unique<DnhNil>();
@@ -309,16 +400,6 @@ DnhArray::DnhArray(const std::vector<double>& rs) :
     }
 }
 
-DnhArray::DnhArray(const std::wstring & s) :
-    DnhValue(Type::ARRAY)
-{
-    Reserve(s.size());
-    for (wchar_t c : s)
-    {
-        PushBack(std::make_unique<DnhChar>(c));
-    }
-}
-
 DnhArray::DnhArray(const Point2D & p) :
     DnhValue(Type::ARRAY)
 {
@@ -377,6 +458,11 @@ const std::unique_ptr<DnhValue>& DnhArray::Index(int idx) const
 void DnhArray::Push(lua_State * L) const
 {
     size_t size = GetSize();
+    if (size != 0 && values_[0]->GetType() == Type::CHAR)
+    {
+        PushString(L, ToString());
+        return;
+    }
     lua_createtable(L, size, 0);
     for (size_t i = 0; i < size; i++)
     {
@@ -412,6 +498,65 @@ void DnhArray::Reserve(size_t size)
     values_.reserve(size);
 }
 
+DnhString::DnhString() :
+    DnhValue(Type::STRING)
+{
+}
+
+DnhString::DnhString(const std::wstring & s) :
+    DnhValue(Type::STRING),
+    value_(s)
+{
+}
+
+DnhString::DnhString(std::wstring && s) :
+    DnhValue(Type::STRING),
+    value_(std::move(s))
+{
+}
+
+size_t DnhString::GetSize() const { return value_.size(); }
+
+double DnhString::ToNum() const { return _wtof(value_.c_str()); }
+
+bool DnhString::ToBool() const { return !value_.empty(); }
+
+std::wstring DnhString::ToString() const { return value_; }
+
+wchar_t DnhString::Index(int idx) const
+{
+    if (idx < 0 || idx >= GetSize())
+    {
+        return L'\0';
+    }
+    return value_[idx];
+}
+
+void DnhString::Push(lua_State * L) const
+{
+    PushString(L, value_);
+}
+
+void DnhString::Serialize(std::ostream & out) const
+{
+    // 弾幕風と互換のある形式 (charの配列)
+    uint32_t header = (uint32_t)Type::ARRAY;
+    out.write((char*)&header, sizeof(header));
+    uint32_t length = GetSize();
+    out.write((char*)&length, sizeof(length));
+    const uint32_t charHeader = (uint32_t)Type::CHAR;
+    for (wchar_t c : value_)
+    {
+        out.write((char*)&charHeader, sizeof(charHeader));
+        out.write((char*)&c, sizeof(c));
+    }
+}
+
+std::unique_ptr<DnhValue> DnhString::Clone() const
+{
+    return std::make_unique<DnhString>(value_);
+}
+
 DnhNil::DnhNil() :
     DnhValue(Type::NIL)
 {
@@ -23,7 +23,8 @@ public:
         REAL_ARRAY = 0x77,
         UINT16_ARRAY = 0x88,
         INT64_ARRAY = 0x99,
-        NIL = 0xaa
+        NIL = 0xaa,
+        STRING = 0xbb // シリアライズ時はARRAY
     };
     DnhValue(Type t) : type_(t) {}
     virtual ~DnhValue() {};
@@ -42,6 +43,8 @@ public:
     static bool ToBool(lua_State* L, int idx);
     static std::wstring ToString(lua_State* L, int idx);
     static std::string ToStringU8(lua_State* L, int idx);
+    // パックした文字列としてLuaスタックに積む
+    static void PushString(lua_State* L, const std::wstring& s);
     static const std::unique_ptr<DnhValue>& Nil();
 private:
     const Type type_;
@@ -96,7 +99,6 @@ public:
     DnhArray(size_t reserveSize);
     DnhArray(std::vector<std::unique_ptr<DnhValue>>&& a);
     DnhArray(const std::vector<double>& rs);
-    DnhArray(const std::wstring& s);
     DnhArray(const Point2D& p);
     DnhArray(const std::vector<Point2D>& ps);
     size_t GetSize() const;
@@ -113,6 +115,28 @@ private:
     std::vector<std::unique_ptr<DnhValue>> values_;
 };
 
+// DnhString: 文字列
+// 文字ごとにDnhCharを作らずに連続したstd::wstringで持つ
+// シリアライズ時は弾幕風と同じcharの配列の形式で書き出す
+class DnhString : public DnhValue
+{
+public:
+    DnhString();
+    DnhString(const std::wstring& s);
+    DnhString(std::wstring&& s);
+    size_t GetSize() const;
+    double ToNum() const override;
+    bool ToBool() const override;
+    std::wstring ToString() const override;
+    wchar_t Index(int idx) const;
+    void Push(lua_State* L) const override;
+    void Serialize(std::ostream& out) const override;
+    std::unique_ptr<DnhValue> Clone() const override;
+    const std::wstring& GetValue() const { return value_; }
+private:
+    std::wstring value_;
+};
+
 class DnhNil : public DnhValue
 {
 public:
@@ -7,5 +7,9 @@ class EngineDevelopOptions
 public:
     bool renderIntersectionEnable = false;
     bool forcePlayerInvincibleEnable = false;
+    bool shotMoveBatchEnable = true;
+    int shotUpdateThreadCount = 1; // ShotMoveBatchのスレッド数, 0ならハードウェアのスレッド数
+    bool parallelCollisionEnable = false;
+    bool uniformGridBroadphaseEnable = false; // read at Package construction
 };
 }
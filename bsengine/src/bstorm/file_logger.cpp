@@ -1,5 +1,7 @@
 #include <bstorm/file_logger.hpp>
 
+#include <bstorm/file_util.hpp>
+
 #include <windows.h>
 
 namespace bstorm
@@ -7,7 +9,7 @@ namespace bstorm
 FileLogger::FileLogger(const std::wstring & filePath, const std::shared_ptr<Logger>& cc) :
     cc_(cc)
 {
-    file_.open(filePath, std::ios::app);
+    OpenFileStream(file_, filePath, std::ios::app);
     if (!file_.good())
     {
         throw Log(LogLevel::LV_ERROR)
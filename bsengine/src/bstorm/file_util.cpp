@@ -11,10 +11,11 @@ void MakeDirectoryP(const std::wstring& dirName)
 {
     auto attr = GetFileAttributes(dirName.c_str());
     if (attr != -1 && (attr & FILE_ATTRIBUTE_DIRECTORY)) return;
-    std::wstring dir = L"";
-    for (auto& name : Split(GetCanonicalPath(dirName), L'/'))
+    const auto path = GetCanonicalPath(dirName);
+    std::wstring dir = (!path.empty() && path[0] == L'/') ? L"/" : L"";
+    for (auto& name : Split(path, L'/'))
     {
-        if (name.empty()) break;
+        if (name.empty()) continue;
         dir += name + L"/";
         _wmkdir(dir.c_str());
     }
@@ -141,35 +142,38 @@ std::wstring GetCanonicalPath(const std::wstring& path)
     std::vector<std::wstring> trail; trail.reserve(16);
     {
         std::wstring tmp;
-        size_t i = 0;
-        for (; i < pathSize; ++i)
+        auto pushSegment = [&]()
+        {
+            if (tmp.empty())
+            {
+            } else if (tmp == L".")
+            {
+                // ignore
+                tmp.pop_back();
+            } else if (tmp == L"..")
+            {
+                if (trail.empty())
+                {
+                    trail.emplace_back(L"..");
+                } else
+                {
+                    trail.pop_back();
+                }
+                tmp.clear();
+            } else
+            {
+                trail.push_back(std::move(tmp));
+                tmp.clear();
+            }
+        };
+        for (size_t i = 0; i < pathSize; ++i)
         {
             const wchar_t& c = path[i];
             switch (c)
             {
                 case L'/':
                 case L'\\':
-separator:
-                    if (tmp.empty())
-                    {
-                    } else if (tmp == L".")
-                    {
-                        // ignore
-                        tmp.pop_back();
-                    } else if (tmp == L"..")
-                    {
-                        if (trail.empty())
-                        {
-                            trail.emplace_back(L"..");
-                        } else
-                        {
-                            trail.pop_back();
-                        }
-                        tmp.clear();
-                    } else
-                    {
-                        trail.push_back(std::move(tmp));
-                    }
+                    pushSegment();
                     break;
                 default:
                     tmp.push_back(c);
@@ -177,12 +181,18 @@ separator:
 
             }
         }
-
-        if (i == pathSize) goto separator; // end of string
+        pushSegment(); // end of string
     }
 
     // concat
     std::wstring ret; ret.reserve(pathSize + 1);
+#ifndef _WIN32
+    // 絶対パスは先頭の/を残す
+    if (!path.empty() && path[0] == L'/')
+    {
+        ret.push_back(L'/');
+    }
+#endif
     for (const auto& s : trail)
     {
         ret += s;
@@ -1,15 +1,29 @@
 ﻿#pragma once
 
+#include <bstorm/string_util.hpp>
+
 #include <string>
 #include <vector>
 #include <string>
 #include <unordered_set>
+#include <ios>
 
 namespace bstorm
 {
 // mkdir -p
 void MakeDirectoryP(const std::wstring& dirName);
 
+// ワイド文字列のパスでfstreamを開く, MSVC以外ではUTF-8のパスとして開く
+template <class FileStream>
+void OpenFileStream(FileStream& stream, const std::wstring& path, std::ios::openmode mode)
+{
+#ifdef _MSC_VER
+    stream.open(path, mode);
+#else
+    stream.open(ToUTF8(path), mode);
+#endif
+}
+
 std::wstring GetExt(const std::wstring& path);
 std::wstring GetLowerExt(const std::wstring& path);
 std::wstring GetStem(const std::wstring& path);
@@ -84,6 +84,18 @@ void GraphicDevice::SwitchRenderTargetToBackBuffer()
     d3DDevice_->SetDepthStencilSurface(backBufferDepthStencilSurface_);
 }
 
+void GraphicDevice::ClearRenderTarget(D3DCOLOR color)
+{
+    d3DDevice_->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, color, 1.0f, 0);
+}
+
+bool GraphicDevice::IsPixelShaderSupported(int major, int minor) const
+{
+    D3DCAPS9 caps;
+    d3DDevice_->GetDeviceCaps(&caps);
+    return caps.PixelShaderVersion >= D3DPS_VERSION(major, minor);
+}
+
 DWORD GraphicDevice::GetBackBufferWidth() const
 {
     return presentParams_.BackBufferWidth;
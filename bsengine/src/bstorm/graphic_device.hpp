@@ -15,6 +15,9 @@ public:
     void Reset();
     IDirect3DDevice9* GetDevice() const;
     void SwitchRenderTargetToBackBuffer();
+    // 現在の描画先と深度バッファを消去する
+    void ClearRenderTarget(D3DCOLOR color);
+    bool IsPixelShaderSupported(int major, int minor) const;
     DWORD GetBackBufferWidth() const;
     DWORD GetBackBufferHeight() const;
 private:
@@ -0,0 +1,497 @@
+﻿#include <bstorm/inliner.hpp>
+
+#include <bstorm/env.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <typeinfo>
+
+namespace bstorm
+{
+// 名前の解決方法
+// 置き換え先の式をsubstに入れる. 展開できない名前ならfalseを返す
+using NameResolver = std::function<bool(const std::string& name, std::shared_ptr<NodeExp>& subst)>;
+
+static std::shared_ptr<NodeExp> CloneExp(const NodeExp& exp, const NameResolver& resolve);
+
+static bool CloneExps(const std::vector<std::shared_ptr<NodeExp>>& exps, const NameResolver& resolve, std::vector<std::shared_ptr<NodeExp>>& clones)
+{
+    for (const auto& exp : exps)
+    {
+        auto clone = CloneExp(*exp, resolve);
+        if (!clone) return false;
+        clones.push_back(clone);
+    }
+    return true;
+}
+
+template <class T>
+static std::shared_ptr<NodeExp> CloneMonoOp(const NodeExp& exp, const NameResolver& resolve)
+{
+    auto rhs = CloneExp(*static_cast<const T&>(exp).rhs, resolve);
+    if (!rhs) return nullptr;
+    return std::make_shared<T>(rhs);
+}
+
+template <class T>
+static std::shared_ptr<NodeExp> CloneBinOp(const NodeExp& exp, const NameResolver& resolve)
+{
+    auto lhs = CloneExp(*static_cast<const T&>(exp).lhs, resolve);
+    if (!lhs) return nullptr;
+    auto rhs = CloneExp(*static_cast<const T&>(exp).rhs, resolve);
+    if (!rhs) return nullptr;
+    return std::make_shared<T>(lhs, rhs);
+}
+
+static std::shared_ptr<NodeExp> CloneExpNode(const NodeExp& exp, const NameResolver& resolve)
+{
+    const auto& type = typeid(exp);
+    if (type == typeid(NodeNum)) return std::make_shared<NodeNum>(std::string(static_cast<const NodeNum&>(exp).number));
+    if (type == typeid(NodeChar)) return std::make_shared<NodeChar>(static_cast<const NodeChar&>(exp).c);
+    if (type == typeid(NodeStr)) return std::make_shared<NodeStr>(std::wstring(static_cast<const NodeStr&>(exp).str));
+    if (type == typeid(NodeArray))
+    {
+        std::vector<std::shared_ptr<NodeExp>> elems;
+        if (!CloneExps(static_cast<const NodeArray&>(exp).elems, resolve, elems)) return nullptr;
+        return std::make_shared<NodeArray>(std::move(elems));
+    }
+    if (type == typeid(NodeNeg)) return CloneMonoOp<NodeNeg>(exp, resolve);
+    if (type == typeid(NodeNot)) return CloneMonoOp<NodeNot>(exp, resolve);
+    if (type == typeid(NodeAbs)) return CloneMonoOp<NodeAbs>(exp, resolve);
+    if (type == typeid(NodeAdd)) return CloneBinOp<NodeAdd>(exp, resolve);
+    if (type == typeid(NodeSub)) return CloneBinOp<NodeSub>(exp, resolve);
+    if (type == typeid(NodeMul)) return CloneBinOp<NodeMul>(exp, resolve);
+    if (type == typeid(NodeDiv)) return CloneBinOp<NodeDiv>(exp, resolve);
+    if (type == typeid(NodeRem)) return CloneBinOp<NodeRem>(exp, resolve);
+    if (type == typeid(NodePow)) return CloneBinOp<NodePow>(exp, resolve);
+    if (type == typeid(NodeLt)) return CloneBinOp<NodeLt>(exp, resolve);
+    if (type == typeid(NodeGt)) return CloneBinOp<NodeGt>(exp, resolve);
+    if (type == typeid(NodeLe)) return CloneBinOp<NodeLe>(exp, resolve);
+    if (type == typeid(NodeGe)) return CloneBinOp<NodeGe>(exp, resolve);
+    if (type == typeid(NodeEq)) return CloneBinOp<NodeEq>(exp, resolve);
+    if (type == typeid(NodeNe)) return CloneBinOp<NodeNe>(exp, resolve);
+    if (type == typeid(NodeAnd)) return CloneBinOp<NodeAnd>(exp, resolve);
+    if (type == typeid(NodeOr)) return CloneBinOp<NodeOr>(exp, resolve);
+    if (type == typeid(NodeCat)) return CloneBinOp<NodeCat>(exp, resolve);
+    if (type == typeid(NodeNoParenCallExp))
+    {
+        const auto& name = static_cast<const NodeNoParenCallExp&>(exp).name;
+        std::shared_ptr<NodeExp> subst;
+        if (!resolve(name, subst)) return nullptr;
+        if (subst) return CloneExp(*subst, [](const std::string&, std::shared_ptr<NodeExp>&) { return true; });
+        return std::make_shared<NodeNoParenCallExp>(name);
+    }
+    if (type == typeid(NodeCallExp))
+    {
+        const auto& call = static_cast<const NodeCallExp&>(exp);
+        std::shared_ptr<NodeExp> subst;
+        if (!resolve(call.name, subst) || subst) return nullptr;
+        std::vector<std::shared_ptr<NodeExp>> args;
+        if (!CloneExps(call.args, resolve, args)) return nullptr;
+        return std::make_shared<NodeCallExp>(call.name, std::move(args));
+    }
+    if (type == typeid(NodeArrayRef))
+    {
+        const auto& ref = static_cast<const NodeArrayRef&>(exp);
+        auto array = CloneExp(*ref.array, resolve);
+        if (!array) return nullptr;
+        auto idx = CloneExp(*ref.idx, resolve);
+        if (!idx) return nullptr;
+        return std::make_shared<NodeArrayRef>(array, idx);
+    }
+    if (type == typeid(NodeArraySlice))
+    {
+        const auto& slice = static_cast<const NodeArraySlice&>(exp);
+        auto array = CloneExp(*slice.array, resolve);
+        if (!array) return nullptr;
+        auto start = CloneExp(*slice.range->start, resolve);
+        if (!start) return nullptr;
+        auto end = CloneExp(*slice.range->end, resolve);
+        if (!end) return nullptr;
+        auto range = std::make_shared<NodeRange>(start, end);
+        range->srcPos = slice.range->srcPos;
+        return std::make_shared<NodeArraySlice>(array, range);
+    }
+    return nullptr;
+}
+
+static std::shared_ptr<NodeExp> CloneExp(const NodeExp& exp, const NameResolver& resolve)
+{
+    auto clone = CloneExpNode(exp, resolve);
+    if (clone && !clone->srcPos)
+    {
+        clone->srcPos = exp.srcPos;
+    }
+    return clone;
+}
+
+// 変数と定数以外の名前の参照(=関数呼び出し)を含むか
+static bool ContainsCall(const NodeExp& exp, const Env& env)
+{
+    bool hasCall = false;
+    CloneExp(exp, [&](const std::string& name, std::shared_ptr<NodeExp>&)
+    {
+        auto def = env.FindDef(name);
+        if (!def->IsVariable() && !std::dynamic_pointer_cast<NodeConst>(def)) hasCall = true;
+        return true;
+    });
+    return hasCall;
+}
+
+static int CountNodes(const NodeExp& exp)
+{
+    if (auto arr = dynamic_cast<const NodeArray*>(&exp))
+    {
+        int cnt = 1;
+        for (const auto& elem : arr->elems) cnt += CountNodes(*elem);
+        return cnt;
+    }
+    if (auto op = dynamic_cast<const NodeMonoOp*>(&exp)) return 1 + CountNodes(*op->rhs);
+    if (auto op = dynamic_cast<const NodeBinOp*>(&exp)) return 1 + CountNodes(*op->lhs) + CountNodes(*op->rhs);
+    if (auto call = dynamic_cast<const NodeCallExp*>(&exp))
+    {
+        int cnt = 1;
+        for (const auto& arg : call->args) cnt += CountNodes(*arg);
+        return cnt;
+    }
+    if (auto ref = dynamic_cast<const NodeArrayRef*>(&exp)) return 1 + CountNodes(*ref->array) + CountNodes(*ref->idx);
+    if (auto slice = dynamic_cast<const NodeArraySlice*>(&exp)) return 1 + CountNodes(*slice->array) + CountNodes(*slice->range->start) + CountNodes(*slice->range->end);
+    return 1;
+}
+
+Inliner::Inliner(int costLimit) :
+    costLimit_(costLimit)
+{
+}
+
+void Inliner::Inline(Node & n)
+{
+    env_ = nullptr;
+    inlined_ = nullptr;
+    candidates_.clear();
+    visitingFuncs_.clear();
+    reports_.clear();
+    n.Traverse(*this);
+}
+void Inliner::Traverse(NodeNum &) {}
+void Inliner::Traverse(NodeChar &) {}
+void Inliner::Traverse(NodeStr &) {}
+void Inliner::Traverse(NodeArray & arr)
+{
+    for (auto& elem : arr.elems) { InlineExp(elem); }
+}
+void Inliner::Traverse(NodeNeg & exp) { InlineMonoOp(exp); }
+void Inliner::Traverse(NodeNot & exp) { InlineMonoOp(exp); }
+void Inliner::Traverse(NodeAbs & exp) { InlineMonoOp(exp); }
+void Inliner::Traverse(NodeAdd & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeSub & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeMul & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeDiv & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeRem & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodePow & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeLt & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeGt & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeLe & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeGe & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeEq & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeNe & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeAnd & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeOr & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeCat & exp) { InlineBinOp(exp); }
+void Inliner::Traverse(NodeNoParenCallExp & call)
+{
+    std::vector<std::shared_ptr<NodeExp>> noArgs;
+    InlineCall(call, call.name, noArgs);
+}
+void Inliner::Traverse(NodeCallExp & call)
+{
+    for (auto& arg : call.args) { InlineExp(arg); }
+    InlineCall(call, call.name, call.args);
+}
+void Inliner::Traverse(NodeArrayRef & exp)
+{
+    InlineExp(exp.array);
+    InlineExp(exp.idx);
+}
+void Inliner::Traverse(NodeRange & range)
+{
+    InlineExp(range.start);
+    InlineExp(range.end);
+}
+void Inliner::Traverse(NodeArraySlice & exp)
+{
+    InlineExp(exp.array);
+    exp.range->Traverse(*this);
+}
+void Inliner::Traverse(NodeNop &) {}
+void Inliner::Traverse(NodeLeftVal & left)
+{
+    for (auto& idx : left.indices) { InlineExp(idx); }
+}
+void Inliner::Traverse(NodeAssign & stmt) { InlineAssign(stmt); }
+void Inliner::Traverse(NodeAddAssign & stmt) { InlineAssign(stmt); }
+void Inliner::Traverse(NodeSubAssign & stmt) { InlineAssign(stmt); }
+void Inliner::Traverse(NodeMulAssign & stmt) { InlineAssign(stmt); }
+void Inliner::Traverse(NodeDivAssign & stmt) { InlineAssign(stmt); }
+void Inliner::Traverse(NodeRemAssign & stmt) { InlineAssign(stmt); }
+void Inliner::Traverse(NodePowAssign & stmt) { InlineAssign(stmt); }
+void Inliner::Traverse(NodeCatAssign & stmt) { InlineAssign(stmt); }
+void Inliner::Traverse(NodeCallStmt & call)
+{
+    for (auto& arg : call.args) { InlineExp(arg); }
+}
+void Inliner::Traverse(NodeReturn & stmt) { InlineExp(stmt.ret); }
+void Inliner::Traverse(NodeReturnVoid &) {}
+void Inliner::Traverse(NodeYield &) {}
+void Inliner::Traverse(NodeBreak &) {}
+void Inliner::Traverse(NodeSucc & stmt) { stmt.lhs->Traverse(*this); }
+void Inliner::Traverse(NodePred & stmt) { stmt.lhs->Traverse(*this); }
+void Inliner::Traverse(NodeVarDecl &) {}
+void Inliner::Traverse(NodeVarInit & stmt) { InlineExp(stmt.rhs); }
+void Inliner::Traverse(NodeProcParam &) {}
+void Inliner::Traverse(NodeLoopParam &) {}
+void Inliner::Traverse(NodeResult &) {}
+void Inliner::Traverse(NodeBlock & blk) { InlineBlock(blk); }
+void Inliner::Traverse(NodeSubDef & def) { def.block->Traverse(*this); }
+void Inliner::Traverse(NodeBuiltInSubDef & def) { def.block->Traverse(*this); }
+void Inliner::Traverse(NodeFuncDef & def) { def.block->Traverse(*this); }
+void Inliner::Traverse(NodeTaskDef & def) { def.block->Traverse(*this); }
+void Inliner::Traverse(NodeBuiltInFunc &) {}
+void Inliner::Traverse(NodeConst &) {}
+void Inliner::Traverse(NodeLocal & stmt) { stmt.block->Traverse(*this); }
+void Inliner::Traverse(NodeLoop & stmt) { stmt.block->Traverse(*this); }
+void Inliner::Traverse(NodeTimes & stmt)
+{
+    InlineExp(stmt.cnt);
+    stmt.block->Traverse(*this);
+}
+void Inliner::Traverse(NodeWhile & stmt)
+{
+    InlineExp(stmt.cond);
+    stmt.block->Traverse(*this);
+}
+void Inliner::Traverse(NodeAscent & stmt)
+{
+    stmt.range->Traverse(*this);
+    stmt.block->Traverse(*this);
+}
+void Inliner::Traverse(NodeDescent & stmt)
+{
+    stmt.range->Traverse(*this);
+    stmt.block->Traverse(*this);
+}
+void Inliner::Traverse(NodeElseIf & elsif)
+{
+    InlineExp(elsif.cond);
+    elsif.block->Traverse(*this);
+}
+void Inliner::Traverse(NodeIf & stmt)
+{
+    InlineExp(stmt.cond);
+    stmt.thenBlock->Traverse(*this);
+    for (auto& elsif : stmt.elsifs) elsif->Traverse(*this);
+    if (stmt.elseBlock) stmt.elseBlock->Traverse(*this);
+}
+void Inliner::Traverse(NodeCase & c)
+{
+    for (auto& exp : c.exps) { InlineExp(exp); }
+    c.block->Traverse(*this);
+}
+void Inliner::Traverse(NodeAlternative & stmt)
+{
+    InlineExp(stmt.cond);
+    for (auto& c : stmt.cases) c->Traverse(*this);
+    if (stmt.others) stmt.others->Traverse(*this);
+}
+void Inliner::Traverse(NodeHeader &) {}
+
+void Inliner::InlineExp(std::shared_ptr<NodeExp>& exp)
+{
+    inlined_ = nullptr;
+    exp->Traverse(*this);
+    if (inlined_)
+    {
+        exp = inlined_;
+        inlined_ = nullptr;
+    }
+}
+void Inliner::InlineCall(const NodeExp & call, const std::string & name, std::vector<std::shared_ptr<NodeExp>>& args)
+{
+    auto candidate = GetCandidate(name);
+    if (!candidate) return;
+
+    // 引数の評価回数と評価順が変わっても結果が同じか, コストに見合うか
+    // 展開すると引数は本体の中で使われる位置で評価され, 使われない引数は評価されなくなる
+    int cost = candidate->cost;
+    for (int i = 0; i < args.size(); i++)
+    {
+        const auto& arg = *args[i];
+        const int useCnt = candidate->paramUseCnts[i];
+        bool isVarRef = false;
+        if (auto ref = dynamic_cast<const NodeNoParenCallExp*>(&arg))
+        {
+            auto def = env_->FindDef(ref->name);
+            isVarRef = def->IsVariable() || std::dynamic_pointer_cast<NodeConst>(def);
+        }
+        bool isLiteral = dynamic_cast<const NodeNum*>(&arg) || dynamic_cast<const NodeChar*>(&arg);
+        if (isVarRef || isLiteral)
+        {
+            if (useCnt > 1) cost += (useCnt - 1) * CountNodes(arg);
+            continue;
+        }
+        // 複雑な式は複製も省略もしない
+        if (useCnt != 1) return;
+        // 副作用があり得る式は, 他の引数や本体との評価順が変わるので展開しない
+        if (ContainsCall(arg, *env_)) return;
+    }
+    if (cost > costLimit_) return;
+
+    auto inlined = CloneBody(*candidate->body, *candidate, args);
+    if (!inlined) return;
+    // 生成コードの行は呼び出し元の位置に対応付ける
+    inlined->srcPos = call.srcPos;
+    inlined_ = inlined;
+
+    if (candidate->reportIdx >= reports_.size())
+    {
+        candidate->reportIdx = reports_.size();
+        reports_.push_back(InlineReport{ candidate->def->name, candidate->cost, 0 });
+    }
+    reports_[candidate->reportIdx].callSiteCnt++;
+}
+std::shared_ptr<Inliner::Candidate> Inliner::GetCandidate(const std::string & name)
+{
+    auto func = std::dynamic_pointer_cast<NodeFuncDef>(env_->FindDef(name));
+    if (!func) return nullptr;
+
+    auto it = candidates_.find(func.get());
+    if (it != candidates_.end()) return it->second;
+
+    // 再帰呼び出し
+    if (visitingFuncs_.count(func.get()) != 0) return nullptr;
+
+    auto defEnv = env_;
+    while (defEnv->GetCurrentBlockNameTable()->count(name) == 0)
+    {
+        defEnv = defEnv->GetParent();
+    }
+
+    // 本体の中の呼び出しを先に展開しておく
+    visitingFuncs_.insert(func.get());
+    auto prevEnv = env_;
+    env_ = defEnv;
+    func->block->Traverse(*this);
+    env_ = prevEnv;
+    visitingFuncs_.erase(func.get());
+
+    std::shared_ptr<Candidate> candidate;
+    const auto& blk = *func->block;
+    if (blk.stmts.size() == 1)
+    {
+        if (auto ret = std::dynamic_pointer_cast<NodeReturn>(blk.stmts[0]))
+        {
+            bool hasLocalDef = false;
+            for (const auto& bind : *blk.nameTable)
+            {
+                if (!std::dynamic_pointer_cast<NodeProcParam>(bind.second) && !std::dynamic_pointer_cast<NodeResult>(bind.second))
+                {
+                    hasLocalDef = true;
+                }
+            }
+            if (!hasLocalDef)
+            {
+                candidate = std::make_shared<Candidate>();
+                candidate->def = func;
+                candidate->bodyEnv = std::make_shared<Env>(blk.nameTable, defEnv);
+                candidate->body = ret->ret;
+                candidate->paramUseCnts.resize(func->params.size(), 0);
+                candidate->cost = CountNodes(*ret->ret);
+                candidate->reportIdx = SIZE_MAX;
+                if (candidate->cost > costLimit_ || !AnalyzeBody(*ret->ret, *candidate->bodyEnv, *func, *candidate))
+                {
+                    candidate = nullptr;
+                }
+            }
+        }
+    }
+    candidates_[func.get()] = candidate;
+    return candidate;
+}
+bool Inliner::AnalyzeBody(const NodeExp & exp, const Env & bodyEnv, const NodeFuncDef & func, Candidate & candidate) const
+{
+    bool inlinable = true;
+    auto clone = CloneExp(exp, [&](const std::string& name, std::shared_ptr<NodeExp>&)
+    {
+        auto def = bodyEnv.FindDef(name);
+        if (std::dynamic_pointer_cast<NodeProcParam>(def) && func.block->nameTable->count(name) != 0)
+        {
+            for (int i = 0; i < func.params.size(); i++)
+            {
+                if (func.params[i] == name) candidate.paramUseCnts[i]++;
+            }
+            return true;
+        }
+        // 呼び出し位置によって値が変わる
+        if (name == "GetCurrentScriptDirectory") inlinable = false;
+        // ユーザ定義関数の呼び出しとresultの参照は展開しない
+        if (std::dynamic_pointer_cast<NodeBuiltInFunc>(def) || std::dynamic_pointer_cast<NodeConst>(def)) return true;
+        if (def->IsVariable() && !std::dynamic_pointer_cast<NodeResult>(def)) return true;
+        inlinable = false;
+        return true;
+    });
+    return clone && inlinable;
+}
+std::shared_ptr<NodeExp> Inliner::CloneBody(const NodeExp & exp, const Candidate & candidate, const std::vector<std::shared_ptr<NodeExp>>& args) const
+{
+    const auto& func = *candidate.def;
+    return CloneExp(exp, [&](const std::string& name, std::shared_ptr<NodeExp>& subst)
+    {
+        if (func.block->nameTable->count(name) != 0)
+        {
+            for (int i = 0; i < func.params.size(); i++)
+            {
+                if (func.params[i] == name)
+                {
+                    subst = args[i];
+                    return true;
+                }
+            }
+        }
+        // 呼び出し位置から同じ定義が見えていなければ展開しない
+        return candidate.bodyEnv->FindDef(name) == env_->FindDef(name);
+    });
+}
+void Inliner::InlineMonoOp(NodeMonoOp & exp)
+{
+    InlineExp(exp.rhs);
+}
+void Inliner::InlineBinOp(NodeBinOp & exp)
+{
+    InlineExp(exp.lhs);
+    InlineExp(exp.rhs);
+}
+void Inliner::InlineAssign(NodeAssign & stmt)
+{
+    stmt.lhs->Traverse(*this);
+    InlineExp(stmt.rhs);
+}
+void Inliner::InlineBlock(NodeBlock & blk)
+{
+    env_ = std::make_shared<Env>(blk.nameTable, env_);
+    for (auto& bind : *(blk.nameTable))
+    {
+        if (std::dynamic_pointer_cast<NodeFuncDef>(bind.second))
+        {
+            GetCandidate(bind.first);
+        } else
+        {
+            bind.second->Traverse(*this);
+        }
+    }
+    for (auto& stmt : blk.stmts)
+    {
+        stmt->Traverse(*this);
+    }
+    env_ = env_->GetParent();
+}
+}
\ No newline at end of file
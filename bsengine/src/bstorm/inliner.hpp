@@ -0,0 +1,129 @@
+﻿#pragma once
+
+#include <bstorm/node.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace bstorm
+{
+// インライン展開する関数本体のコストの上限
+constexpr int DEFAULT_INLINE_COST_LIMIT = 20;
+
+struct InlineReport
+{
+    std::string funcName;
+    int cost;
+    int callSiteCnt;
+};
+
+class Env;
+// 小さな関数のインライン展開
+// 対象: 本体が return e; だけで, e がユーザ定義関数を呼ばない関数
+// (再帰やyieldを含む関数は自然に対象外になる. subとtaskは値を返さないので対象外)
+// 副作用があり得る引数を渡す呼び出しは展開しない
+// NOTE: CodeAnalyzerより前に実行すること
+class Inliner : public NodeTraverser
+{
+public:
+    Inliner(int costLimit = DEFAULT_INLINE_COST_LIMIT);
+    void Inline(Node& n);
+    const std::vector<InlineReport>& GetReports() const { return reports_; }
+    void Traverse(NodeNum&) override;
+    void Traverse(NodeChar&) override;
+    void Traverse(NodeStr&) override;
+    void Traverse(NodeArray&) override;
+    void Traverse(NodeNeg&) override;
+    void Traverse(NodeNot&) override;
+    void Traverse(NodeAbs&) override;
+    void Traverse(NodeAdd&) override;
+    void Traverse(NodeSub&) override;
+    void Traverse(NodeMul&) override;
+    void Traverse(NodeDiv&) override;
+    void Traverse(NodeRem&) override;
+    void Traverse(NodePow&) override;
+    void Traverse(NodeLt&) override;
+    void Traverse(NodeGt&) override;
+    void Traverse(NodeLe&) override;
+    void Traverse(NodeGe&) override;
+    void Traverse(NodeEq&) override;
+    void Traverse(NodeNe&) override;
+    void Traverse(NodeAnd&) override;
+    void Traverse(NodeOr&) override;
+    void Traverse(NodeCat&) override;
+    void Traverse(NodeNoParenCallExp&) override;
+    void Traverse(NodeCallExp&) override;
+    void Traverse(NodeArrayRef&) override;
+    void Traverse(NodeRange&) override;
+    void Traverse(NodeArraySlice&) override;
+    void Traverse(NodeNop&) override;
+    void Traverse(NodeLeftVal&) override;
+    void Traverse(NodeAssign&) override;
+    void Traverse(NodeAddAssign&) override;
+    void Traverse(NodeSubAssign&) override;
+    void Traverse(NodeMulAssign&) override;
+    void Traverse(NodeDivAssign&) override;
+    void Traverse(NodeRemAssign&) override;
+    void Traverse(NodePowAssign&) override;
+    void Traverse(NodeCatAssign&) override;
+    void Traverse(NodeCallStmt&) override;
+    void Traverse(NodeReturn&) override;
+    void Traverse(NodeReturnVoid&) override;
+    void Traverse(NodeYield&) override;
+    void Traverse(NodeBreak&) override;
+    void Traverse(NodeSucc&) override;
+    void Traverse(NodePred&) override;
+    void Traverse(NodeVarDecl&) override;
+    void Traverse(NodeVarInit&) override;
+    void Traverse(NodeProcParam&) override;
+    void Traverse(NodeLoopParam&) override;
+    void Traverse(NodeResult&) override;
+    void Traverse(NodeBlock&) override;
+    void Traverse(NodeSubDef&) override;
+    void Traverse(NodeBuiltInSubDef&) override;
+    void Traverse(NodeFuncDef&) override;
+    void Traverse(NodeTaskDef&) override;
+    void Traverse(NodeBuiltInFunc&) override;
+    void Traverse(NodeConst&) override;
+    void Traverse(NodeLocal&) override;
+    void Traverse(NodeLoop&) override;
+    void Traverse(NodeTimes&) override;
+    void Traverse(NodeWhile&) override;
+    void Traverse(NodeAscent&) override;
+    void Traverse(NodeDescent&) override;
+    void Traverse(NodeElseIf&) override;
+    void Traverse(NodeIf&) override;
+    void Traverse(NodeCase&) override;
+    void Traverse(NodeAlternative&) override;
+    void Traverse(NodeHeader&) override;
+private:
+    struct Candidate
+    {
+        std::shared_ptr<NodeFuncDef> def;
+        std::shared_ptr<Env> bodyEnv;
+        std::shared_ptr<NodeExp> body;
+        std::vector<int> paramUseCnts;
+        int cost;
+        size_t reportIdx;
+    };
+    const int costLimit_;
+    std::shared_ptr<Env> env_;
+    std::shared_ptr<NodeExp> inlined_;
+    // nullptr: 展開不可
+    std::unordered_map<const NodeFuncDef*, std::shared_ptr<Candidate>> candidates_;
+    std::unordered_set<const NodeFuncDef*> visitingFuncs_;
+    std::vector<InlineReport> reports_;
+    void InlineExp(std::shared_ptr<NodeExp>& exp);
+    void InlineCall(const NodeExp& call, const std::string& name, std::vector<std::shared_ptr<NodeExp>>& args);
+    std::shared_ptr<Candidate> GetCandidate(const std::string& name);
+    bool AnalyzeBody(const NodeExp& exp, const Env& bodyEnv, const NodeFuncDef& func, Candidate& candidate) const;
+    std::shared_ptr<NodeExp> CloneBody(const NodeExp& exp, const Candidate& candidate, const std::vector<std::shared_ptr<NodeExp>>& args) const;
+    void InlineMonoOp(NodeMonoOp& exp);
+    void InlineBinOp(NodeBinOp& exp);
+    void InlineAssign(NodeAssign& stmt);
+    void InlineBlock(NodeBlock& blk);
+};
+}
\ No newline at end of file
@@ -1,45 +1,23 @@
 ﻿#include <bstorm/intersection.hpp>
 
-#include <bstorm/dnh_const.hpp>
-#include <bstorm/point2D.hpp>
-#include <bstorm/vertex.hpp>
-#include <bstorm/math_util.hpp>
+#include <bstorm/broadphase.hpp>
 #include <bstorm/ptr_util.hpp>
-#include <bstorm/dx_util.hpp>
-#include <bstorm/renderer.hpp>
-#include <bstorm/obj_enemy.hpp>
-#include <bstorm/obj_shot.hpp>
-#include <bstorm/obj_item.hpp>
-#include <bstorm/obj_player.hpp>
-#include <bstorm/obj_spell.hpp>
-
-#include <array>
+
 #include <deque>
 #include <algorithm>
-#include <d3dx9.h>
 #include <cassert>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BSTORM_CIRCLE_BATCH_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace bstorm
 {
 
-// Rect = std::array<Point2D, 4>
-// 頂点の順番は以下の通り ([0] = (x1, y1), [2] = (x2, y2)
-// [0] - [1]
-//  |     |
-// [3] - [2]
-
-static std::array<Point2D, 4> LineToRect(float x1, float y1, float x2, float y2, float width)
-{
-    const float halfWidth = width / 2.0f;
-    const float normalDir = atan2(y2 - y1, x2 - x1) + D3DX_PI / 2.0f;
-    const float dx = halfWidth * cos(normalDir);
-    const float dy = halfWidth * sin(normalDir);
-    return std::array<Point2D, 4>{Point2D(x1 + dx, y1 + dy),
-        Point2D(x1 - dx, y1 - dy),
-        Point2D(x2 - dx, y2 - dy),
-        Point2D(x2 + dx, y2 + dy)};
-}
-
 BoundingBox::BoundingBox() :
     left_(0.0f),
     top_(0.0f),
@@ -61,102 +39,61 @@ bool BoundingBox::IsIntersected(const BoundingBox& other) const
     return left_ <= other.right_ && top_ <= other.bottom_ && other.left_ <= right_ && other.top_ <= bottom_;
 }
 
-// 外積
-static inline float cross2(float x1, float y1, float x2, float y2)
-{
-    return x1 * y2 - x2 * y1;
-}
-
-// 内積
-static inline float dot2(float x1, float y1, float x2, float y2)
-{
-    return x1 * x2 + y1 * y2;
-}
-
-// 線分と線分の交差判定
-static bool IsIntersectedSegmentSegment(const Point2D& a, const Point2D& b, const Point2D& c, const Point2D& d)
-{
-    // x : cross
-    // * : multiply
-    // check
-    // AC x DC * BC x DC <= 0 && AC x AB * AD x AB <= 0
-
-    float acX = c.x - a.x;
-    float acY = c.y - a.y;
-    float abX = b.x - a.x;
-    float abY = b.y - a.y;
-    float adX = d.x - a.x;
-    float adY = d.y - a.y;
-    float bcX = c.x - b.x;
-    float bcY = c.y - b.y;
-    float dcX = c.x - d.x;
-    float dcY = c.y - d.y;
-    float cp1 = cross2(acX, acY, dcX, dcY);
-    float cp2 = cross2(bcX, bcY, dcX, dcY);
-    float cp3 = cross2(acX, acY, abX, abY);
-    float cp4 = cross2(adX, adY, abX, abY);
-
-    return cp1 * cp2 <= 0.0f && cp3 * cp4 <= 0.0f;
-}
-
-// 点が矩形内にあるかどうか判定
-static bool IsPointInRect(const Point2D& p, const std::array<Point2D, 4>& rect)
-{
-    const Point2D& a = rect[0];
-    const Point2D& b = rect[1];
-    const Point2D& c = rect[2];
-    const Point2D& d = rect[3];
-    float apX = p.x - a.x;
-    float apY = p.y - a.y;
-    float abX = b.x - a.x;
-    float abY = b.y - a.y;
-    float bpX = p.x - b.x;
-    float bpY = p.y - b.y;
-    float bcX = c.x - b.x;
-    float bcY = c.y - b.y;
-    float cpX = p.x - c.x;
-    float cpY = p.y - c.y;
-    float cdX = d.x - c.x;
-    float cdY = d.y - c.y;
-    float dpX = p.x - d.x;
-    float dpY = p.y - d.y;
-    float daX = a.x - d.x;
-    float daY = a.y - d.y;
-    float cp1 = cross2(apX, apY, abX, abY);
-    float cp2 = cross2(bpX, bpY, bcX, bcY);
-    float cp3 = cross2(cpX, cpY, cdX, cdY);
-    float cp4 = cross2(dpX, dpY, daX, daY);
-    // 全て負なら矩形内に含まれる
-    // 矩形は必ず時計回りなので全て正の場合を調べる必要はない
-    return cp1 <= 0.0f && cp2 <= 0.0f && cp3 <= 0.0f && cp4 <= 0.0f;
-}
-
-static bool IsIntersectedCircleSegment(float cx, float cy, float r, const Point2D& a, const Point2D& b)
-{
-    float abX = b.x - a.x;
-    float abY = b.y - a.y;
-    float acX = cx - a.x;
-    float acY = cy - a.y;
-    float bcX = cx - b.x;
-    float bcY = cy - b.y;
-    // d : 円の中心からABを通る直線への垂線の長さ
-    float d = abs(cross2(abX, abY, acX, acY)) / std::hypotf(abX, abY);
-    if (d > r) return false;
-    if (dot2(abX, abY, acX, acY) * dot2(abX, abY, bcX, bcY) <= 0.0f) return true;
-    return std::hypotf(acX, acY) <= r || std::hypotf(bcX, bcY) <= r;
+OrientedRect LineToOrientedRect(float x1, float y1, float x2, float y2, float width)
+{
+    const float dx = x2 - x1;
+    const float dy = y2 - y1;
+    const float length = std::sqrt(dx * dx + dy * dy);
+    OrientedRect rect;
+    rect.centerX = (x1 + x2) / 2.0f;
+    rect.centerY = (y1 + y2) / 2.0f;
+    if (length > 0.0f)
+    {
+        rect.axisX = dx / length;
+        rect.axisY = dy / length;
+    } else
+    {
+        // 長さ0の場合はx軸の向きとする (atan2(0, 0) = 0)
+        rect.axisX = 1.0f;
+        rect.axisY = 0.0f;
+    }
+    rect.halfLength = length / 2.0f;
+    rect.halfWidth = std::abs(width) / 2.0f;
+    return rect;
+}
+
+bool IsIntersectedOrientedRectCircle(const OrientedRect& rect, float cx, float cy, float r)
+{
+    // 円の中心を矩形の座標系に移し、矩形内の最も近い点との距離を調べる
+    const float px = cx - rect.centerX;
+    const float py = cy - rect.centerY;
+    const float u = px * rect.axisX + py * rect.axisY;
+    const float v = py * rect.axisX - px * rect.axisY;
+    const float du = std::max(std::abs(u) - rect.halfLength, 0.0f);
+    const float dv = std::max(std::abs(v) - rect.halfWidth, 0.0f);
+    return du * du + dv * dv <= r * r;
+}
+
+bool IsIntersectedOrientedRects(const OrientedRect& rect1, const OrientedRect& rect2)
+{
+    // 分離軸判定
+    // 軸の候補は両方の矩形の長さ方向と幅方向
+    const float dx = rect2.centerX - rect1.centerX;
+    const float dy = rect2.centerY - rect1.centerY;
+    // 長さ方向同士のなす角のcos, sin
+    const float c = std::abs(rect1.axisX * rect2.axisX + rect1.axisY * rect2.axisY);
+    const float s = std::abs(rect1.axisX * rect2.axisY - rect1.axisY * rect2.axisX);
+    if (std::abs(dx * rect1.axisX + dy * rect1.axisY) > rect1.halfLength + rect2.halfLength * c + rect2.halfWidth * s) return false;
+    if (std::abs(dy * rect1.axisX - dx * rect1.axisY) > rect1.halfWidth + rect2.halfLength * s + rect2.halfWidth * c) return false;
+    if (std::abs(dx * rect2.axisX + dy * rect2.axisY) > rect2.halfLength + rect1.halfLength * c + rect1.halfWidth * s) return false;
+    if (std::abs(dy * rect2.axisX - dx * rect2.axisY) > rect2.halfWidth + rect1.halfLength * s + rect1.halfWidth * c) return false;
+    return true;
 }
 
 // 弾幕風のLine = Rect
 bool IsIntersectedLineCircle(float x1, float y1, float x2, float y2, float width, float cx, float cy, float r)
 {
-    const auto rect = LineToRect(x1, y1, x2, y2, width);
-    // 円が矩形の辺と交わっている場合
-    for (int i = 0; i < 4; i++)
-    {
-        if (IsIntersectedCircleSegment(cx, cy, r, rect[i], rect[(i + 1) & 3])) return true;
-    }
-    // 円が矩形に入っている場合
-    return IsPointInRect(Point2D(cx, cy), rect);
+    return IsIntersectedOrientedRectCircle(LineToOrientedRect(x1, y1, x2, y2, width), cx, cy, r);
 }
 
 Shape::Shape(float x, float y, float r) :
@@ -176,6 +113,21 @@ Shape::Shape(float x1, float y1, float x2, float y2, float width) :
     params_.Rect.x2 = x2;
     params_.Rect.y2 = y2;
     params_.Rect.width = width;
+    params_.Rect.orientedRect = LineToOrientedRect(x1, y1, x2, y2, width);
+    UpdateBoundingBox();
+}
+
+Shape::Shape(int circleCnt, const float* xs, const float* ys, const float* rs) :
+    type_(Type::CIRCLES)
+{
+    assert(circleCnt >= 1 && circleCnt <= MaxCompoundCircleCount);
+    for (int i = 0; i < circleCnt; i++)
+    {
+        params_.Circles.x[i] = xs[i];
+        params_.Circles.y[i] = ys[i];
+        params_.Circles.r[i] = rs[i];
+    }
+    params_.Circles.count = circleCnt;
     UpdateBoundingBox();
 }
 
@@ -187,6 +139,69 @@ bool Shape::IsIntersected(const Shape& other) const
         return false;
     }
 
+    if (type_ == Type::CIRCLES)
+    {
+        // 円ごとに調べる
+        for (int i = 0; i < params_.Circles.count; i++)
+        {
+            if (GetCompoundCircleShape(i).IsIntersected(other)) return true;
+        }
+        return false;
+    } else if (other.type_ == Type::CIRCLES)
+    {
+        return other.IsIntersected(*this);
+    }
+    return IsIntersectedPrimitive(other);
+}
+
+int Shape::CountIntersections(const Shape& other) const
+{
+    if (!boundingBox_.IsIntersected(other.boundingBox_)) return 0;
+
+    if (type_ == Type::CIRCLES)
+    {
+        int cnt = 0;
+        for (int i = 0; i < params_.Circles.count; i++)
+        {
+            cnt += GetCompoundCircleShape(i).CountIntersections(other);
+        }
+        return cnt;
+    } else if (other.type_ == Type::CIRCLES)
+    {
+        return other.CountIntersections(*this);
+    }
+    return IsIntersectedPrimitive(other) ? 1 : 0;
+}
+
+float Shape::GetDistance(float x, float y) const
+{
+    if (type_ == Type::CIRCLE)
+    {
+        const float dx = x - params_.Circle.x;
+        const float dy = y - params_.Circle.y;
+        return std::max(std::sqrt(dx * dx + dy * dy) - params_.Circle.r, 0.0f);
+    } else if (type_ == Type::RECT)
+    {
+        // 点を矩形の座標系に移し、矩形内の最も近い点との距離を求める
+        const OrientedRect& rect = params_.Rect.orientedRect;
+        const float px = x - rect.centerX;
+        const float py = y - rect.centerY;
+        const float u = px * rect.axisX + py * rect.axisY;
+        const float v = py * rect.axisX - px * rect.axisY;
+        const float du = std::max(std::abs(u) - rect.halfLength, 0.0f);
+        const float dv = std::max(std::abs(v) - rect.halfWidth, 0.0f);
+        return std::sqrt(du * du + dv * dv);
+    }
+    float dist = GetCompoundCircleShape(0).GetDistance(x, y);
+    for (int i = 1; i < params_.Circles.count; i++)
+    {
+        dist = std::min(dist, GetCompoundCircleShape(i).GetDistance(x, y));
+    }
+    return dist;
+}
+
+bool Shape::IsIntersectedPrimitive(const Shape& other) const
+{
     if (type_ == Type::CIRCLE && other.type_ == Type::CIRCLE)
     {
         // 円と円
@@ -197,42 +212,15 @@ bool Shape::IsIntersected(const Shape& other) const
     } else if (type_ == Type::CIRCLE && other.type_ == Type::RECT)
     {
         // 円と矩形
-        float x1 = other.params_.Rect.x1;
-        float y1 = other.params_.Rect.y1;
-        float x2 = other.params_.Rect.x2;
-        float y2 = other.params_.Rect.y2;
-        float width = other.params_.Rect.width;
-        float cx = params_.Circle.x;
-        float cy = params_.Circle.y;
-        float r = params_.Circle.r;
-        return IsIntersectedLineCircle(x1, y1, x2, y2, width, cx, cy, r);
+        return IsIntersectedOrientedRectCircle(other.params_.Rect.orientedRect, params_.Circle.x, params_.Circle.y, params_.Circle.r);
     } else if (type_ == Type::RECT && other.type_ == Type::CIRCLE)
     {
         // 円と矩形
-        float x1 = params_.Rect.x1;
-        float y1 = params_.Rect.y1;
-        float x2 = params_.Rect.x2;
-        float y2 = params_.Rect.y2;
-        float width = params_.Rect.width;
-        float cx = other.params_.Circle.x;
-        float cy = other.params_.Circle.y;
-        float r = other.params_.Circle.r;
-        return IsIntersectedLineCircle(x1, y1, x2, y2, width, cx, cy, r);
+        return IsIntersectedOrientedRectCircle(params_.Rect.orientedRect, other.params_.Circle.x, other.params_.Circle.y, other.params_.Circle.r);
     } else if (type_ == Type::RECT && other.type_ == Type::RECT)
     {
         // 矩形と矩形
-        const auto rect1 = LineToRect(params_.Rect.x1, params_.Rect.y1, params_.Rect.x2, params_.Rect.y2, params_.Rect.width);
-        const auto rect2 = LineToRect(other.params_.Rect.x1, other.params_.Rect.y1, other.params_.Rect.x2, other.params_.Rect.y2, other.params_.Rect.width);
-        // 辺同士が交わってる場合
-        for (int i = 0; i < 4; i++)
-        {
-            for (int j = 0; j < 4; j++)
-            {
-                if (IsIntersectedSegmentSegment(rect1[i], rect1[(i + 1) & 3], rect2[j], rect2[(j + 1) & 3])) return true;
-            }
-        }
-        // 矩形が片方の矩形に完全に含まれる場合
-        return IsPointInRect(rect1[0], rect2) || IsPointInRect(rect2[0], rect1);
+        return IsIntersectedOrientedRects(params_.Rect.orientedRect, other.params_.Rect.orientedRect);
     }
     return false;
 }
@@ -252,6 +240,16 @@ void Shape::Trans(float dx, float dy)
     {
         params_.Rect.x1 += dx; params_.Rect.x2 += dx;
         params_.Rect.y1 += dy; params_.Rect.y2 += dy;
+        // 向きと大きさは変わらない
+        params_.Rect.orientedRect.centerX += dx;
+        params_.Rect.orientedRect.centerY += dy;
+    } else if (type_ == Type::CIRCLES)
+    {
+        for (int i = 0; i < params_.Circles.count; i++)
+        {
+            params_.Circles.x[i] += dx;
+            params_.Circles.y[i] += dy;
+        }
     }
     TransBoundingBox(dx, dy);
 }
@@ -265,6 +263,14 @@ void Shape::SetWidth(float width)
     } else if (type_ == Type::RECT)
     {
         params_.Rect.width = width;
+        params_.Rect.orientedRect.halfWidth = width / 2.0f;
+    } else if (type_ == Type::CIRCLES)
+    {
+        // 円を別々の判定にした場合と同じく全ての円の半径を変える
+        for (int i = 0; i < params_.Circles.count; i++)
+        {
+            params_.Circles.r[i] = width / 2.0f;
+        }
     }
     UpdateBoundingBox();
 }
@@ -290,6 +296,23 @@ void Shape::GetRect(float & x1, float & y1, float & x2, float & y2, float & widt
     width = params_.Rect.width;
 }
 
+int Shape::GetCompoundCircleCount() const
+{
+    return params_.Circles.count;
+}
+
+void Shape::GetCompoundCircle(int idx, float & x, float & y, float & r) const
+{
+    x = params_.Circles.x[idx];
+    y = params_.Circles.y[idx];
+    r = params_.Circles.r[idx];
+}
+
+Shape Shape::GetCompoundCircleShape(int idx) const
+{
+    return Shape(params_.Circles.x[idx], params_.Circles.y[idx], params_.Circles.r[idx]);
+}
+
 void Shape::UpdateBoundingBox()
 {
     if (type_ == Type::CIRCLE)
@@ -300,24 +323,25 @@ void Shape::UpdateBoundingBox()
         boundingBox_.bottom_ = params_.Circle.y + params_.Circle.r;
     } else if (type_ == Type::RECT)
     {
-        const auto rect = LineToRect(params_.Rect.x1, params_.Rect.y1, params_.Rect.x2, params_.Rect.y2, params_.Rect.width);
-        float minX = rect[0].x;
-        float maxX = minX;
-        float minY = rect[0].y;
-        float maxY = minY;
-        for (int i = 1; i < 4; i++)
+        const auto& rect = params_.Rect.orientedRect;
+        const float halfExtentX = std::abs(rect.axisX) * rect.halfLength + std::abs(rect.axisY) * rect.halfWidth;
+        const float halfExtentY = std::abs(rect.axisY) * rect.halfLength + std::abs(rect.axisX) * rect.halfWidth;
+        boundingBox_.left_ = rect.centerX - halfExtentX;
+        boundingBox_.top_ = rect.centerY - halfExtentY;
+        boundingBox_.right_ = rect.centerX + halfExtentX;
+        boundingBox_.bottom_ = rect.centerY + halfExtentY;
+    } else if (type_ == Type::CIRCLES)
+    {
+        // 全ての円のBBを含むBB
+        boundingBox_ = GetCompoundCircleShape(0).GetBoundingBox();
+        for (int i = 1; i < params_.Circles.count; i++)
         {
-            float x = rect[i].x;
-            minX = std::min(minX, x);
-            maxX = std::max(maxX, x);
-            float y = rect[i].y;
-            minY = std::min(minY, y);
-            maxY = std::max(maxY, y);
+            const BoundingBox bb = GetCompoundCircleShape(i).GetBoundingBox();
+            boundingBox_.left_ = std::min(boundingBox_.left_, bb.left_);
+            boundingBox_.top_ = std::min(boundingBox_.top_, bb.top_);
+            boundingBox_.right_ = std::max(boundingBox_.right_, bb.right_);
+            boundingBox_.bottom_ = std::max(boundingBox_.bottom_, bb.bottom_);
         }
-        boundingBox_.left_ = minX;
-        boundingBox_.top_ = minY;
-        boundingBox_.right_ = maxX;
-        boundingBox_.bottom_ = maxY;
     }
 }
 
@@ -329,6 +353,126 @@ void Shape::TransBoundingBox(float dx, float dy)
     boundingBox_.bottom_ += dy;
 }
 
+void CircleBatch::Clear()
+{
+    Resize(0);
+}
+
+void CircleBatch::Resize(size_t size)
+{
+    left.resize(size);
+    top.resize(size);
+    right.resize(size);
+    bottom.resize(size);
+    x.resize(size);
+    y.resize(size);
+    r.resize(size);
+    ids.resize(size);
+}
+
+void CircleBatch::Push(const BoundingBox& boundingBox, float cx, float cy, float cr, uint32_t id)
+{
+    left.push_back(boundingBox.left_);
+    top.push_back(boundingBox.top_);
+    right.push_back(boundingBox.right_);
+    bottom.push_back(boundingBox.bottom_);
+    x.push_back(cx);
+    y.push_back(cy);
+    r.push_back(cr);
+    ids.push_back(id);
+}
+
+void CircleBatch::Append(const CircleBatch& other)
+{
+    left.insert(left.end(), other.left.begin(), other.left.end());
+    top.insert(top.end(), other.top.begin(), other.top.end());
+    right.insert(right.end(), other.right.begin(), other.right.end());
+    bottom.insert(bottom.end(), other.bottom.begin(), other.bottom.end());
+    x.insert(x.end(), other.x.begin(), other.x.end());
+    y.insert(y.end(), other.y.begin(), other.y.end());
+    r.insert(r.end(), other.r.begin(), other.r.end());
+    ids.insert(ids.end(), other.ids.begin(), other.ids.end());
+}
+
+size_t IntersectCircleBatch(const BoundingBox& boundingBox, float x, float y, float r, const CircleBatch& batch, size_t begin, size_t end, uint32_t* hitIndices)
+{
+    size_t hitCnt = 0;
+    size_t i = begin;
+    // Shape::IsIntersectedと同じく、バウンディングボックスの判定の後に dx * dx + dy * dy <= d * d で判定する
+    // 積和をFMAにまとめると結果が変わるので、乗算と加算は分けて行う
+#if defined(__AVX__)
+    const __m256 l1 = _mm256_set1_ps(boundingBox.left_);
+    const __m256 t1 = _mm256_set1_ps(boundingBox.top_);
+    const __m256 r1 = _mm256_set1_ps(boundingBox.right_);
+    const __m256 b1 = _mm256_set1_ps(boundingBox.bottom_);
+    const __m256 x1 = _mm256_set1_ps(x);
+    const __m256 y1 = _mm256_set1_ps(y);
+    const __m256 cr1 = _mm256_set1_ps(r);
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(l1, _mm256_loadu_ps(&batch.right[i]), _CMP_LE_OQ),
+                                   _mm256_cmp_ps(t1, _mm256_loadu_ps(&batch.bottom[i]), _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_loadu_ps(&batch.left[i]), r1, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_loadu_ps(&batch.top[i]), b1, _CMP_LE_OQ));
+        const __m256 dx = _mm256_sub_ps(x1, _mm256_loadu_ps(&batch.x[i]));
+        const __m256 dy = _mm256_sub_ps(y1, _mm256_loadu_ps(&batch.y[i]));
+        const __m256 d = _mm256_add_ps(cr1, _mm256_loadu_ps(&batch.r[i]));
+        const __m256 distSq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(distSq, _mm256_mul_ps(d, d), _CMP_LE_OQ));
+        int mask = _mm256_movemask_ps(hit);
+        while (mask != 0)
+        {
+            int k = 0;
+            while (((mask >> k) & 1) == 0) k++;
+            mask &= ~(1 << k);
+            hitIndices[hitCnt++] = (uint32_t)(i + k);
+        }
+    }
+#elif defined(BSTORM_CIRCLE_BATCH_SSE2)
+    const __m128 l1 = _mm_set1_ps(boundingBox.left_);
+    const __m128 t1 = _mm_set1_ps(boundingBox.top_);
+    const __m128 r1 = _mm_set1_ps(boundingBox.right_);
+    const __m128 b1 = _mm_set1_ps(boundingBox.bottom_);
+    const __m128 x1 = _mm_set1_ps(x);
+    const __m128 y1 = _mm_set1_ps(y);
+    const __m128 cr1 = _mm_set1_ps(r);
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 hit = _mm_and_ps(_mm_cmple_ps(l1, _mm_loadu_ps(&batch.right[i])),
+                                _mm_cmple_ps(t1, _mm_loadu_ps(&batch.bottom[i])));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_loadu_ps(&batch.left[i]), r1));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_loadu_ps(&batch.top[i]), b1));
+        const __m128 dx = _mm_sub_ps(x1, _mm_loadu_ps(&batch.x[i]));
+        const __m128 dy = _mm_sub_ps(y1, _mm_loadu_ps(&batch.y[i]));
+        const __m128 d = _mm_add_ps(cr1, _mm_loadu_ps(&batch.r[i]));
+        const __m128 distSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(distSq, _mm_mul_ps(d, d)));
+        int mask = _mm_movemask_ps(hit);
+        while (mask != 0)
+        {
+            int k = 0;
+            while (((mask >> k) & 1) == 0) k++;
+            mask &= ~(1 << k);
+            hitIndices[hitCnt++] = (uint32_t)(i + k);
+        }
+    }
+#endif
+    for (; i < end; i++)
+    {
+        if (boundingBox.left_ <= batch.right[i] && boundingBox.top_ <= batch.bottom[i] && batch.left[i] <= boundingBox.right_ && batch.top[i] <= boundingBox.bottom_)
+        {
+            const float dx = x - batch.x[i];
+            const float dy = y - batch.y[i];
+            const float d = r + batch.r[i];
+            if (dx * dx + dy * dy <= d * d)
+            {
+                hitIndices[hitCnt++] = (uint32_t)i;
+            }
+        }
+    }
+    return hitCnt;
+}
+
 CollisionMatrix::CollisionMatrix(int dim, const CollisionFunction * mat) :
     dimension_(dim)
 {
@@ -378,7 +522,7 @@ bool CollisionMatrix::IsCollidable(CollisionGroup group1, CollisionGroup group2)
 Intersection::Intersection(const Shape& shape, CollisionGroup colGroup) :
     shape_(shape),
     colGroup_(colGroup),
-    treeIdx_(-1)
+    slotIdx_(-1)
 {
     assert(colGroup_ >= 0);
 }
@@ -400,31 +544,20 @@ const Shape & Intersection::GetShape() const
     return shape_;
 }
 
-int Intersection::GetTreeIndex() const
-{
-    return treeIdx_;
-}
-
 const std::deque<std::weak_ptr<Intersection>>& Intersection::GetCollideIntersections() const
 {
     return collideIsects_;
 }
 
-static inline int CalcTreeIndex(int level, int morton)
+CollisionDetector::CollisionDetector(int fieldWidth, int fieldHeight, const std::shared_ptr<CollisionMatrix>& colMatrix) :
+    CollisionDetector(std::make_shared<QuadTreeBroadphase>(fieldWidth, fieldHeight), colMatrix)
 {
-    return ((1 << (level << 1)) - 1) / 3 + morton;
 }
 
-CollisionDetector::CollisionDetector(int fieldWidth, int fieldHeight, const std::shared_ptr<CollisionMatrix>& colMatrix) :
-    fieldWidth_((float)fieldWidth),
-    fieldHeight_((float)fieldHeight),
-    unitCellWidth_(1.0f * fieldWidth / (1 << MaxLevel)),
-    unitCellHeight_(1.0f * fieldHeight / (1 << MaxLevel)),
+CollisionDetector::CollisionDetector(const std::shared_ptr<Broadphase>& broadphase, const std::shared_ptr<CollisionMatrix>& colMatrix) :
+    broadphase_(broadphase),
     colMatrix_(colMatrix)
 {
-    assert(fieldWidth_ >= 0.0f);
-    assert(fieldHeight_ >= 0.0f);
-    assert(MaxLevel >= 0);
 }
 
 CollisionDetector::~CollisionDetector()
@@ -433,28 +566,17 @@ CollisionDetector::~CollisionDetector()
 
 void CollisionDetector::Add(const std::shared_ptr<Intersection>& isect)
 {
-    if (isect->treeIdx_ >= 0)
-    {
-        Remove(isect);
-    }
-    isect->treeIdx_ = CalcTreeIndexFromBoundingBox(isect->shape_.GetBoundingBox());
-    auto& cell = quadTree_[isect->treeIdx_];
-    isect->posInCell_ = cell.insert(cell.end(), isect);
+    broadphase_->Add(isect);
 }
 
 void CollisionDetector::Remove(const std::shared_ptr<Intersection>& isect)
 {
-    if (isect->treeIdx_ >= 0)
-    {
-        isect->posInCell_->reset();
-        isect->treeIdx_ = -1;
-    }
+    broadphase_->Remove(isect);
 }
 
 void CollisionDetector::Update(const std::shared_ptr<Intersection>& isect)
 {
-    Remove(isect);
-    Add(isect);
+    broadphase_->Update(isect);
 }
 
 void CollisionDetector::Trans(const std::shared_ptr<Intersection>& isect, float dx, float dy)
@@ -469,471 +591,94 @@ void CollisionDetector::SetWidth(const std::shared_ptr<Intersection>& isect, flo
     Update(isect);
 }
 
-std::deque<std::shared_ptr<Intersection>> CollisionDetector::GetIntersectionsCollideWithIntersection(const std::shared_ptr<Intersection>& self, CollisionGroup targetGroup) const
+std::deque<std::shared_ptr<Intersection>> CollisionDetector::GetIntersectionsCollideWithIntersection(const std::shared_ptr<Intersection>& self, int targetGroup) const
 {
     std::deque<std::shared_ptr<Intersection>> ret;
     const CollisionGroup group1 = self->GetCollisionGroup();
-
-    // 幅優先探索
-    const int startTreeIndex = self->GetTreeIndex();
-    std::deque<int> treeIndices;
-    treeIndices.push_back(startTreeIndex);
-    while (!treeIndices.empty())
-    {
-        const int treeIdx = treeIndices.front();
-        treeIndices.pop_front();
-        for (const auto& p : quadTree_.at(treeIdx))
-        {
-            if (auto other = p.lock())
-            {
-                const CollisionGroup group2 = other->GetCollisionGroup();
-                // ターゲットグループでないなら無視
-                if (targetGroup >= 0 && group2 != targetGroup) continue;
-                // 衝突しないグループ同士なら無視
-                if (!colMatrix_->IsCollidable(group1, group2)) continue;
-                if (self->IsIntersected(other))
-                {
-                    ret.push_back(other);
-                }
-            }
-        }
-        // 下位レベル
-        if (treeIdx >= startTreeIndex)
-        {
-            int lowLevelNode1 = (treeIdx << 2) + 1;
-            if (lowLevelNode1 < quadTree_.size())
-            {
-                treeIndices.push_back(lowLevelNode1);
-                treeIndices.push_back(lowLevelNode1 + 1);
-                treeIndices.push_back(lowLevelNode1 + 2);
-                treeIndices.push_back(lowLevelNode1 + 3);
-            }
-        }
-        // 上位レベル
-        if (treeIdx <= startTreeIndex)
+    broadphase_->ForEachCandidate(self->GetShape().GetBoundingBox(), [&](const std::shared_ptr<Intersection>& other)
+    {
+        const CollisionGroup group2 = other->GetCollisionGroup();
+        // ターゲットグループでないなら無視
+        if (targetGroup >= 0 && group2 != targetGroup) return;
+        // 衝突しないグループ同士なら無視
+        if (!colMatrix_->IsCollidable(group1, group2)) return;
+        if (self->IsIntersected(other))
         {
-            if (treeIdx != 0)
-            {
-                treeIndices.push_back(((treeIdx - 1) >> 2));
-            }
+            ret.push_back(other);
         }
-    }
+    });
     return ret;
 }
 
-std::deque<std::shared_ptr<Intersection>> CollisionDetector::GetIntersectionsCollideWithShape(const Shape & self, CollisionGroup targetGroup) const
+std::deque<std::shared_ptr<Intersection>> CollisionDetector::GetIntersectionsCollideWithShape(const Shape & self, int targetGroup) const
 {
     std::deque<std::shared_ptr<Intersection>> ret;
-
-    // 幅優先探索
-    const int startTreeIndex = CalcTreeIndexFromBoundingBox(self.GetBoundingBox());
-    std::deque<int> treeIndices;
-    treeIndices.push_back(startTreeIndex);
-    while (!treeIndices.empty())
+    ForEachIntersectionCollideWithShape(self, targetGroup, [&](const std::shared_ptr<Intersection>& other)
     {
-        const int treeIdx = treeIndices.front();
-        treeIndices.pop_front();
-        for (const auto& p : quadTree_.at(treeIdx))
-        {
-            if (auto other = p.lock())
-            {
-                // ターゲットグループでないなら無視
-                if (targetGroup >= 0 && other->GetCollisionGroup() != targetGroup) continue;
-                if (self.IsIntersected(other->shape_)) ret.push_back(other);
-            }
-        }
-        // 下位レベル
-        if (treeIdx >= startTreeIndex)
-        {
-            int lowLevelNode1 = (treeIdx << 2) + 1;
-            if (lowLevelNode1 < quadTree_.size())
-            {
-                treeIndices.push_back(lowLevelNode1);
-                treeIndices.push_back(lowLevelNode1 + 1);
-                treeIndices.push_back(lowLevelNode1 + 2);
-                treeIndices.push_back(lowLevelNode1 + 3);
-            }
-        }
-        // 上位レベル
-        if (treeIdx <= startTreeIndex)
-        {
-            if (treeIdx != 0)
-            {
-                treeIndices.push_back(((treeIdx - 1) >> 2));
-            }
-        }
-    }
+        ret.push_back(other);
+    });
     return ret;
 }
 
-void CollisionDetector::TestAllCollision()
-{
-    static std::unique_ptr<VisitedIsects[]> visitedIsects(new VisitedIsects[colMatrix_->GetDimension()], std::default_delete<VisitedIsects[]>());
-    TestNodeCollision(0, visitedIsects.get());
-}
-
-// 指定したノードの上位と下位にある全当たり判定のペアに対して衝突検査を行う
-// treeIdx: ノード番号
-// visitedIsects: 上位レベルのノードか、このノードで既に発見された当たり判定
-//                shared_ptrをそのまま格納するとコピーのコストが重いので、weak_ptrの場所を示す生ポインタを保持
-//                visitedに追加されたポインタの指す先がTestCollision時に削除されることはないので問題ない。
-
-// NOTE: CollisionFunction内でオブジェクトを移動させたりしてCollisionDetector内のIntersectionの位置が変わると、移動先でさらに判定が取られてしまう
-//       弾幕風の場合、衝突時に移動することはないのでこれを仕様とし特に対策は行わない
-void CollisionDetector::TestNodeCollision(int treeIdx, VisitedIsects visitedIsects[])
-{
-    // 上位のレベルの判定の数をグループごとに覚えておく
-    std::unique_ptr<size_t[]> prevVisitedIsectCounts(new size_t[colMatrix_->GetDimension()], std::default_delete<size_t[]>());
-    for (int i = 0; i < colMatrix_->GetDimension(); ++i)
-    {
-        prevVisitedIsectCounts[i] = visitedIsects[i].size();
-    }
-
-    // 上位レベルに所属する全てのIntersectionと衝突判定を取る（グループごと)
-    auto& cell = quadTree_[treeIdx];
-    auto it = cell.begin();
-    while (it != cell.end())
-    {
-        if (auto newVisit = it->lock())
-        {
-            // 前フレームで衝突した当たり判定を空にする
-            newVisit->collideIsects_.clear();
-            const CollisionGroup group1 = newVisit->GetCollisionGroup();
-            for (int group2 = 0; group2 < colMatrix_->GetDimension(); ++group2)
-            {
-                // 衝突しないグループは無視
-                if (!colMatrix_->IsCollidable(group1, group2)) continue;
-
-                for (auto& p : visitedIsects[group2])
-                {
-                    if (auto visited = p->lock())
-                    {
-                        if (newVisit->IsIntersected(visited))
-                        {
-                            // 衝突した相手を保存
-                            newVisit->collideIsects_.push_back(visited);
-                            visited->collideIsects_.push_back(newVisit);
-                            colMatrix_->Collide(newVisit, visited);
-                        }
-                    }
-                }
-            }
-            // 発見済みに追加
-            visitedIsects[group1].push_back(&(*it));
-            ++it;
-        } else
-        {
-            // 弱参照が切れてたらリストから削除
-            it = cell.erase(it);
-        }
-    }
-    const int lowLevelNode1 = (treeIdx << 2) + 1;
-    if (lowLevelNode1 < quadTree_.size())
-    {
-        TestNodeCollision(lowLevelNode1, visitedIsects);
-        TestNodeCollision(lowLevelNode1 + 1, visitedIsects);
-        TestNodeCollision(lowLevelNode1 + 2, visitedIsects);
-        TestNodeCollision(lowLevelNode1 + 3, visitedIsects);
-    }
-
-    // このノード以下で得た当たり判定を除外
-    for (int i = 0; i < colMatrix_->GetDimension(); ++i)
-    {
-        visitedIsects[i].resize(prevVisitedIsectCounts[i]);
-    }
-}
-
-static inline DWORD separateBit(DWORD n)
+void CollisionDetector::ForEachIntersectionCollideWithShape(const Shape & self, int targetGroup, const std::function<void(const std::shared_ptr<Intersection>&)>& func) const
 {
-    n = (n | (n << 8)) & 0x00ff00ff;
-    n = (n | (n << 4)) & 0x0f0f0f0f;
-    n = (n | (n << 2)) & 0x33333333;
-    return (n | (n << 1)) & 0x55555555;
-}
-
-static inline DWORD pointToMorton(float x, float y, float unitWidth, float unitHeight)
-{
-    return separateBit(x / unitWidth) | (separateBit(y / unitHeight) << 1);
-}
-
-int CollisionDetector::CalcTreeIndexFromBoundingBox(const BoundingBox & boundingBox) const
-{
-    float left = constrain(boundingBox.left_, 0.0f, fieldWidth_ - 1);
-    float right = constrain(boundingBox.right_, 0.0f, fieldWidth_ - 1);
-    float top = constrain(boundingBox.top_, 0.0f, fieldHeight_ - 1);
-    float bottom = constrain(boundingBox.bottom_, 0.0f, fieldHeight_ - 1);
-
-    DWORD m1 = pointToMorton(left, top, unitCellWidth_, unitCellHeight_);
-    DWORD m2 = pointToMorton(right, bottom, unitCellWidth_, unitCellHeight_);
-    DWORD m = m1 ^ m2;
-    int k = 0;
-    for (int i = 0; i < MaxLevel; m >>= 2, i++)
+    broadphase_->ForEachCandidate(self.GetBoundingBox(), [&](const std::shared_ptr<Intersection>& other)
     {
-        if ((m & 0x3) != 0) { k = i + 1; }
-    }
-    int level = MaxLevel - k;
-    DWORD morton = m2 >> (k << 1);
-    return CalcTreeIndex(level, morton);
-}
-
-ShotIntersection::ShotIntersection(float x, float y, float r, const std::shared_ptr<ObjShot>& shot, bool isTmpIntersection) :
-    Intersection(Shape(x, y, r),
-                 shot->IsPlayerShot() ?
-                 (shot->IsEraseShotEnabled() ? COL_GRP_PLAYER_ERASE_SHOT : COL_GRP_PLAYER_NON_ERASE_SHOT) :
-                 COL_GRP_ENEMY_SHOT),
-    shot_(shot),
-    isPlayerShot_(shot->IsPlayerShot()),
-    isTmpIntersection_(isTmpIntersection)
-{
-}
-
-ShotIntersection::ShotIntersection(float x1, float y1, float x2, float y2, float width, const std::shared_ptr<ObjShot>& shot, bool isTmpIntersection) :
-    Intersection(Shape(x1, y1, x2, y2, width),
-                 shot->IsPlayerShot() ?
-                 (shot->IsEraseShotEnabled() ? COL_GRP_PLAYER_ERASE_SHOT : COL_GRP_PLAYER_NON_ERASE_SHOT) :
-                 COL_GRP_ENEMY_SHOT),
-    shot_(shot),
-    isPlayerShot_(shot->IsPlayerShot()),
-    isTmpIntersection_(isTmpIntersection)
-{
-}
-
-void ShotIntersection::SetEraseShotEnable(bool enable)
-{
-    ChangeCollisionGroup(enable ? COL_GRP_PLAYER_ERASE_SHOT : COL_GRP_PLAYER_NON_ERASE_SHOT);
+        // ターゲットグループでないなら無視
+        if (targetGroup >= 0 && other->GetCollisionGroup() != targetGroup) return;
+        if (self.IsIntersected(other->shape_)) func(other);
+    });
 }
 
-EnemyIntersectionToShot::EnemyIntersectionToShot(float x, float y, float r, const std::shared_ptr<ObjEnemy>& enemy) :
-    Intersection(Shape(x, y, r), COL_GRP_ENEMY_TO_SHOT),
-    enemy_(enemy),
-    x_(x),
-    y_(y)
+void CollisionDetector::CollectNearestIds(float x, float y, int k, int targetGroup, const IdGetter& getId, std::vector<std::pair<float, int>>& distances, std::vector<int>& ids) const
 {
-}
-
-EnemyIntersectionToPlayer::EnemyIntersectionToPlayer(float x, float y, float r, const std::shared_ptr<ObjEnemy>& enemy) :
-    Intersection(Shape(x, y, r), COL_GRP_ENEMY_TO_PLAYER),
-    enemy_(enemy)
-{
-}
-
-PlayerIntersection::PlayerIntersection(float x, float y, float r, const std::shared_ptr<ObjPlayer>& player) :
-    Intersection(Shape(x, y, r), COL_GRP_PLAYER),
-    player_(player)
-{
-}
-
-PlayerGrazeIntersection::PlayerGrazeIntersection(float x, float y, float r, const std::shared_ptr<ObjPlayer>& player) :
-    Intersection(Shape(x, y, r), COL_GRP_PLAYER_GRAZE),
-    player_(player)
-{
-}
-
-SpellIntersection::SpellIntersection(float x, float y, float r, const std::shared_ptr<ObjSpell>& spell) :
-    Intersection(Shape(x, y, r), COL_GRP_SPELL),
-    spell_(spell)
-{
-}
-
-SpellIntersection::SpellIntersection(float x1, float y1, float x2, float y2, float width, const std::shared_ptr<ObjSpell>& spell) :
-    Intersection(Shape(x1, y1, x2, y2, width), COL_GRP_SPELL),
-    spell_(spell)
-{
-}
-
-PlayerIntersectionToItem::PlayerIntersectionToItem(float x, float y, const std::shared_ptr<ObjPlayer>& player) :
-    Intersection(Shape(x, y, 0), COL_GRP_PLAYER_TO_ITEM),
-    player_(player)
-{
-}
-
-ItemIntersection::ItemIntersection(float x, float y, float r, const std::shared_ptr<ObjItem>& item) :
-    Intersection(Shape(x, y, r), COL_GRP_ITEM),
-    item_(item)
-{
-}
-
-TempEnemyShotIntersection::TempEnemyShotIntersection(float x, float y, float r) :
-    Intersection(Shape(x, y, r), COL_GRP_TEMP_ENEMY_SHOT)
-{
-}
-
-TempEnemyShotIntersection::TempEnemyShotIntersection(float x1, float y1, float x2, float y2, float width) :
-    Intersection(Shape(x1, y1, x2, y2, width), COL_GRP_TEMP_ENEMY_SHOT)
-{
-}
-
-static inline bool isShotIntersectionEnabled(const std::shared_ptr<ShotIntersection>& isect)
-{
-    if (auto shot = isect->GetShot().lock())
+    // 検索を始める半径と, 画面外の判定も含むように十分大きく取った最大の半径
+    constexpr float initRadius = 64.0f;
+    constexpr float maxRadius = 8192.0f;
+    // 半径ちょうどの判定が誤差で見つからない場合に備えて, k番目までの距離がこれだけ半径より小さくなるまで広げる
+    constexpr float radiusMargin = 1.0f;
+    ids.clear();
+    if (k <= 0) return;
+    // 半径rの円と当たる判定は形状までの距離がr以下のものなので,
+    // 半径を広げながら検索し, k番目に近いものまでの距離が半径より小さくなったら終える
+    size_t cnt = 0;
+    float r = initRadius;
+    while (true)
     {
-        // Regist前でShotDataで元から設定されている当たり判定の時は衝突無効
-        if (!shot->IsRegistered() && !isect->IsTempIntersection()) return false;
-        // 判定が無効になっているとき、または遅延時は衝突無効
-        if (!shot->IsIntersectionEnabled() || shot->IsDelay()) return false;
-        return true;
-    }
-    return false;
-}
-
-static void collideEnemyShotWithPlayerEraseShot(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
-{
-    auto playerShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect2);
-    if (auto playerShot = playerShotIsect->GetShot().lock())
-    {
-        if (playerShot->IsEraseShotEnabled())
-        {
-            auto enemyShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect1);
-            if (auto enemyShot = enemyShotIsect->GetShot().lock())
-            {
-                if (isShotIntersectionEnabled(enemyShotIsect) && isShotIntersectionEnabled(playerShotIsect))
-                {
-                    if (playerShot->GetType() == OBJ_SHOT)
-                    {
-                        playerShot->SetPenetration(playerShot->GetPenetration() - 1);
-                    }
-                    enemyShot->EraseWithSpell();
-                }
-            }
-        }
-    }
-}
-
-static void collideEnemyShotWithPlayer(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
-{
-    auto enemyShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect1);
-    if (isShotIntersectionEnabled(enemyShotIsect))
-    {
-        if (auto enemyShot = enemyShotIsect->GetShot().lock())
-        {
-            if (auto player = std::dynamic_pointer_cast<PlayerIntersection>(isect2)->GetPlayer().lock())
-            {
-                player->Hit(enemyShot->GetID());
-            }
-        }
-    }
-}
-
-static void collideEnemyShotWithPlayerGraze(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
-{
-    auto enemyShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect1);
-    if (isShotIntersectionEnabled(enemyShotIsect))
-    {
-        if (auto enemyShot = enemyShotIsect->GetShot().lock())
-        {
-            if (auto player = std::dynamic_pointer_cast<PlayerGrazeIntersection>(isect2)->GetPlayer().lock())
-            {
-                if (enemyShot->IsGrazeEnabled() && player->IsGrazeEnabled())
-                {
-                    player->GrazeToShot(enemyShot->GetID(), 1);
-                    enemyShot->Graze();
-                }
-            }
-        }
-    }
-}
-
-static void collideEnemyShotWithSpell(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
-{
-    auto enemyShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect1);
-    if (auto spell = std::dynamic_pointer_cast<SpellIntersection>(isect2)->GetSpell().lock())
-    {
-        if (spell->IsEraseShotEnabled())
-        {
-            if (isShotIntersectionEnabled(enemyShotIsect))
-            {
-                if (auto enemyShot = enemyShotIsect->GetShot().lock())
-                {
-                    enemyShot->EraseWithSpell();
-                }
-            }
-        }
-    }
-}
-
-static void collidePlayerShotWithEnemyIntersectionToShot(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
-{
-    auto playerShotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect1);
-    auto enemyIsectToShot = std::dynamic_pointer_cast<EnemyIntersectionToShot>(isect2);
-    if (isShotIntersectionEnabled(playerShotIsect))
-    {
-        if (auto playerShot = playerShotIsect->GetShot().lock())
+        distances.clear();
+        ForEachIntersectionCollideWithShape(Shape(x, y, r), targetGroup, [&](const std::shared_ptr<Intersection>& isect)
         {
-            if (auto enemy = enemyIsectToShot->GetEnemy().lock())
+            int id;
+            if (getId(isect, id))
             {
-                if (playerShot->GetType() == OBJ_SHOT)
-                {
-                    playerShot->SetPenetration(playerShot->GetPenetration() - 1);
-                }
-                if (playerShot->IsSpellFactorEnabled())
-                {
-                    enemy->AddSpellDamage(playerShot->GetDamage());
-                } else
-                {
-                    enemy->AddShotDamage(playerShot->GetDamage());
-                }
+                distances.emplace_back(isect->GetShape().GetDistance(x, y), id);
             }
-        }
-    }
-}
-
-static void collidePlayerWithEnemyIntersectionToPlayer(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
-{
-    if (auto player = std::dynamic_pointer_cast<PlayerIntersection>(isect1)->GetPlayer().lock())
-    {
-        if (auto enemy = std::dynamic_pointer_cast<EnemyIntersectionToPlayer>(isect2)->GetEnemy().lock())
+        });
+        // IDごとに最も近い判定の距離だけを残す
+        std::sort(distances.begin(), distances.end(), [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.second != b.second ? a.second < b.second : a.first < b.first; });
+        distances.erase(std::unique(distances.begin(), distances.end(), [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.second == b.second; }), distances.end());
+        // 距離が同じならIDの小さい方を先にする
+        cnt = std::min((size_t)k, distances.size());
+        std::partial_sort(distances.begin(), distances.begin() + cnt, distances.end());
+        if (r >= maxRadius) break;
+        if (cnt == (size_t)k)
         {
-            player->Hit(enemy->GetID());
-        }
-    }
-}
-
-static void collideEnemyIntersectionToShotWithSpell(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
-{
-    if (auto enemy = std::dynamic_pointer_cast<EnemyIntersectionToShot>(isect1)->GetEnemy().lock())
-    {
-        if (auto spell = std::dynamic_pointer_cast<SpellIntersection>(isect2)->GetSpell().lock())
+            const float kthDist = distances[cnt - 1].first;
+            if (kthDist + radiusMargin <= r) break;
+            r = std::min(maxRadius, std::max(r * 2.0f, kthDist + radiusMargin));
+        } else
         {
-            enemy->AddSpellDamage(spell->GetDamage());
+            r = std::min(maxRadius, r * 2.0f);
         }
     }
-}
-
-static void collideWithPlayerToItemWithItem(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
-{
-    if (auto player = std::dynamic_pointer_cast<PlayerIntersectionToItem>(isect1)->GetPlayer().lock())
+    for (size_t i = 0; i < cnt; i++)
     {
-        if (auto item = std::dynamic_pointer_cast<ItemIntersection>(isect2)->GetItem().lock())
-        {
-            if (player->GetState() == STATE_NORMAL)
-            {
-                player->ObtainItem(item->GetID());
-                item->Obtained();
-            }
-        }
+        ids.push_back(distances[i].second);
     }
 }
 
-static void collidePlayerWithTempEnemyShot(const std::shared_ptr<Intersection>& isect1, const std::shared_ptr<Intersection>& isect2)
+void CollisionDetector::TestAllCollision()
 {
-    if (auto player = std::dynamic_pointer_cast<PlayerIntersection>(isect1)->GetPlayer().lock())
-    {
-        player->Hit(ID_INVALID);
-    }
+    broadphase_->TestAllCollision(*colMatrix_);
 }
-
-// col matrix
-const CollisionFunction DEFAULT_COLLISION_MATRIX[DEFAULT_COLLISION_MATRIX_DIMENSION * DEFAULT_COLLISION_MATRIX_DIMENSION] = {
-    /* COL_GRP_ENEMY_SHOT           */  nullptr, collideEnemyShotWithPlayerEraseShot, nullptr, collideEnemyShotWithPlayer, collideEnemyShotWithPlayerGraze, nullptr, nullptr, collideEnemyShotWithSpell, nullptr, nullptr, nullptr,
-    /* COL_GRP_PLAYER_ERASE_SHOT    */  nullptr, nullptr, nullptr, nullptr, nullptr, collidePlayerShotWithEnemyIntersectionToShot, nullptr, nullptr, nullptr, nullptr, nullptr,
-    /* COL_GRP_PLAYER_NON_ERASESHOT */  nullptr, nullptr, nullptr, nullptr, nullptr, collidePlayerShotWithEnemyIntersectionToShot, nullptr, nullptr, nullptr, nullptr, nullptr,
-    /* COL_GRP_PLAYER               */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, collidePlayerWithEnemyIntersectionToPlayer, nullptr, nullptr, nullptr, collidePlayerWithTempEnemyShot,
-    /* COL_GRP_PLAYER_GRAZE         */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
-    /* COL_GRP_ENEMY_TO_SHOT        */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, collideEnemyIntersectionToShotWithSpell, nullptr, nullptr, nullptr,
-    /* COL_GRP_ENEMY_TO_PLAYER      */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
-    /* COL_GRP_SPELL                */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
-    /* COL_GRP_PLAYER_TO_ITEM       */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, collideWithPlayerToItemWithItem, nullptr,
-    /* COL_GRP_ITEM                 */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
-    /* COL_GRP_TEMP_ENEMY_SHOT      */  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
-};
 }
\ No newline at end of file
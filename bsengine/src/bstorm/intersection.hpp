@@ -3,8 +3,9 @@
 #include <array>
 #include <vector>
 #include <deque>
-#include <list>
+#include <functional>
 #include <memory>
+#include <cstdint>
 
 #include <bstorm/non_copyable.hpp>
 
@@ -21,6 +22,22 @@ struct BoundingBox
     float bottom_;
 };
 
+// 回転した矩形
+// 中心, 長さ方向の単位ベクトル, 長さと幅の半分で表す
+struct OrientedRect
+{
+    float centerX;
+    float centerY;
+    float axisX;
+    float axisY;
+    float halfLength;
+    float halfWidth;
+};
+
+// 弾幕風のLine((x1, y1)から(x2, y2)までの太さwidthの線分)を矩形にする
+OrientedRect LineToOrientedRect(float x1, float y1, float x2, float y2, float width);
+bool IsIntersectedOrientedRectCircle(const OrientedRect& rect, float cx, float cy, float r);
+bool IsIntersectedOrientedRects(const OrientedRect& rect1, const OrientedRect& rect2);
 bool IsIntersectedLineCircle(float x1, float y1, float x2, float y2, float width, float cx, float cy, float r);
 
 class Renderer;
@@ -31,11 +48,21 @@ public:
     enum class Type
     {
         CIRCLE,
-        RECT
+        RECT,
+        CIRCLES
     };
+    // CIRCLESにまとめられる円の最大数
+    static constexpr int MaxCompoundCircleCount = 4;
     Shape(float x, float y, float r);
     Shape(float x1, float y1, float x2, float y2, float width);
+    // 複数の円を1つの形状にまとめる (circleCnt <= MaxCompoundCircleCount)
+    Shape(int circleCnt, const float* xs, const float* ys, const float* rs);
     bool IsIntersected(const Shape& other) const;
+    // 当たっている円や矩形の組の数を返す
+    // CIRCLESの円はそれぞれ別の判定として数えるので, 円を別々の判定にした場合の衝突回数と一致する
+    int CountIntersections(const Shape& other) const;
+    // (x, y)から形状までの距離, 形状の内側なら0
+    float GetDistance(float x, float y) const;
     const BoundingBox& GetBoundingBox() const;
     void Trans(float dx, float dy);
     void SetWidth(float width);
@@ -44,7 +71,11 @@ public:
     Type GetType() const;
     void GetCircle(float& x, float &y, float& r) const;
     void GetRect(float& x1, float& y1, float& x2, float& y2, float& width) const;
+    int GetCompoundCircleCount() const;
+    void GetCompoundCircle(int idx, float& x, float& y, float& r) const;
 private:
+    bool IsIntersectedPrimitive(const Shape& other) const;
+    Shape GetCompoundCircleShape(int idx) const;
     void UpdateBoundingBox();
     void TransBoundingBox(float dx, float dy);
     const Type type_;
@@ -63,11 +94,41 @@ private:
             float x2;
             float y2;
             float width;
+            OrientedRect orientedRect; // x1, y1, x2, y2, widthが変わった時に計算する
         } Rect;
+        struct
+        {
+            float x[MaxCompoundCircleCount];
+            float y[MaxCompoundCircleCount];
+            float r[MaxCompoundCircleCount];
+            int count;
+        } Circles;
     } params_;
     BoundingBox boundingBox_;
 };
 
+// 円の当たり判定を種類別の配列(SoA)に並べたもの
+struct CircleBatch
+{
+    void Clear();
+    void Resize(size_t size);
+    size_t Size() const { return x.size(); }
+    void Push(const BoundingBox& boundingBox, float cx, float cy, float cr, uint32_t id);
+    void Append(const CircleBatch& other);
+    std::vector<float> left;
+    std::vector<float> top;
+    std::vector<float> right;
+    std::vector<float> bottom;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> r;
+    std::vector<uint32_t> ids;
+};
+
+// 円(x, y, r)とbatch[begin, end)の円の衝突検査をSIMDでまとめて行い、衝突した円の添字をhitIndicesに書き込んでその数を返す
+// Shape::IsIntersectedと同じ演算を行うので結果は一致する
+size_t IntersectCircleBatch(const BoundingBox& boundingBox, float x, float y, float r, const CircleBatch& batch, size_t begin, size_t end, uint32_t* hitIndices);
+
 // ===================================================
 // ◆ CollisionGroup
 // ===================================================
@@ -91,18 +152,17 @@ public:
     bool IsIntersected(const std::shared_ptr<Intersection>& isect) const;
     virtual void Render(const std::shared_ptr<Renderer>& renderer, bool permitCamera) const;
     const Shape& GetShape() const;
-    int GetTreeIndex() const;
     const std::deque<std::weak_ptr<Intersection>>& GetCollideIntersections() const;
 protected:
     void ChangeCollisionGroup(CollisionGroup colGroup) { colGroup_ = colGroup; }
 private:
     Shape shape_;
     CollisionGroup colGroup_;
-    int treeIdx_;
-    std::list<std::weak_ptr<Intersection>>::iterator posInCell_;
+    int slotIdx_; // Broadphaseに登録されていなければ-1
     std::deque<std::weak_ptr<Intersection>> collideIsects_; // 衝突した当たり判定
 
     friend class CollisionDetector;
+    friend class Broadphase;
 };
 
 // ===================================================
@@ -128,13 +188,14 @@ private:
     CollisionFunction* matrix_;
 };
 
-// CollisionDetector: 当たり判定の管理を行う。4分木構造になっている。
+class Broadphase;
+// CollisionDetector: 当たり判定の管理を行う。空間分割はBroadphaseで行う。
 class CollisionDetector
 {
 public:
-    // 4分木の分割度, 合計(4^(MaxLevel+1) - 1) / 3個のセルが生成される
-    static constexpr int MaxLevel = 4;
+    // 4分木を使う
     CollisionDetector(int fieldWidth, int fieldHeight, const std::shared_ptr<CollisionMatrix>& colMatrix);
+    CollisionDetector(const std::shared_ptr<Broadphase>& broadphase, const std::shared_ptr<CollisionMatrix>& colMatrix);
     ~CollisionDetector();
     void Add(const std::shared_ptr<Intersection>&);
     void Remove(const std::shared_ptr<Intersection>&);
@@ -143,20 +204,20 @@ public:
     void SetWidth(const std::shared_ptr<Intersection>&, float width);
     // GetIntersectionsCollideWith ~: ある判定と当たっている判定を取得する
     // すべてのグループの判定を取得したいならtargetGroupを負にする
-    std::deque<std::shared_ptr<Intersection>> GetIntersectionsCollideWithIntersection(const std::shared_ptr<Intersection>& isect, CollisionGroup targetGroup) const;
-    std::deque<std::shared_ptr<Intersection>> GetIntersectionsCollideWithShape(const Shape& shape, CollisionGroup targetGroup) const;
+    std::deque<std::shared_ptr<Intersection>> GetIntersectionsCollideWithIntersection(const std::shared_ptr<Intersection>& isect, int targetGroup) const;
+    std::deque<std::shared_ptr<Intersection>> GetIntersectionsCollideWithShape(const Shape& shape, int targetGroup) const;
+    // shapeと当たっている判定を順にfuncに渡す, 結果を格納するコンテナを作らない
+    void ForEachIntersectionCollideWithShape(const Shape& shape, int targetGroup, const std::function<void(const std::shared_ptr<Intersection>&)>& func) const;
+    // targetGroupの判定からgetIdで求めたIDを, 判定の形状が(x, y)に近い順に重複なしで最大k個idsに書き込む
+    // getIdは判定に対応するIDがあれば書き込んでtrueを返す, 同じIDの判定が複数あれば最も近いものの距離を使う
+    // distancesは作業用のバッファ
+    using IdGetter = std::function<bool(const std::shared_ptr<Intersection>&, int&)>;
+    void CollectNearestIds(float x, float y, int k, int targetGroup, const IdGetter& getId, std::vector<std::pair<float, int>>& distances, std::vector<int>& ids) const;
     void TestAllCollision();
+    const std::shared_ptr<Broadphase>& GetBroadphase() const { return broadphase_; }
 private:
-    using VisitedIsects = std::vector<std::weak_ptr<Intersection>*>;
-    void TestNodeCollision(int treeIdx, VisitedIsects visitedIsects[]);
-    int CalcTreeIndexFromBoundingBox(const BoundingBox& boundingBox) const;
-    const float fieldWidth_;
-    const float fieldHeight_;
-    const float unitCellWidth_;
-    const float unitCellHeight_;
+    std::shared_ptr<Broadphase> broadphase_;
     std::shared_ptr<CollisionMatrix> colMatrix_;
-    static constexpr int CellCount = ((1 << (2 * (MaxLevel + 1))) - 1) / 3;
-    std::array<std::list<std::weak_ptr<Intersection>>, CellCount> quadTree_;
 };
 
 constexpr int DEFAULT_COLLISION_MATRIX_DIMENSION = 11;
@@ -180,6 +241,7 @@ class ShotIntersection : public Intersection
 public:
     ShotIntersection(float x, float y, float r, const std::shared_ptr<ObjShot>& shot, bool isTmpIntersection);
     ShotIntersection(float x1, float y1, float x2, float y2, float width, const std::shared_ptr<ObjShot>& shot, bool isTmpIntersection);
+    ShotIntersection(const Shape& shape, const std::shared_ptr<ObjShot>& shot, bool isTmpIntersection);
     void SetEraseShotEnable(bool enable);
     const std::weak_ptr<ObjShot>& GetShot() const { return shot_; }
     bool IsPlayerShot() const { return isPlayerShot_; }
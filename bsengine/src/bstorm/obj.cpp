@@ -2,12 +2,18 @@
 
 #include <bstorm/dnh_const.hpp>
 #include <bstorm/dnh_value.hpp>
+#include <bstorm/logger.hpp>
+
+#include <algorithm>
 
 namespace bstorm
 {
 Obj::Obj(const std::shared_ptr<Package>& state) :
     id_(ID_INVALID),
     type_(0),
+    classMask_(CLASS_MASK),
+    objMove_(nullptr),
+    objCol_(nullptr),
     isDead_(false),
     isStgSceneObj_(true),
     package_(state)
@@ -55,84 +61,153 @@ const std::unordered_map<std::wstring, std::unique_ptr<DnhValue>>& Obj::GetPrope
 }
 
 ObjectTable::ObjectTable() :
-    idGen_(0),
-    isUpdating_(false),
-    objCache_(std::make_shared<Obj>(nullptr)) // ダミーで初期化
+    hasDeadObjects_(false),
+    isUpdating_(false)
 {
-    // 取得されないようにDead状態にする
-    objCache_->Die();
 }
 
 ObjectTable::~ObjectTable()
 {
 }
 
+int ObjectTable::AllocSlot(const std::shared_ptr<Obj>& obj)
+{
+    uint32_t slotIdx;
+    const bool canGrow = slots_.size() <= SLOT_INDEX_MASK;
+    if (freeSlots_.empty() && !canGrow)
+    {
+        throw Log(LogLevel::LV_ERROR)
+            .Msg("too many objects.")
+            .Param(LogParam(LogParam::Tag::TEXT, std::to_wstring(slots_.size())));
+    }
+    if (freeSlots_.empty() || (canGrow && freeSlots_.size() < MIN_FREE_SLOTS))
+    {
+        slotIdx = slots_.size();
+        slots_.emplace_back();
+    } else
+    {
+        slotIdx = freeSlots_.front();
+        freeSlots_.pop_front();
+    }
+    auto& slot = slots_[slotIdx];
+    slot.obj = obj;
+    return (int)((slot.generation << SLOT_INDEX_BITS) | slotIdx);
+}
+
+void ObjectTable::FreeSlot(int id)
+{
+    const uint32_t slotIdx = (uint32_t)id & SLOT_INDEX_MASK;
+    auto& slot = slots_[slotIdx];
+    slot.obj.reset();
+    slot.generation = slot.generation == MAX_GENERATION ? 0 : slot.generation + 1;
+    freeSlots_.push_back(slotIdx);
+}
+
+void ObjectTable::RemoveDeadObjects()
+{
+    if (!hasDeadObjects_) return;
+    for (const auto& obj : objs_)
+    {
+        // 自分で死んだもの, 更新中に更新済みの位置で削除されたものはまだスロットを持っている
+        if (obj->IsDead() && slots_[(uint32_t)obj->GetID() & SLOT_INDEX_MASK].obj == obj)
+        {
+            FreeSlot(obj->GetID());
+        }
+    }
+    objs_.erase(std::remove_if(objs_.begin(), objs_.end(), [](const std::shared_ptr<Obj>& obj) { return obj->IsDead(); }), objs_.end());
+    hasDeadObjects_ = false;
+}
+
 void ObjectTable::Delete(int id)
 {
-    auto it = table_.find(id);
-    if (it != table_.end())
+    if (auto obj = Get<Obj>(id))
     {
-        it->second->Die();
+        obj->Die();
+        hasDeadObjects_ = true;
         if (!isUpdating_)
         {
-            table_.erase(it);
+            FreeSlot(id);
         }
     }
 }
 
 bool ObjectTable::IsDeleted(int id)
 {
-    auto it = table_.find(id);
-    if (it != table_.end())
-    {
-        return it->second->IsDead();
-    } else
-    {
-        return true;
-    }
+    return !Get<Obj>(id);
 }
 
 void ObjectTable::UpdateAll(bool ignoreStgSceneObj)
 {
     isUpdating_ = true;
-    auto it = table_.begin();
-    while (it != table_.end())
+    // 更新中に作成されたオブジェクトも更新する
+    for (size_t i = 0; i < objs_.size(); i++)
     {
-        auto& obj = it->second;
-        if (!obj->IsDead())
+        // 更新中にobjs_が伸びることがあるのでコピーを取る
+        std::shared_ptr<Obj> obj = objs_[i];
+        const bool needUpdate = !obj->IsDead() && !(ignoreStgSceneObj && obj->IsStgSceneObject());
+        // 連続してバッチに入るものは溜めておき, そうでないものが来たら先に溜めた分を更新する
+        if (needUpdate && updateBatch_ && updateBatch_->Add(obj.get()))
         {
-            if (!(ignoreStgSceneObj && obj->IsStgSceneObject()))
-            {
-                obj->Update();
-            }
+            batchedObjIndices_.push_back(i);
+            continue;
         }
-        if (obj->IsDead())
+        FlushUpdateBatch();
+        if (needUpdate)
         {
-            table_.erase(it++);
-        } else
-        {
-            ++it;
+            obj->Update();
         }
+        FreeSlotIfDead(obj);
     }
+    FlushUpdateBatch();
     isUpdating_ = false;
+    RemoveDeadObjects();
 }
 
-void ObjectTable::DeleteStgSceneObject()
+void ObjectTable::FreeSlotIfDead(const std::shared_ptr<Obj>& obj)
 {
-    auto it = table_.begin();
-    while (it != table_.end())
+    if (obj->IsDead())
     {
-        if (it->second->IsStgSceneObject())
+        // 更新中に削除されたオブジェクトのスロットはここで解放する
+        if (slots_[(uint32_t)obj->GetID() & SLOT_INDEX_MASK].obj == obj)
         {
-            table_.erase(it++);
-        } else
+            FreeSlot(obj->GetID());
+        }
+        hasDeadObjects_ = true;
+    }
+}
+
+void ObjectTable::FlushUpdateBatch()
+{
+    if (batchedObjIndices_.empty()) return;
+    updateBatch_->Flush();
+    for (size_t i : batchedObjIndices_)
+    {
+        FreeSlotIfDead(objs_[i]);
+    }
+    batchedObjIndices_.clear();
+}
+
+void ObjectTable::DeleteStgSceneObject()
+{
+    for (const auto& obj : objs_)
+    {
+        if (obj->IsStgSceneObject())
         {
-            ++it;
+            if (slots_[(uint32_t)obj->GetID() & SLOT_INDEX_MASK].obj == obj)
+            {
+                FreeSlot(obj->GetID());
+            }
         }
     }
+    objs_.erase(std::remove_if(objs_.begin(), objs_.end(), [](const std::shared_ptr<Obj>& obj) { return obj->IsStgSceneObject(); }), objs_.end());
 }
-const std::map<int, std::shared_ptr<Obj>>& ObjectTable::GetAll()
+
+const std::vector<std::shared_ptr<Obj>>& ObjectTable::GetAll()
 {
-    return table_;
+    if (!isUpdating_)
+    {
+        RemoveDeadObjects();
+    }
+    return objs_;
 }
 }
\ No newline at end of file
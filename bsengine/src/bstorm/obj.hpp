@@ -2,20 +2,65 @@
 
 #include <bstorm/non_copyable.hpp>
 #include <bstorm/nullable_shared_ptr.hpp>
+#include <bstorm/pool_allocator.hpp>
 
-#include <map>
+#include <string>
 #include <unordered_map>
+#include <vector>
+#include <deque>
 #include <memory>
+#include <cstdint>
+#include <type_traits>
 
 namespace bstorm
 {
 class DnhValue;
 class ObjectTable;
 class Package;
+class ObjMove;
+class ObjCol;
+
+// 型判定用のクラスビット
+// 各クラスは CLASS_MASK = 自身のビット | 基底クラスのCLASS_MASK を持つ
+namespace ObjClass
+{
+constexpr uint32_t OBJ = 1u << 0;
+constexpr uint32_t RENDER = 1u << 1;
+constexpr uint32_t SHADER = 1u << 2;
+constexpr uint32_t PRIM = 1u << 3;
+constexpr uint32_t PRIM_2D = 1u << 4;
+constexpr uint32_t SPRITE_2D = 1u << 5;
+constexpr uint32_t SPRITE_LIST_2D = 1u << 6;
+constexpr uint32_t PRIM_3D = 1u << 7;
+constexpr uint32_t SPRITE_3D = 1u << 8;
+constexpr uint32_t MESH = 1u << 9;
+constexpr uint32_t TEXT = 1u << 10;
+constexpr uint32_t SOUND = 1u << 11;
+constexpr uint32_t FILE = 1u << 12;
+constexpr uint32_t FILE_T = 1u << 13;
+constexpr uint32_t FILE_B = 1u << 14;
+constexpr uint32_t MOVE = 1u << 15;
+constexpr uint32_t COL = 1u << 16;
+constexpr uint32_t SHOT = 1u << 17;
+constexpr uint32_t LASER = 1u << 18;
+constexpr uint32_t LOOSE_LASER = 1u << 19;
+constexpr uint32_t ST_LASER = 1u << 20;
+constexpr uint32_t CR_LASER = 1u << 21;
+constexpr uint32_t ITEM = 1u << 22;
+constexpr uint32_t ITEM_SCORE_TEXT = 1u << 23;
+constexpr uint32_t ENEMY = 1u << 24;
+constexpr uint32_t ENEMY_BOSS_SCENE = 1u << 25;
+constexpr uint32_t PLAYER = 1u << 26;
+constexpr uint32_t SPELL = 1u << 27;
+constexpr uint32_t SPELL_MANAGE = 1u << 28;
+}
+
 class Obj : private NonCopyable
 {
 public:
     using Type = uint8_t;
+    static constexpr uint32_t CLASS_BIT = ObjClass::OBJ;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT;
     Obj(const std::shared_ptr<Package>& state);
     virtual ~Obj();
     virtual void Update() {}
@@ -26,12 +71,19 @@ public:
     bool IsValueExists(const std::wstring& key) const;
     int GetID() const { return id_; }
     Type GetType() const { return type_; }
+    uint32_t GetClassMask() const { return classMask_; }
+    // ObjMove, ObjColは多重継承なのでObjからのオフセットを覚えておく
+    ObjMove* GetObjMove() const { return objMove_; }
+    ObjCol* GetObjCol() const { return objCol_; }
     bool IsDead() const { return isDead_; }
     bool IsStgSceneObject() const { return isStgSceneObj_; }
     void SetStgSceneObject(bool b) { isStgSceneObj_ = b; }
     const std::unordered_map<std::wstring, std::unique_ptr<DnhValue>>& GetProperties() const;
 protected:
     void SetType(Type t) { type_ = t; }
+    void SetClassMask(uint32_t mask) { classMask_ = mask; }
+    void SetObjMove(ObjMove* move) { objMove_ = move; }
+    void SetObjCol(ObjCol* col) { objCol_ = col; }
     void Die() noexcept
     {
         if (isDead_) return;
@@ -43,6 +95,9 @@ protected:
 private:
     int id_;
     Type type_;
+    uint32_t classMask_;
+    ObjMove* objMove_;
+    ObjCol* objCol_;
     bool isDead_;
     std::unordered_map<std::wstring, std::unique_ptr<DnhValue>> properties_;
     std::weak_ptr<Package> package_;
@@ -50,59 +105,135 @@ private:
     friend class ObjectTable;
 };
 
-class ObjectTable
+// dynamic_castの代わりにクラスビットで判定する
+template <class T>
+struct ObjCaster
 {
-public:
-    ObjectTable();
-    ~ObjectTable();
-    template <class T>
-    NullableSharedPtr<T> Get(int id)
+    static T* Cast(Obj* obj)
     {
-        if (objCache_->GetID() == id && !objCache_->IsDead())
-        {
-            return std::dynamic_pointer_cast<T>(objCache_);
-        }
-
-        auto it = table_.find(id);
-        if (it != table_.end() && !it->second->IsDead())
+        if (obj && (obj->GetClassMask() & T::CLASS_BIT))
         {
-            objCache_ = it->second;
-            return std::dynamic_pointer_cast<T>(objCache_);
+            return static_cast<T*>(obj);
         }
         return nullptr;
     }
-    template <>
-    NullableSharedPtr<Obj> Get(int id)
+};
+
+template <>
+struct ObjCaster<Obj>
+{
+    static Obj* Cast(Obj* obj) { return obj; }
+};
+
+template <>
+struct ObjCaster<ObjMove>
+{
+    static ObjMove* Cast(Obj* obj) { return obj ? obj->GetObjMove() : nullptr; }
+};
+
+template <>
+struct ObjCaster<ObjCol>
+{
+    static ObjCol* Cast(Obj* obj) { return obj ? obj->GetObjCol() : nullptr; }
+};
+
+template <class T>
+T* ObjCast(Obj* obj)
+{
+    return ObjCaster<T>::Cast(obj);
+}
+
+template <class T>
+std::shared_ptr<T> ObjCast(const std::shared_ptr<Obj>& obj)
+{
+    if (T* p = ObjCaster<T>::Cast(obj.get()))
     {
-        if (objCache_->GetID() == id && !objCache_->IsDead())
-        {
-            return objCache_;
-        }
+        return std::shared_ptr<T>(obj, p);
+    }
+    return nullptr;
+}
 
-        auto it = table_.find(id);
-        if (it != table_.end() && !it->second->IsDead())
-        {
-            return objCache_ = it->second;
-        }
-        return nullptr;
+// UpdateAllでObj::Updateの代わりにまとめて更新する
+// Addで受け取ったオブジェクトはFlushまでに追加順に更新すること
+// 受け取るのは, 更新が他のオブジェクトやスクリプトに影響しないものに限る
+class ObjUpdateBatch
+{
+public:
+    virtual ~ObjUpdateBatch() {}
+    virtual bool Add(Obj* obj) = 0;
+    virtual void Flush() = 0;
+};
+
+// 大量に生成, 破棄される型はtrueにしておくとObjectTable::Createでプールから確保する
+template <class T>
+struct IsPooledObj : std::false_type {};
+
+// ObjectTable: スロットマップ
+// ID = (世代 << SLOT_INDEX_BITS) | スロット番号
+// スロットを再利用する度に世代を進めるので, 世代が一周するまでは削除済みのIDで別のオブジェクトを引くことはない
+class ObjectTable
+{
+public:
+    static constexpr int SLOT_INDEX_BITS = 20;
+    static constexpr uint32_t SLOT_INDEX_MASK = (1u << SLOT_INDEX_BITS) - 1;
+    static constexpr uint32_t MAX_GENERATION = (1u << (31 - SLOT_INDEX_BITS)) - 1;
+    // 空きスロットがこれだけ溜まるまでは再利用しない (同じIDが早く巡ってこないように)
+    static constexpr size_t MIN_FREE_SLOTS = 1024;
+    ObjectTable();
+    ~ObjectTable();
+    template <class T>
+    NullableSharedPtr<T> Get(int id)
+    {
+        return ObjCast<T>(Get<Obj>(id));
     }
     template <class T, class... Args>
     std::shared_ptr<T> Create(Args&&... args)
     {
-        std::shared_ptr<T> obj = std::make_shared<T>(std::forward<Args>(args)...);
-        obj->id_ = idGen_++;
-        table_.emplace_hint(table_.end(), obj->id_, obj);
+        std::shared_ptr<T> obj = IsPooledObj<T>::value ? MakePooled<T>(std::forward<Args>(args)...) : std::make_shared<T>(std::forward<Args>(args)...);
+        obj->id_ = AllocSlot(obj);
+        objs_.push_back(obj);
         return obj;
     }
     void Delete(int id);
     bool IsDeleted(int id);
     void UpdateAll(bool ignoreStgSceneObj);
+    void SetUpdateBatch(const std::shared_ptr<ObjUpdateBatch>& batch) { updateBatch_ = batch; }
     void DeleteStgSceneObject();
-    const std::map<int, std::shared_ptr<Obj>>& GetAll();
+    // 作成順
+    const std::vector<std::shared_ptr<Obj>>& GetAll();
+    size_t GetSlotCount() const { return slots_.size(); }
+    size_t GetFreeSlotCount() const { return freeSlots_.size(); }
 private:
-    int idGen_;
-    std::map<int, std::shared_ptr<Obj>> table_;
-    std::shared_ptr<Obj> objCache_;
+    struct Slot
+    {
+        std::shared_ptr<Obj> obj;
+        uint32_t generation = 0;
+    };
+    int AllocSlot(const std::shared_ptr<Obj>& obj);
+    void FreeSlot(int id);
+    void RemoveDeadObjects();
+    void FreeSlotIfDead(const std::shared_ptr<Obj>& obj);
+    void FlushUpdateBatch();
+    std::vector<Slot> slots_;
+    std::deque<uint32_t> freeSlots_; // 古い順に再利用する
+    std::vector<std::shared_ptr<Obj>> objs_; // 作成順, 削除済みのものは次のRemoveDeadObjectsまで残る
+    bool hasDeadObjects_;
     bool isUpdating_;
+    std::shared_ptr<ObjUpdateBatch> updateBatch_;
+    std::vector<size_t> batchedObjIndices_; // updateBatch_に渡したobjs_の添字
 };
+
+template <>
+inline NullableSharedPtr<Obj> ObjectTable::Get<Obj>(int id)
+{
+    if (id < 0) return nullptr;
+    const uint32_t slotIdx = (uint32_t)id & SLOT_INDEX_MASK;
+    if (slotIdx >= slots_.size()) return nullptr;
+    const auto& obj = slots_[slotIdx].obj;
+    if (obj && obj->id_ == id && !obj->IsDead())
+    {
+        return obj;
+    }
+    return nullptr;
+}
 }
\ No newline at end of file
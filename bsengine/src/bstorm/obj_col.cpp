@@ -46,6 +46,18 @@ void ObjCol::SetWidthIntersection(float width)
     }
 }
 
+void ObjCol::UpdateIntersectionGroup()
+{
+    for (auto& isect : isects_)
+    {
+        colDetector_->Update(isect);
+    }
+    for (auto& isect : tempIsects_)
+    {
+        colDetector_->Update(isect);
+    }
+}
+
 void ObjCol::ClearIntersection()
 {
     isects_.clear();
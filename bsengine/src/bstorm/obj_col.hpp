@@ -1,5 +1,7 @@
 #pragma once
 
+#include <bstorm/obj.hpp>
+
 #include <deque>
 #include <vector>
 #include <memory>
@@ -13,6 +15,8 @@ class Package;
 class ObjCol
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::COL;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT;
     ObjCol(const std::shared_ptr<CollisionDetector>& colDetector);
     ~ObjCol();
     const std::deque<std::shared_ptr<Intersection>>& GetIntersections() const { return isects_; }
@@ -27,6 +31,8 @@ protected:
     void AddTempIntersection(const std::shared_ptr<Intersection>& isect);
     void TransIntersection(float dx, float dy);
     void SetWidthIntersection(float width);
+    // ̃O[vςɌĂCollisionDetectorɓo^
+    void UpdateIntersectionGroup();
     // develop only
     void RenderIntersection(const std::shared_ptr<Renderer>& renderer, bool isPermitCamera, const std::weak_ptr<Package>& package) const;
     void ClearIntersection();
@@ -19,6 +19,9 @@ ObjEnemy::ObjEnemy(bool isBoss, const std::shared_ptr<CollisionDetector>& colDet
     prevFrameShotHitCount_(0),
     isBoss_(isBoss)
 {
+    SetClassMask(CLASS_MASK);
+    SetObjMove(this);
+    SetObjCol(this);
     SetType(isBoss ? OBJ_ENEMY_BOSS : OBJ_ENEMY);
 }
 
@@ -87,12 +90,12 @@ const std::vector<Point2D>& ObjEnemy::GetIntersectionToShotPositions() const
 
 void ObjEnemy::AddTempIntersectionCircleToShot(float x, float y, float r)
 {
-    AddTempIntersection(std::make_shared<EnemyIntersectionToShot>(x, y, r, shared_from_this()));
+    AddTempIntersection(MakePooled<EnemyIntersectionToShot>(x, y, r, shared_from_this()));
 }
 
 void ObjEnemy::AddTempIntersectionCircleToPlayer(float x, float y, float r)
 {
-    AddTempIntersection(std::make_shared<EnemyIntersectionToPlayer>(x, y, r, shared_from_this()));
+    AddTempIntersection(MakePooled<EnemyIntersectionToPlayer>(x, y, r, shared_from_this()));
 }
 
 void ObjEnemy::AddShotDamage(double damage)
@@ -11,6 +11,8 @@ class Intersection;
 class ObjEnemy : public ObjSprite2D, public ObjMove, public ObjCol, public std::enable_shared_from_this<ObjEnemy>
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::ENEMY;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjSprite2D::CLASS_MASK | ObjMove::CLASS_MASK | ObjCol::CLASS_MASK;
     ObjEnemy(bool isBoss, const std::shared_ptr<CollisionDetector>& colDetector, const std::shared_ptr<Package>& package);
     ~ObjEnemy();
     void Update() override;
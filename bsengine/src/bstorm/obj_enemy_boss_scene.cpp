@@ -20,6 +20,7 @@ ObjEnemyBossScene::ObjEnemyBossScene(const std::shared_ptr<Package>& package) :
     lastEnemyBossX_(0),
     lastEnemyBossY_(0)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_ENEMY_BOSS_SCENE);
     steps_[0] = std::vector<Phase>();
 }
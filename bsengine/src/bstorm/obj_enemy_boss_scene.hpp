@@ -3,6 +3,8 @@
 #include <bstorm/obj.hpp>
 #include <bstorm/stage_common_player_params.hpp>
 
+#include <map>
+
 namespace bstorm
 {
 struct SourcePos;
@@ -10,6 +12,8 @@ class ObjEnemy;
 class ObjEnemyBossScene : public Obj
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::ENEMY_BOSS_SCENE;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | Obj::CLASS_MASK;
     ObjEnemyBossScene(const std::shared_ptr<Package>& package);
     void Update() override;
     void Regist(const std::shared_ptr<SourcePos>& srcPos);
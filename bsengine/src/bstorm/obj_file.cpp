@@ -4,10 +4,13 @@
 #include <bstorm/string_util.hpp>
 #include <bstorm/file_util.hpp>
 
+#include <algorithm>
+
 namespace bstorm
 {
 ObjFile::ObjFile(const std::shared_ptr<Package>& state) : Obj(state)
 {
+    SetClassMask(CLASS_MASK);
 }
 
 ObjFile::~ObjFile()
@@ -32,6 +35,7 @@ int ObjFile::getSize()
 
 ObjFileT::ObjFileT(const std::shared_ptr<Package>& state) : ObjFile(state)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_FILE_TEXT);
 }
 
@@ -40,7 +44,7 @@ void ObjFileT::Update() {}
 bool ObjFileT::Open(const std::wstring & path)
 {
     file_.close();
-    file_.open(path, std::ios::in);
+    OpenFileStream(file_, path, std::ios::in);
     if (!file_.is_open()) return false;
 
     // 行の読み込み
@@ -88,7 +92,7 @@ bool ObjFileT::OpenNW(const std::wstring& path)
 {
     file_.close();
     MakeDirectoryP(GetParentPath(path));
-    file_.open(path, std::ios::out);
+    OpenFileStream(file_, path, std::ios::out);
     return file_.good();
 }
 
@@ -134,6 +138,7 @@ ObjFileB::ObjFileB(const std::shared_ptr<Package>& state) :
     code_(Encoding::ACP),
     useBE_(false)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_FILE_BINARY);
 }
 
@@ -142,7 +147,7 @@ void ObjFileB::Update() {}
 bool ObjFileB::Open(const std::wstring & path)
 {
     file_.close();
-    file_.open(path, std::ios::in | std::ios::binary);
+    OpenFileStream(file_, path, std::ios::in | std::ios::binary);
     return file_.is_open();
 }
 
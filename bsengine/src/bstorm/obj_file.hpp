@@ -12,6 +12,8 @@ namespace bstorm
 class ObjFile : public Obj
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::FILE;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | Obj::CLASS_MASK;
     ObjFile(const std::shared_ptr<Package>& state);
     ~ObjFile();
     void OnDead() noexcept override;
@@ -26,6 +28,8 @@ protected:
 class ObjFileT : public ObjFile
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::FILE_T;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjFile::CLASS_MASK;
     ObjFileT(const std::shared_ptr<Package>& state);
     void Update() override;
     bool Open(const std::wstring& path);
@@ -43,6 +47,8 @@ private:
 class ObjFileB : public ObjFile
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::FILE_B;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjFile::CLASS_MASK;
     enum class Encoding
     {
         ACP,
@@ -30,6 +30,9 @@ ObjItem::ObjItem(int itemType, const std::shared_ptr<CollisionDetector>& colDete
     animationFrameCnt_(0),
     animationIdx_(0)
 {
+    SetClassMask(CLASS_MASK);
+    SetObjMove(this);
+    SetObjCol(this);
     SetType(OBJ_ITEM);
     SetBlendType(BLEND_NONE);
 
@@ -47,7 +50,7 @@ void ObjItem::SetIntersection()
 {
     if (GetIntersections().size() == 0)
     {
-        AddIntersection(std::make_shared<ItemIntersection>(GetX(), GetY(), 23.99999f, shared_from_this()));
+        AddIntersection(MakePooled<ItemIntersection>(GetX(), GetY(), 23.99999f, shared_from_this()));
     }
 
 }
@@ -83,7 +86,7 @@ void ObjItem::Update()
                 float playerY = player->GetY();
                 float distX = playerX - x;
                 float distY = playerY - y;
-                float dist = std::hypotf(distX, distY);
+                float dist = std::hypot(distX, distY);
                 float dx = autoCollectSpeed_ * distX / dist;
                 float dy = autoCollectSpeed_ * distY / dist;
                 // moveによる移動を消す
@@ -334,6 +337,8 @@ ObjItemScoreText::ObjItemScoreText(PlayerScore score, const std::shared_ptr<Text
     scoreTextDeleteTimer_(32),
     scoreTextAlpha_(0xff)
 {
+    SetClassMask(CLASS_MASK);
+    SetObjMove(this);
     SetBlendType(BLEND_ADD_ARGB);
     SetTexture(texture);
     SetMoveMode(std::make_shared<MoveModeHoverItemScoreText>(1.0f));
@@ -468,7 +473,7 @@ MoveModeItemDest::MoveModeItemDest(float destX, float destY, ObjMove * obj) :
 {
     float distX = destX - obj->GetMoveX();
     float distY = destY - obj->GetMoveY();
-    float dist = std::hypotf(distX, distY);
+    float dist = std::hypot(distX, distY);
     speed_ = dist / 16.0;
     frame_ = 0;
     lastX_ = obj->GetMoveX();
@@ -515,7 +520,7 @@ void MoveModeItemToPlayer::Move(float & x, float & y)
     {
         float distX = player->GetX() - x;
         float distY = player->GetY() - y;
-        float dist = std::hypotf(distX, distY);
+        float dist = std::hypot(distX, distY);
         float dx = speed_ * distX / dist;
         float dy = speed_ * distY / dist;
         x += dx;
@@ -19,6 +19,8 @@ class ItemIntersection;
 class ObjItem : public ObjRender, public ObjMove, public ObjCol, public std::enable_shared_from_this<ObjItem>
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::ITEM;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjRender::CLASS_MASK | ObjMove::CLASS_MASK | ObjCol::CLASS_MASK;
     ObjItem(int itemType, const std::shared_ptr<CollisionDetector>& colDetector, const std::shared_ptr<Package>& package);
     ~ObjItem();
     void SetIntersection();
@@ -60,6 +62,8 @@ private:
 class ObjItemScoreText : public ObjSpriteList2D, public ObjMove
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::ITEM_SCORE_TEXT;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjSpriteList2D::CLASS_MASK | ObjMove::CLASS_MASK;
     ObjItemScoreText(PlayerScore score, const std::shared_ptr<Texture>& texture, const std::shared_ptr<Package>& package);
     ~ObjItemScoreText();
     void Update() override;
@@ -141,4 +145,7 @@ public:
 private:
     float speed_;
 };
+
+template <> struct IsPooledObj<ObjItem> : std::true_type {};
+template <> struct IsPooledObj<ObjItemScoreText> : std::true_type {};
 }
\ No newline at end of file
@@ -11,6 +11,7 @@ namespace bstorm
 ObjMesh::ObjMesh(const std::shared_ptr<Package>& package) :
     ObjRender(package)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_MESH);
 }
 
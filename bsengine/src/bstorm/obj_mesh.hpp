@@ -10,6 +10,8 @@ class Mesh;
 class ObjMesh : public ObjRender
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::MESH;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjRender::CLASS_MASK;
     ObjMesh(const std::shared_ptr<Package>& state);
     ~ObjMesh();
     void Update() override;
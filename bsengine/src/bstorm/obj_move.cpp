@@ -93,7 +93,7 @@ void ObjMove::SetDestAtSpeed(float x, float y, float speed)
 {
     float dx = x - GetMoveX();
     float dy = y - GetMoveY();
-    float dist = std::hypotf(dx, dy);
+    float dist = std::hypot(dx, dy);
     int frame = (int)(ceil(dist / speed));
     float angle = D3DXToDegree(atan2(dy, dx));
     SetMoveMode(std::make_shared<MoveModeAtFrame>(frame, speed, angle));
@@ -103,7 +103,7 @@ void ObjMove::SetDestAtFrame(float x, float y, int frame)
 {
     float dx = x - GetMoveX();
     float dy = y - GetMoveY();
-    float dist = std::hypotf(dx, dy);
+    float dist = std::hypot(dx, dy);
     float speed = dist / frame;
     float angle = D3DXToDegree(atan2(dy, dx));
     SetMoveMode(std::make_shared<MoveModeAtFrame>(frame, speed, angle));
@@ -160,7 +160,69 @@ const std::shared_ptr<MoveMode>& ObjMove::GetMoveMode() const
     return mode;
 }
 
+// MoveModeA::MoveとMoveModeAKernelで共通の処理
+static inline void AccelerateA(float& speed, float& angle, float accel, float maxSpeed, float angularVelocity)
+{
+    speed += accel;
+    if (accel > 0 && speed > maxSpeed || accel < 0 && speed < maxSpeed)
+    {
+        speed = maxSpeed;
+    }
+    angle += angularVelocity;
+}
+
+static inline void TranslateA(float& x, float& y, float speed, float angle)
+{
+    float rad = D3DXToRadian(angle);
+    float dx = speed * cos(rad);
+    float dy = speed * sin(rad);
+    x += dx;
+    y += dy;
+}
+
+// MoveModeB::MoveとMoveModeBKernelで共通の処理
+static inline void MoveB(float& x, float& y, float& speedX, float& speedY, float accelX, float accelY, float maxSpeedX, float maxSpeedY)
+{
+    speedX += accelX;
+    if (accelX > 0 && speedX > maxSpeedX || accelX < 0 && speedX < maxSpeedX)
+    {
+        speedX = maxSpeedX;
+    }
+    speedY += accelY;
+    if (accelY > 0 && speedY > maxSpeedY || accelY < 0 && speedY < maxSpeedY)
+    {
+        speedY = maxSpeedY;
+    }
+    x += speedX;
+    y += speedY;
+}
+
+void MoveModeAKernel(size_t n, float* x, float* y, float* speed, float* angle, const float* accel, const float* maxSpeed, const float* angularVelocity)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        AccelerateA(speed[i], angle[i], accel[i], maxSpeed[i], angularVelocity[i]);
+    }
+    // 三角関数はベクトル化すると結果が変わりうるのでスカラーで計算する
+#ifdef _MSC_VER
+#pragma loop(no_vector)
+#endif
+    for (size_t i = 0; i < n; i++)
+    {
+        TranslateA(x[i], y[i], speed[i], angle[i]);
+    }
+}
+
+void MoveModeBKernel(size_t n, float* x, float* y, float* speedX, float* speedY, const float* accelX, const float* accelY, const float* maxSpeedX, const float* maxSpeedY)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        MoveB(x[i], y[i], speedX[i], speedY[i], accelX[i], accelY[i], maxSpeedX[i], maxSpeedY[i]);
+    }
+}
+
 MoveModeA::MoveModeA() :
+    MoveMode(Kind::A),
     speed_(0),
     angle_(0),
     accel_(0),
@@ -170,20 +232,12 @@ MoveModeA::MoveModeA() :
 }
 void MoveModeA::Move(float & x, float & y)
 {
-    speed_ += accel_;
-    if (accel_ > 0 && speed_ > maxSpeed_ || accel_ < 0 && speed_ < maxSpeed_)
-    {
-        speed_ = maxSpeed_;
-    }
-    angle_ += angularVelocity_;
-    float rad = D3DXToRadian(angle_);
-    float dx = speed_ * cos(rad);
-    float dy = speed_ * sin(rad);
-    x += dx;
-    y += dy;
+    AccelerateA(speed_, angle_, accel_, maxSpeed_, angularVelocity_);
+    TranslateA(x, y, speed_, angle_);
 }
 
 MoveModeB::MoveModeB(float speedX, float speedY, float accelX, float accelY, float maxSpeedX, float maxSpeedY) :
+    MoveMode(Kind::B),
     speedX_(speedX),
     speedY_(speedY),
     accelX_(accelX),
@@ -195,18 +249,7 @@ MoveModeB::MoveModeB(float speedX, float speedY, float accelX, float accelY, flo
 
 void MoveModeB::Move(float & x, float & y)
 {
-    speedX_ += accelX_;
-    if (accelX_ > 0 && speedX_ > maxSpeedX_ || accelX_ < 0 && speedX_ < maxSpeedX_)
-    {
-        speedX_ = maxSpeedX_;
-    }
-    speedY_ += accelY_;
-    if (accelY_ > 0 && speedY_ > maxSpeedY_ || accelY_ < 0 && speedY_ < maxSpeedY_)
-    {
-        speedY_ = maxSpeedY_;
-    }
-    x += speedX_;
-    y += speedY_;
+    MoveB(x, y, speedX_, speedY_, accelX_, accelY_, maxSpeedX_, maxSpeedY_);
 }
 
 float MoveModeB::GetAngle() const
@@ -216,7 +259,7 @@ float MoveModeB::GetAngle() const
 
 float MoveModeB::GetSpeed() const
 {
-    return std::hypotf(speedX_, speedY_);
+    return std::hypot(speedX_, speedY_);
 }
 
 MoveModeAtFrame::MoveModeAtFrame(int frame, float speed, float angle) :
@@ -260,7 +303,7 @@ MoveModeAtWeight::MoveModeAtWeight(float destX, float destY, float angle, float
 void MoveModeAtWeight::Move(float & x, float & y)
 {
     if (isArrived_) return;
-    float distFromDest = std::hypotf(x - destX_, y - destY_);
+    float distFromDest = std::hypot(x - destX_, y - destY_);
     if (distFromDest <= 1)
     {
         speed_ = 0;
@@ -318,7 +361,7 @@ void MovePatternA::Apply(ObjMove* move, ObjRender* obj)
         modeA->SetAngle(modeA->GetAngle() + D3DXToDegree(atan2(baseY - move->GetMoveY(), baseX - move->GetMoveX())));
     }
     // shotData
-    if (auto shot = dynamic_cast<ObjShot*>(obj))
+    if (auto shot = ObjCast<ObjShot>(obj))
     {
         if (auto data = shotData_.lock())
         {
@@ -358,7 +401,7 @@ void MovePatternB::Apply(ObjMove * move, ObjRender * obj)
     // maxSpeedY
     modeB->SetMaxSpeedY(maxSpeedY_);
     // shotData
-    if (auto shot = dynamic_cast<ObjShot*>(obj))
+    if (auto shot = ObjCast<ObjShot>(obj))
     {
         if (auto data = shotData_.lock())
         {
@@ -1,17 +1,31 @@
 ﻿#pragma once
 
+#include <bstorm/obj.hpp>
+
 #include <memory>
 #include <list>
+#include <cstddef>
 
 namespace bstorm
 {
 class MoveMode
 {
 public:
+    // まとめて移動できるものの判定用
+    enum class Kind
+    {
+        A,
+        B,
+        OTHER
+    };
+    MoveMode(Kind kind = Kind::OTHER) : kind_(kind) {}
     virtual ~MoveMode();
+    Kind GetKind() const { return kind_; }
     virtual void Move(float& x, float& y) = 0;
     virtual float GetSpeed() const = 0;
     virtual float GetAngle() const = 0;
+private:
+    const Kind kind_;
 };
 
 class MoveModeA : public MoveMode
@@ -149,6 +163,8 @@ private:
 class ObjMove
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::MOVE;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT;
     ObjMove(ObjRender *obj);
     float GetMoveX() const;
     void SetMoveX(float x);
@@ -168,6 +184,7 @@ public:
     const std::shared_ptr<MoveMode>& GetMoveMode() const;
     void SetMoveMode(const std::shared_ptr<MoveMode>& mode);
     void AddMovePattern(const std::shared_ptr<MovePattern>& pattern);
+    bool HasMovePattern() const { return !patterns_.empty(); }
 protected:
     void Move();
 private:
@@ -175,4 +192,9 @@ private:
     std::list<std::shared_ptr<MovePattern>> patterns_;
     ObjRender *obj_;
 };
+
+// MoveModeA, MoveModeBのMoveをn個まとめて行う (SoA)
+// 1要素ごとの演算はMove()と同じ順序なので結果も同じになる
+void MoveModeAKernel(size_t n, float* x, float* y, float* speed, float* angle, const float* accel, const float* maxSpeed, const float* angularVelocity);
+void MoveModeBKernel(size_t n, float* x, float* y, float* speedX, float* speedY, const float* accelX, const float* accelY, const float* maxSpeedX, const float* maxSpeedY);
 };
\ No newline at end of file
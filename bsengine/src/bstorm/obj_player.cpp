@@ -43,6 +43,9 @@ ObjPlayer::ObjPlayer(const std::shared_ptr<CollisionDetector>& colDetector, cons
     downStateTimer_(0),
     currentFrameGrazeCnt_(0)
 {
+    SetClassMask(CLASS_MASK);
+    SetObjMove(this);
+    SetObjCol(this);
     SetType(OBJ_PLAYER);
     InitPosition();
 }
@@ -124,8 +127,8 @@ void ObjPlayer::AddIntersectionCircleA1(float dx, float dy, float r, float dr)
 {
     if (auto package = GetPackage().lock())
     {
-        ObjCol::AddIntersection(std::make_shared<PlayerIntersection>(GetX() + dx, GetY() + dy, r, shared_from_this()));
-        ObjCol::AddIntersection(std::make_shared<PlayerGrazeIntersection>(GetX() + dx, GetY() + dy, r + dr, shared_from_this()));
+        ObjCol::AddIntersection(MakePooled<PlayerIntersection>(GetX() + dx, GetY() + dy, r, shared_from_this()));
+        ObjCol::AddIntersection(MakePooled<PlayerGrazeIntersection>(GetX() + dx, GetY() + dy, r + dr, shared_from_this()));
     }
 }
 
@@ -133,7 +136,7 @@ void ObjPlayer::AddIntersectionCircleA2(float dx, float dy, float r)
 {
     if (auto package = GetPackage().lock())
     {
-        ObjCol::AddIntersection(std::make_shared<PlayerGrazeIntersection>(GetX() + dx, GetY() + dy, r, shared_from_this()));
+        ObjCol::AddIntersection(MakePooled<PlayerGrazeIntersection>(GetX() + dx, GetY() + dy, r, shared_from_this()));
     }
 }
 
@@ -141,7 +144,7 @@ void ObjPlayer::AddIntersectionToItem()
 {
     if (auto package = GetPackage().lock())
     {
-        ObjCol::AddIntersection(std::make_shared<PlayerIntersectionToItem>(GetX(), GetY(), shared_from_this()));
+        ObjCol::AddIntersection(MakePooled<PlayerIntersectionToItem>(GetX(), GetY(), shared_from_this()));
     }
 }
 
@@ -16,6 +16,8 @@ class ObjShot;
 class ObjPlayer : public ObjSprite2D, public ObjMove, public ObjCol, public std::enable_shared_from_this<ObjPlayer>
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::PLAYER;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjSprite2D::CLASS_MASK | ObjMove::CLASS_MASK | ObjCol::CLASS_MASK;
     ObjPlayer(const std::shared_ptr<CollisionDetector>& colDetector, const std::shared_ptr<Package>& package);
     ~ObjPlayer();
     void Update() override;
@@ -21,6 +21,7 @@ ObjPrim::ObjPrim(const std::shared_ptr<Package>& state) :
     ObjRender(state),
     primType_(D3DPT_TRIANGLELIST)
 {
+    SetClassMask(CLASS_MASK);
 }
 
 ObjPrim::~ObjPrim()
@@ -173,6 +174,7 @@ _D3DPRIMITIVETYPE ObjPrim::GetD3DPrimitiveType() const
 ObjPrim2D::ObjPrim2D(const std::shared_ptr<Package>& state) :
     ObjPrim(state)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_PRIMITIVE_2D);
 }
 
@@ -185,6 +187,7 @@ void ObjPrim2D::Render(const std::shared_ptr<Renderer>& renderer)
 ObjSprite2D::ObjSprite2D(const std::shared_ptr<Package>& state) :
     ObjPrim2D(state)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_SPRITE_2D);
     SetPrimitiveType(PRIMITIVE_TRIANGLESTRIP);
     SetVertexCount(4);
@@ -230,6 +233,7 @@ ObjSpriteList2D::ObjSpriteList2D(const std::shared_ptr<Package>& state) :
     dstRectRight_(0),
     dstRectBottom_(0)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_SPRITE_LIST_2D);
     SetPrimitiveType(D3DPT_TRIANGLELIST);
 }
@@ -359,6 +363,7 @@ ObjPrim3D::ObjPrim3D(const std::shared_ptr<Package>& state) :
     ObjPrim(state),
     billboardEnable_(false)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_PRIMITIVE_3D);
 }
 
@@ -376,6 +381,7 @@ bool ObjPrim3D::IsBillboardEnabled() const
 ObjSprite3D::ObjSprite3D(const std::shared_ptr<Package>& state) :
     ObjPrim3D(state)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_SPRITE_3D);
     SetPrimitiveType(PRIMITIVE_TRIANGLESTRIP);
     SetVertexCount(4);
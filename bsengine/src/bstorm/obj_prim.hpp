@@ -15,6 +15,8 @@ class RenderTarget;
 class ObjPrim : public ObjRender
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::PRIM;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjRender::CLASS_MASK;
     ObjPrim(const std::shared_ptr<Package>& state);
     ~ObjPrim();
     void Update() override;
@@ -48,6 +50,8 @@ private:
 class ObjPrim2D : public ObjPrim
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::PRIM_2D;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjPrim::CLASS_MASK;
     ObjPrim2D(const std::shared_ptr<Package>& state);
     void Render(const std::shared_ptr<Renderer>& renderer) override;
 };
@@ -55,6 +59,8 @@ public:
 class ObjSprite2D : public ObjPrim2D
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::SPRITE_2D;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjPrim2D::CLASS_MASK;
     ObjSprite2D(const std::shared_ptr<Package>& state);
     void SetSourceRect(float left, float top, float right, float bottom);
     void SetDestRect(float left, float top, float right, float bottom);
@@ -64,6 +70,8 @@ public:
 class ObjSpriteList2D : public ObjPrim2D
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::SPRITE_LIST_2D;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjPrim2D::CLASS_MASK;
     ObjSpriteList2D(const std::shared_ptr<Package>& state);
     void Render(const std::shared_ptr<Renderer>& renderer) override;
     void SetSourceRect(float left, float top, float right, float bottom);
@@ -87,6 +95,8 @@ private:
 class ObjPrim3D : public ObjPrim
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::PRIM_3D;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjPrim::CLASS_MASK;
     ObjPrim3D(const std::shared_ptr<Package>& state);
     void Render(const std::shared_ptr<Renderer>& renderer) override;
     bool IsBillboardEnabled() const;
@@ -97,6 +107,8 @@ protected:
 class ObjSprite3D : public ObjPrim3D
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::SPRITE_3D;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjPrim3D::CLASS_MASK;
     ObjSprite3D(const std::shared_ptr<Package>& state);
     void SetSourceRect(float left, float top, float right, float bottom);
     void SetDestRect(float left, float top, float right, float bottom);
@@ -33,6 +33,7 @@ ObjRender::ObjRender(const std::shared_ptr<Package>& package) :
     zTestEnable_(true),
     permitCamera_(true)
 {
+    SetClassMask(CLASS_MASK);
 }
 
 ObjRender::~ObjRender()
@@ -233,7 +234,7 @@ void ObjectLayerList::RenderLayer(int priority, bool ignoreStgSceneObj, bool che
     auto it = layer.begin();
     while (it != layer.end())
     {
-        auto& obj = it->lock();
+        auto obj = it->lock();
         if (!obj)
         {
             //解放済み
@@ -248,7 +249,7 @@ void ObjectLayerList::RenderLayer(int priority, bool ignoreStgSceneObj, bool che
         // StgSceneのオブジェクトを描画するかどうか
         if (ignoreStgSceneObj && obj->IsStgSceneObject()) { continue; }
 
-        auto shot = std::dynamic_pointer_cast<ObjShot>(obj);
+        ObjShot* shot = ObjCast<ObjShot>(obj.get());
 
         // 非Shot
         if (!shot)
@@ -278,20 +279,20 @@ void ObjectLayerList::RenderLayer(int priority, bool ignoreStgSceneObj, bool che
             switch (blendType)
             {
                 case BLEND_ALPHA:
-                    alphaShots.push_back(shot);
+                    alphaShots.push_back(obj);
                     break;
                 case BLEND_ADD_RGB:
                 case BLEND_ADD_ARGB:
-                    addShots.push_back(shot);
+                    addShots.push_back(obj);
                     break;
                 case BLEND_MULTIPLY:
-                    mulShots.push_back(shot);
+                    mulShots.push_back(obj);
                     break;
                 case BLEND_SUBTRACT:
-                    subShots.push_back(shot);
+                    subShots.push_back(obj);
                     break;
                 case BLEND_INV_DESTRGB:
-                    invShots.push_back(shot);
+                    invShots.push_back(obj);
                     break;
             }
         }
@@ -396,6 +397,7 @@ void ObjectLayerList::ClearInvalidRenderPriority()
 
 ObjShader::ObjShader(const std::shared_ptr<Package>& package) : ObjRender(package)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_SHADER);
 }
 ObjShader::~ObjShader() {}
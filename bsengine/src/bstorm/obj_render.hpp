@@ -20,6 +20,8 @@ class ObjectLayerList;
 class ObjRender : public Obj
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::RENDER;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | Obj::CLASS_MASK;
     ObjRender(const std::shared_ptr<Package>& package);
     ~ObjRender();
     virtual void Render(const std::shared_ptr<Renderer>& renderer) = 0;
@@ -120,6 +122,8 @@ private:
 class ObjShader : public ObjRender
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::SHADER;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjRender::CLASS_MASK;
     ObjShader(const std::shared_ptr<Package>& package);
     ~ObjShader();
     void Update() override {}
@@ -47,6 +47,9 @@ ObjShot::ObjShot(bool isPlayerShot, const std::shared_ptr<CollisionDetector>& co
     animationFrameCnt_(0),
     animationIdx_(0)
 {
+    SetClassMask(CLASS_MASK);
+    SetObjMove(this);
+    SetObjCol(this);
     SetType(OBJ_SHOT);
     SetBlendType(BLEND_NONE);
     if (isPlayerShot_)
@@ -70,21 +73,69 @@ void ObjShot::Update()
         if (!IsDelay())
         {
             Move();
-            CheckAutoDelete(GetX(), GetY());
-            if (shotData_)
-            {
-                SetAngleZ(GetAngleZ() + GetAngularVelocity());
-                UpdateAnimationPosition();
-            }
         }
-        TickAddedShotFrameCount();
-        TickDelayTimer();
-        TickDeleteFrameTimer();
-        TickFadeDeleteTimer();
+        UpdateAfterMove();
+    } else
+    {
+        UpdateTempIntersection();
+    }
+}
+
+void ObjShot::UpdateAfterMove()
+{
+    if (!IsDelay())
+    {
+        CheckAutoDelete(GetX(), GetY());
+        if (shotData_)
+        {
+            SetAngleZ(GetAngleZ() + GetAngularVelocity());
+            UpdateAnimationPosition();
+        }
     }
+    TickAddedShotFrameCount();
+    TickDelayTimer();
+    TickDeleteFrameTimer();
+    TickFadeDeleteTimer();
     UpdateTempIntersection();
 }
 
+bool ObjShot::UpdateAfterMoveLocal(const Package& package, float x, float y)
+{
+    // IsMoveBatchableなので遅延中ではない
+    if (shotData_)
+    {
+        SetAngleZ(GetAngleZ() + GetAngularVelocity());
+        UpdateAnimationPosition();
+    }
+    // 遅延中でないので遅延タイマーは0のまま. 他のTickより先に呼んでも結果は同じ
+    TickDelayTimer();
+    return autoDeleteEnable_ && package.IsOutOfShotAutoDeleteClip(x, y);
+}
+
+void ObjShot::UpdateAfterMoveShared(bool isAutoDeleted)
+{
+    if (isAutoDeleted)
+    {
+        Die();
+    }
+    TickAddedShotFrameCount();
+    TickDeleteFrameTimer();
+    TickFadeDeleteTimer();
+    UpdateTempIntersection();
+}
+
+bool ObjShot::IsMoveBatchable() const
+{
+    // レーザーはUpdateが別
+    if (GetClassMask() & ObjClass::LASER) return false;
+    if (IsDead() || !IsRegistered() || IsDelay() || GetPenetration() <= 0) return false;
+    // 移動の後にスクリプトのイベントや他のオブジェクトの操作が起こりうるものは逐次更新する
+    if (!addedShots_.empty() || IsFadeDeleteStarted() || IsFrameDeleteStarted()) return false;
+    if (HasMovePattern()) return false;
+    const auto kind = GetMoveMode()->GetKind();
+    return kind == MoveMode::Kind::A || kind == MoveMode::Kind::B;
+}
+
 void ObjShot::OnDead() noexcept
 {
     if (auto package = GetPackage().lock())
@@ -251,6 +302,7 @@ void ObjShot::SetEraseShotEnable(bool enable)
                 shotIsect->SetEraseShotEnable(enable);
             }
         }
+        ObjCol::UpdateIntersectionGroup();
     }
 }
 
@@ -296,12 +348,12 @@ void ObjShot::AddIntersectionCircleA1(float r)
 
 void ObjShot::AddIntersectionCircleA2(float x, float y, float r)
 {
-    AddIntersection(std::make_shared<ShotIntersection>(x, y, r, shared_from_this(), false));
+    AddIntersection(MakePooled<ShotIntersection>(x, y, r, shared_from_this(), false));
 }
 
 void ObjShot::AddIntersectionLine(float x1, float y1, float x2, float y2, float width)
 {
-    AddIntersection(std::make_shared<ShotIntersection>(x1, y1, x2, y2, width, shared_from_this(), false));
+    AddIntersection(MakePooled<ShotIntersection>(x1, y1, x2, y2, width, shared_from_this(), false));
 }
 
 void ObjShot::AddTempIntersectionCircleA1(float r)
@@ -311,12 +363,12 @@ void ObjShot::AddTempIntersectionCircleA1(float r)
 
 void ObjShot::AddTempIntersectionCircleA2(float x, float y, float r)
 {
-    AddTempIntersection(std::make_shared<ShotIntersection>(x, y, r, shared_from_this(), true));
+    AddTempIntersection(MakePooled<ShotIntersection>(x, y, r, shared_from_this(), true));
 }
 
 void ObjShot::AddTempIntersectionLine(float x1, float y1, float x2, float y2, float width)
 {
-    AddTempIntersection(std::make_shared<ShotIntersection>(x1, y1, x2, y2, width, shared_from_this(), true));
+    AddTempIntersection(MakePooled<ShotIntersection>(x1, y1, x2, y2, width, shared_from_this(), true));
 }
 
 bool ObjShot::IsIntersectionEnabled() const
@@ -358,9 +410,26 @@ void ObjShot::SetShotData(const std::shared_ptr<ShotData>& data)
             {
                 if (!isTempIntersectionMode_)
                 {
-                    for (const auto& col : shotData_->collisions)
+                    // 複数の円は1つの判定にまとめる
+                    const auto& cols = shotData_->collisions;
+                    for (size_t begin = 0; begin < cols.size(); begin += Shape::MaxCompoundCircleCount)
                     {
-                        AddIntersectionCircleA2(GetX() + col.x, GetY() + col.y, col.r);
+                        const int circleCnt = (int)std::min(cols.size() - begin, (size_t)Shape::MaxCompoundCircleCount);
+                        if (circleCnt == 1)
+                        {
+                            AddIntersectionCircleA2(GetX() + cols[begin].x, GetY() + cols[begin].y, cols[begin].r);
+                            continue;
+                        }
+                        float xs[Shape::MaxCompoundCircleCount];
+                        float ys[Shape::MaxCompoundCircleCount];
+                        float rs[Shape::MaxCompoundCircleCount];
+                        for (int i = 0; i < circleCnt; i++)
+                        {
+                            xs[i] = GetX() + cols[begin + i].x;
+                            ys[i] = GetY() + cols[begin + i].y;
+                            rs[i] = cols[begin + i].r;
+                        }
+                        AddIntersection(MakePooled<ShotIntersection>(Shape(circleCnt, xs, ys, rs), shared_from_this(), false));
                     }
                 }
                 if (shotData_->useAngularVelocityRand)
@@ -606,7 +675,7 @@ void ObjShot::TickAddedShotFrameCount()
                     } else if (it->type == AddedShot::Type::A2)
                     {
                         float baseAngle = 0;
-                        auto stLaser = dynamic_cast<ObjStLaser*>(this);
+                        auto stLaser = ObjCast<ObjStLaser>(this);
                         if (stLaser != NULL)
                         {
                             baseAngle = stLaser->GetLaserAngle();
@@ -694,6 +763,7 @@ ObjLaser::ObjLaser(bool isPlayerShot, const std::shared_ptr<CollisionDetector>&
     grazeInvalidTimer_(0),
     itemDistance_(25)
 {
+    SetClassMask(CLASS_MASK);
     SetSpellResistEnable(true);
     SetPenetration(1 << 24);
 }
@@ -795,6 +865,7 @@ ObjLooseLaser::ObjLooseLaser(bool isPlayerShot, const std::shared_ptr<CollisionD
     invalidLengthTail_(0),
     defaultInvalidLengthEnable_(true)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_LOOSE_LASER);
 }
 
@@ -979,6 +1050,7 @@ ObjStLaser::ObjStLaser(bool isPlayerShot, const std::shared_ptr<CollisionDetecto
     laserSourceEnable_(true),
     laserWidthScale_(0)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_STRAIGHT_LASER);
 }
 
@@ -1080,6 +1152,7 @@ ObjCrLaser::ObjCrLaser(bool isPlayerShot, const std::shared_ptr<CollisionDetecto
     shrinkThresholdOffset_((size_t)(this) & 0xff),
     tipDecrement_(1)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_CURVE_LASER);
 }
 
@@ -1259,7 +1332,7 @@ void ObjCrLaser::Extend(float x, float y)
         trail_.emplace_back(x + dx, y + dy, 0.0f, 0, 0.0f, 0.0f);
         trail_.emplace_back(x - dx, y - dy, 0.0f, 0, 0.0f, 0.0f);
 
-        float laserNodeLength = std::hypotf(x - headX_, y - headY_);
+        float laserNodeLength = std::hypot(x - headX_, y - headY_);
         totalLaserLength_ += laserNodeLength;
         laserNodeLengthList_.push_back(laserNodeLength);
 
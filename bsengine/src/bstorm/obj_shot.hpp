@@ -17,6 +17,8 @@ class ShotCounter;
 class ObjShot : public ObjRender, public ObjMove, public ObjCol, public std::enable_shared_from_this<ObjShot>
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::SHOT;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjRender::CLASS_MASK | ObjMove::CLASS_MASK | ObjCol::CLASS_MASK;
     ObjShot(bool isPlayerShot, const std::shared_ptr<CollisionDetector>& colDetector, const std::shared_ptr<Package>& package);
     ~ObjShot();
 
@@ -24,6 +26,16 @@ public:
     void OnDead() noexcept override;
     void Render(const std::shared_ptr<Renderer>& renderer) override;
 
+    // ShotMoveBatchで移動をまとめて行えるか
+    bool IsMoveBatchable() const;
+    // Updateのうち移動より後の処理
+    void UpdateAfterMove();
+    // ShotMoveBatch用にUpdateAfterMoveを2つに分けたもの. 続けて呼ぶとUpdateAfterMoveと同じ結果になる
+    // Local: 自身の状態しか変更しないので並列に呼んでよい. 移動後の位置を受け取り, 自動削除されるかを返す
+    // Shared: 削除や当たり判定の登録など他に影響する処理なので逐次呼ぶ
+    bool UpdateAfterMoveLocal(const Package& package, float x, float y);
+    void UpdateAfterMoveShared(bool isAutoDeleted);
+
     bool IsRegistered() const;
     void Regist();
     bool IsPlayerShot() const;
@@ -147,6 +159,8 @@ private:
 class ObjLaser : public ObjShot
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::LASER;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjShot::CLASS_MASK;
     ObjLaser(bool isPlayerShot, const std::shared_ptr<CollisionDetector>& colDetector, const std::shared_ptr<Package>& package);
     void SetShotData(const std::shared_ptr<ShotData>& shotData) override;
     void Graze() override;
@@ -178,6 +192,8 @@ private:
 class ObjLooseLaser : public ObjLaser
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::LOOSE_LASER;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjLaser::CLASS_MASK;
     ObjLooseLaser(bool isPlayerShot, const std::shared_ptr<CollisionDetector>& colDetector, const std::shared_ptr<Package>& package);
     void Update() override;
     void Render(const std::shared_ptr<Renderer>& renderer) override;
@@ -204,6 +220,8 @@ private:
 class ObjStLaser : public ObjLooseLaser
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::ST_LASER;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjLooseLaser::CLASS_MASK;
     ObjStLaser(bool isPlayerShot, const std::shared_ptr<CollisionDetector>& colDetector, const std::shared_ptr<Package>& package);
     void Update() override;
     void Render(const std::shared_ptr<Renderer>& renderer) override;
@@ -222,6 +240,8 @@ private:
 class ObjCrLaser : public ObjLaser
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::CR_LASER;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjLaser::CLASS_MASK;
     ObjCrLaser(bool isPlayerShot, const std::shared_ptr<CollisionDetector>& colDetector, const std::shared_ptr<Package>& package);
     void Update() override;
     void Render(const std::shared_ptr<Renderer>& renderer) override;
@@ -243,4 +263,9 @@ protected:
     float headY_;
     float tipDecrement_;
 };
+
+template <> struct IsPooledObj<ObjShot> : std::true_type {};
+template <> struct IsPooledObj<ObjLooseLaser> : std::true_type {};
+template <> struct IsPooledObj<ObjStLaser> : std::true_type {};
+template <> struct IsPooledObj<ObjCrLaser> : std::true_type {};
 }
\ No newline at end of file
@@ -12,6 +12,7 @@ ObjSound::ObjSound(const std::shared_ptr<Package>& package) :
     division_(SoundDivision::BGM),
     fadeRatePerSec_(0)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_SOUND);
 }
 
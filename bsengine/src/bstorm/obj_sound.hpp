@@ -10,6 +10,8 @@ class SoundBuffer;
 class ObjSound : public Obj
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::SOUND;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | Obj::CLASS_MASK;
     enum class SoundDivision
     {
         BGM,
@@ -13,6 +13,8 @@ ObjSpell::ObjSpell(const std::shared_ptr<CollisionDetector>& colDetector, const
     isRegistered_(false),
     eraseShotEnable_(true)
 {
+    SetClassMask(CLASS_MASK);
+    SetObjCol(this);
     SetType(OBJ_SPELL);
 }
 
@@ -49,16 +51,17 @@ void ObjSpell::SetEraseShotEnable(bool enable) { eraseShotEnable_ = enable; }
 
 void ObjSpell::AddTempIntersectionCircle(float x, float y, float r)
 {
-    AddTempIntersection(std::make_shared<SpellIntersection>(x, y, r, shared_from_this()));
+    AddTempIntersection(MakePooled<SpellIntersection>(x, y, r, shared_from_this()));
 }
 
 void ObjSpell::AddTempIntersectionLine(float x1, float y1, float x2, float y2, float width)
 {
-    AddTempIntersection(std::make_shared<SpellIntersection>(x1, y1, x2, y2, width, shared_from_this()));
+    AddTempIntersection(MakePooled<SpellIntersection>(x1, y1, x2, y2, width, shared_from_this()));
 }
 ObjSpellManage::ObjSpellManage(const std::shared_ptr<Package>& package) :
     Obj(package)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_SPELL_MANAGE);
 }
 ObjSpellManage::~ObjSpellManage()
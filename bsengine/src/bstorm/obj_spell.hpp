@@ -9,6 +9,8 @@ class SpellIntersection;
 class ObjSpell : public ObjPrim2D, public ObjCol, public std::enable_shared_from_this<ObjSpell>
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::SPELL;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjPrim2D::CLASS_MASK | ObjCol::CLASS_MASK;
     ObjSpell(const std::shared_ptr<CollisionDetector>& colDetector, const std::shared_ptr<Package>& package);
     ~ObjSpell();
     void Update() override;
@@ -30,6 +32,8 @@ protected:
 class ObjSpellManage : public Obj
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::SPELL_MANAGE;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | Obj::CLASS_MASK;
     ObjSpellManage(const std::shared_ptr<Package>& package);
     ~ObjSpellManage();
     void Update() override;
@@ -36,6 +36,7 @@ ObjText::ObjText(const std::shared_ptr<Package>& state) :
     syntacticAnalysisEnable_(true),
     isFontParamModified_(true)
 {
+    SetClassMask(CLASS_MASK);
     SetType(OBJ_TEXT);
 }
 
@@ -12,6 +12,8 @@ class FontStore;
 class ObjText : public ObjRender
 {
 public:
+    static constexpr uint32_t CLASS_BIT = ObjClass::TEXT;
+    static constexpr uint32_t CLASS_MASK = CLASS_BIT | ObjRender::CLASS_MASK;
     ObjText(const std::shared_ptr<Package>& state);
     ~ObjText();
     void Update() override;
@@ -38,19 +38,26 @@
 #include <bstorm/obj_item.hpp>
 #include <bstorm/obj_player.hpp>
 #include <bstorm/shot_counter.hpp>
+#include <bstorm/shot_move_batch.hpp>
+#include <bstorm/engine_develop_options.hpp>
 #include <bstorm/intersection.hpp>
+#include <bstorm/broadphase.hpp>
 #include <bstorm/shot_data.hpp>
 #include <bstorm/item_data.hpp>
 #include <bstorm/rand_generator.hpp>
 #include <bstorm/file_loader.hpp>
 #include <bstorm/script_info.hpp>
 #include <bstorm/serialized_script.hpp>
+#include <bstorm/script_precompiler.hpp>
 #include <bstorm/script.hpp>
 #include <bstorm/replay_data.hpp>
 #include <bstorm/config.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <exception>
 #include <ctime>
+#include <thread>
 
 #undef VK_LEFT
 #undef VK_RIGHT
@@ -64,6 +71,15 @@
 
 namespace bstorm
 {
+static std::shared_ptr<Broadphase> createBroadphase(int fieldWidth, int fieldHeight, const EngineDevelopOptions& engineDevelopOptions)
+{
+    if (engineDevelopOptions.uniformGridBroadphaseEnable)
+    {
+        return std::make_shared<UniformGridBroadphase>(fieldWidth, fieldHeight, UniformGridBroadphase::CalcCellSize(DEFAULT_TYPICAL_SHOT_RADIUS));
+    }
+    return std::make_shared<QuadTreeBroadphase>(fieldWidth, fieldHeight);
+}
+
 Package::Package(HWND hWnd,
                  int screenWidth,
                  int screenHeight,
@@ -86,20 +102,22 @@ Package::Package(HWND hWnd,
     soundDevice(std::make_shared<SoundDevice>(hWnd)),
     renderer_(std::make_shared<Renderer>(graphicDevice_->GetDevice())),
     objTable_(std::make_shared<ObjectTable>()),
+    shotMoveBatch_(std::make_shared<ShotMoveBatch>(this)),
     objLayerList_(std::make_shared<ObjectLayerList>()),
-    colDetector_(std::make_shared<CollisionDetector>(screenWidth, screenHeight, std::make_shared<CollisionMatrix>(DEFAULT_COLLISION_MATRIX_DIMENSION, DEFAULT_COLLISION_MATRIX))),
+    colDetector_(std::make_shared<CollisionDetector>(createBroadphase(screenWidth, screenHeight, *engineDevelopOptions), std::make_shared<CollisionMatrix>(DEFAULT_COLLISION_MATRIX_DIMENSION, DEFAULT_COLLISION_MATRIX))),
     textureStore_(std::make_shared<TextureStore>(graphicDevice_)),
     meshStore_(std::make_shared<MeshStore>(textureStore_, fileLoader_)),
     camera2D_(std::make_shared<Camera2D>()),
     camera3D_(std::make_shared<Camera3D>()),
     commonDataDB_(std::make_shared<CommonDataDB>()),
-    serializedScriptStore_(std::make_shared<SerializedScriptStore>(fileLoader_)),
+    serializedScriptStore_(std::make_shared<SerializedScriptStore>(fileLoader_, DEFAULT_SCRIPT_CACHE_DIR)),
     scriptManager_(std::make_shared<ScriptManager>(fileLoader_, serializedScriptStore_)),
+    scriptPrecompiler_(std::make_shared<ScriptPrecompiler>(serializedScriptStore_, fileLoader_, 0)),
     playerShotDataTable_(std::make_shared<ShotDataTable>(ShotDataTable::Type::PLAYER, textureStore_, fileLoader_)),
     enemyShotDataTable_(std::make_shared<ShotDataTable>(ShotDataTable::Type::ENEMY, textureStore_, fileLoader_)),
     itemDataTable_(std::make_shared<ItemDataTable>(textureStore_, fileLoader_)),
     shotCounter_(std::make_shared<ShotCounter>()),
-    randGenerator_(std::make_shared<RandGenerator>((uint32_t)this)), // FUTURE : from rand
+    randGenerator_(std::make_shared<RandGenerator>((uint32_t)(uintptr_t)this)), // FUTURE : from rand
     autoItemCollectionManager_(std::make_shared<AutoItemCollectionManager>()),
     elapsedFrame_(0),
     stageElapesdFrame_(0),
@@ -219,6 +237,11 @@ void Package::TickFrame()
 
     scriptManager_->RunMainLoopAllNonStgScript();
 
+    objTable_->SetUpdateBatch(engineDevelopOptions_->shotMoveBatchEnable ? shotMoveBatch_ : nullptr);
+    const int shotUpdateThreadCnt = engineDevelopOptions_->shotUpdateThreadCount;
+    shotMoveBatch_->SetThreadCount(shotUpdateThreadCnt > 0 ? shotUpdateThreadCnt : (int)std::thread::hardware_concurrency());
+    colDetector_->GetBroadphase()->SetThreadCount(engineDevelopOptions_->parallelCollisionEnable ? (int)std::thread::hardware_concurrency() : 1);
+
     if (IsStagePaused())
     {
         objTable_->UpdateAll(true);
@@ -522,19 +545,6 @@ std::wstring Package::GetTransitionRenderTargetName() const
     return TRANSITION_RENDER_TARGET_NAME;
 }
 
-static D3DXIMAGE_FILEFORMAT getProperFileFormat(const std::wstring& path)
-{
-    auto ext = GetLowerExt(path);
-    if (ext == L".png" || ext.empty()) return D3DXIFF_PNG;
-    if (ext == L".bmp") return D3DXIFF_BMP;
-    if (ext == L".dds") return D3DXIFF_DDS;
-    if (ext == L".jpg" || ext == L".jpeg") return D3DXIFF_JPG;
-    if (ext == L".dib") return D3DXIFF_DIB;
-    if (ext == L".hdr") return D3DXIFF_HDR;
-    if (ext == L".pfm") return D3DXIFF_PFM;
-    return D3DXIFF_PNG;
-}
-
 void Package::SaveRenderedTextureA1(const std::wstring & name, const std::wstring & path, const std::shared_ptr<SourcePos>& srcPos)
 {
     if (auto renderTarget = GetRenderTarget(name))
@@ -548,10 +558,8 @@ void Package::SaveRenderedTextureA2(const std::wstring & name, const std::wstrin
 {
     if (auto renderTarget = GetRenderTarget(name))
     {
-        auto viewport = renderTarget->GetViewport();
-        RECT rect = { left, top, right, bottom };
         MakeDirectoryP(GetParentPath(path));
-        if (SUCCEEDED(D3DXSaveSurfaceToFile(path.c_str(), getProperFileFormat(path), renderTarget->GetSurface(), NULL, &rect)))
+        if (renderTarget->SaveToFile(path, left, top, right, bottom))
         {
             return;
         }
@@ -598,9 +606,7 @@ std::shared_ptr<Shader> Package::CreateShader(const std::wstring & path, bool pr
 
 bool Package::IsPixelShaderSupported(int major, int minor)
 {
-    D3DCAPS9 caps;
-    graphicDevice_->GetDevice()->GetDeviceCaps(&caps);
-    return caps.PixelShaderVersion >= D3DPS_VERSION(major, minor);
+    return graphicDevice_->IsPixelShaderSupported(major, minor);
 }
 
 const std::shared_ptr<Mesh>& Package::LoadMesh(const std::wstring & path)
@@ -1875,47 +1881,84 @@ void Package::DeleteShotInCircle(int target, int behavior, float x, float y, flo
     }
 }
 
-std::vector<std::shared_ptr<ObjShot>> Package::GetShotInCircle(float x, float y, float r, int target) const
+// targetに該当する弾の判定ならその弾のIDを取り出す
+static bool getTargetShot(const std::shared_ptr<Intersection>& isect, int target, int& id)
+{
+    auto shotIsect = dynamic_cast<ShotIntersection*>(isect.get());
+    if (!shotIsect) return false;
+    if (target == TARGET_ENEMY && shotIsect->IsPlayerShot()) return false;
+    if (target == TARGET_PLAYER && !shotIsect->IsPlayerShot()) return false;
+    if (auto shot = shotIsect->GetShot().lock())
+    {
+        if (shot->IsDead()) return false;
+        id = shot->GetID();
+        return true;
+    }
+    return false;
+}
+
+// 検索する判定のグループ, 負なら全て
+static int getShotTargetGroup(int target)
 {
-    // 同じショットに紐付いている判定が複数あるので、まずIDだけを集める
-    std::unordered_set<int> shotIds;
+    return target == TARGET_ENEMY ? COL_GRP_ENEMY_SHOT : -1;
+}
 
-    auto isects = colDetector_->GetIntersectionsCollideWithShape(Shape(x, y, r), -1);
-    for (auto& isect : isects)
+const std::vector<int>& Package::GetShotIdInShape(const Shape& shape, int target)
+{
+    queryIds_.clear();
+    colDetector_->ForEachIntersectionCollideWithShape(shape, getShotTargetGroup(target), [&](const std::shared_ptr<Intersection>& isect)
     {
-        if (auto shotIsect = std::dynamic_pointer_cast<ShotIntersection>(isect))
+        int id;
+        if (getTargetShot(isect, target, id))
         {
-            if (target == TARGET_ENEMY && shotIsect->IsPlayerShot()) continue;
-            if (target == TARGET_PLAYER && !shotIsect->IsPlayerShot()) continue;
-            if (auto shot = shotIsect->GetShot().lock())
-            {
-                if (!shot->IsDead())
-                {
-                    shotIds.insert(shot->GetID());
-                }
-            }
+            queryIds_.push_back(id);
         }
-    }
+    });
+    // 同じショットに紐付いている判定が複数あるので重複を除く
+    std::sort(queryIds_.begin(), queryIds_.end());
+    queryIds_.erase(std::unique(queryIds_.begin(), queryIds_.end()), queryIds_.end());
+    return queryIds_;
+}
 
-    std::vector<std::shared_ptr<ObjShot>> shots;
-    shots.reserve(shotIds.size());
-    for (auto id : shotIds)
+int Package::GetShotCountInShape(const Shape& shape, int target)
+{
+    return GetShotIdInShape(shape, target).size();
+}
+
+const std::vector<int>& Package::GetShotIdNearest(float x, float y, int k, int target)
+{
+    colDetector_->CollectNearestIds(x, y, k, getShotTargetGroup(target), [target](const std::shared_ptr<Intersection>& isect, int& id)
     {
-        shots.push_back(GetObject<ObjShot>(id));
-    }
-    return shots;
+        return getTargetShot(isect, target, id);
+    }, queryDistances_, queryIds_);
+    return queryIds_;
+}
+
+const std::vector<int>& Package::GetEnemyIdNearest(float x, float y, int k)
+{
+    colDetector_->CollectNearestIds(x, y, k, COL_GRP_ENEMY_TO_SHOT, [](const std::shared_ptr<Intersection>& isect, int& id)
+    {
+        if (auto enemy = std::static_pointer_cast<EnemyIntersectionToShot>(isect)->GetEnemy().lock())
+        {
+            if (enemy->IsDead()) return false;
+            id = enemy->GetID();
+            return true;
+        }
+        return false;
+    }, queryDistances_, queryIds_);
+    return queryIds_;
 }
 
 void Package::SetShotIntersectoinCicle(float x, float y, float r)
 {
-    auto isect = std::make_shared<TempEnemyShotIntersection>(x, y, r);
+    auto isect = MakePooled<TempEnemyShotIntersection>(x, y, r);
     colDetector_->Add(isect);
     tempEnemyShotIsects_.push_back(isect);
 }
 
 void Package::SetShotIntersectoinLine(float x1, float y1, float x2, float y2, float width)
 {
-    auto isect = std::make_shared<TempEnemyShotIntersection>(x1, y1, x2, y2, width);
+    auto isect = MakePooled<TempEnemyShotIntersection>(x1, y1, x2, y2, width);
     colDetector_->Add(isect);
     tempEnemyShotIsects_.push_back(isect);
 }
@@ -2046,6 +2089,19 @@ void Package::Start()
         Log(LogLevel::LV_INFO)
         .Msg("start package.")
         .Param(LogParam(LogParam::Tag::SCRIPT, GetMainScriptPath()))));
+
+    // パッケージから到達できるスクリプトを裏でコンパイルしておく
+    scriptPrecompiler_->AddScript(packageMainScriptInfo_.path, ScriptType::Value::PACKAGE, packageMainScriptInfo_.version);
+    if (!stageMainScriptInfo_.path.empty())
+    {
+        scriptPrecompiler_->AddStageMainScript(stageMainScriptInfo_.path);
+    }
+    if (!stagePlayerScriptInfo_.path.empty())
+    {
+        scriptPrecompiler_->AddPlayerScript(stagePlayerScriptInfo_.path);
+    }
+    scriptPrecompiler_->Start();
+
     auto script = scriptManager_->Compile(packageMainScriptInfo_.path, ScriptType::Value::PACKAGE, packageMainScriptInfo_.version, shared_from_this(), nullptr);
     packageMainScript_ = script;
     script->RunInitialize();
@@ -2059,19 +2115,19 @@ bool Package::IsReplay() const
 void Package::SetPauseScriptPath(const std::wstring & path)
 {
     CreateCommonDataArea(DEFAULT_PACKAGE_ARGS_COMMON_DATA_AREA_NAME);
-    SetAreaCommonData(DEFAULT_PACKAGE_ARGS_COMMON_DATA_AREA_NAME, L"PauseScript", std::make_unique<DnhArray>(path));
+    SetAreaCommonData(DEFAULT_PACKAGE_ARGS_COMMON_DATA_AREA_NAME, L"PauseScript", std::make_unique<DnhString>(path));
 }
 
 void Package::SetEndSceneScriptPath(const std::wstring & path)
 {
     CreateCommonDataArea(DEFAULT_PACKAGE_ARGS_COMMON_DATA_AREA_NAME);
-    SetAreaCommonData(DEFAULT_PACKAGE_ARGS_COMMON_DATA_AREA_NAME, L"EndSceneScript", std::make_unique<DnhArray>(path));
+    SetAreaCommonData(DEFAULT_PACKAGE_ARGS_COMMON_DATA_AREA_NAME, L"EndSceneScript", std::make_unique<DnhString>(path));
 }
 
 void Package::SetReplaySaveSceneScriptPath(const std::wstring & path)
 {
     CreateCommonDataArea(DEFAULT_PACKAGE_ARGS_COMMON_DATA_AREA_NAME);
-    SetAreaCommonData(DEFAULT_PACKAGE_ARGS_COMMON_DATA_AREA_NAME, L"ReplaySaveSceneScript", std::make_unique<DnhArray>(path));
+    SetAreaCommonData(DEFAULT_PACKAGE_ARGS_COMMON_DATA_AREA_NAME, L"ReplaySaveSceneScript", std::make_unique<DnhString>(path));
 }
 
 Point2D Package::Get2DPosition(float x, float y, float z, bool isStgScene)
@@ -2091,7 +2147,8 @@ Point2D Package::Get2DPosition(float x, float y, float z, bool isStgScene)
         viewport._42 = GetScreenHeight() / 2.0f;
     }
     D3DXVECTOR3 pos = D3DXVECTOR3(x, y, z);
-    D3DXVec3TransformCoord(&pos, &pos, &(view * proj * viewport));
+    const D3DXMATRIX viewProjViewport3D = view * proj * viewport;
+    D3DXVec3TransformCoord(&pos, &pos, &viewProjViewport3D);
     if (isStgScene)
     {
         camera2D_->GenerateViewMatrix(&view);
@@ -2311,7 +2368,7 @@ void Package::RenderToTexture(const std::wstring& name, int begin, int end, int
 
     if (doClear)
     {
-        graphicDevice_->GetDevice()->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 0), 1.0f, 0);
+        graphicDevice_->ClearRenderTarget(D3DCOLOR_XRGB(0, 0, 0));
     }
 
     begin = std::max(begin, 0);
@@ -2437,7 +2494,7 @@ NullableSharedPtr<Obj> Package::GetObj(int id) const
     return objTable_->Get<Obj>(id);
 }
 
-const std::map<int, std::shared_ptr<Obj>>& Package::GetObjAll() const
+const std::vector<std::shared_ptr<Obj>>& Package::GetObjAll() const
 {
     return objTable_->GetAll();
 }
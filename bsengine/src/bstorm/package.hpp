@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <bstorm/obj.hpp>
 #include <bstorm/nullable_shared_ptr.hpp>
 #include <bstorm/stage_types.hpp>
 #include <bstorm/key_types.hpp>
@@ -9,6 +10,7 @@
 #include <bstorm/point2D.hpp>
 #include <bstorm/rect.hpp>
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -47,7 +49,6 @@ class LostableGraphicResource;
 class LostableGraphicResourceManager;
 class Mesh;
 class MeshStore;
-class Obj;
 class ObjCrLaser;
 class ObjEnemy;
 class ObjEnemyBossScene;
@@ -72,6 +73,7 @@ class ObjStLaser;
 class ObjText;
 class ObjectLayerList;
 class ObjectTable;
+class ShotMoveBatch;
 class RandGenerator;
 class RenderTarget;
 class Renderer;
@@ -80,7 +82,9 @@ class Script;
 class ScriptInfo;
 class SerializedScriptStore;
 class ScriptManager;
+class ScriptPrecompiler;
 class Shader;
+class Shape;
 class ShotCounter;
 class ShotData;
 class ShotDataTable;
@@ -145,7 +149,7 @@ public:
 
     /* path */
     std::wstring GetMainStgScriptPath() const;
-    std::wstring Package::GetMainStgScriptDirectory() const;
+    std::wstring GetMainStgScriptDirectory() const;
     std::wstring GetMainPackageScriptPath() const;
     // スクリプトタイプがPackageの場合はMainPackageScript、それ以外の場合はMainStgScript
     std::wstring GetMainScriptPath() const;
@@ -286,13 +290,7 @@ public:
     template <class T>
     NullableSharedPtr<T> GetObject(int id) const
     {
-        return std::dynamic_pointer_cast<T>(GetObj(id));
-    };
-
-    template <>
-    NullableSharedPtr<Obj> GetObject(int id) const
-    {
-        return GetObj(id);
+        return ObjCast<T>(GetObj(id));
     };
 
     template <class T>
@@ -301,7 +299,8 @@ public:
         std::vector<std::shared_ptr<T>> objs;
         for (const auto& entry : GetObjAll())
         {
-            if (auto obj = std::dynamic_pointer_cast<T>(entry.second))
+            if (entry->IsDead()) continue;
+            if (auto obj = ObjCast<T>(entry))
             {
                 objs.push_back(obj);
             }
@@ -423,7 +422,16 @@ public:
     bool IsDeleteShotToItemEventOnShotScriptEnabled() const;
     void DeleteShotAll(int tarGet, int behavior);
     void DeleteShotInCircle(int tarGet, int behavior, float x, float y, float r);
-    std::vector<std::shared_ptr<ObjShot>> GetShotInCircle(float x, float y, float r, int tarGet) const;
+    // 当たり判定を使った弾と敵の検索
+    // 結果はPackageが持つバッファに書き込んで返すので, 次に検索するまで有効
+    // 当たり判定がshapeと当たっている弾のID (昇順)
+    const std::vector<int>& GetShotIdInShape(const Shape& shape, int target);
+    int GetShotCountInShape(const Shape& shape, int target);
+    // (x, y)に近い順に最大k個の弾のID, 距離は弾の当たり判定までで測る
+    const std::vector<int>& GetShotIdNearest(float x, float y, int k, int target);
+    // (x, y)に近い順に最大k個の敵のID, ショットへの当たり判定が登録されている敵のみ
+    // 距離は敵のショットへの当たり判定までで測る
+    const std::vector<int>& GetEnemyIdNearest(float x, float y, int k);
     void SetShotIntersectoinCicle(float x, float y, float r);
     void SetShotIntersectoinLine(float x1, float y1, float x2, float y2, float width);
 
@@ -482,7 +490,7 @@ public:
 private:
     void RenderToTexture(const std::wstring& renderTargetName, int begin, int end, int objId, bool doClear, bool renderToBackBuffer, bool checkInvalidRenderPriority, bool checkVisibleFlag);
     NullableSharedPtr<Obj> GetObj(int id) const;
-    const std::map<int, std::shared_ptr<Obj>>& GetObjAll() const;
+    const std::vector<std::shared_ptr<Obj>>& GetObjAll() const;
 
     const HWND hWnd_;
 
@@ -503,6 +511,7 @@ private:
     std::unordered_map <std::wstring, std::shared_ptr<SoundBuffer>> orphanSounds_;
     std::shared_ptr<Renderer> renderer_;
     std::shared_ptr<ObjectTable> objTable_;
+    std::shared_ptr<ShotMoveBatch> shotMoveBatch_;
     std::shared_ptr<ObjectLayerList> objLayerList_;
     std::shared_ptr<CollisionDetector> colDetector_;
     std::vector<std::shared_ptr<Intersection>> tempEnemyShotIsects_;
@@ -513,6 +522,7 @@ private:
     std::shared_ptr<CommonDataDB> commonDataDB_;
     std::shared_ptr<SerializedScriptStore> serializedScriptStore_;
     std::shared_ptr<ScriptManager> scriptManager_;
+    std::shared_ptr<ScriptPrecompiler> scriptPrecompiler_;
 
     std::shared_ptr<ShotDataTable> playerShotDataTable_;
     std::shared_ptr<ShotDataTable> enemyShotDataTable_;
@@ -568,5 +578,15 @@ private:
     StageCommonPlayerParams stageCommonPlayerParams_;
 
     std::shared_ptr<TimePoint> packageStartTime_;
+
+    // 検索結果のバッファ
+    std::vector<int> queryIds_;
+    std::vector<std::pair<float, int>> queryDistances_;
 };
+
+template <>
+inline NullableSharedPtr<Obj> Package::GetObject<Obj>(int id) const
+{
+    return GetObj(id);
+}
 }
\ No newline at end of file
@@ -72,16 +72,22 @@ static ScriptInfo CreateScriptInfo(const std::wstring& filePath, const std::vect
     }
     return info;
 }
-std::shared_ptr<NodeBlock> ParseDnhScript(const std::wstring& filePath, const std::shared_ptr<Env>& globalEnv, bool expandInclude, ScriptInfo* scriptInfo, const std::shared_ptr<FileLoader>& loader)
+std::shared_ptr<NodeBlock> ParseDnhScript(const std::wstring& filePath, const std::shared_ptr<Env>& globalEnv, bool expandInclude, ScriptInfo* scriptInfo, const std::shared_ptr<FileLoader>& loader, std::vector<std::wstring>* dependencyFilePaths, const std::shared_ptr<DnhTokenCache>& tokenCache)
 {
     DnhLexer lexer;
     lexer.SetLoader(loader);
+    lexer.SetTokenCache(tokenCache);
     lexer.PushInclude(filePath);
     DnhParseContext ctx(globalEnv, &lexer, expandInclude);
     DnhParser parser(&ctx);
     parser.parse();
     lexer.PopInclude();
     *scriptInfo = CreateScriptInfo(filePath, ctx.headers);
+    if (dependencyFilePaths)
+    {
+        const auto& visited = lexer.GetVisitedFilePaths();
+        dependencyFilePaths->assign(visited.begin(), visited.end());
+    }
     return ctx.result;
 }
 ScriptInfo ScanDnhScriptInfo(const std::wstring & filePath, const std::shared_ptr<FileLoader>& loader)
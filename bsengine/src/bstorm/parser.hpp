@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace bstorm
 {
@@ -12,9 +13,12 @@ class FileLoader;
 class UserShotData;
 class UserItemData;
 class Env;
+class DnhTokenCache;
 struct NodeBlock;
 struct Mqo;
-std::shared_ptr<NodeBlock> ParseDnhScript(const std::wstring& filePath, const std::shared_ptr<Env>& globalEnv, bool expandInclude, ScriptInfo* scriptInfo, const std::shared_ptr<FileLoader>& loader);
+// dependencyFilePaths : 読み込んだファイル(本体とinclude)のパスを格納する, nullable
+// tokenCache : include先のトークン列のキャッシュ, nullable
+std::shared_ptr<NodeBlock> ParseDnhScript(const std::wstring& filePath, const std::shared_ptr<Env>& globalEnv, bool expandInclude, ScriptInfo* scriptInfo, const std::shared_ptr<FileLoader>& loader, std::vector<std::wstring>* dependencyFilePaths = nullptr, const std::shared_ptr<DnhTokenCache>& tokenCache = nullptr);
 ScriptInfo ScanDnhScriptInfo(const std::wstring& filePath, const std::shared_ptr<FileLoader>& loader);
 std::shared_ptr<UserShotData> ParseUserShotData(const std::wstring& filePath, const std::shared_ptr<FileLoader>& loader);
 std::shared_ptr<UserItemData> ParseUserItemData(const std::wstring& filePath, const std::shared_ptr<FileLoader>& loader);
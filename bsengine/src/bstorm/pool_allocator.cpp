@@ -0,0 +1,93 @@
+﻿#include <bstorm/pool_allocator.hpp>
+
+#include <algorithm>
+
+namespace bstorm
+{
+static std::vector<FixedBlockPool*>& GetPoolList()
+{
+    static std::vector<FixedBlockPool*> pools;
+    return pools;
+}
+
+static size_t RoundUpBlockSize(size_t size)
+{
+    constexpr size_t align = alignof(std::max_align_t);
+    return (size + align - 1) / align * align;
+}
+
+FixedBlockPool::FixedBlockPool(const std::string& name, size_t blockSize, size_t blocksPerChunk) :
+    name_(name),
+    blockSize_(RoundUpBlockSize(std::max(blockSize, sizeof(FreeBlock)))),
+    blocksPerChunk_(blocksPerChunk),
+    freeList_(nullptr)
+{
+    GetPoolList().push_back(this);
+}
+
+FixedBlockPool::~FixedBlockPool()
+{
+    auto& pools = GetPoolList();
+    pools.erase(std::remove(pools.begin(), pools.end(), this), pools.end());
+    for (void* chunk : chunks_)
+    {
+        ::operator delete(chunk);
+    }
+}
+
+void* FixedBlockPool::Allocate()
+{
+    stats_.allocCount++;
+    if (freeList_)
+    {
+        stats_.reuseCount++;
+    } else
+    {
+        AllocChunk();
+    }
+    FreeBlock* block = freeList_;
+    freeList_ = block->next;
+    stats_.liveCount++;
+    stats_.peakLiveCount = std::max(stats_.peakLiveCount, stats_.liveCount);
+    return block;
+}
+
+void FixedBlockPool::Deallocate(void * p) noexcept
+{
+    if (!p) return;
+    FreeBlock* block = static_cast<FreeBlock*>(p);
+    block->next = freeList_;
+    freeList_ = block;
+    stats_.freeCount++;
+    stats_.liveCount--;
+}
+
+void FixedBlockPool::ResetStats()
+{
+    const size_t liveCount = stats_.liveCount;
+    const size_t chunkCount = stats_.chunkCount;
+    stats_ = Stats();
+    stats_.liveCount = stats_.peakLiveCount = liveCount;
+    stats_.chunkCount = chunkCount;
+}
+
+const std::vector<FixedBlockPool*>& FixedBlockPool::GetAll()
+{
+    return GetPoolList();
+}
+
+void FixedBlockPool::AllocChunk()
+{
+    // operator newはmax_align_tの境界に揃っているので, ブロックサイズをその倍数にしておけば各ブロックも揃う
+    char* chunk = static_cast<char*>(::operator new(blockSize_ * blocksPerChunk_));
+    chunks_.push_back(chunk);
+    stats_.chunkCount++;
+    // 先頭のブロックから順に使われるように後ろから繋ぐ
+    for (size_t i = blocksPerChunk_; i > 0; i--)
+    {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + blockSize_ * (i - 1));
+        block->next = freeList_;
+        freeList_ = block;
+    }
+}
+}
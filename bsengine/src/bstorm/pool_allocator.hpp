@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include <bstorm/non_copyable.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace bstorm
+{
+// 固定サイズのブロックを使い回すプール
+// 解放されたブロックはフリーリストに繋いで次の確保で再利用する
+// スレッドセーフではないので, 確保と解放はメインスレッドで行うこと
+class FixedBlockPool : private NonCopyable
+{
+public:
+    struct Stats
+    {
+        size_t allocCount = 0; // Allocateが呼ばれた回数
+        size_t reuseCount = 0; // そのうちフリーリストから返した回数
+        size_t freeCount = 0;
+        size_t chunkCount = 0; // ヒープから確保したチャンク数
+        size_t liveCount = 0;
+        size_t peakLiveCount = 0;
+    };
+    FixedBlockPool(const std::string& name, size_t blockSize, size_t blocksPerChunk);
+    ~FixedBlockPool();
+    void* Allocate();
+    void Deallocate(void* p) noexcept;
+    const std::string& GetName() const { return name_; }
+    size_t GetBlockSize() const { return blockSize_; }
+    const Stats& GetStats() const { return stats_; }
+    void ResetStats();
+    // 生成済みの全てのプール
+    static const std::vector<FixedBlockPool*>& GetAll();
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+    void AllocChunk();
+    const std::string name_;
+    const size_t blockSize_;
+    const size_t blocksPerChunk_;
+    FreeBlock* freeList_;
+    std::vector<void*> chunks_;
+    Stats stats_;
+};
+
+// allocate_sharedに渡すアロケータ
+// 制御ブロックとオブジェクトをまとめて1ブロックとしてプールから確保する
+// 同じOwnerかつ同じ型には同じプールが使われる
+template <class T, class Owner = T>
+class PoolAllocator
+{
+public:
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned type can not be pooled");
+    using value_type = T;
+    template <class U>
+    struct rebind
+    {
+        using other = PoolAllocator<U, Owner>;
+    };
+    PoolAllocator() noexcept {}
+    template <class U>
+    PoolAllocator(const PoolAllocator<U, Owner>&) noexcept {}
+    T* allocate(size_t n)
+    {
+        if (n != 1) return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(GetPool().Allocate());
+    }
+    void deallocate(T* p, size_t n) noexcept
+    {
+        if (n != 1)
+        {
+            ::operator delete(p);
+            return;
+        }
+        GetPool().Deallocate(p);
+    }
+    static FixedBlockPool& GetPool()
+    {
+        // 終了時の破棄順に依存しないように解放しない
+        static FixedBlockPool* pool = new FixedBlockPool(typeid(Owner).name(), sizeof(T), BLOCKS_PER_CHUNK);
+        return *pool;
+    }
+private:
+    static constexpr size_t BLOCKS_PER_CHUNK = 256;
+};
+
+template <class T, class U, class Owner>
+bool operator==(const PoolAllocator<T, Owner>&, const PoolAllocator<U, Owner>&) noexcept { return true; }
+
+template <class T, class U, class Owner>
+bool operator!=(const PoolAllocator<T, Owner>&, const PoolAllocator<U, Owner>&) noexcept { return false; }
+
+template <class T, class... Args>
+std::shared_ptr<T> MakePooled(Args&&... args)
+{
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+}
@@ -2,8 +2,10 @@
 
 #include <bstorm/ptr_util.hpp>
 #include <bstorm/logger.hpp>
+#include <bstorm/file_util.hpp>
 
 #include <exception>
+#include <d3dx9.h>
 
 namespace bstorm
 {
@@ -71,6 +73,25 @@ void RenderTarget::SetViewport(int left, int top, int width, int height)
     viewport_ = { (DWORD)left, (DWORD)top, (DWORD)width, (DWORD)height, 0.0f, 1.0f };
 }
 
+static D3DXIMAGE_FILEFORMAT getProperFileFormat(const std::wstring& path)
+{
+    auto ext = GetLowerExt(path);
+    if (ext == L".png" || ext.empty()) return D3DXIFF_PNG;
+    if (ext == L".bmp") return D3DXIFF_BMP;
+    if (ext == L".dds") return D3DXIFF_DDS;
+    if (ext == L".jpg" || ext == L".jpeg") return D3DXIFF_JPG;
+    if (ext == L".dib") return D3DXIFF_DIB;
+    if (ext == L".hdr") return D3DXIFF_HDR;
+    if (ext == L".pfm") return D3DXIFF_PFM;
+    return D3DXIFF_PNG;
+}
+
+bool RenderTarget::SaveToFile(const std::wstring& path, int left, int top, int right, int bottom) const
+{
+    RECT rect = { left, top, right, bottom };
+    return SUCCEEDED(D3DXSaveSurfaceToFile(path.c_str(), getProperFileFormat(path), textureSurface_, NULL, &rect));
+}
+
 void RenderTarget::OnResetDevice()
 {
     if (textureSurface_ != nullptr || textureDepthStencilSurface_ != nullptr) return;
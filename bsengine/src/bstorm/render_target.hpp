@@ -21,6 +21,8 @@ public:
     int GetHeight() const;
     const D3DVIEWPORT9& GetViewport() const;
     void SetViewport(int left, int top, int width, int height);
+    // 拡張子から画像形式を決める, 失敗したらfalse
+    bool SaveToFile(const std::wstring& path, int left, int top, int right, int bottom) const;
     void OnLostDevice() override;
     void OnResetDevice() override;
 private:
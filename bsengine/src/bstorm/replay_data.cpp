@@ -24,20 +24,20 @@ ReplayData::ReplayData()
     // vC̏lݒ
     data_.ClearAllCommonDataArea();
     data_.CreateCommonDataArea(ReplayInfoAreaName);
-    data_.SetAreaCommonData(ReplayInfoAreaName, FilePathInfoKey, std::make_unique<DnhArray>(L""));
-    data_.SetAreaCommonData(ReplayInfoAreaName, DateTimeInfoKey, std::make_unique<DnhArray>(L""));
-    data_.SetAreaCommonData(ReplayInfoAreaName, UserNameInfoKey, std::make_unique<DnhArray>(L""));
+    data_.SetAreaCommonData(ReplayInfoAreaName, FilePathInfoKey, std::make_unique<DnhString>(L""));
+    data_.SetAreaCommonData(ReplayInfoAreaName, DateTimeInfoKey, std::make_unique<DnhString>(L""));
+    data_.SetAreaCommonData(ReplayInfoAreaName, UserNameInfoKey, std::make_unique<DnhString>(L""));
     data_.SetAreaCommonData(ReplayInfoAreaName, TotalScoreInfoKey, std::make_unique<DnhReal>(0.0));
     data_.SetAreaCommonData(ReplayInfoAreaName, FpsAverageInfoKey, std::make_unique<DnhReal>(0.0));
-    data_.SetAreaCommonData(ReplayInfoAreaName, PlayerNameInfoKey, std::make_unique<DnhArray>(L""));
+    data_.SetAreaCommonData(ReplayInfoAreaName, PlayerNameInfoKey, std::make_unique<DnhString>(L""));
     data_.SetAreaCommonData(ReplayInfoAreaName, StageIndexListInfoKey, std::make_unique<DnhArray>());
-    data_.SetAreaCommonData(ReplayInfoAreaName, CommentInfoKey, std::make_unique<DnhArray>(L""));
+    data_.SetAreaCommonData(ReplayInfoAreaName, CommentInfoKey, std::make_unique<DnhString>(L""));
 }
 
 ReplayData::ReplayData(const std::wstring & filePath)
 {
     std::fstream fstream;
-    fstream.open(filePath, std::ios::in | std::ios::binary);
+    OpenFileStream(fstream, filePath, std::ios::in | std::ios::binary);
     if (!fstream.is_open())
     {
         throw cant_open_replay_file(filePath);
@@ -127,16 +127,16 @@ void ReplayData::Save(const std::wstring & filePath, const std::wstring & userNa
     const auto uniqPath = GetCanonicalPath(filePath);
 
     // e탊vCۑ
-    data_.SetAreaCommonData(ReplayInfoAreaName, FilePathInfoKey, std::make_unique<DnhArray>(uniqPath));
+    data_.SetAreaCommonData(ReplayInfoAreaName, FilePathInfoKey, std::make_unique<DnhString>(uniqPath));
     {
         // ۑݒ
         time_t now = std::time(nullptr);
         struct tm* local = std::localtime(&now);
         std::string buf(16, '\0');
         sprintf(&buf[0], "%04d/%02d/%02d %02d:%02d", local->tm_year + 1900, local->tm_mon + 1, local->tm_mday, local->tm_hour, local->tm_min);
-        data_.SetAreaCommonData(ReplayInfoAreaName, DateTimeInfoKey, std::make_unique<DnhArray>(ToUnicode(buf)));
+        data_.SetAreaCommonData(ReplayInfoAreaName, DateTimeInfoKey, std::make_unique<DnhString>(ToUnicode(buf)));
     }
-    data_.SetAreaCommonData(ReplayInfoAreaName, UserNameInfoKey, std::make_unique<DnhArray>(userName));
+    data_.SetAreaCommonData(ReplayInfoAreaName, UserNameInfoKey, std::make_unique<DnhString>(userName));
     data_.SetAreaCommonData(ReplayInfoAreaName, TotalScoreInfoKey, std::make_unique<DnhReal>((double)totalScore));
     {
         // fps
@@ -161,7 +161,7 @@ void ReplayData::Save(const std::wstring & filePath, const std::wstring & userNa
             }
         }
     }
-    data_.SetAreaCommonData(ReplayInfoAreaName, PlayerNameInfoKey, std::make_unique<DnhArray>(playerName));
+    data_.SetAreaCommonData(ReplayInfoAreaName, PlayerNameInfoKey, std::make_unique<DnhString>(playerName));
 
     // GAꗗۑ
     {
@@ -171,7 +171,7 @@ void ReplayData::Save(const std::wstring & filePath, const std::wstring & userNa
         {
             if (areaName != ReplayInfoAreaName)
             {
-                arr->PushBack(std::make_unique<DnhArray>(areaName));
+                arr->PushBack(std::make_unique<DnhString>(areaName));
             }
         }
         data_.SetAreaCommonData(ReplayInfoAreaName, AreaNameListInfoKey, std::move(arr));
@@ -183,7 +183,7 @@ void ReplayData::Save(const std::wstring & filePath, const std::wstring & userNa
         // fBNgȂ쐬
         MakeDirectoryP(GetParentPath(uniqPath));
         std::ofstream fstream;
-        fstream.open(uniqPath, std::ios::out | std::ios::binary);
+        OpenFileStream(fstream, uniqPath, std::ios::out | std::ios::binary);
         if (!fstream.good())
         {
             throw failed_to_save_replay_file(filePath);
@@ -206,7 +206,7 @@ void Script::RunFinalize()
 
 void Script::NotifyEvent(int eventType)
 {
-    NotifyEvent(eventType, std::make_unique<DnhArray>(L""));
+    NotifyEvent(eventType, std::make_unique<DnhArray>());
 }
 
 void Script::NotifyEvent(int eventType, const std::unique_ptr<DnhArray>& args)
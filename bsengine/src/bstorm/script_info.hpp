@@ -33,6 +33,13 @@ public:
 
 constexpr wchar_t* SCRIPT_VERSION_PH3 = L"3";
 
+// スクリプト中でLoadScriptなどに直接書かれたスクリプトのパス
+struct ScriptReference
+{
+    std::string funcName;
+    std::wstring path;
+};
+
 class ScriptInfo
 {
 public:
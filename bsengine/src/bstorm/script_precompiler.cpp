@@ -0,0 +1,220 @@
+﻿#include <bstorm/script_precompiler.hpp>
+
+#include <bstorm/serialized_script.hpp>
+#include <bstorm/parser.hpp>
+#include <bstorm/file_util.hpp>
+#include <bstorm/path_const.hpp>
+#include <bstorm/time_point.hpp>
+#include <bstorm/time_stamp.hpp>
+#include <bstorm/logger.hpp>
+
+#include <algorithm>
+
+namespace bstorm
+{
+ScriptPrecompiler::ScriptPrecompiler(const std::shared_ptr<SerializedScriptStore>& serializedScriptStore, const std::shared_ptr<FileLoader>& fileLoader, size_t workerCnt) :
+    serializedScriptStore_(serializedScriptStore),
+    fileLoader_(fileLoader),
+    workerCnt_(workerCnt == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : workerCnt),
+    runningTaskCnt_(0),
+    isCanceled_(false)
+{
+}
+
+ScriptPrecompiler::~ScriptPrecompiler()
+{
+    Cancel();
+    Join();
+}
+
+void ScriptPrecompiler::Start()
+{
+    if (!workers_.empty()) return;
+    for (size_t i = 0; i < workerCnt_; i++)
+    {
+        workers_.emplace_back(&ScriptPrecompiler::WorkerMain, this);
+    }
+}
+
+void ScriptPrecompiler::Wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return isCanceled_ || (taskQueue_.empty() && runningTaskCnt_ == 0); });
+}
+
+void ScriptPrecompiler::Cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isCanceled_ = true;
+    }
+    cond_.notify_all();
+}
+
+bool ScriptPrecompiler::IsFinished() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return taskQueue_.empty() && runningTaskCnt_ == 0;
+}
+
+std::vector<PrecompileReport> ScriptPrecompiler::GetReports() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reports_;
+}
+
+void ScriptPrecompiler::WorkerMain()
+{
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] { return isCanceled_ || !taskQueue_.empty() || runningTaskCnt_ == 0; });
+            if (isCanceled_ || taskQueue_.empty())
+            {
+                // 実行中のタスクが無くキューが空なら, もう新しいタスクは来ない
+                cond_.notify_all();
+                return;
+            }
+            task = std::move(taskQueue_.front());
+            taskQueue_.pop_front();
+            runningTaskCnt_++;
+        }
+
+        PrecompileReport report{ task.path, task.type, task.version, 0.0f, false };
+        std::shared_ptr<SerializedScript> script;
+        TimePoint startTime;
+        try
+        {
+            script = serializedScriptStore_->Load(task.path, task.type, task.version);
+            report.succeeded = true;
+        } catch (...)
+        {
+            // エラーは実際にスクリプトを読み込んだ時に報告される
+        }
+        report.compileTimeMilliSec = startTime.GetElapsedMilliSec();
+
+        if (script)
+        {
+            EnqueueReferences(task, script);
+        }
+
+        Logger::Write(std::move(
+            Log(report.succeeded ? LogLevel::LV_INFO : LogLevel::LV_WARN)
+            .Msg((report.succeeded ? "precompiled script (" : "failed to precompile script (") + std::to_string(report.compileTimeMilliSec) + " ms).")
+            .Param(LogParam(LogParam::Tag::SCRIPT, task.path))));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            reports_.push_back(std::move(report));
+            runningTaskCnt_--;
+        }
+        cond_.notify_all();
+    }
+}
+
+void ScriptPrecompiler::AddScript(const std::wstring & path, ScriptType type, const std::wstring & version)
+{
+    if (path.empty()) return;
+    if (GetFileLastUpdateTime(path) == TIME_STAMP_NONE) return;
+    const auto canonicalPath = GetCanonicalPath(path);
+    const auto key = canonicalPath + L"|" + std::to_wstring((int)type.value) + L"|" + version;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (isCanceled_) return;
+        if (!enqueuedTaskKeys_.insert(key).second) return;
+        taskQueue_.push_back(Task{ canonicalPath, type, version });
+    }
+    cond_.notify_one();
+}
+
+void ScriptPrecompiler::AddStageMainScript(const std::wstring & path)
+{
+    // Package::StartStageSceneと同じ規則
+    ScriptInfo info;
+    try
+    {
+        info = ScanDnhScriptInfo(path, fileLoader_);
+    } catch (...)
+    {
+        return;
+    }
+    if (info.systemPath.empty() || GetFileName(info.systemPath) == L"DEFAULT")
+    {
+        AddScript(DEFAULT_SYSTEM_PATH, ScriptType::Value::STAGE, info.version);
+    } else
+    {
+        AddScript(info.systemPath, ScriptType::Value::STAGE, info.version);
+    }
+    if (info.type == ScriptType::Value::SINGLE)
+    {
+        // System_SingleStageがObjEnemyBossScene_Addで読み込む
+        AddScript(SYSTEM_SINGLE_STAGE_PATH, ScriptType::Value::STAGE, info.version);
+        AddScript(path, ScriptType::Value::SINGLE, SCRIPT_VERSION_PH3);
+    } else if (info.type == ScriptType::Value::PLURAL)
+    {
+        // System_PluralStageがLoadScriptで読み込む
+        AddScript(SYSTEM_PLURAL_STAGE_PATH, ScriptType::Value::STAGE, info.version);
+        AddScript(path, ScriptType::Value::STAGE, SCRIPT_VERSION_PH3);
+    } else
+    {
+        AddScript(path, ScriptType::Value::STAGE, info.version);
+    }
+    if (!info.backgroundPath.empty() && GetFileName(info.backgroundPath) != L"DEFAULT")
+    {
+        AddScript(info.backgroundPath, ScriptType::Value::STAGE, info.version);
+    }
+    for (const auto& playerPath : info.playerScriptPaths)
+    {
+        AddPlayerScript(playerPath);
+    }
+}
+
+void ScriptPrecompiler::AddPlayerScript(const std::wstring & path)
+{
+    try
+    {
+        AddScript(path, ScriptType::Value::PLAYER, ScanDnhScriptInfo(path, fileLoader_).version);
+    } catch (...) {}
+}
+
+void ScriptPrecompiler::EnqueueReferences(const Task & task, const std::shared_ptr<SerializedScript>& script)
+{
+    for (const auto& ref : script->GetScriptReferences())
+    {
+        if (ref.funcName == "LoadScript" || ref.funcName == "LoadScriptInThread")
+        {
+            // 読み込む側のスクリプトの種別でコンパイルされる
+            AddScript(ref.path, task.type, SCRIPT_VERSION_PH3);
+        } else if (ref.funcName == "ObjEnemyBossScene_Add")
+        {
+            AddScript(ref.path, ScriptType::Value::SINGLE, SCRIPT_VERSION_PH3);
+        } else if (ref.funcName == "StartShotScript")
+        {
+            AddScript(ref.path, ScriptType::Value::SHOT_CUSTOM, task.version);
+        } else if (ref.funcName == "StartItemScript")
+        {
+            AddScript(ref.path, ScriptType::Value::ITEM_CUSTOM, task.version);
+        } else if (ref.funcName == "SetStageMainScript")
+        {
+            AddStageMainScript(ref.path);
+        } else if (ref.funcName == "SetStagePlayerScript")
+        {
+            AddPlayerScript(ref.path);
+        }
+    }
+}
+
+void ScriptPrecompiler::Join()
+{
+    for (auto& worker : workers_)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+}
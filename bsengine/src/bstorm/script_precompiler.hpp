@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include <bstorm/script_info.hpp>
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace bstorm
+{
+class FileLoader;
+class SerializedScript;
+class SerializedScriptStore;
+
+struct PrecompileReport
+{
+    std::wstring path;
+    ScriptType type;
+    std::wstring version;
+    float compileTimeMilliSec;
+    bool succeeded;
+};
+
+// パッケージから到達できるスクリプトを先にまとめてコンパイルしておく
+// 到達可能性は #System, #Background, #Player ヘッダ, LoadScriptなどの定数引数から判断する
+// (#includeはコンパイル時に展開される)
+class ScriptPrecompiler
+{
+public:
+    // workerCnt : 0ならコア数
+    ScriptPrecompiler(const std::shared_ptr<SerializedScriptStore>& serializedScriptStore, const std::shared_ptr<FileLoader>& fileLoader, size_t workerCnt);
+    ~ScriptPrecompiler();
+    // Startの前に起点となるスクリプトを追加する
+    void AddScript(const std::wstring& path, ScriptType type, const std::wstring& version);
+    void AddStageMainScript(const std::wstring& path);
+    void AddPlayerScript(const std::wstring& path);
+    // non blocking
+    void Start();
+    void Wait();
+    void Cancel();
+    bool IsFinished() const;
+    std::vector<PrecompileReport> GetReports() const;
+private:
+    struct Task
+    {
+        std::wstring path;
+        ScriptType type;
+        std::wstring version;
+    };
+    void WorkerMain();
+    void EnqueueReferences(const Task& task, const std::shared_ptr<SerializedScript>& script);
+    void Join();
+    std::shared_ptr<SerializedScriptStore> serializedScriptStore_;
+    std::shared_ptr<FileLoader> fileLoader_;
+    const size_t workerCnt_;
+    std::vector<std::thread> workers_;
+    std::deque<Task> taskQueue_;
+    std::unordered_set<std::wstring> enqueuedTaskKeys_;
+    size_t runningTaskCnt_;
+    bool isCanceled_;
+    std::vector<PrecompileReport> reports_;
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+};
+}
@@ -5,28 +5,88 @@
 -- rl_: runtime local
 -- rb_: runtime builtin
 
+-- 配列はコピーオンライト
+-- r_cpは配列を複製せずに共有の印を付けて返す
+-- 書き込み(r_write1, r_write, r_mcat)の前にrl_ownで共有されている配列を複製する
+-- 印は外さないので, 共有元の配列も次の書き込みで一度だけ複製される
+local RL_SHARED = 0; -- 共有の印を置くキー. #や1始まりの添字には影響しない
+
+-- 文字列は文字の配列の他に, パックした表現 {str = utf8文字列, len = 文字数} を持つ
+-- パックした文字列は書き換えないので, 同じ内容なら使い回す
+-- 配列の長さと要素はrl_len, rl_atで取ること
+local rl_strs = setmetatable({}, {__mode = "v"});
+
+local function rl_str(s)
+  local x = rl_strs[s];
+  if x == nil then
+    local len = #s;
+    if string.find(s, "[\128-\255]") then
+      -- utf8の継続バイト以外を数える
+      local _;
+      _, len = string.gsub(s, "[^\128-\191]", "");
+    end
+    x = {str = s, len = len};
+    rl_strs[s] = x;
+  end
+  return x;
+end
+
+-- ASCII以外を含む文字列の添字アクセス用
+local function rl_chars(x)
+  local t = x.chars;
+  if t == nil then
+    t = {};
+    local i = 1;
+    for c in string.gmatch(x.str, "[^\128-\191][\128-\191]*") do
+      t[i] = c;
+      i = i + 1;
+    end
+    x.chars = t;
+  end
+  return t;
+end
+
+local function rl_len(a)
+  return a.len or #a;
+end
+
+local function rl_at(a, i)
+  local s = a.str;
+  if s == nil then return a[i]; end
+  if a.len == #s then return string.sub(s, i, i); end
+  return rl_chars(a)[i];
+end
+
+-- 文字列をutf8のLuaの文字列にする
+local function rl_tostr(a)
+  return a.str or table.concat(a, "", 1, #a);
+end
+
 local function rl_copyarray(a)
   local r = {};
+  if a.str then
+    for i=1,a.len do r[i] = rl_at(a, i); end
+    return r;
+  end
   for i=1,#a do r[i] = r_cp(a[i]); end
   return r;
 end
 
-local function rl_strtodnhstr(s)
-  local t = {};
-  for i = 1, #s do
-    t[i] = string.sub(s, i, i);
+local function rl_own(a)
+  if a[RL_SHARED] or a.str then
+    return rl_copyarray(a);
   end
-  return t;
+  return a;
 end
 
 local function rl_type_eq(x, y)
   local tx = type(x);
   local ty = type(y);
   if tx == 'table' and ty == 'table' then
-    if #x == 0 or #y == 0 then
+    if rl_len(x) == 0 or rl_len(y) == 0 then
       return true;
     else
-      return rl_type_eq(x[1], y[1]);
+      return rl_type_eq(rl_at(x, 1), rl_at(y, 1));
     end
   else
     return tx == ty;
@@ -61,7 +121,7 @@ function r_tobool(x)
   local t = type(x);
   if(t == 'boolean') then return x end
   if(t == 'number') then return x ~= 0 end
-  if(t == 'table') then return #x ~= 0 end
+  if(t == 'table') then return rl_len(x) ~= 0 end
   if(t == 'string') then return c_chartonum(x) ~= 0 end
   if(t == 'nil') then return false end
   return false
@@ -73,12 +133,12 @@ function r_add(x, y)
     if type(y) ~= "table" then
       c_raiseerror("can't apply '+' to diffrent type values.");
     end
-    if #x ~= #y then
+    if rl_len(x) ~= rl_len(y) then
       c_raiseerror("can't apply '+' to diffrent length arrays.");
     end
     local z = {};
-    for i = 1, #x do
-      z[i] = r_add(x[i], y[i]);
+    for i = 1, rl_len(x) do
+      z[i] = r_add(rl_at(x, i), rl_at(y, i));
     end
     return z;
   else
@@ -92,12 +152,12 @@ function r_sub(x, y)
     if type(y) ~= "table" then
       c_raiseerror("can't compare diffrent type values.");
     end
-    if #x ~= #y then
+    if rl_len(x) ~= rl_len(y) then
       c_raiseerror("can't apply '-' to diffrent length arrays.");
     end
     local z = {};
-    for i = 1, #x do
-      z[i] = r_sub(x[i], y[i]);
+    for i = 1, rl_len(x) do
+      z[i] = r_sub(rl_at(x, i), rl_at(y, i));
     end
     return z;
   else
@@ -154,11 +214,22 @@ local function r_cmp(x, y)
   end
 
   if type(x) == "table" then
-    for i = 1, math.min(#x, #y) do
-      local r = r_cmp(x[i], y[i]);
+    local sx, sy = x.str, y.str;
+    if sx and sy then
+      -- utf8のバイト列の順序は文字コードの順序と同じ
+      if sx == sy then return 0 end
+      for i = 1, math.min(#sx, #sy) do
+        local bx, by = string.byte(sx, i), string.byte(sy, i);
+        if bx ~= by then return bx < by and -1 or 1 end
+      end
+      return r_cmp(#sx, #sy);
+    end
+    local lx, ly = rl_len(x), rl_len(y);
+    for i = 1, math.min(lx, ly) do
+      local r = r_cmp(rl_at(x, i), rl_at(y, i));
       if r ~= 0 then return r end
     end
-    return r_cmp(#x, #y);
+    return r_cmp(lx, ly);
   end
 
   return 0;
@@ -181,13 +252,17 @@ function r_or(x, f)
   return f();
 end
 
+r_str = rl_str;
+
 function r_cp(x)
   if type(x) == "table" then
-    return rl_copyarray(x)
+    x[RL_SHARED] = true;
   end
   return x;
 end
 
+-- throws
+-- 連結した配列を返すので, aに代入し直すこと
 function r_mcat(a, b)
   if type(a) ~= "table" or type(b) ~= "table" then
     c_raiseerror("can't concat non-array values.");
@@ -197,6 +272,14 @@ function r_mcat(a, b)
     c_raiseerror("can't concat diffrent type values.");
   end
 
+  -- パックした文字列との連結は, 連結した文字列を作る
+  if a.str or b.str then
+    if rl_len(a) == 0 then return r_cp(b) end
+    if rl_len(b) == 0 then return a end
+    return rl_str(rl_tostr(a) .. rl_tostr(b));
+  end
+
+  a = rl_own(a);
   local j = #a + 1;
   for i = 1, #b do a[j] = r_cp(b[i]); j = j + 1; end
   return a;
@@ -204,7 +287,10 @@ end
 
 -- throws
 function r_cat(a, b)
-  return r_mcat(r_cp(a), b);
+  if type(a) == "table" and not a.str then
+    a = rl_copyarray(a);
+  end
+  return r_mcat(a, b);
 end
 
 -- throws
@@ -215,12 +301,18 @@ function r_slice(a, s, e)
 
   s = rl_toint(s); e = rl_toint(e);
 
-  if s > e  or s > #a or e > #a or s < 0 or e < 0 then
+  if s > e  or s > rl_len(a) or e > rl_len(a) or s < 0 or e < 0 then
     c_raiseerror("array index out of bounds.");
   end
 
   s = s + 1; e = e + 1;
 
+  local str = a.str;
+  if str then
+    if a.len == #str then return rl_str(string.sub(str, s, e - 1)) end
+    return rl_str(table.concat(rl_chars(a), "", s, e - 1));
+  end
+
   local r = {};
   local i = 1;
   for j = s, e-1 do
@@ -241,28 +333,35 @@ function r_arr(a)
 end
 
 -- throws
-function r_read(a, idx)
+-- 要素をコピーせずに返す
+-- 戻り値を保存する側でr_cpすること
+function r_ref(a, idx)
   if type(a) ~= "table" then
     c_raiseerror("attempt to index a non-array value.");
   end
 
   idx = rl_toint(idx);
 
-  if idx >= #a or idx < 0 then
+  if idx >= rl_len(a) or idx < 0 then
     c_raiseerror("array index out of bounds.");
   end
 
-  idx = idx + 1;
+  return rl_at(a, idx + 1);
+end
 
-  return r_cp(a[idx]);
+-- throws
+function r_read(a, idx)
+  return r_cp(r_ref(a, idx));
 end
 
 -- throws
+-- 書き込んだ配列を返すので, aに代入し直すこと
 function r_write1(a, idx, v)
   if type(a) ~= "table" then
     c_raiseerror("attempt to index a non-array value.");
   end
 
+  a = rl_own(a);
   idx = rl_toint(idx);
 
   if idx >= #a or idx < 0 then
@@ -276,15 +375,26 @@ function r_write1(a, idx, v)
   end
 
   a[idx] = r_cp(v);
+  return a;
 end
 
 -- throws
+-- 書き込んだ配列を返すので, aに代入し直すこと
 function r_write(a, indices, v)
+  local root, parent, pidx;
   for k=1, #indices do
     if type(a) ~= "table" then
       c_raiseerror("attempt to index a non-array value.");
     end
 
+    -- 書き込む経路上の共有されている配列を複製して繋ぎ直す
+    a = rl_own(a);
+    if parent == nil then
+      root = a;
+    else
+      parent[pidx] = a;
+    end
+
     local idx = rl_toint(indices[k]);
 
     if idx >= #a or idx < 0 then
@@ -301,8 +411,10 @@ function r_write(a, indices, v)
       a[idx] = r_cp(v);
     end
 
+    parent, pidx = a, idx;
     a = a[idx];
   end
+  return root;
 end
 
 -- throws
@@ -370,12 +482,19 @@ function rb_erase(a, i)
 
   i = rl_toint(i);
 
-  if i >= #a or i < 0 then
+  if i >= rl_len(a) or i < 0 then
     c_raiseerror("array index out of bounds.");
   end
 
   i = i + 1;
 
+  local s = a.str;
+  if s then
+    if a.len == #s then return rl_str(string.sub(s, 1, i - 1) .. string.sub(s, i + 1)) end
+    local t = rl_chars(a);
+    return rl_str(table.concat(t, "", 1, i - 1) .. table.concat(t, "", i + 1, a.len));
+  end
+
   local r = {};
   for j = 1, #a do
     if j ~= i then table.insert(r, r_cp(a[j])); end
@@ -387,7 +506,7 @@ function rb_length(a)
   if type(a) ~= "table" then
     return 0;
   else
-    return #a;
+    return rl_len(a);
   end
 end
 
@@ -467,13 +586,13 @@ function rb_modc(x, y)
 end
 
 function rb_IntToString(n)
-  return rl_strtodnhstr(string.format("%d", rl_toint(n)));
+  return rl_str(string.format("%d", rl_toint(n)));
 end
 
 rb_itoa = rb_IntToString
 
 function rb_rtoa(n)
-  return rl_strtodnhstr(string.format("%f", rl_tonum(n)));
+  return rl_str(string.format("%f", rl_tonum(n)));
 end
 
 script_event_type = -1;
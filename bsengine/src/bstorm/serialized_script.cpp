@@ -9,11 +9,24 @@
 #include <bstorm/source_map.hpp>
 #include <bstorm/parser.hpp>
 #include <bstorm/semantics_checker.hpp>
+#include <bstorm/inliner.hpp>
 #include <bstorm/code_analyzer.hpp>
 #include <bstorm/code_generator.hpp>
 #include <bstorm/script_entry_routine_names.hpp>
+#include <bstorm/file_loader.hpp>
+#include <bstorm/version.hpp>
+#include <bstorm/dnh_token_cache.hpp>
 
 #include <luajit/lua.hpp>
+#include <yas/std_types.hpp>
+#include <yas/mem_streams.hpp>
+#include <yas/binary_iarchive.hpp>
+#include <yas/binary_oarchive.hpp>
+#include <yas/buffers.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 
 namespace bstorm
 {
@@ -45,16 +58,142 @@ size_t SerializedScriptSignature::hashValue() const
     return h;
 }
 
-SerializedScript::SerializedScript(const SerializedScriptSignature& signature, const std::shared_ptr<FileLoader>& fileLoader) :
-    signature_(signature)
+template <class Ar>
+void serialize(Ar& ar, ScriptDependency& dep)
 {
+    ar & dep.path
+        & dep.contentHash
+        & dep.lastUpdateTime;
+}
+
+template <class Ar>
+void serialize(Ar& ar, ScriptReference& ref)
+{
+    ar & ref.funcName
+        & ref.path;
+}
+
+constexpr auto yas_option = yas::binary | yas::no_header | yas::compacted;
+
+// LbVt@C̃wb_
+constexpr char SCRIPT_CACHE_HEADER[] = "BSTORM_SCRIPT_CACHE";
+// LbV̒ǧ`ςグ
+constexpr uint32_t SCRIPT_CACHE_FORMAT_VERSION = 7;
+
+// R[h̓rh\ɂĕς
+#ifdef _DEBUG
+constexpr char SCRIPT_CACHE_BUILD_FLAVOR[] = "debug";
+#else
+constexpr char SCRIPT_CACHE_BUILD_FLAVOR[] = "release";
+#endif
+
+// FNV-1a (64bit)
+// LbṼL[̓vZXׂŎĝ, ˑstd::hash͎gȂ
+static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+static void Fnv1a(uint64_t& h, const void* data, size_t size)
+{
+    auto p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+}
+
+template <class Char>
+static void Fnv1a(uint64_t& h, const std::basic_string<Char>& str)
+{
+    const uint64_t size = str.size();
+    Fnv1a(h, &size, sizeof(size));
+    Fnv1a(h, str.data(), str.size() * sizeof(Char));
+}
+
+// t@C̓ẽnbVlvZ, JȂfalse
+static bool GetFileContentHash(const std::wstring& path, const std::shared_ptr<FileLoader>& fileLoader, uint64_t& hash)
+{
+    std::FILE* fp = fileLoader->OpenFile(path);
+    if (fp == nullptr) return false;
+    uint64_t h = FNV_OFFSET_BASIS;
+    char buf[4096];
+    size_t readSize;
+    while ((readSize = std::fread(buf, 1, sizeof(buf), fp)) > 0)
+    {
+        Fnv1a(h, buf, readSize);
+    }
+    fileLoader->CloseFile(path, fp);
+    hash = h;
+    return true;
+}
+
+// XNvgƑSˑt@C̓e, GW̃o[W狁߂L[
+static uint64_t GetScriptContentKey(const SerializedScriptSignature& signature, const std::vector<ScriptDependency>& dependencies)
+{
+    uint64_t h = FNV_OFFSET_BASIS;
+    Fnv1a(h, std::string(BSTORM_VERSION));
+    Fnv1a(h, &SCRIPT_CACHE_FORMAT_VERSION, sizeof(SCRIPT_CACHE_FORMAT_VERSION));
+    Fnv1a(h, std::string(SCRIPT_CACHE_BUILD_FLAVOR));
+    Fnv1a(h, signature.path);
+    Fnv1a(h, &signature.type.value, sizeof(signature.type.value));
+    Fnv1a(h, signature.version);
+    for (const auto& dep : dependencies)
+    {
+        Fnv1a(h, dep.path);
+        Fnv1a(h, &dep.contentHash, sizeof(dep.contentHash));
+    }
+    return h;
+}
+
+SerializedScript::SerializedScript(const SerializedScriptSignature& signature, const std::shared_ptr<FileLoader>& fileLoader, const std::wstring& cacheDir, const std::shared_ptr<DnhTokenCache>& tokenCache) :
+    signature_(signature),
+    loadedFromDiskCache_(false)
+{
+    if (cacheDir.empty())
+    {
+        Compile(fileLoader, tokenCache);
+        return;
+    }
+
+    const auto cachePath = GetDiskCachePath(cacheDir);
+    if (LoadDiskCache(cachePath, fileLoader))
+    {
+        loadedFromDiskCache_ = true;
+        return;
+    }
+    Compile(fileLoader, tokenCache);
+    try
+    {
+        SaveDiskCache(cachePath);
+    } catch (Log& log)
+    {
+        // LbV̕ۑɎsĂRpCʂ͎g
+        log.Level(LogLevel::LV_WARN);
+        Logger::Write(log);
+    }
+}
+
+void SerializedScript::Compile(const std::shared_ptr<FileLoader>& fileLoader, const std::shared_ptr<DnhTokenCache>& tokenCache)
+{
+    const auto& signature = signature_;
     std::unique_ptr<lua_State, decltype(&lua_close)> L(luaL_newstate(), lua_close);
     // 쐬
     auto globalEnv = CreateInitRootEnv(signature.type, signature.version, nullptr);
 
     // p[X
     ScriptInfo scriptInfo;
-    std::shared_ptr<NodeBlock> program = ParseDnhScript(signature.path, globalEnv, true, &scriptInfo, fileLoader);
+    std::vector<std::wstring> dependencyFilePaths;
+    std::shared_ptr<NodeBlock> program = ParseDnhScript(signature.path, globalEnv, true, &scriptInfo, fileLoader, &dependencyFilePaths, tokenCache);
+
+    // ˑt@C̓ẽnbVlL^
+    dependencies_.clear();
+    for (auto& path : dependencyFilePaths)
+    {
+        const TimeStamp lastUpdateTime = GetFileLastUpdateTime(path);
+        uint64_t contentHash = 0;
+        GetFileContentHash(path, fileLoader, contentHash);
+        dependencies_.push_back(ScriptDependency{ std::move(path), contentHash, lastUpdateTime });
+    }
 
     // ÓIG[
     {
@@ -72,17 +211,39 @@ SerializedScript::SerializedScript(const SerializedScriptSignature& signature, c
         }
     }
 
+    // CCWJ
+    {
+        Inliner inliner;
+        inliner.Inline(*program);
+        for (const auto& report : inliner.GetReports())
+        {
+            Logger::Write(std::move(
+                Log(LogLevel::LV_DEBUG)
+                .Msg("inlined function '" + report.funcName + "' at " + std::to_string(report.callSiteCnt) + " call site(s) (cost " + std::to_string(report.cost) + ").")
+                .Param(LogParam(LogParam::Tag::SCRIPT, signature.path))));
+        }
+    }
+
     // ÓI
     CodeAnalyzer analyzer;
     analyzer.Analyze(*program);
+    scriptRefs_ = analyzer.GetScriptReferences();
 
     // R[h
     CodeGenerator::Option codeGenOption;
     codeGenOption.enableNilCheck = false;
     codeGenOption.deleteUnreachableDefinition = true;
     codeGenOption.deleteUnneededAssign = true;
+    codeGenOption.foldConstant = true;
     CodeGenerator codeGen(codeGenOption);
     codeGen.Generate(*program);
+    if (codeGen.GetFoldedNodeCount() > 0)
+    {
+        Logger::Write(std::move(
+            Log(LogLevel::LV_DEBUG)
+            .Msg("folded " + std::to_string(codeGen.GetFoldedNodeCount()) + " constant expression(s).")
+            .Param(LogParam(LogParam::Tag::SCRIPT, signature.path))));
+    }
 
     // RpC
     {
@@ -129,6 +290,120 @@ SerializedScript::SerializedScript(const SerializedScriptSignature& signature, c
         }
     }
 }
+
+std::wstring SerializedScript::GetDiskCachePath(const std::wstring& cacheDir) const
+{
+    // t@C̓XNvg̃pX, , o[W猈߂
+    // eςĂȂ͓ǂݍݎGetScriptContentKeyŌ
+    uint64_t h = FNV_OFFSET_BASIS;
+    Fnv1a(h, signature_.path);
+    Fnv1a(h, &signature_.type.value, sizeof(signature_.type.value));
+    Fnv1a(h, signature_.version);
+    wchar_t name[32];
+    swprintf(name, sizeof(name) / sizeof(name[0]), L"%016llx.bsc", (unsigned long long)h);
+    return ConcatPath(cacheDir, name);
+}
+
+bool SerializedScript::LoadDiskCache(const std::wstring& cachePath, const std::shared_ptr<FileLoader>& fileLoader)
+{
+    std::ifstream stream;
+    OpenFileStream(stream, cachePath, std::ios::in | std::ios::binary);
+    if (!stream.is_open()) return false;
+    std::string data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    stream.close();
+
+    // header, payload hash, payload
+    constexpr size_t headerSize = sizeof(SCRIPT_CACHE_HEADER) - 1;
+    if (data.size() < headerSize + sizeof(uint64_t)) return false;
+    if (data.compare(0, headerSize, SCRIPT_CACHE_HEADER) != 0) return false;
+    uint64_t payloadHash;
+    memcpy(&payloadHash, data.data() + headerSize, sizeof(payloadHash));
+    const char* payload = data.data() + headerSize + sizeof(payloadHash);
+    const size_t payloadSize = data.size() - headerSize - sizeof(payloadHash);
+    uint64_t h = FNV_OFFSET_BASIS;
+    Fnv1a(h, payload, payloadSize);
+    if (h != payloadHash) return false;
+
+    uint64_t contentKey;
+    std::vector<ScriptDependency> dependencies;
+    std::vector<ScriptReference> scriptRefs;
+    std::string scriptInfo, srcMap, byteCode, srcCode;
+    std::unordered_map<std::string, std::string> builtInSubNameConversionMap;
+    try
+    {
+        yas::mem_istream is(payload, payloadSize);
+        yas::binary_iarchive<yas::mem_istream, yas_option> ia(is);
+        ia & contentKey
+            & dependencies
+            & scriptRefs
+            & scriptInfo
+            & srcMap
+            & byteCode
+            & srcCode
+            & builtInSubNameConversionMap;
+    } catch (...)
+    {
+        return false;
+    }
+
+    // ˑt@C̓eςĂȂ
+    if (contentKey != GetScriptContentKey(signature_, dependencies)) return false;
+    for (auto& dep : dependencies)
+    {
+        // eȂXVςĂĂg
+        dep.lastUpdateTime = GetFileLastUpdateTime(dep.path);
+        uint64_t contentHash;
+        if (!GetFileContentHash(dep.path, fileLoader, contentHash)) return false;
+        if (contentHash != dep.contentHash) return false;
+    }
+
+    dependencies_ = std::move(dependencies);
+    scriptRefs_ = std::move(scriptRefs);
+    scriptInfo_ = std::move(scriptInfo);
+    srcMap_ = std::move(srcMap);
+    byteCode_ = std::move(byteCode);
+    srcCode_ = std::move(srcCode);
+    builtInSubNameConversionMap_ = std::move(builtInSubNameConversionMap);
+    return true;
+}
+
+void SerializedScript::SaveDiskCache(const std::wstring& cachePath) const
+{
+    const uint64_t contentKey = GetScriptContentKey(signature_, dependencies_);
+    yas::mem_ostream os;
+    yas::binary_oarchive<yas::mem_ostream, yas_option> oa(os);
+    oa & contentKey
+        & dependencies_
+        & scriptRefs_
+        & scriptInfo_
+        & srcMap_
+        & byteCode_
+        & srcCode_
+        & builtInSubNameConversionMap_;
+    auto buf = os.get_intrusive_buffer();
+    uint64_t payloadHash = FNV_OFFSET_BASIS;
+    Fnv1a(payloadHash, buf.data, buf.size);
+
+    MakeDirectoryP(GetParentPath(cachePath));
+    std::ofstream fstream;
+    OpenFileStream(fstream, cachePath, std::ios::out | std::ios::binary);
+    if (!fstream.good())
+    {
+        throw Log(LogLevel::LV_WARN)
+            .Msg("failed to save script cache.")
+            .Param(LogParam(LogParam::Tag::TEXT, cachePath));
+    }
+    fstream.write(SCRIPT_CACHE_HEADER, sizeof(SCRIPT_CACHE_HEADER) - 1);
+    fstream.write((const char*)&payloadHash, sizeof(payloadHash));
+    fstream.write(buf.data, buf.size);
+    if (!fstream.good())
+    {
+        throw Log(LogLevel::LV_WARN)
+            .Msg("failed to save script cache.")
+            .Param(LogParam(LogParam::Tag::TEXT, cachePath));
+    }
+}
+
 std::string SerializedScript::GetConvertedBuiltInSubName(const std::string & name) const
 {
     auto it = builtInSubNameConversionMap_.find(name);
@@ -139,21 +414,27 @@ std::string SerializedScript::GetConvertedBuiltInSubName(const std::string & nam
     return "";
 }
 
-SerializedScriptStore::SerializedScriptStore(const std::shared_ptr<FileLoader>& fileLoader) :
-    fileLoader_(fileLoader)
+SerializedScriptStore::SerializedScriptStore(const std::shared_ptr<FileLoader>& fileLoader, const std::wstring& cacheDir) :
+    fileLoader_(fileLoader),
+    cacheDir_(cacheDir),
+    tokenCache_(std::make_shared<DnhTokenCache>())
 {
 }
 
 const std::shared_ptr<SerializedScript>& SerializedScriptStore::Load(const std::wstring & path, ScriptType type, const std::wstring & version)
 {
     SerializedScriptSignature signature(path, type, version, GetFileLastUpdateTime(path));
-    return cacheStore_.Load(signature, signature, fileLoader_);
+    InvalidateIfDependencyUpdated(signature);
+    const auto& script = cacheStore_.Load(signature, signature, fileLoader_, cacheDir_, tokenCache_);
+    RegisterDependencies(script);
+    return script;
 }
 
 SerializedScriptSignature SerializedScriptStore::LoadAsync(const std::wstring & path, ScriptType type, const std::wstring & version)
 {
     SerializedScriptSignature signature(path, type, version, GetFileLastUpdateTime(path));
-    cacheStore_.LoadAsync(signature, signature, fileLoader_);
+    InvalidateIfDependencyUpdated(signature);
+    cacheStore_.LoadAsync(signature, signature, fileLoader_, cacheDir_, tokenCache_);
     return signature;
 }
 
@@ -176,4 +457,66 @@ bool SerializedScriptStore::IsLoadCompleted(const SerializedScriptSignature & si
 {
     return cacheStore_.IsLoadCompleted(signature);
 }
+
+void SerializedScriptStore::InvalidateDependents(const std::wstring & path)
+{
+    const auto canonicalPath = GetCanonicalPath(path);
+    tokenCache_->Remove(canonicalPath);
+    std::lock_guard<std::mutex> lock(dependentsMutex_);
+    auto it = dependents_.find(canonicalPath);
+    if (it == dependents_.end()) return;
+    for (const auto& signature : it->second)
+    {
+        cacheStore_.Remove(signature);
+    }
+    dependents_.erase(it);
+}
+
+std::vector<SerializedScriptSignature> SerializedScriptStore::GetDependents(const std::wstring & path) const
+{
+    std::vector<SerializedScriptSignature> signatures;
+    std::lock_guard<std::mutex> lock(dependentsMutex_);
+    auto it = dependents_.find(GetCanonicalPath(path));
+    if (it != dependents_.end())
+    {
+        signatures.assign(it->second.begin(), it->second.end());
+    }
+    return signatures;
+}
+
+void SerializedScriptStore::InvalidateIfDependencyUpdated(const SerializedScriptSignature & signature)
+{
+    if (!cacheStore_.IsLoadCompleted(signature)) return;
+    auto script = Get(signature);
+    if (!script)
+    {
+        // RpCɎsXNvginclude悪Ă邩Ȃ̂ō蒼
+        cacheStore_.Remove(signature);
+        return;
+    }
+    bool updated = false;
+    for (const auto& dep : script->GetDependencies())
+    {
+        if (GetFileLastUpdateTime(dep.path) != dep.lastUpdateTime)
+        {
+            // t@CɈˑĂ鑼̃XNvg܂Ƃ߂Ĕj
+            InvalidateDependents(dep.path);
+            updated = true;
+        }
+    }
+    if (updated)
+    {
+        // ˑOtɖo^(LoadAsynĉ)̏ꍇ
+        cacheStore_.Remove(signature);
+    }
+}
+
+void SerializedScriptStore::RegisterDependencies(const std::shared_ptr<SerializedScript>& script)
+{
+    std::lock_guard<std::mutex> lock(dependentsMutex_);
+    for (const auto& dep : script->GetDependencies())
+    {
+        dependents_[dep.path].insert(script->GetSignature());
+    }
+}
 }
\ No newline at end of file
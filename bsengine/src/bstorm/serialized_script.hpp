@@ -9,6 +9,9 @@
 #include <memory>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <cstdint>
 
 namespace bstorm
 {
@@ -40,11 +43,24 @@ struct hash<bstorm::SerializedScriptSignature>
 
 namespace bstorm
 {
+constexpr wchar_t DEFAULT_SCRIPT_CACHE_DIR[] = L"cache/script";
+
+// a file read while compiling a script (the script itself and its #include files)
+struct ScriptDependency
+{
+    std::wstring path;
+    uint64_t contentHash;
+    TimeStamp lastUpdateTime;
+};
+
 class FileLoader;
+class DnhTokenCache;
 class SerializedScript
 {
 public:
-    SerializedScript(const SerializedScriptSignature& signature, const std::shared_ptr<FileLoader>& fileLoader);
+    // cacheDir : directory of on-disk bytecode cache, empty = disabled
+    // tokenCache : nullable
+    SerializedScript(const SerializedScriptSignature& signature, const std::shared_ptr<FileLoader>& fileLoader, const std::wstring& cacheDir, const std::shared_ptr<DnhTokenCache>& tokenCache);
     const std::string& GetScriptInfo() const { return scriptInfo_; }
     const std::string& GetSourceMap() const { return srcMap_; }
     const char* GetByteCode() { return byteCode_.data(); }
@@ -52,8 +68,18 @@ public:
     const std::string& GetSourceCode() const { return srcCode_; }
     std::string GetConvertedBuiltInSubName(const std::string& name) const;
     const SerializedScriptSignature& GetSignature() const { return signature_; }
+    const std::vector<ScriptDependency>& GetDependencies() const { return dependencies_; }
+    const std::vector<ScriptReference>& GetScriptReferences() const { return scriptRefs_; }
+    bool IsLoadedFromDiskCache() const { return loadedFromDiskCache_; }
 private:
+    void Compile(const std::shared_ptr<FileLoader>& fileLoader, const std::shared_ptr<DnhTokenCache>& tokenCache);
+    std::wstring GetDiskCachePath(const std::wstring& cacheDir) const;
+    bool LoadDiskCache(const std::wstring& cachePath, const std::shared_ptr<FileLoader>& fileLoader);
+    void SaveDiskCache(const std::wstring& cachePath) const;
     const SerializedScriptSignature signature_;
+    std::vector<ScriptDependency> dependencies_;
+    std::vector<ScriptReference> scriptRefs_;
+    bool loadedFromDiskCache_;
     std::string scriptInfo_;
     std::string srcMap_;
     std::string byteCode_;
@@ -64,16 +90,28 @@ private:
 class SerializedScriptStore
 {
 public:
-    SerializedScriptStore(const std::shared_ptr<FileLoader>& fileLoader);
+    SerializedScriptStore(const std::shared_ptr<FileLoader>& fileLoader, const std::wstring& cacheDir);
     const std::shared_ptr<SerializedScript>& Load(const std::wstring& path, ScriptType type, const std::wstring& version);
     SerializedScriptSignature LoadAsync(const std::wstring& path, ScriptType type, const std::wstring& version);
     NullableSharedPtr<SerializedScript> Get(const SerializedScriptSignature& signature) const;
     void RemoveCache(const SerializedScriptSignature& signature);
     bool IsLoadCompleted(const SerializedScriptSignature& signature) const;
+    // discard all scripts which depend on the file (e.g. an #include file was updated)
+    void InvalidateDependents(const std::wstring& path);
+    std::vector<SerializedScriptSignature> GetDependents(const std::wstring& path) const;
+    const std::shared_ptr<DnhTokenCache>& GetTokenCache() const { return tokenCache_; }
     template <class Fn>
     void ForEach(Fn func) { cacheStore_.ForEach(func); }
 private:
+    // discard the script if any of its dependencies was updated since compiled
+    void InvalidateIfDependencyUpdated(const SerializedScriptSignature& signature);
+    void RegisterDependencies(const std::shared_ptr<SerializedScript>& script);
     std::shared_ptr<FileLoader> fileLoader_;
+    const std::wstring cacheDir_;
+    std::shared_ptr<DnhTokenCache> tokenCache_;
     CacheStore<SerializedScriptSignature, SerializedScript> cacheStore_;
+    // dependency path -> scripts
+    std::unordered_map<std::wstring, std::unordered_set<SerializedScriptSignature>> dependents_;
+    mutable std::mutex dependentsMutex_;
 };
 }
@@ -0,0 +1,172 @@
+﻿#include <bstorm/shot_move_batch.hpp>
+
+#include <bstorm/obj_shot.hpp>
+#include <bstorm/package.hpp>
+#include <bstorm/thread_util.hpp>
+
+#include <algorithm>
+
+namespace bstorm
+{
+ShotMoveBatch::ShotMoveBatch(const Package* package) :
+    package_(package),
+    threadCnt_(1)
+{
+}
+
+ShotMoveBatch::~ShotMoveBatch()
+{
+}
+
+bool ShotMoveBatch::Add(Obj* obj)
+{
+    ObjShot* shot = ObjCast<ObjShot>(obj);
+    if (!shot || !shot->IsMoveBatchable()) return false;
+    const auto& mode = shot->GetMoveMode();
+    if (mode->GetKind() == MoveMode::Kind::A)
+    {
+        auto modeA = static_cast<MoveModeA*>(mode.get());
+        entries_.push_back(Entry{ shot, false, (uint32_t)lanesA_.Size() });
+        lanesA_.modes.push_back(modeA);
+        lanesA_.x.push_back(shot->GetMoveX());
+        lanesA_.y.push_back(shot->GetMoveY());
+        lanesA_.speed.push_back(modeA->GetSpeed());
+        lanesA_.angle.push_back(modeA->GetAngle());
+        lanesA_.accel.push_back(modeA->GetAcceleration());
+        lanesA_.maxSpeed.push_back(modeA->GetMaxSpeed());
+        lanesA_.angularVelocity.push_back(modeA->GetAngularVelocity());
+    } else
+    {
+        auto modeB = static_cast<MoveModeB*>(mode.get());
+        entries_.push_back(Entry{ shot, true, (uint32_t)lanesB_.Size() });
+        lanesB_.modes.push_back(modeB);
+        lanesB_.x.push_back(shot->GetMoveX());
+        lanesB_.y.push_back(shot->GetMoveY());
+        lanesB_.speedX.push_back(modeB->GetSpeedX());
+        lanesB_.speedY.push_back(modeB->GetSpeedY());
+        lanesB_.accelX.push_back(modeB->GetAccelerationX());
+        lanesB_.accelY.push_back(modeB->GetAccelerationY());
+        lanesB_.maxSpeedX.push_back(modeB->GetMaxSpeedX());
+        lanesB_.maxSpeedY.push_back(modeB->GetMaxSpeedY());
+    }
+    return true;
+}
+
+void ShotMoveBatch::Flush()
+{
+    if (entries_.empty()) return;
+
+    // 並列: 移動と弾ごとに独立した処理
+    const int shotCnt = (int)entries_.size();
+    const int threadCnt = std::min(threadCnt_, shotCnt / MIN_SHOT_COUNT_PER_THREAD);
+    isAutoDeleted_.resize(shotCnt);
+    ParallelRange(shotCnt, threadCnt, [&](int begin, int end)
+    {
+        UpdateLocal(begin, end, *package_);
+    });
+
+    // 逐次: 逐次更新と同じ順で位置を書き戻し, 副作用のある処理を行う (当たり判定の移動順や削除順を変えないため)
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+        const auto& entry = entries_[i];
+        ObjShot* shot = entry.shot;
+        if (shot->IsDead()) continue;
+        if (entry.isModeB)
+        {
+            shot->SetMovePosition(lanesB_.x[entry.lane], lanesB_.y[entry.lane]);
+        } else
+        {
+            shot->SetMovePosition(lanesA_.x[entry.lane], lanesA_.y[entry.lane]);
+        }
+        shot->UpdateAfterMoveShared(isAutoDeleted_[i] != 0);
+    }
+    entries_.clear();
+    lanesA_.Clear();
+    lanesB_.Clear();
+}
+
+void ShotMoveBatch::SetThreadCount(int threadCnt)
+{
+    threadCnt_ = std::max(1, threadCnt);
+}
+
+void ShotMoveBatch::UpdateLocal(size_t begin, size_t end, const Package& package)
+{
+    // entries_[begin, end)に含まれるレーンは種類ごとに連続している
+    size_t laneBeginA = lanesA_.Size();
+    size_t laneEndA = 0;
+    size_t laneBeginB = lanesB_.Size();
+    size_t laneEndB = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        const auto& entry = entries_[i];
+        if (entry.isModeB)
+        {
+            laneBeginB = std::min(laneBeginB, (size_t)entry.lane);
+            laneEndB = entry.lane + 1;
+        } else
+        {
+            laneBeginA = std::min(laneBeginA, (size_t)entry.lane);
+            laneEndA = entry.lane + 1;
+        }
+    }
+    if (laneBeginA < laneEndA)
+    {
+        const size_t l = laneBeginA;
+        MoveModeAKernel(laneEndA - l, &lanesA_.x[l], &lanesA_.y[l], &lanesA_.speed[l], &lanesA_.angle[l],
+                        &lanesA_.accel[l], &lanesA_.maxSpeed[l], &lanesA_.angularVelocity[l]);
+    }
+    if (laneBeginB < laneEndB)
+    {
+        const size_t l = laneBeginB;
+        MoveModeBKernel(laneEndB - l, &lanesB_.x[l], &lanesB_.y[l], &lanesB_.speedX[l], &lanesB_.speedY[l],
+                        &lanesB_.accelX[l], &lanesB_.accelY[l], &lanesB_.maxSpeedX[l], &lanesB_.maxSpeedY[l]);
+    }
+    for (size_t i = begin; i < end; i++)
+    {
+        const auto& entry = entries_[i];
+        float x, y;
+        if (entry.isModeB)
+        {
+            auto modeB = lanesB_.modes[entry.lane];
+            modeB->SetSpeedX(lanesB_.speedX[entry.lane]);
+            modeB->SetSpeedY(lanesB_.speedY[entry.lane]);
+            x = lanesB_.x[entry.lane];
+            y = lanesB_.y[entry.lane];
+        } else
+        {
+            auto modeA = lanesA_.modes[entry.lane];
+            modeA->SetSpeed(lanesA_.speed[entry.lane]);
+            modeA->SetAngle(lanesA_.angle[entry.lane]);
+            x = lanesA_.x[entry.lane];
+            y = lanesA_.y[entry.lane];
+        }
+        isAutoDeleted_[i] = entry.shot->UpdateAfterMoveLocal(package, x, y);
+    }
+}
+
+void ShotMoveBatch::LanesA::Clear()
+{
+    modes.clear();
+    x.clear();
+    y.clear();
+    speed.clear();
+    angle.clear();
+    accel.clear();
+    maxSpeed.clear();
+    angularVelocity.clear();
+}
+
+void ShotMoveBatch::LanesB::Clear()
+{
+    modes.clear();
+    x.clear();
+    y.clear();
+    speedX.clear();
+    speedY.clear();
+    accelX.clear();
+    accelY.clear();
+    maxSpeedX.clear();
+    maxSpeedY.clear();
+}
+}
@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include <bstorm/obj.hpp>
+
+#include <vector>
+#include <cstdint>
+
+namespace bstorm
+{
+class ObjShot;
+class MoveModeA;
+class MoveModeB;
+// 弾の移動をまとめて行う
+// MoveModeA, MoveModeBの弾の位置と速度等を種類別の配列(SoA)に集めてMoveModeAKernel, MoveModeBKernelで一度に進め,
+// 弾ごとに独立した処理(ObjShot::UpdateAfterMoveLocal)までをスレッド数で分割して並列に行う
+// 位置の書き戻しと削除などの副作用(ObjShot::UpdateAfterMoveShared)は追加順に逐次行うので, 結果はスレッド数によらない
+class ShotMoveBatch : public ObjUpdateBatch
+{
+public:
+    ShotMoveBatch(const Package* package); // packageがShotMoveBatchを所有する
+    ~ShotMoveBatch();
+    bool Add(Obj* obj) override;
+    void Flush() override;
+    int GetThreadCount() const { return threadCnt_; }
+    void SetThreadCount(int threadCnt);
+    // これより少ない弾数では並列化しない
+    static constexpr int MIN_SHOT_COUNT_PER_THREAD = 512;
+private:
+    void UpdateLocal(size_t begin, size_t end, const Package& package);
+    struct LanesA
+    {
+        void Clear();
+        size_t Size() const { return modes.size(); }
+        std::vector<MoveModeA*> modes;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> speed;
+        std::vector<float> angle;
+        std::vector<float> accel;
+        std::vector<float> maxSpeed;
+        std::vector<float> angularVelocity;
+    };
+    struct LanesB
+    {
+        void Clear();
+        size_t Size() const { return modes.size(); }
+        std::vector<MoveModeB*> modes;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> speedX;
+        std::vector<float> speedY;
+        std::vector<float> accelX;
+        std::vector<float> accelY;
+        std::vector<float> maxSpeedX;
+        std::vector<float> maxSpeedY;
+    };
+    struct Entry
+    {
+        ObjShot* shot;
+        bool isModeB;
+        uint32_t lane;
+    };
+    const Package* package_;
+    int threadCnt_;
+    std::vector<Entry> entries_; // 追加順
+    std::vector<uint8_t> isAutoDeleted_; // entries_と同じ並び
+    LanesA lanesA_;
+    LanesB lanesB_;
+};
+}
@@ -1,6 +1,5 @@
 ﻿#include <bstorm/texture.hpp>
 
-#include <bstorm/file_util.hpp>
 #include <bstorm/ptr_util.hpp>
 #include <bstorm/logger.hpp>
 #include <bstorm/graphic_device.hpp>
@@ -109,58 +108,4 @@ int GetD3DTextureHeight(IDirect3DTexture9 * texture)
     GetD3DTextureSize(texture, &w, &h);
     return h;
 }
-
-TextureStore::TextureStore(const std::shared_ptr<GraphicDevice>& graphicDevice) :
-    graphicDevice_(graphicDevice)
-{
-}
-
-TextureStore::~TextureStore()
-{
-}
-
-const std::shared_ptr<Texture>& TextureStore::Load(const std::wstring & path)
-{
-    auto uniqPath = GetCanonicalPath(path);
-    if (cacheStore_.Contains(uniqPath))
-    {
-        return cacheStore_.Get(uniqPath);
-    }
-    auto& texture = cacheStore_.Load(uniqPath, uniqPath, graphicDevice_);
-    Logger::Write(std::move(
-        Log(LogLevel::LV_INFO).Msg(std::string("load texture."))
-        .Param(LogParam(LogParam::Tag::TEXTURE, uniqPath))));
-    return texture;
-}
-
-void TextureStore::LoadInThread(const std::wstring & path)
-{
-    auto uniqPath = GetCanonicalPath(path);
-    if (cacheStore_.Contains(uniqPath)) return;
-    cacheStore_.LoadAsync(uniqPath, uniqPath, graphicDevice_);
-    Logger::Write(std::move(
-        Log(LogLevel::LV_INFO).Msg(std::string("load texture (async)."))
-        .Param(LogParam(LogParam::Tag::TEXTURE, uniqPath))));
-}
-
-void TextureStore::SetReserveFlag(const std::wstring & path, bool reserve)
-{
-    auto uniqPath = GetCanonicalPath(path);
-    cacheStore_.SetReserveFlag(uniqPath, reserve);
-}
-
-bool TextureStore::IsReserved(const std::wstring & path) const
-{
-    return cacheStore_.IsReserved(path);
-}
-
-void TextureStore::RemoveUnusedTexture()
-{
-    cacheStore_.RemoveUnused();
-}
-bool TextureStore::IsLoadCompleted(const std::wstring& path) const
-{
-    auto uniqPath = GetCanonicalPath(path);
-    return cacheStore_.IsLoadCompleted(uniqPath);
-}
 }
\ No newline at end of file
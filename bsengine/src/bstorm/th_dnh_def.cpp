@@ -26,6 +26,8 @@ ThDnhDef LoadThDnhDef(const std::string & path)
         std::string line;
         while (std::getline(ss, line))
         {
+            // eLXg[hŉsR[hϊȂłCRc
+            if (!line.empty() && line.back() == '\r') line.pop_back();
             if (line.empty()) continue;
             std::smatch match;
             if (regex_match(line, match, std::regex(R"(screen.width\s*=\s*(\d+))")))
@@ -1,6 +1,8 @@
-#pragma once
+﻿#pragma once
 
+#include <algorithm>
 #include <future>
+#include <thread>
 #include <vector>
 
 namespace bstorm
@@ -23,4 +25,29 @@ void ParallelTimes(int loopCnt, Fn&& func)
     }
     for (const auto& worker : workers) { worker.wait(); }
 }
+
+// [0, loopCnt)をthreadCnt個の区間に分けてfunc(begin, end)を並列に呼ぶ
+// 最初の区間は呼び出し元のスレッドで処理する
+template <class Fn>
+void ParallelRange(int loopCnt, int threadCnt, Fn&& func)
+{
+    threadCnt = std::max(1, std::min(threadCnt, loopCnt));
+    if (threadCnt <= 1)
+    {
+        func(0, loopCnt);
+        return;
+    }
+    auto getBegin = [=](int id) { return loopCnt / threadCnt * id + std::min(loopCnt % threadCnt, id); };
+    std::vector<std::future<void>> workers;
+    workers.reserve(threadCnt - 1);
+    for (int id = 1; id < threadCnt; ++id)
+    {
+        workers.emplace_back(std::async(std::launch::async, [&func, getBegin](int id)
+        {
+            func(getBegin(id), getBegin(id + 1));
+        }, id));
+    }
+    func(getBegin(0), getBegin(1));
+    for (auto& worker : workers) { worker.get(); }
+}
 }
\ No newline at end of file
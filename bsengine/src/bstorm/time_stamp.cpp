@@ -13,12 +13,14 @@ TimeStamp GetFileLastUpdateTime(const std::wstring & file) noexcept(false)
     }
 
     FILETIME lastUpdateTime;
+    TimeStamp timeStamp = TIME_STAMP_NONE;
     if (GetFileTime(fileHandle, NULL, NULL, &lastUpdateTime))
     {
         uint64_t high = static_cast<uint64_t>(lastUpdateTime.dwHighDateTime);
         uint64_t low = static_cast<uint64_t>(lastUpdateTime.dwLowDateTime);
-        return (high << 32u) | low;
+        timeStamp = (high << 32u) | low;
     }
-    return TIME_STAMP_NONE;
+    CloseHandle(fileHandle);
+    return timeStamp;
 }
 }
@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include <bstorm/env.hpp>
+#include <bstorm/node.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bstorm
+{
+// テスト用に構文木を組み立てる
+// パーサ(dnh.y)と同じく, 定義はブロックの名前表に, 文はブロックの文の列に入れる
+class AstBuilder
+{
+public:
+    using Exps = std::vector<std::shared_ptr<NodeExp>>;
+    AstBuilder() : env_(std::make_shared<Env>()), blockStmts_(1) {}
+
+    static std::shared_ptr<NodeExp> Num(const std::string& n) { return std::make_shared<NodeNum>(std::string(n)); }
+    static std::shared_ptr<NodeExp> Ref(const std::string& name) { return std::make_shared<NodeNoParenCallExp>(name); }
+    static std::shared_ptr<NodeExp> Call(const std::string& name, Exps&& args) { return std::make_shared<NodeCallExp>(name, std::move(args)); }
+    static std::shared_ptr<NodeExp> Array(Exps&& elems) { return std::make_shared<NodeArray>(std::move(elems)); }
+
+    // let name = rhs;
+    std::shared_ptr<NodeVarInit> Let(const std::string& name, const std::shared_ptr<NodeExp>& rhs)
+    {
+        auto stmt = std::make_shared<NodeVarInit>(name, rhs);
+        env_->AddDef(name, std::make_shared<NodeVarDecl>(name));
+        AddStmt(stmt);
+        return stmt;
+    }
+    // name[indices] = rhs;
+    std::shared_ptr<NodeAssign> Assign(const std::string& name, Exps&& indices, const std::shared_ptr<NodeExp>& rhs)
+    {
+        auto stmt = std::make_shared<NodeAssign>(std::make_shared<NodeLeftVal>(name, std::move(indices)), rhs);
+        AddStmt(stmt);
+        return stmt;
+    }
+    // name++;
+    void Succ(const std::string& name)
+    {
+        AddStmt(std::make_shared<NodeSucc>(std::make_shared<NodeLeftVal>(name, Exps())));
+    }
+    // return exp;
+    void Return(const std::shared_ptr<NodeExp>& exp)
+    {
+        AddStmt(std::make_shared<NodeReturn>(exp));
+    }
+    // function name(params) { body }
+    void Function(const std::string& name, std::vector<std::string>&& params, const std::function<void()>& body)
+    {
+        env_ = std::make_shared<Env>(env_);
+        blockStmts_.emplace_back();
+        for (const auto& param : params)
+        {
+            env_->AddDef(param, std::make_shared<NodeProcParam>(param));
+        }
+        env_->AddDef("result", std::make_shared<NodeResult>());
+        body();
+        auto blk = std::make_shared<NodeBlock>(env_->GetCurrentBlockNameTable(), std::move(blockStmts_.back()));
+        blockStmts_.pop_back();
+        env_ = env_->GetParent();
+        env_->AddDef(name, std::make_shared<NodeFuncDef>(name, std::move(params), blk));
+    }
+    std::shared_ptr<NodeBlock> Build()
+    {
+        return std::make_shared<NodeBlock>(env_->GetCurrentBlockNameTable(), std::move(blockStmts_.back()));
+    }
+    std::shared_ptr<NodeDef> FindDef(const std::string& name) const { return env_->FindDef(name); }
+private:
+    void AddStmt(const std::shared_ptr<NodeStmt>& stmt) { blockStmts_.back().push_back(stmt); }
+    std::shared_ptr<Env> env_;
+    std::vector<std::vector<std::shared_ptr<NodeStmt>>> blockStmts_;
+};
+}
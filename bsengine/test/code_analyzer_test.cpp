@@ -0,0 +1,50 @@
+﻿#include <bstorm/code_analyzer.hpp>
+
+#include "ast_builder.hpp"
+#include "test_util.hpp"
+
+using namespace bstorm;
+
+// 一度スカラーと推論された変数が, 再解析で配列になった場合
+//   let y = [1]; let x = 0; x = y; let z = x; z[0] = 9;
+// z = x はコピーしないとyの中身が書き換わる
+static void TestCopyRequiredAfterRejectedGuess()
+{
+    AstBuilder b;
+    b.Let("y", b.Array({ b.Num("1") }));
+    b.Let("x", b.Num("0"));
+    b.Assign("x", {}, b.Ref("y"));
+    auto zInit = b.Let("z", b.Ref("x"));
+    b.Assign("z", { b.Num("0") }, b.Num("9"));
+    auto program = b.Build();
+
+    CodeAnalyzer analyzer;
+    analyzer.Analyze(*program);
+
+    TEST_CHECK(b.FindDef("x")->retType == ExpType::ANY);
+    TEST_CHECK(zInit->rhs->expType == ExpType::ANY);
+    TEST_CHECK(zInit->rhs->copyRequired);
+}
+
+// スカラーの変数の参照はコピーしない
+static void TestScalarRefNotCopied()
+{
+    AstBuilder b;
+    b.Let("a", b.Num("0"));
+    auto bInit = b.Let("b", b.Ref("a"));
+    b.Assign("a", {}, b.Num("1"));
+    auto program = b.Build();
+
+    CodeAnalyzer analyzer;
+    analyzer.Analyze(*program);
+
+    TEST_CHECK(b.FindDef("a")->retType == ExpType::REAL);
+    TEST_CHECK(!bInit->rhs->copyRequired);
+}
+
+int main()
+{
+    TestCopyRequiredAfterRejectedGuess();
+    TestScalarRefNotCopied();
+    return TestResult("code_analyzer_test");
+}
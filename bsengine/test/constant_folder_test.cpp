@@ -0,0 +1,39 @@
+﻿#include <bstorm/code_analyzer.hpp>
+#include <bstorm/constant_folder.hpp>
+
+#include "ast_builder.hpp"
+#include "test_util.hpp"
+
+using namespace bstorm;
+
+// 負の数に畳み込んだ式も実数の演算として特殊化される
+//   let x = 2; let y = (0 - 1) * x; x = 3;
+static void TestFoldedNegativeKeepsRealType()
+{
+    AstBuilder b;
+    b.Let("x", b.Num("2"));
+    auto yInit = b.Let("y", std::make_shared<NodeMul>(std::make_shared<NodeSub>(b.Num("0"), b.Num("1")), b.Ref("x")));
+    b.Assign("x", {}, b.Num("3"));
+    auto program = b.Build();
+
+    CodeAnalyzer analyzer;
+    analyzer.Analyze(*program);
+    ConstantFolder folder;
+    TEST_CHECK(folder.Fold(*program) > 0);
+
+    auto mul = std::dynamic_pointer_cast<NodeMul>(yInit->rhs);
+    TEST_CHECK(mul != nullptr);
+    if (!mul) return;
+    auto neg = std::dynamic_pointer_cast<NodeNeg>(mul->lhs);
+    TEST_CHECK(neg != nullptr);
+    if (!neg) return;
+    TEST_CHECK(neg->expType == ExpType::REAL);
+    TEST_CHECK(!neg->copyRequired);
+    TEST_CHECK(mul->expType == ExpType::REAL);
+}
+
+int main()
+{
+    TestFoldedNegativeKeepsRealType();
+    return TestResult("constant_folder_test");
+}
@@ -0,0 +1,91 @@
+﻿#include <bstorm/inliner.hpp>
+
+#include "ast_builder.hpp"
+#include "test_util.hpp"
+
+using namespace bstorm;
+
+// let x = 0;
+// function inc() { x++; return x; }
+// function f(a, b) { return b + a; }
+// function g(a, b) { return a; }
+static void DefineFunctions(AstBuilder& b)
+{
+    b.Let("x", b.Num("0"));
+    b.Function("inc", {}, [&]()
+    {
+        b.Succ("x");
+        b.Return(b.Ref("x"));
+    });
+    b.Function("f", { "a", "b" }, [&]()
+    {
+        b.Return(std::make_shared<NodeAdd>(b.Ref("b"), b.Ref("a")));
+    });
+    b.Function("g", { "a", "b" }, [&]()
+    {
+        b.Return(b.Ref("a"));
+    });
+}
+
+static bool IsCallOf(const std::shared_ptr<NodeExp>& exp, const std::string& name)
+{
+    auto call = std::dynamic_pointer_cast<NodeCallExp>(exp);
+    return call && call->name == name;
+}
+
+// 副作用のない引数なら展開する
+//   let y = f(x, 2); => let y = 2 + x;
+static void TestInlinePureArgs()
+{
+    AstBuilder b;
+    DefineFunctions(b);
+    auto yInit = b.Let("y", b.Call("f", { b.Ref("x"), b.Num("2") }));
+    auto program = b.Build();
+
+    Inliner inliner;
+    inliner.Inline(*program);
+
+    auto add = std::dynamic_pointer_cast<NodeAdd>(yInit->rhs);
+    TEST_CHECK(add != nullptr);
+    if (!add) return;
+    TEST_CHECK(std::dynamic_pointer_cast<NodeNum>(add->lhs) != nullptr);
+    TEST_CHECK(std::dynamic_pointer_cast<NodeNoParenCallExp>(add->rhs) != nullptr);
+}
+
+// 展開すると x が inc() の後に読まれる
+//   let y = f(x, inc());
+static void TestKeepArgEvaluationOrder()
+{
+    AstBuilder b;
+    DefineFunctions(b);
+    auto yInit = b.Let("y", b.Call("f", { b.Ref("x"), b.Call("inc", {}) }));
+    auto program = b.Build();
+
+    Inliner inliner;
+    inliner.Inline(*program);
+
+    TEST_CHECK(IsCallOf(yInit->rhs, "f"));
+}
+
+// 展開すると使われない引数の inc() が呼ばれなくなる
+//   let y = g(x, inc());
+static void TestKeepUnusedSideEffectArg()
+{
+    AstBuilder b;
+    DefineFunctions(b);
+    auto yInit = b.Let("y", b.Call("g", { b.Ref("x"), b.Call("inc", {}) }));
+    auto program = b.Build();
+
+    Inliner inliner;
+    inliner.Inline(*program);
+
+    TEST_CHECK(IsCallOf(yInit->rhs, "g"));
+}
+
+int main()
+{
+    TestInlinePureArgs();
+    TestKeepArgEvaluationOrder();
+    TestKeepUnusedSideEffectArg();
+    return TestResult("inliner_test");
+}
@@ -0,0 +1,190 @@
+﻿#include <bstorm/intersection.hpp>
+#include <bstorm/broadphase.hpp>
+
+#include "test_util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace bstorm;
+
+constexpr int FIELD_WIDTH = 384;
+constexpr int FIELD_HEIGHT = 448;
+constexpr CollisionGroup GRP_TARGET = 0;
+constexpr CollisionGroup GRP_OTHER = 1;
+
+// オブジェクトのIDを持つ判定
+class TestIntersection : public Intersection
+{
+public:
+    TestIntersection(const Shape& shape, CollisionGroup colGroup, int id) :
+        Intersection(shape, colGroup),
+        id(id)
+    {
+    }
+    const int id;
+};
+
+static std::shared_ptr<CollisionMatrix> createCollisionMatrix()
+{
+    static const CollisionFunction matrix[4] = { nullptr, nullptr, nullptr, nullptr };
+    return std::make_shared<CollisionMatrix>(2, matrix);
+}
+
+static bool nearlyEqual(float a, float b)
+{
+    return std::abs(a - b) < 1e-3f;
+}
+
+static void TestShapeDistance()
+{
+    Shape circle(10.0f, 20.0f, 5.0f);
+    TEST_CHECK(circle.GetDistance(10.0f, 20.0f) == 0.0f);
+    TEST_CHECK(circle.GetDistance(13.0f, 20.0f) == 0.0f);
+    TEST_CHECK(nearlyEqual(circle.GetDistance(10.0f, 30.0f), 5.0f));
+    TEST_CHECK(nearlyEqual(circle.GetDistance(16.0f, 28.0f), 5.0f));
+
+    // (0, 0)-(10, 0), 幅4
+    Shape line(0.0f, 0.0f, 10.0f, 0.0f, 4.0f);
+    TEST_CHECK(line.GetDistance(5.0f, 1.0f) == 0.0f);
+    TEST_CHECK(nearlyEqual(line.GetDistance(5.0f, 5.0f), 3.0f));
+    TEST_CHECK(nearlyEqual(line.GetDistance(13.0f, 0.0f), 3.0f));
+    TEST_CHECK(nearlyEqual(line.GetDistance(-3.0f, -6.0f), 5.0f));
+
+    // 斜めの線 (0, 0)-(10, 10), 幅0
+    Shape diagonal(0.0f, 0.0f, 10.0f, 10.0f, 0.0f);
+    TEST_CHECK(nearlyEqual(diagonal.GetDistance(10.0f, 0.0f), std::sqrt(50.0f)));
+
+    const float xs[] = { 0.0f, 100.0f };
+    const float ys[] = { 0.0f, 0.0f };
+    const float rs[] = { 10.0f, 20.0f };
+    Shape circles(2, xs, ys, rs);
+    TEST_CHECK(nearlyEqual(circles.GetDistance(-30.0f, 0.0f), 20.0f));
+    TEST_CHECK(nearlyEqual(circles.GetDistance(70.0f, 0.0f), 10.0f));
+    TEST_CHECK(circles.GetDistance(110.0f, 0.0f) == 0.0f);
+}
+
+// 位置からずれた判定を持つオブジェクトは, 位置ではなく判定までの距離で並べる
+static void TestNearestByOffsetIntersection()
+{
+    CollisionDetector detector(FIELD_WIDTH, FIELD_HEIGHT, createCollisionMatrix());
+    // ID 1: 位置は(100, 100)だが判定は300px右にある
+    // ID 2: 位置は(250, 100)で判定も位置にある
+    auto isect1 = std::make_shared<TestIntersection>(Shape(400.0f, 100.0f, 8.0f), GRP_TARGET, 1);
+    auto isect2 = std::make_shared<TestIntersection>(Shape(250.0f, 100.0f, 8.0f), GRP_TARGET, 2);
+    detector.Add(isect1);
+    detector.Add(isect2);
+
+    std::vector<std::pair<float, int>> distances;
+    std::vector<int> ids;
+    auto getId = [](const std::shared_ptr<Intersection>& isect, int& id)
+    {
+        id = std::static_pointer_cast<TestIntersection>(isect)->id;
+        return true;
+    };
+    detector.CollectNearestIds(100.0f, 100.0f, 2, GRP_TARGET, getId, distances, ids);
+    TEST_CHECK(ids == std::vector<int>({ 2, 1 }));
+    detector.CollectNearestIds(100.0f, 100.0f, 1, GRP_TARGET, getId, distances, ids);
+    TEST_CHECK(ids == std::vector<int>({ 2 }));
+    detector.CollectNearestIds(100.0f, 100.0f, 0, GRP_TARGET, getId, distances, ids);
+    TEST_CHECK(ids.empty());
+}
+
+// 位置からずらした判定を複数持つオブジェクトを並べて, 全ての判定との距離を求めて並べた結果と比べる
+static void TestNearestMatchesBruteForce(const std::shared_ptr<Broadphase>& broadphase)
+{
+    CollisionDetector detector(broadphase, createCollisionMatrix());
+    std::mt19937 rng(12345);
+    auto uniform = [&](float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); };
+
+    constexpr int objCnt = 300;
+    std::vector<std::shared_ptr<TestIntersection>> isects;
+    for (int id = 1; id <= objCnt; id++)
+    {
+        // 画面外のオブジェクトも混ぜる
+        const bool outside = id % 10 == 0;
+        const float x = outside ? uniform(-1000.0f, 1400.0f) : uniform(0.0f, FIELD_WIDTH);
+        const float y = outside ? uniform(-1000.0f, 1400.0f) : uniform(0.0f, FIELD_HEIGHT);
+        const int isectCnt = 1 + id % 3;
+        for (int i = 0; i < isectCnt; i++)
+        {
+            const float ox = x + uniform(-150.0f, 150.0f);
+            const float oy = y + uniform(-150.0f, 150.0f);
+            const int type = (id + i) % 3;
+            if (type == 0)
+            {
+                isects.push_back(std::make_shared<TestIntersection>(Shape(ox, oy, uniform(2.0f, 20.0f)), GRP_TARGET, id));
+            } else if (type == 1)
+            {
+                isects.push_back(std::make_shared<TestIntersection>(Shape(ox, oy, ox + uniform(-80.0f, 80.0f), oy + uniform(-80.0f, 80.0f), uniform(0.0f, 10.0f)), GRP_TARGET, id));
+            } else
+            {
+                const float xs[] = { ox, ox + uniform(-30.0f, 30.0f), ox + uniform(-30.0f, 30.0f) };
+                const float ys[] = { oy, oy + uniform(-30.0f, 30.0f), oy + uniform(-30.0f, 30.0f) };
+                const float rs[] = { uniform(2.0f, 10.0f), uniform(2.0f, 10.0f), uniform(2.0f, 10.0f) };
+                isects.push_back(std::make_shared<TestIntersection>(Shape(3, xs, ys, rs), GRP_TARGET, id));
+            }
+        }
+        // 対象でないグループの判定
+        isects.push_back(std::make_shared<TestIntersection>(Shape(x, y, 4.0f), GRP_OTHER, -id));
+    }
+    for (const auto& isect : isects)
+    {
+        detector.Add(isect);
+    }
+
+    // 7の倍数のIDは対応するオブジェクトがないものとして扱う
+    auto getId = [](const std::shared_ptr<Intersection>& isect, int& id)
+    {
+        id = std::static_pointer_cast<TestIntersection>(isect)->id;
+        return id % 7 != 0;
+    };
+
+    std::vector<std::pair<float, int>> distances;
+    std::vector<int> ids;
+    for (int q = 0; q < 200; q++)
+    {
+        const float x = q % 5 == 0 ? uniform(-500.0f, 900.0f) : uniform(0.0f, FIELD_WIDTH);
+        const float y = q % 5 == 0 ? uniform(-500.0f, 900.0f) : uniform(0.0f, FIELD_HEIGHT);
+        for (int k : { 1, 3, 10, 50, objCnt + 10 })
+        {
+            std::map<int, float> nearest;
+            for (const auto& isect : isects)
+            {
+                int id;
+                if (isect->GetCollisionGroup() != GRP_TARGET || !getId(isect, id)) continue;
+                const float dist = isect->GetShape().GetDistance(x, y);
+                auto it = nearest.find(id);
+                if (it == nearest.end() || dist < it->second) nearest[id] = dist;
+            }
+            std::vector<std::pair<float, int>> expected;
+            for (const auto& entry : nearest)
+            {
+                expected.emplace_back(entry.second, entry.first);
+            }
+            std::sort(expected.begin(), expected.end());
+            expected.resize(std::min((size_t)k, expected.size()));
+            std::vector<int> expectedIds;
+            for (const auto& entry : expected)
+            {
+                expectedIds.push_back(entry.second);
+            }
+
+            detector.CollectNearestIds(x, y, k, GRP_TARGET, getId, distances, ids);
+            TEST_CHECK(ids == expectedIds);
+        }
+    }
+}
+
+int main()
+{
+    TestShapeDistance();
+    TestNearestByOffsetIntersection();
+    TestNearestMatchesBruteForce(std::make_shared<QuadTreeBroadphase>(FIELD_WIDTH, FIELD_HEIGHT));
+    TestNearestMatchesBruteForce(std::make_shared<UniformGridBroadphase>(FIELD_WIDTH, FIELD_HEIGHT, 32.0f));
+    return TestResult("intersection_test");
+}
@@ -0,0 +1,73 @@
+﻿#include <bstorm/obj.hpp>
+
+#include "test_util.hpp"
+
+#include <functional>
+
+using namespace bstorm;
+
+class TestObj : public Obj
+{
+public:
+    TestObj() : Obj(nullptr) {}
+    void Update() override { if (onUpdate) onUpdate(); }
+    void Kill() { Die(); }
+    std::function<void()> onUpdate;
+};
+
+// 自分で死んだオブジェクトを, 他のオブジェクトの削除のついでに取り除く場合
+// (当たり判定で消えた弾 -> Obj_Delete -> GetAllEnemyID)
+static void TestFreeSlotOfSelfKilledObject()
+{
+    ObjectTable table;
+    auto a = table.Create<TestObj>();
+    auto b = table.Create<TestObj>();
+    auto c = table.Create<TestObj>();
+    const size_t slotCnt = table.GetSlotCount();
+
+    a->Kill();
+    table.Delete(b->GetID());
+    TEST_CHECK(table.GetAll().size() == 1);
+    TEST_CHECK(table.GetFreeSlotCount() == 2);
+    TEST_CHECK(table.GetSlotCount() == slotCnt);
+    TEST_CHECK(table.IsDeleted(a->GetID()));
+    TEST_CHECK(!table.IsDeleted(c->GetID()));
+}
+
+// 更新中に, 更新済みの位置のオブジェクトを削除する場合
+static void TestFreeSlotOfObjectDeletedBehind()
+{
+    ObjectTable table;
+    auto a = table.Create<TestObj>();
+    auto b = table.Create<TestObj>();
+    b->onUpdate = [&]() { table.Delete(a->GetID()); };
+
+    table.UpdateAll(false);
+    TEST_CHECK(table.GetAll().size() == 1);
+    TEST_CHECK(table.GetFreeSlotCount() == 1);
+}
+
+// 自分で死んだオブジェクトは次の更新で取り除く
+static void TestFreeSlotOnUpdate()
+{
+    ObjectTable table;
+    for (int i = 0; i < 10; i++)
+    {
+        table.Create<TestObj>();
+    }
+    for (const auto& obj : table.GetAll())
+    {
+        std::static_pointer_cast<TestObj>(obj)->Kill();
+    }
+    table.UpdateAll(false);
+    TEST_CHECK(table.GetAll().empty());
+    TEST_CHECK(table.GetFreeSlotCount() == 10);
+}
+
+int main()
+{
+    TestFreeSlotOfSelfKilledObject();
+    TestFreeSlotOfObjectDeletedBehind();
+    TestFreeSlotOnUpdate();
+    return TestResult("obj_table_test");
+}
@@ -0,0 +1,21 @@
+﻿#include <bstorm/dnh_value.hpp>
+#include <bstorm/intersection.hpp>
+#include <bstorm/source_map.hpp>
+#include <bstorm/string_util.hpp>
+
+// テストでリンクしないソース(LuaJIT, yas, DirectXに依存するもの)の代わり
+namespace bstorm
+{
+const std::unique_ptr<DnhValue>& DnhValue::Nil()
+{
+    static const std::unique_ptr<DnhValue> nil;
+    return nil;
+}
+
+std::string SourcePos::ToString() const
+{
+    return ToUTF8(*filename) + ":" + std::to_string(line);
+}
+
+void Shape::Render(const std::shared_ptr<Renderer>& renderer, bool permitCamera) const {}
+}
@@ -0,0 +1,32 @@
+﻿#pragma once
+
+#include <cstdio>
+
+// 失敗した検査の数
+inline int& TestFailureCount()
+{
+    static int cnt = 0;
+    return cnt;
+}
+
+// 失敗しても続けて他の検査を行う
+#define TEST_CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            TestFailureCount()++; \
+        } \
+    } while (0)
+
+inline int TestResult(const char* name)
+{
+    if (TestFailureCount() == 0)
+    {
+        std::printf("%s: ok\n", name);
+        return 0;
+    }
+    std::printf("%s: %d check(s) failed\n", name, TestFailureCount());
+    return 1;
+}
@@ -102,6 +102,12 @@ void Shape::Render(const std::shared_ptr<Renderer>& renderer, bool permitCamera)
         D3DXMATRIX world;
         D3DXMatrixIdentity(&world);
         renderer->RenderPrim2D(D3DPT_TRIANGLESTRIP, vertices.size(), vertices.data(), nullptr, BLEND_ALPHA, world, std::shared_ptr<Shader>(), permitCamera, false);
+    } else if (type_ == Type::CIRCLES)
+    {
+        for (int i = 0; i < params_.Circles.count; i++)
+        {
+            GetCompoundCircleShape(i).Render(renderer, permitCamera);
+        }
     }
 }
 }
\ No newline at end of file
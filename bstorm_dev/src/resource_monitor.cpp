@@ -8,6 +8,7 @@
 #include <bstorm/serialized_script.hpp>
 #include <bstorm/logger.hpp>
 #include <bstorm/package.hpp>
+#include <bstorm/pool_allocator.hpp>
 
 #include <algorithm>
 #include <imgui.h>
@@ -270,6 +271,40 @@ void DrawScriptCacheInfoTab(const std::shared_ptr<SerializedScriptStore>& serial
     ImGui::EndChild();
 }
 
+void DrawPoolInfoTab()
+{
+    ImGui::Columns(7, "pool info");
+    ImGui::Separator();
+    ImGui::Text("type"); ImGui::NextColumn();
+    ImGui::Text("block-size"); ImGui::NextColumn();
+    ImGui::Text("live"); ImGui::NextColumn();
+    ImGui::Text("peak"); ImGui::NextColumn();
+    ImGui::Text("alloc"); ImGui::NextColumn();
+    ImGui::Text("reuse"); ImGui::NextColumn();
+    ImGui::Text("chunk"); ImGui::NextColumn();
+    ImGui::Separator();
+    for (const auto pool : FixedBlockPool::GetAll())
+    {
+        const auto& stats = pool->GetStats();
+        ImGui::Text("%s", pool->GetName().c_str()); ImGui::NextColumn();
+        ImGui::Text("%d", (int)pool->GetBlockSize()); ImGui::NextColumn();
+        ImGui::Text("%d", (int)stats.liveCount); ImGui::NextColumn();
+        ImGui::Text("%d", (int)stats.peakLiveCount); ImGui::NextColumn();
+        ImGui::Text("%d", (int)stats.allocCount); ImGui::NextColumn();
+        ImGui::Text("%d", (int)stats.reuseCount); ImGui::NextColumn();
+        ImGui::Text("%d", (int)stats.chunkCount); ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+    ImGui::Separator();
+    if (ImGui::Button("Reset"))
+    {
+        for (auto pool : FixedBlockPool::GetAll())
+        {
+            pool->ResetStats();
+        }
+    }
+}
+
 struct RenderTargetMonitor;
 template <>
 void Package::backDoor<RenderTargetMonitor>()
@@ -302,13 +337,14 @@ enum class Tab
     TEXTURE,
     FONT,
     RENDER_TARGET,
-    SCRIPT_CACHE
+    SCRIPT_CACHE,
+    POOL
 };
 
 template <>
 void Package::backDoor<ResourceMonitor>()
 {
-    ImGui::Columns(4, "resource tab");
+    ImGui::Columns(5, "resource tab");
     ImGui::Separator();
     static Tab selectedTab = Tab::TEXTURE;
     if (ImGui::Selectable("Texture##ResourceTextureTab", selectedTab == Tab::TEXTURE))
@@ -330,6 +366,11 @@ void Package::backDoor<ResourceMonitor>()
     {
         selectedTab = Tab::SCRIPT_CACHE;
     }
+    ImGui::NextColumn();
+    if (ImGui::Selectable("Pool##PoolTab", selectedTab == Tab::POOL))
+    {
+        selectedTab = Tab::POOL;
+    }
     ImGui::Columns(1);
     ImGui::Separator();
     switch (selectedTab)
@@ -346,6 +387,9 @@ void Package::backDoor<ResourceMonitor>()
         case Tab::SCRIPT_CACHE:
             DrawScriptCacheInfoTab(serializedScriptStore_);
             break;
+        case Tab::POOL:
+            DrawPoolInfoTab();
+            break;
 
     }
 }
@@ -156,7 +156,7 @@ void DrawIntersectionInfo(const std::shared_ptr<Intersection>& isect)
         ImGui::BeginGroup();
         const Shape& shape = isect->GetShape();
         auto shapeType = shape.GetType();
-        ImGui::BulletText("shape    : %s", shapeType == Shape::Type::CIRCLE ? "Circle" : "Line");
+        ImGui::BulletText("shape    : %s", shapeType == Shape::Type::CIRCLE ? "Circle" : shapeType == Shape::Type::CIRCLES ? "Circles" : "Line");
         if (shapeType == Shape::Type::CIRCLE)
         {
             float x, y, r;
@@ -173,6 +173,14 @@ void DrawIntersectionInfo(const std::shared_ptr<Intersection>& isect)
             ImGui::BulletText("end-x   : %f", x2);
             ImGui::BulletText("end-y   : %f", y2);
             ImGui::BulletText("width   : %f", width);
+        } else if (shapeType == Shape::Type::CIRCLES)
+        {
+            for (int i = 0; i < shape.GetCompoundCircleCount(); i++)
+            {
+                float x, y, r;
+                shape.GetCompoundCircle(i, x, y, r);
+                ImGui::BulletText("circle-%d : (%f, %f) r = %f", i, x, y, r);
+            }
         }
         ImGui::EndGroup();
     }
@@ -0,0 +1,99 @@
+﻿#include <bstorm/logger.hpp>
+#include <bstorm/engine.hpp>
+#include <bstorm/package.hpp>
+#include <bstorm/string_util.hpp>
+#include <bstorm/config.hpp>
+#include <bstorm/th_dnh_def.hpp>
+#include <bstorm/time_point.hpp>
+#include <bstorm/headless_stats.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace bstorm;
+
+constexpr const char* thDnhDefFilePath = "th_dnh.def";
+constexpr int defaultFrameCount = 600;
+
+// 警告とエラーだけを標準エラー出力に書く
+class StderrLogger : public Logger
+{
+public:
+    void log(Log& lg) noexcept(false) override
+    {
+        if (lg.Level() != LogLevel::LV_WARN && lg.Level() != LogLevel::LV_ERROR) return;
+        std::fprintf(stderr, "%s\n", lg.ToString().c_str());
+    }
+    void log(Log&& lg) noexcept(false) override
+    {
+        log(lg);
+    }
+};
+
+// usage: bstorm_headless [frame count] [package main script]
+// パッケージを描画せずに指定フレーム数だけ進め, 所要時間とバックエンドの記録を出力する
+int main(int argc, char* argv[])
+{
+    const int frameCount = argc > 1 ? std::atoi(argv[1]) : defaultFrameCount;
+    std::wstring packageMainScriptPath = argc > 2 ? ToUnicode(argv[2]) : L"";
+    int screenWidth = 640;
+    int screenHeight = 480;
+    int exitCode = 0;
+
+    Logger::Init(std::make_shared<StderrLogger>());
+
+    try
+    {
+        if (packageMainScriptPath.empty())
+        {
+            // th_dnh.def読み込み
+            ThDnhDef def = LoadThDnhDef(thDnhDefFilePath);
+            packageMainScriptPath = def.packageScriptMain;
+            screenWidth = def.screenWidth;
+            screenHeight = def.screenHeight;
+        }
+
+        if (packageMainScriptPath.empty())
+        {
+            throw Log(LogLevel::LV_ERROR).Msg("package main script not specified.");
+        }
+
+        conf::KeyConfig keyConfig;
+        Engine engine(NULL, &keyConfig);
+        auto package = engine.CreatePackage(screenWidth, screenHeight, packageMainScriptPath);
+        package->Start();
+
+        TimePoint startTime;
+        int frame = 0;
+        for (; frame < frameCount; frame++)
+        {
+            if (package->IsClosed()) break;
+            engine.UpdateFpsCounter();
+            package->TickFrame();
+            package->Render();
+        }
+        const float elapsedMilliSec = startTime.GetElapsedMilliSec();
+        package->Finalize();
+
+        const auto& stats = GetHeadlessStats();
+        std::printf("frames: %d\n", frame);
+        std::printf("total: %.3f ms\n", elapsedMilliSec);
+        std::printf("per frame: %.4f ms\n", frame == 0 ? 0.0f : elapsedMilliSec / frame);
+        std::printf("draw calls: %llu\n", (unsigned long long)stats.drawCallCount);
+        std::printf("vertices: %llu\n", (unsigned long long)stats.vertexCount);
+        std::printf("texture loads: %llu\n", (unsigned long long)stats.textureLoadCount);
+        std::printf("font creates: %llu\n", (unsigned long long)stats.fontCreateCount);
+        std::printf("sound plays: %llu\n", (unsigned long long)stats.soundPlayCount);
+    } catch (Log& log)
+    {
+        Logger::Write(log);
+        exitCode = 1;
+    } catch (const std::exception& e)
+    {
+        Logger::Write(LogLevel::LV_ERROR, e.what());
+        exitCode = 1;
+    }
+    Logger::Shutdown();
+    return exitCode;
+}